@@ -8,9 +8,13 @@
 #include <string>
 
 #include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 
 namespace base {
 
+class SecureHashAlgorithm;
+
 // These functions perform SHA-1 operations.
 
 static const size_t kSHA1Length = 20;  // Length in bytes of a SHA-1 hash.
@@ -24,6 +28,26 @@ BASE_EXPORT std::string SHA1HashString(const std::string& str);
 BASE_EXPORT void SHA1HashBytes(const unsigned char* data, size_t len,
                                unsigned char* hash);
 
+// Computes the SHA-1 hash of data that is supplied in several pieces, for
+// callers that produce their input incrementally.
+class BASE_EXPORT SHA1Hasher {
+ public:
+  SHA1Hasher();
+  ~SHA1Hasher();
+
+  // Adds the |len| bytes at |data| to the hashed data.
+  void Update(const void* data, size_t len);
+
+  // Returns the full hash of all the data passed to Update(), and resets the
+  // hasher so that it can be reused.
+  std::string Finish();
+
+ private:
+  scoped_ptr<SecureHashAlgorithm> sha_;
+
+  DISALLOW_COPY_AND_ASSIGN(SHA1Hasher);
+};
+
 }  // namespace base
 
 #endif  // BASE_SHA1_H_
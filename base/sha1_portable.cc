@@ -6,6 +6,8 @@
 
 #include <string.h>
 
+#include <algorithm>
+
 #include "base/basictypes.h"
 
 namespace base {
@@ -50,8 +52,6 @@ class SecureHashAlgorithm {
   void Pad();
   void Process();
 
-  uint32 A, B, C, D, E;
-
   uint32 H[5];
 
   union {
@@ -63,32 +63,22 @@ class SecureHashAlgorithm {
   uint64 l;
 };
 
-static inline uint32 f(uint32 t, uint32 B, uint32 C, uint32 D) {
-  if (t < 20) {
-    return (B & C) | ((~B) & D);
-  } else if (t < 40) {
-    return B ^ C ^ D;
-  } else if (t < 60) {
-    return (B & C) | (B & D) | (C & D);
-  } else {
-    return B ^ C ^ D;
-  }
-}
-
 static inline uint32 S(uint32 n, uint32 X) {
   return (X << n) | (X >> (32-n));
 }
 
-static inline uint32 K(uint32 t) {
-  if (t < 20) {
-    return 0x5a827999;
-  } else if (t < 40) {
-    return 0x6ed9eba1;
-  } else if (t < 60) {
-    return 0x8f1bbcdc;
-  } else {
-    return 0xca62c1d6;
-  }
+// The round functions of each group of 20 rounds.  These are split out,
+// rather than selected per round, so that the round loops are branch free.
+static inline uint32 Ch(uint32 B, uint32 C, uint32 D) {
+  return D ^ (B & (C ^ D));
+}
+
+static inline uint32 Parity(uint32 B, uint32 C, uint32 D) {
+  return B ^ C ^ D;
+}
+
+static inline uint32 Maj(uint32 B, uint32 C, uint32 D) {
+  return (B & C) | (D & (B | C));
 }
 
 static inline void swapends(uint32* t) {
@@ -98,11 +88,6 @@ static inline void swapends(uint32* t) {
 const int SecureHashAlgorithm::kDigestSizeBytes = 20;
 
 void SecureHashAlgorithm::Init() {
-  A = 0;
-  B = 0;
-  C = 0;
-  D = 0;
-  E = 0;
   cursor = 0;
   l = 0;
   H[0] = 0x67452301;
@@ -122,12 +107,31 @@ void SecureHashAlgorithm::Final() {
 
 void SecureHashAlgorithm::Update(const void* data, size_t nbytes) {
   const uint8* d = reinterpret_cast<const uint8*>(data);
-  while (nbytes--) {
-    M[cursor++] = *d++;
-    if (cursor >= 64)
-      Process();
-    l += 8;
+  l += static_cast<uint64>(nbytes) * 8;
+
+  // Top up a partially filled block first.
+  if (cursor > 0) {
+    size_t n = std::min(nbytes, static_cast<size_t>(64 - cursor));
+    memcpy(M + cursor, d, n);
+    cursor += static_cast<uint32>(n);
+    d += n;
+    nbytes -= n;
+    if (cursor < 64)
+      return;
+    Process();
   }
+
+  // Then process whole blocks straight from the input, rather than a byte at
+  // a time.
+  while (nbytes >= 64) {
+    memcpy(M, d, 64);
+    Process();
+    d += 64;
+    nbytes -= 64;
+  }
+
+  memcpy(M, d, nbytes);
+  cursor = static_cast<uint32>(nbytes);
 }
 
 void SecureHashAlgorithm::Pad() {
@@ -171,21 +175,35 @@ void SecureHashAlgorithm::Process() {
     W[t] = S(1, W[t - 3] ^ W[t - 8] ^ W[t - 14] ^ W[t - 16]);
 
   // c.
-  A = H[0];
-  B = H[1];
-  C = H[2];
-  D = H[3];
-  E = H[4];
+  //
+  // The working variables are locals so that they can live in registers.
+  uint32 A = H[0];
+  uint32 B = H[1];
+  uint32 C = H[2];
+  uint32 D = H[3];
+  uint32 E = H[4];
 
   // d.
-  for (t = 0; t < 80; ++t) {
-    uint32 TEMP = S(5, A) + f(t, B, C, D) + E + W[t] + K(t);
-    E = D;
-    D = C;
-    C = S(30, B);
-    B = A;
-    A = TEMP;
-  }
+#define SHA1_ROUND(func, k)                                  \
+  do {                                                       \
+    uint32 TEMP = S(5, A) + func(B, C, D) + E + W[t] + (k);  \
+    E = D;                                                   \
+    D = C;                                                   \
+    C = S(30, B);                                            \
+    B = A;                                                   \
+    A = TEMP;                                                \
+  } while (0)
+
+  for (t = 0; t < 20; ++t)
+    SHA1_ROUND(Ch, 0x5a827999);
+  for (; t < 40; ++t)
+    SHA1_ROUND(Parity, 0x6ed9eba1);
+  for (; t < 60; ++t)
+    SHA1_ROUND(Maj, 0x8f1bbcdc);
+  for (; t < 80; ++t)
+    SHA1_ROUND(Parity, 0xca62c1d6);
+
+#undef SHA1_ROUND
 
   // e.
   H[0] += A;
@@ -213,4 +231,22 @@ void SHA1HashBytes(const unsigned char* data, size_t len,
   memcpy(hash, sha.Digest(), SecureHashAlgorithm::kDigestSizeBytes);
 }
 
+SHA1Hasher::SHA1Hasher() : sha_(new SecureHashAlgorithm) {
+}
+
+SHA1Hasher::~SHA1Hasher() {
+}
+
+void SHA1Hasher::Update(const void* data, size_t len) {
+  sha_->Update(data, len);
+}
+
+std::string SHA1Hasher::Finish() {
+  sha_->Final();
+  std::string hash(reinterpret_cast<const char*>(sha_->Digest()),
+                   SecureHashAlgorithm::kDigestSizeBytes);
+  sha_->Init();
+  return hash;
+}
+
 }  // namespace base
@@ -4,6 +4,7 @@
 
 #include "base/sha1.h"
 
+#include <algorithm>
 #include <string>
 
 #include "base/basictypes.h"
@@ -106,3 +107,18 @@ TEST(SHA1Test, Test3Bytes) {
   for (size_t i = 0; i < base::kSHA1Length; i++)
     EXPECT_EQ(expected[i], output[i]);
 }
+
+TEST(SHA1Test, Incremental) {
+  std::string input =
+      "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  std::string expected = base::SHA1HashString(input);
+
+  base::SHA1Hasher hasher;
+  for (size_t i = 0; i < input.length(); i += 7)
+    hasher.Update(input.data() + i, std::min<size_t>(7, input.length() - i));
+  EXPECT_EQ(expected, hasher.Finish());
+
+  // The hasher is reusable after Finish().
+  hasher.Update(input.data(), input.length());
+  EXPECT_EQ(expected, hasher.Finish());
+}
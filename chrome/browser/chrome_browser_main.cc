@@ -33,6 +33,7 @@
 #include "base/strings/utf_string_conversions.h"
 #include "base/sys_info.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/sequenced_worker_pool.h"
 #include "base/time/time.h"
 #include "base/values.h"
 #include "build/build_config.h"
@@ -621,6 +622,15 @@ void ChromeBrowserMainParts::SetupMetricsAndFieldTrials() {
   // deleted after the Task is executed.
   field_trial_synchronizer_ = new FieldTrialSynchronizer();
 
+  // Keep unsent logs in their own files in the user data dir rather than in
+  // Local State, so that persisting them doesn't rewrite Local State.
+  base::SequencedWorkerPool* pool = BrowserThread::GetBlockingPool();
+  metrics->UseLogStoreFiles(
+      user_data_dir_,
+      pool->GetSequencedTaskRunnerWithShutdownBehavior(
+          pool->GetSequenceToken(),
+          base::SequencedWorkerPool::BLOCK_SHUTDOWN));
+
   // Now that field trials have been created, initializes metrics recording.
   metrics->InitializeMetricsRecordingState();
 }
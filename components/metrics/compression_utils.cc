@@ -4,18 +4,17 @@
 
 #include "components/metrics/compression_utils.h"
 
-#include <vector>
+#include <algorithm>
+#include <limits>
 
 #include "base/basictypes.h"
 #include "base/logging.h"
+#include "base/strings/string_util.h"
 #include "base/sys_byteorder.h"
 #include "third_party/zlib/zlib.h"
 
 namespace {
 
-// The difference in bytes between a zlib header and a gzip header.
-const size_t kGzipZlibHeaderDifferenceBytes = 16;
-
 // Pass an integer greater than the following get a gzip header instead of a
 // zlib header when calling deflateInit2() and inflateInit2().
 const int kWindowBitsToGetGzipHeader = 16;
@@ -25,51 +24,8 @@ const int kWindowBitsToGetGzipHeader = 16;
 // http://www.zlib.net/manual.html (search for memLevel).
 const int kZlibMemoryLevel = 8;
 
-// This code is taken almost verbatim from third_party/zlib/compress.c. The only
-// difference is deflateInit2() is called which sets the window bits to be > 16.
-// That causes a gzip header to be emitted rather than a zlib header.
-int GzipCompressHelper(Bytef* dest,
-                       uLongf* dest_length,
-                       const Bytef* source,
-                       uLong source_length) {
-  z_stream stream;
-
-  stream.next_in = bit_cast<Bytef*>(source);
-  stream.avail_in = static_cast<uInt>(source_length);
-  stream.next_out = dest;
-  stream.avail_out = static_cast<uInt>(*dest_length);
-  if (static_cast<uLong>(stream.avail_out) != *dest_length)
-    return Z_BUF_ERROR;
-
-  stream.zalloc = static_cast<alloc_func>(0);
-  stream.zfree = static_cast<free_func>(0);
-  stream.opaque = static_cast<voidpf>(0);
-
-  gz_header gzip_header;
-  memset(&gzip_header, 0, sizeof(gzip_header));
-  int err = deflateInit2(&stream,
-                         Z_DEFAULT_COMPRESSION,
-                         Z_DEFLATED,
-                         MAX_WBITS + kWindowBitsToGetGzipHeader,
-                         kZlibMemoryLevel,
-                         Z_DEFAULT_STRATEGY);
-  if (err != Z_OK)
-    return err;
-
-  err = deflateSetHeader(&stream, &gzip_header);
-  if (err != Z_OK)
-    return err;
-
-  err = deflate(&stream, Z_FINISH);
-  if (err != Z_STREAM_END) {
-    deflateEnd(&stream);
-    return err == Z_OK ? Z_BUF_ERROR : err;
-  }
-  *dest_length = stream.total_out;
-
-  err = deflateEnd(&stream);
-  return err;
-}
+// The smallest amount by which GzipCompressor grows its output.
+const size_t kMinOutputGrowth = 4096;
 
 // This code is taken almost verbatim from third_party/zlib/uncompr.c. The only
 // difference is inflateInit2() is called which sets the window bits to be > 16.
@@ -125,21 +81,105 @@ uint32 GetUncompressedSize(const std::string& compressed_data) {
 
 namespace metrics {
 
-bool GzipCompress(const std::string& input, std::string* output) {
-  const uLongf input_size = static_cast<uLongf>(input.size());
-  std::vector<Bytef> compressed_data(kGzipZlibHeaderDifferenceBytes +
-                                     compressBound(input_size));
-
-  uLongf compressed_size = static_cast<uLongf>(compressed_data.size());
-  if (GzipCompressHelper(&compressed_data.front(),
-                         &compressed_size,
-                         bit_cast<const Bytef*>(input.data()),
-                         input_size) != Z_OK) {
+GzipCompressor::GzipCompressor(std::string* output)
+    : output_(output),
+      stream_(new z_stream),
+      gzip_header_(new gz_header),
+      initialized_(false),
+      uncompressed_size_(0) {
+  output_->clear();
+  memset(stream_.get(), 0, sizeof(z_stream));
+  stream_->zalloc = static_cast<alloc_func>(0);
+  stream_->zfree = static_cast<free_func>(0);
+  stream_->opaque = static_cast<voidpf>(0);
+
+  // Setting the window bits to be > 16 causes a gzip header to be emitted
+  // rather than a zlib header.
+  int err = deflateInit2(stream_.get(),
+                         Z_DEFAULT_COMPRESSION,
+                         Z_DEFLATED,
+                         MAX_WBITS + kWindowBitsToGetGzipHeader,
+                         kZlibMemoryLevel,
+                         Z_DEFAULT_STRATEGY);
+  if (err != Z_OK)
+    return;
+  initialized_ = true;
+
+  memset(gzip_header_.get(), 0, sizeof(gz_header));
+  if (deflateSetHeader(stream_.get(), gzip_header_.get()) != Z_OK) {
+    deflateEnd(stream_.get());
+    initialized_ = false;
+  }
+}
+
+GzipCompressor::~GzipCompressor() {
+  if (initialized_)
+    deflateEnd(stream_.get());
+}
+
+bool GzipCompressor::Write(const char* data, size_t size) {
+  if (!initialized_)
     return false;
+  while (size > 0) {
+    // |avail_in| is only a uInt, so feed very large inputs in pieces.
+    uInt chunk = static_cast<uInt>(
+        std::min<size_t>(size, std::numeric_limits<uInt>::max()));
+    stream_->next_in = bit_cast<Bytef*>(data);
+    stream_->avail_in = chunk;
+    if (Deflate(Z_NO_FLUSH) != Z_OK) {
+      deflateEnd(stream_.get());
+      initialized_ = false;
+      return false;
+    }
+    data += chunk;
+    size -= chunk;
+    uncompressed_size_ += chunk;
   }
+  return true;
+}
 
-  compressed_data.resize(compressed_size);
-  output->assign(compressed_data.begin(), compressed_data.end());
+bool GzipCompressor::Finish() {
+  if (!initialized_)
+    return false;
+  stream_->next_in = NULL;
+  stream_->avail_in = 0;
+  int err = Deflate(Z_FINISH);
+  output_->resize(stream_->total_out);
+  deflateEnd(stream_.get());
+  initialized_ = false;
+  return err == Z_STREAM_END;
+}
+
+int GzipCompressor::Deflate(int flush) {
+  while (true) {
+    size_t used = stream_->total_out;
+    if (output_->size() == used) {
+      // Grow geometrically so that the number of reallocations is
+      // logarithmic in the compressed size.
+      output_->resize(used + std::max(output_->size(), kMinOutputGrowth));
+    }
+    stream_->next_out = bit_cast<Bytef*>(string_as_array(output_) + used);
+    stream_->avail_out = static_cast<uInt>(
+        std::min<size_t>(output_->size() - used,
+                         std::numeric_limits<uInt>::max()));
+    int err = deflate(stream_.get(), flush);
+    if (err == Z_STREAM_END)
+      return err;
+    if (err != Z_OK && err != Z_BUF_ERROR)
+      return err;
+    // Z_NO_FLUSH is complete once all input is consumed and there was room
+    // left in the output.  Z_FINISH is complete only at Z_STREAM_END.
+    if (flush == Z_NO_FLUSH && stream_->avail_in == 0 &&
+        stream_->avail_out != 0) {
+      return Z_OK;
+    }
+  }
+}
+
+bool GzipCompress(const std::string& input, std::string* output) {
+  GzipCompressor compressor(output);
+  if (!compressor.Write(input.data(), input.size()) || !compressor.Finish())
+    return false;
   DCHECK_EQ(input.size(), GetUncompressedSize(*output));
   return true;
 }
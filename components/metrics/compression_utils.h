@@ -7,8 +7,49 @@
 
 #include <string>
 
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+
+struct gz_header_s;
+struct z_stream_s;
+
 namespace metrics {
 
+// Compresses data using gzip as it is produced, so that the uncompressed data
+// never has to be held in memory in its entirety.  The compressed data is
+// written directly into |output|, without an intermediate buffer.
+class GzipCompressor {
+ public:
+  // |output| is cleared, and must outlive the compressor.
+  explicit GzipCompressor(std::string* output);
+  ~GzipCompressor();
+
+  // Compresses the |size| bytes at |data|.  Returns false on failure, after
+  // which the compressor must not be used.
+  bool Write(const char* data, size_t size);
+
+  // Flushes the remaining compressed data and the gzip trailer to |output|.
+  // Returns false on failure.  No more data may be written afterwards.
+  bool Finish();
+
+  // The number of uncompressed bytes passed to Write() so far.
+  size_t uncompressed_size() const { return uncompressed_size_; }
+
+ private:
+  // Runs deflate over the pending input with the given |flush| mode, growing
+  // |output_| as needed.  Returns the zlib status.
+  int Deflate(int flush);
+
+  std::string* output_;
+  scoped_ptr<z_stream_s> stream_;
+  // zlib refers to the header until the stream is finished.
+  scoped_ptr<gz_header_s> gzip_header_;
+  bool initialized_;
+  size_t uncompressed_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(GzipCompressor);
+};
+
 // Compresses the data in |input| using gzip, storing the result in |output|.
 bool GzipCompress(const std::string& input, std::string* output);
 
@@ -4,6 +4,7 @@
 
 #include "components/metrics/compression_utils.h"
 
+#include <algorithm>
 #include <string>
 
 #include "base/basictypes.h"
@@ -73,4 +74,40 @@ TEST(CompressionUtilsTest, LargeInput) {
   EXPECT_EQ(data, uncompressed_data);
 }
 
+// Checks that data written to a GzipCompressor in pieces round-trips, and
+// compresses identically to a single GzipCompress() call.
+TEST(CompressionUtilsTest, StreamingCompression) {
+  const size_t kSize = 1024 * 1024 + 17;
+
+  std::string data;
+  data.resize(kSize);
+  uint32 state = 1;
+  for (size_t i = 0; i < kSize; ++i) {
+    // Mix repetitive and pseudo-random bytes so the output spans many deflate
+    // blocks.
+    state = state * 1103515245 + 12345;
+    data[i] = (i & 0x1000) ? static_cast<char>(state >> 24)
+                           : static_cast<char>(i & 0x3F);
+  }
+
+  std::string streamed_data;
+  GzipCompressor compressor(&streamed_data);
+  size_t offset = 0;
+  for (size_t chunk = 1; offset < kSize; chunk = chunk * 3 + 1) {
+    size_t size = std::min(chunk, kSize - offset);
+    EXPECT_TRUE(compressor.Write(data.data() + offset, size));
+    offset += size;
+  }
+  EXPECT_TRUE(compressor.Finish());
+  EXPECT_EQ(kSize, compressor.uncompressed_size());
+
+  std::string compressed_data;
+  EXPECT_TRUE(GzipCompress(data, &compressed_data));
+  EXPECT_EQ(compressed_data, streamed_data);
+
+  std::string uncompressed_data;
+  EXPECT_TRUE(GzipUncompress(streamed_data, &uncompressed_data));
+  EXPECT_EQ(data, uncompressed_data);
+}
+
 }  // namespace metrics
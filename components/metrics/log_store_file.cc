@@ -0,0 +1,309 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/metrics/log_store_file.h"
+
+#include <string.h>
+
+#include "base/file_util.h"
+#include "base/files/file.h"
+#include "base/files/important_file_writer.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/logging.h"
+#include "base/metrics/histogram.h"
+#include "base/sha1.h"
+#include "base/strings/string_piece.h"
+#include "third_party/zlib/zlib.h"
+
+namespace metrics {
+
+namespace {
+
+// The file starts with a magic number and a format version.  Records follow,
+// each a RecordHeader and then |payload_size| bytes of payload.
+const uint32 kFileMagic = 0x4c414d55;  // "UMAL"
+const uint32 kFileVersion = 1;
+const size_t kFileHeaderSize = 2 * sizeof(uint32);
+
+// Record types.  The payload of a kAddRecord is the hash of the log followed
+// by the compressed log data.  The payload of a kRemoveRecord is the hash of a
+// log that was discarded.
+const uint32 kAddRecord = 1;
+const uint32 kRemoveRecord = 2;
+
+struct RecordHeader {
+  uint32 type;
+  uint32 payload_size;
+  // CRC32 of |type|, |payload_size| and the payload.
+  uint32 checksum;
+};
+COMPILE_ASSERT(sizeof(RecordHeader) == 3 * sizeof(uint32),
+               record_header_must_not_have_padding);
+
+// Files smaller than this are never compacted, as rewriting them would cost
+// more than the space it frees.
+const int64 kMinCompactionFileSize = 256 * 1024;
+
+uint32 ComputeChecksum(uint32 type,
+                       uint32 payload_size,
+                       const char* payload) {
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, reinterpret_cast<const Bytef*>(&type), sizeof(type));
+  crc = crc32(crc, reinterpret_cast<const Bytef*>(&payload_size),
+              sizeof(payload_size));
+  crc = crc32(crc, reinterpret_cast<const Bytef*>(payload), payload_size);
+  return static_cast<uint32>(crc);
+}
+
+void AppendFileHeader(std::string* output) {
+  output->append(reinterpret_cast<const char*>(&kFileMagic),
+                 sizeof(kFileMagic));
+  output->append(reinterpret_cast<const char*>(&kFileVersion),
+                 sizeof(kFileVersion));
+}
+
+// Appends a record of |type| with |hash| and |data| as its payload to
+// |output|, and returns the size of the record.
+size_t AppendRecord(uint32 type,
+                    const std::string& hash,
+                    const base::StringPiece& data,
+                    std::string* output) {
+  DCHECK_EQ(base::kSHA1Length, hash.size());
+  const size_t record_start = output->size();
+  RecordHeader header;
+  header.type = type;
+  header.payload_size = static_cast<uint32>(hash.size() + data.size());
+  output->append(reinterpret_cast<const char*>(&header), sizeof(header));
+  output->append(hash);
+  data.AppendToString(output);
+
+  const char* payload = output->data() + record_start + sizeof(header);
+  header.checksum = ComputeChecksum(header.type, header.payload_size, payload);
+  output->replace(record_start, sizeof(header),
+                  reinterpret_cast<const char*>(&header), sizeof(header));
+  return output->size() - record_start;
+}
+
+void RecordBytesWritten(size_t bytes) {
+  UMA_HISTOGRAM_COUNTS("UMA.LogStoreFile.BytesWritten",
+                       static_cast<int>(bytes));
+}
+
+}  // namespace
+
+LogStoreFile::LogStoreFile(const base::FilePath& path)
+    : path_(path),
+      file_size_(0),
+      live_bytes_(0) {
+}
+
+LogStoreFile::~LogStoreFile() {
+}
+
+LogStoreFile::LoadResult LogStoreFile::Load(std::vector<Log>* logs) {
+  DCHECK(logs->empty());
+  DCHECK(live_records_.empty());
+  file_size_ = 0;
+  live_bytes_ = 0;
+
+  LoadResult result = LOAD_SUCCESS;
+  int64 mapped_length = 0;
+  if (!base::PathExists(path_)) {
+    result = LOAD_NO_FILE;
+  } else {
+    // Scope the mapping so that the file is unmapped before it is modified.
+    base::MemoryMappedFile mapped_file;
+    const char* data = NULL;
+    if (mapped_file.Initialize(path_)) {
+      data = reinterpret_cast<const char*>(mapped_file.data());
+      mapped_length = mapped_file.length();
+    }
+    uint32 magic = 0;
+    uint32 version = 0;
+    if (data && mapped_length >= static_cast<int64>(kFileHeaderSize)) {
+      memcpy(&magic, data, sizeof(magic));
+      memcpy(&version, data + sizeof(magic), sizeof(version));
+    }
+
+    if (magic != kFileMagic || version != kFileVersion) {
+      result = LOAD_BAD_HEADER;
+    } else {
+      int64 offset = kFileHeaderSize;
+      while (offset < mapped_length) {
+        RecordHeader header;
+        if (mapped_length - offset < static_cast<int64>(sizeof(header)))
+          break;
+        memcpy(&header, data + offset, sizeof(header));
+        const int64 record_size = sizeof(header) + header.payload_size;
+        if (record_size > mapped_length - offset)
+          break;
+        const char* payload = data + offset + sizeof(header);
+        if (header.checksum !=
+            ComputeChecksum(header.type, header.payload_size, payload)) {
+          break;
+        }
+        if (header.payload_size < base::kSHA1Length)
+          break;
+
+        std::string hash(payload, base::kSHA1Length);
+        if (header.type == kAddRecord) {
+          logs->push_back(Log());
+          logs->back().hash = hash;
+          logs->back().compressed_log_data.assign(
+              payload + base::kSHA1Length,
+              header.payload_size - base::kSHA1Length);
+          LiveRecord record = { hash, offset, record_size };
+          live_records_.push_back(record);
+          live_bytes_ += record_size;
+        } else if (header.type == kRemoveRecord &&
+                   header.payload_size == base::kSHA1Length) {
+          for (size_t i = 0; i < live_records_.size(); ++i) {
+            if (live_records_[i].hash == hash) {
+              logs->erase(logs->begin() + i);
+              live_bytes_ -= live_records_[i].size;
+              live_records_.erase(live_records_.begin() + i);
+              break;
+            }
+          }
+        } else {
+          break;
+        }
+        offset += record_size;
+      }
+      file_size_ = offset;
+      if (file_size_ < mapped_length)
+        result = LOAD_TRUNCATED;
+    }
+  }
+
+  UMA_HISTOGRAM_ENUMERATION("UMA.LogStoreFile.LoadResult", result,
+                            END_LOAD_RESULT);
+
+  if (result == LOAD_BAD_HEADER) {
+    base::DeleteFile(path_, false);
+  } else if (result == LOAD_TRUNCATED) {
+    // Records appended after the corrupt one would never be read, so cut it
+    // off.  If that fails, write out the logs that were recovered instead.
+    base::File file(path_, base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+    if (!file.IsValid() || !file.SetLength(file_size_)) {
+      file.Close();
+      Replace(*logs);
+    }
+  }
+  return result;
+}
+
+bool LogStoreFile::Append(const std::vector<std::string>& removed_hashes,
+                          const std::vector<Log>& added_logs) {
+  if (removed_hashes.empty() && added_logs.empty())
+    return true;
+
+  std::string data;
+  if (file_size_ == 0)
+    AppendFileHeader(&data);
+  for (size_t i = 0; i < removed_hashes.size(); ++i)
+    AppendRecord(kRemoveRecord, removed_hashes[i], base::StringPiece(), &data);
+  std::vector<LiveRecord> added_records;
+  for (size_t i = 0; i < added_logs.size(); ++i) {
+    const int64 offset = file_size_ + data.size();
+    const size_t record_size = AppendRecord(
+        kAddRecord, added_logs[i].hash, added_logs[i].compressed_log_data,
+        &data);
+    LiveRecord record = {
+      added_logs[i].hash, offset, static_cast<int64>(record_size)
+    };
+    added_records.push_back(record);
+  }
+
+  base::File file(path_,
+                  base::File::FLAG_OPEN_ALWAYS | base::File::FLAG_WRITE);
+  if (!file.IsValid())
+    return false;
+  if (file.Write(file_size_, data.data(), data.size()) !=
+          static_cast<int>(data.size()) ||
+      !file.Flush()) {
+    // Don't leave a partial record behind, or the records appended after it
+    // would not be loaded.
+    file.SetLength(file_size_);
+    return false;
+  }
+  file.Close();
+  file_size_ += data.size();
+  RecordBytesWritten(data.size());
+
+  for (size_t i = 0; i < removed_hashes.size(); ++i)
+    RemoveLiveRecord(removed_hashes[i]);
+  for (size_t i = 0; i < added_records.size(); ++i) {
+    live_records_.push_back(added_records[i]);
+    live_bytes_ += added_records[i].size;
+  }
+  CompactIfNeeded();
+  return true;
+}
+
+bool LogStoreFile::Replace(const std::vector<Log>& logs) {
+  std::string data;
+  AppendFileHeader(&data);
+  std::vector<LiveRecord> live_records;
+  for (size_t i = 0; i < logs.size(); ++i) {
+    const int64 offset = static_cast<int64>(data.size());
+    const size_t record_size = AppendRecord(
+        kAddRecord, logs[i].hash, logs[i].compressed_log_data, &data);
+    LiveRecord record = {
+      logs[i].hash, offset, static_cast<int64>(record_size)
+    };
+    live_records.push_back(record);
+  }
+  return ReplaceFile(data, live_records);
+}
+
+void LogStoreFile::RemoveLiveRecord(const std::string& hash) {
+  for (std::vector<LiveRecord>::iterator it = live_records_.begin();
+       it != live_records_.end(); ++it) {
+    if (it->hash == hash) {
+      live_bytes_ -= it->size;
+      live_records_.erase(it);
+      return;
+    }
+  }
+}
+
+void LogStoreFile::CompactIfNeeded() {
+  if (file_size_ < kMinCompactionFileSize || live_bytes_ * 2 > file_size_)
+    return;
+
+  // The live records are copied as they are, checksums included.
+  std::string data;
+  data.reserve(kFileHeaderSize + live_bytes_);
+  AppendFileHeader(&data);
+  std::vector<LiveRecord> live_records;
+  {
+    base::MemoryMappedFile mapped_file;
+    if (!mapped_file.Initialize(path_) ||
+        static_cast<int64>(mapped_file.length()) < file_size_) {
+      return;
+    }
+    const char* mapped_data = reinterpret_cast<const char*>(mapped_file.data());
+    for (size_t i = 0; i < live_records_.size(); ++i) {
+      LiveRecord record = live_records_[i];
+      data.append(mapped_data + record.offset, record.size);
+      record.offset = data.size() - record.size;
+      live_records.push_back(record);
+    }
+  }
+  ReplaceFile(data, live_records);
+}
+
+bool LogStoreFile::ReplaceFile(const std::string& data,
+                               const std::vector<LiveRecord>& live_records) {
+  if (!base::ImportantFileWriter::WriteFileAtomically(path_, data))
+    return false;
+  RecordBytesWritten(data.size());
+  file_size_ = data.size();
+  live_records_ = live_records;
+  live_bytes_ = file_size_ - kFileHeaderSize;
+  return true;
+}
+
+}  // namespace metrics
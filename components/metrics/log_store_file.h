@@ -0,0 +1,104 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COMPONENTS_METRICS_LOG_STORE_FILE_H_
+#define COMPONENTS_METRICS_LOG_STORE_FILE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+
+namespace metrics {
+
+// An append-only file of unsent logs, which PersistedLogs can use instead of a
+// Local State preference.  Storing a log appends a record holding it, and
+// discarding a log appends a small record naming it, so persisting the logs
+// only writes what changed rather than re-encoding every log into Local State.
+//
+// Every record carries a CRC32 checksum.  A record torn by a crash while it
+// was being appended fails the check, and it and anything after it are
+// dropped when the file is loaded.  Once discarded logs make up most of the
+// file, it is compacted by atomically replacing it with only the live records.
+//
+// The methods do blocking file IO.  Load() is expected to be called once, at
+// startup, and the other methods on a sequence that allows IO afterwards.
+class LogStoreFile {
+ public:
+  // A log in the store.
+  struct Log {
+    // The SHA1 hash of the uncompressed log, which identifies it in the file.
+    std::string hash;
+
+    // The compressed log data.
+    std::string compressed_log_data;
+  };
+
+  // The result of Load(), recorded to a histogram.
+  enum LoadResult {
+    LOAD_SUCCESS,     // The whole file was read.
+    LOAD_NO_FILE,     // There was no file to read.
+    LOAD_BAD_HEADER,  // The file was not a log store, and was discarded.
+    LOAD_TRUNCATED,   // A torn or corrupt record was dropped from the end.
+    END_LOAD_RESULT
+  };
+
+  explicit LogStoreFile(const base::FilePath& path);
+  ~LogStoreFile();
+
+  // Reads the logs in the file into |logs|, oldest first.  Logs read before a
+  // corrupt record are kept, and the file is truncated to them so that later
+  // records are appended after valid data.
+  LoadResult Load(std::vector<Log>* logs);
+
+  // Records that the logs with hashes |removed_hashes| were discarded, then
+  // appends |added_logs|, in a single write.  Returns false if the write
+  // failed, in which case the file is left as it was.
+  bool Append(const std::vector<std::string>& removed_hashes,
+              const std::vector<Log>& added_logs);
+
+  // Atomically replaces the contents of the file with |logs|.  Returns false
+  // if the file could not be replaced, in which case it is left as it was.
+  bool Replace(const std::vector<Log>& logs);
+
+  // The number of bytes in the file, as far as this object knows.
+  int64 file_size() const { return file_size_; }
+
+ private:
+  // A record of a log that has not been discarded.
+  struct LiveRecord {
+    std::string hash;
+    int64 offset;
+    int64 size;
+  };
+
+  // Removes the first record of the log with |hash| from |live_records_|.
+  void RemoveLiveRecord(const std::string& hash);
+
+  // Rewrites the file with only |live_records_| if discarded records take up
+  // more than half of it.
+  void CompactIfNeeded();
+
+  // Replaces the file with |data|, which holds |live_records| after the file
+  // header.
+  bool ReplaceFile(const std::string& data,
+                   const std::vector<LiveRecord>& live_records);
+
+  const base::FilePath path_;
+
+  // The size of the valid part of the file.
+  int64 file_size_;
+
+  // The records of the logs in the file that have not been discarded, oldest
+  // first, and the total number of bytes they take up.
+  std::vector<LiveRecord> live_records_;
+  int64 live_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(LogStoreFile);
+};
+
+}  // namespace metrics
+
+#endif  // COMPONENTS_METRICS_LOG_STORE_FILE_H_
@@ -0,0 +1,242 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/metrics/log_store_file.h"
+
+#include <string>
+#include <vector>
+
+#include "base/file_util.h"
+#include "base/files/file.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/rand_util.h"
+#include "base/sha1.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace metrics {
+
+namespace {
+
+LogStoreFile::Log MakeLog(const std::string& data) {
+  LogStoreFile::Log log;
+  log.hash = base::SHA1HashString(data);
+  log.compressed_log_data = data;
+  return log;
+}
+
+class LogStoreFileTest : public testing::Test {
+ public:
+  LogStoreFileTest() {}
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("logs");
+  }
+
+ protected:
+  // Loads the logs in the file at |path_| with a new LogStoreFile, and checks
+  // that they hold |expected_data|.
+  void ExpectLogs(const std::vector<std::string>& expected_data) {
+    LogStoreFile store(path_);
+    std::vector<LogStoreFile::Log> logs;
+    store.Load(&logs);
+    ASSERT_EQ(expected_data.size(), logs.size());
+    for (size_t i = 0; i < logs.size(); ++i) {
+      EXPECT_EQ(expected_data[i], logs[i].compressed_log_data);
+      EXPECT_EQ(base::SHA1HashString(expected_data[i]), logs[i].hash);
+    }
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LogStoreFileTest);
+};
+
+}  // namespace
+
+TEST_F(LogStoreFileTest, NoFile) {
+  LogStoreFile store(path_);
+  std::vector<LogStoreFile::Log> logs;
+  EXPECT_EQ(LogStoreFile::LOAD_NO_FILE, store.Load(&logs));
+  EXPECT_TRUE(logs.empty());
+}
+
+TEST_F(LogStoreFileTest, AppendAndRemove) {
+  {
+    LogStoreFile store(path_);
+    std::vector<LogStoreFile::Log> logs;
+    store.Load(&logs);
+    logs.push_back(MakeLog("one"));
+    logs.push_back(MakeLog("two"));
+    logs.push_back(MakeLog("three"));
+    store.Append(std::vector<std::string>(), logs);
+
+    std::vector<std::string> removed_hashes;
+    removed_hashes.push_back(base::SHA1HashString("two"));
+    std::vector<LogStoreFile::Log> added_logs;
+    added_logs.push_back(MakeLog("four"));
+    store.Append(removed_hashes, added_logs);
+  }
+
+  std::vector<std::string> expected;
+  expected.push_back("one");
+  expected.push_back("three");
+  expected.push_back("four");
+  ExpectLogs(expected);
+
+  // Appending to a loaded store continues the same file.
+  {
+    LogStoreFile store(path_);
+    std::vector<LogStoreFile::Log> logs;
+    EXPECT_EQ(LogStoreFile::LOAD_SUCCESS, store.Load(&logs));
+    std::vector<std::string> removed_hashes;
+    removed_hashes.push_back(base::SHA1HashString("one"));
+    store.Append(removed_hashes, std::vector<LogStoreFile::Log>());
+  }
+  expected.erase(expected.begin());
+  ExpectLogs(expected);
+}
+
+TEST_F(LogStoreFileTest, Replace) {
+  LogStoreFile store(path_);
+  std::vector<LogStoreFile::Log> logs;
+  store.Load(&logs);
+  logs.push_back(MakeLog("one"));
+  logs.push_back(MakeLog("two"));
+  store.Append(std::vector<std::string>(), logs);
+
+  logs.clear();
+  logs.push_back(MakeLog("zero"));
+  logs.push_back(MakeLog("two"));
+  store.Replace(logs);
+
+  std::vector<std::string> expected;
+  expected.push_back("zero");
+  expected.push_back("two");
+  ExpectLogs(expected);
+}
+
+// A record torn by a crash while it was being written is dropped, along with
+// anything after it, and later records are still read.
+TEST_F(LogStoreFileTest, TornRecord) {
+  int64 intact_size = 0;
+  {
+    LogStoreFile store(path_);
+    std::vector<LogStoreFile::Log> logs;
+    store.Load(&logs);
+    logs.push_back(MakeLog("one"));
+    store.Append(std::vector<std::string>(), logs);
+    intact_size = store.file_size();
+
+    logs.clear();
+    logs.push_back(MakeLog("two"));
+    store.Append(std::vector<std::string>(), logs);
+  }
+  {
+    base::File file(path_, base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+    ASSERT_TRUE(file.SetLength(file.GetLength() - 1));
+  }
+
+  {
+    LogStoreFile store(path_);
+    std::vector<LogStoreFile::Log> logs;
+    EXPECT_EQ(LogStoreFile::LOAD_TRUNCATED, store.Load(&logs));
+    ASSERT_EQ(1U, logs.size());
+    EXPECT_EQ("one", logs[0].compressed_log_data);
+    EXPECT_EQ(intact_size, store.file_size());
+
+    logs.clear();
+    logs.push_back(MakeLog("three"));
+    store.Append(std::vector<std::string>(), logs);
+  }
+
+  std::vector<std::string> expected;
+  expected.push_back("one");
+  expected.push_back("three");
+  ExpectLogs(expected);
+}
+
+TEST_F(LogStoreFileTest, CorruptPayload) {
+  {
+    LogStoreFile store(path_);
+    std::vector<LogStoreFile::Log> logs;
+    store.Load(&logs);
+    logs.push_back(MakeLog("one"));
+    logs.push_back(MakeLog("two"));
+    store.Append(std::vector<std::string>(), logs);
+  }
+  {
+    // Flip the last byte, which is part of the payload of "two".
+    base::File file(path_, base::File::FLAG_OPEN | base::File::FLAG_READ |
+                               base::File::FLAG_WRITE);
+    const int64 offset = file.GetLength() - 1;
+    char byte = 0;
+    ASSERT_EQ(1, file.Read(offset, &byte, 1));
+    byte ^= 1;
+    ASSERT_EQ(1, file.Write(offset, &byte, 1));
+  }
+
+  LogStoreFile store(path_);
+  std::vector<LogStoreFile::Log> logs;
+  EXPECT_EQ(LogStoreFile::LOAD_TRUNCATED, store.Load(&logs));
+  ASSERT_EQ(1U, logs.size());
+  EXPECT_EQ("one", logs[0].compressed_log_data);
+}
+
+TEST_F(LogStoreFileTest, BadHeader) {
+  const char kGarbage[] = "not a log store";
+  ASSERT_EQ(static_cast<int>(sizeof(kGarbage)),
+            base::WriteFile(path_, kGarbage, sizeof(kGarbage)));
+
+  {
+    LogStoreFile store(path_);
+    std::vector<LogStoreFile::Log> logs;
+    EXPECT_EQ(LogStoreFile::LOAD_BAD_HEADER, store.Load(&logs));
+    EXPECT_TRUE(logs.empty());
+    EXPECT_FALSE(base::PathExists(path_));
+
+    logs.push_back(MakeLog("one"));
+    store.Append(std::vector<std::string>(), logs);
+  }
+
+  std::vector<std::string> expected;
+  expected.push_back("one");
+  ExpectLogs(expected);
+}
+
+// Once most of the file is discarded logs, it is compacted.
+TEST_F(LogStoreFileTest, Compaction) {
+  const size_t kLogSize = 100 * 1024;
+  LogStoreFile store(path_);
+  std::vector<LogStoreFile::Log> logs;
+  store.Load(&logs);
+
+  std::vector<std::string> expected;
+  for (int i = 0; i < 4; ++i) {
+    expected.push_back(base::RandBytesAsString(kLogSize));
+    logs.push_back(MakeLog(expected.back()));
+  }
+  store.Append(std::vector<std::string>(), logs);
+  const int64 full_size = store.file_size();
+  EXPECT_GT(full_size, static_cast<int64>(4 * kLogSize));
+
+  // Discarding one of the logs doesn't compact the file yet.
+  std::vector<std::string> removed_hashes;
+  removed_hashes.push_back(logs[0].hash);
+  store.Append(removed_hashes, std::vector<LogStoreFile::Log>());
+  EXPECT_GT(store.file_size(), full_size);
+
+  removed_hashes.clear();
+  removed_hashes.push_back(logs[1].hash);
+  removed_hashes.push_back(logs[2].hash);
+  store.Append(removed_hashes, std::vector<LogStoreFile::Log>());
+  EXPECT_LT(store.file_size(), static_cast<int64>(2 * kLogSize));
+
+  expected.erase(expected.begin(), expected.begin() + 3);
+  ExpectLogs(expected);
+}
+
+}  // namespace metrics
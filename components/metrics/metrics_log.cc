@@ -22,6 +22,8 @@
 #include "base/strings/utf_string_conversions.h"
 #include "base/sys_info.h"
 #include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
+#include "components/metrics/compression_utils.h"
 #include "components/metrics/metrics_hashes.h"
 #include "components/metrics/metrics_pref_names.h"
 #include "components/metrics/metrics_provider.h"
@@ -30,6 +32,7 @@
 #include "components/metrics/proto/system_profile.pb.h"
 #include "components/metrics/proto/user_action_event.pb.h"
 #include "components/variations/active_field_trials.h"
+#include "third_party/protobuf/src/google/protobuf/io/zero_copy_stream_impl_lite.h"
 
 #if defined(OS_ANDROID)
 #include "base/android/build_info.h"
@@ -73,6 +76,29 @@ std::string ComputeSHA1(const std::string& data) {
   return base::HexEncode(sha1.data(), sha1.size());
 }
 
+// Feeds serialized protobuf data to a gzip compressor and a SHA1 hasher as it
+// is produced.
+class CompressingHashingStream
+    : public google::protobuf::io::CopyingOutputStream {
+ public:
+  CompressingHashingStream(metrics::GzipCompressor* compressor,
+                           base::SHA1Hasher* hasher)
+      : compressor_(compressor), hasher_(hasher) {}
+  virtual ~CompressingHashingStream() {}
+
+  // google::protobuf::io::CopyingOutputStream:
+  virtual bool Write(const void* buffer, int size) OVERRIDE {
+    hasher_->Update(buffer, size);
+    return compressor_->Write(static_cast<const char*>(buffer), size);
+  }
+
+ private:
+  metrics::GzipCompressor* compressor_;
+  base::SHA1Hasher* hasher_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompressingHashingStream);
+};
+
 void WriteFieldTrials(const std::vector<ActiveGroupId>& field_trial_ids,
                       SystemProfileProto* system_profile) {
   for (std::vector<ActiveGroupId>::const_iterator it =
@@ -435,3 +461,24 @@ void MetricsLog::GetEncodedLog(std::string* encoded_log) {
   DCHECK(closed_);
   uma_proto_.SerializeToString(encoded_log);
 }
+
+bool MetricsLog::GetCompressedEncodedLog(std::string* compressed_log,
+                                         std::string* log_hash,
+                                         size_t* log_size) {
+  DCHECK(closed_);
+  base::ElapsedTimer timer;
+  metrics::GzipCompressor compressor(compressed_log);
+  base::SHA1Hasher hasher;
+  {
+    CompressingHashingStream stream(&compressor, &hasher);
+    google::protobuf::io::CopyingOutputStreamAdaptor adaptor(&stream);
+    if (!uma_proto_.SerializeToZeroCopyStream(&adaptor) || !adaptor.Flush())
+      return false;
+  }
+  if (!compressor.Finish())
+    return false;
+  *log_hash = hasher.Finish();
+  *log_size = compressor.uncompressed_size();
+  UMA_HISTOGRAM_TIMES("UMA.LogCompressionTime", timer.Elapsed());
+  return true;
+}
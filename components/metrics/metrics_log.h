@@ -130,6 +130,15 @@ class MetricsLog {
   // record.  Must only be called after CloseLog() has been called.
   void GetEncodedLog(std::string* encoded_log);
 
+  // Serializes the record directly into a gzip stream, storing the compressed
+  // data in |compressed_log|, the SHA1 hash of the uncompressed serialization
+  // in |log_hash| and its size in |log_size|.  This avoids holding the
+  // uncompressed serialization in memory.  Returns false if compression
+  // failed.  Must only be called after CloseLog() has been called.
+  bool GetCompressedEncodedLog(std::string* compressed_log,
+                               std::string* log_hash,
+                               size_t* log_size);
+
   const base::TimeTicks& creation_time() const {
     return creation_time_;
   }
@@ -6,7 +6,9 @@
 
 #include <algorithm>
 
+#include "base/files/file_path.h"
 #include "base/metrics/histogram.h"
+#include "base/sequenced_task_runner.h"
 #include "base/strings/string_util.h"
 #include "base/timer/elapsed_timer.h"
 #include "components/metrics/metrics_log.h"
@@ -36,6 +38,13 @@ const size_t kOngoingLogsPersistLimit = 8;
 // is a long series of very small logs.
 const size_t kStorageByteLimitPerLogType = 300000;
 
+// The names of the files that initial and ongoing logs are persisted to when
+// log store files are used.
+const base::FilePath::CharType kInitialLogsFileName[] =
+    FILE_PATH_LITERAL("UMA Initial Logs");
+const base::FilePath::CharType kOngoingLogsFileName[] =
+    FILE_PATH_LITERAL("UMA Ongoing Logs");
+
 }  // namespace
 
 MetricsLogManager::MetricsLogManager(PrefService* local_state,
@@ -54,6 +63,16 @@ MetricsLogManager::MetricsLogManager(PrefService* local_state,
 
 MetricsLogManager::~MetricsLogManager() {}
 
+void MetricsLogManager::UseLogStoreFiles(
+    const base::FilePath& directory,
+    const scoped_refptr<base::SequencedTaskRunner>& task_runner) {
+  DCHECK(!unsent_logs_loaded_);
+  initial_log_queue_.UseLogStoreFile(directory.Append(kInitialLogsFileName),
+                                     task_runner);
+  ongoing_log_queue_.UseLogStoreFile(directory.Append(kOngoingLogsFileName),
+                                     task_runner);
+}
+
 void MetricsLogManager::BeginLoggingWithLog(scoped_ptr<MetricsLog> log) {
   DCHECK(!current_log_);
   current_log_ = log.Pass();
@@ -62,10 +81,20 @@ void MetricsLogManager::BeginLoggingWithLog(scoped_ptr<MetricsLog> log) {
 void MetricsLogManager::FinishCurrentLog() {
   DCHECK(current_log_.get());
   current_log_->CloseLog();
-  std::string log_data;
-  current_log_->GetEncodedLog(&log_data);
-  if (!log_data.empty())
-    StoreLog(log_data, current_log_->log_type());
+  // Serialize straight into the compressed form that is queued, rather than
+  // materializing the uncompressed log first.
+  std::string compressed_log_data;
+  std::string log_hash;
+  size_t log_size = 0;
+  if (current_log_->GetCompressedEncodedLog(&compressed_log_data, &log_hash,
+                                            &log_size)) {
+    if (log_size > 0) {
+      GetLogQueue(current_log_->log_type())->StoreCompressedLog(
+          &compressed_log_data, log_hash, log_size);
+    }
+  } else {
+    NOTREACHED();
+  }
   current_log_.reset();
 }
 
@@ -101,16 +130,15 @@ void MetricsLogManager::ResumePausedLog() {
   current_log_.reset(paused_log_.release());
 }
 
-void MetricsLogManager::StoreLog(const std::string& log_data,
-                                 MetricsLog::LogType log_type) {
+PersistedLogs* MetricsLogManager::GetLogQueue(MetricsLog::LogType log_type) {
   switch (log_type) {
     case MetricsLog::INITIAL_STABILITY_LOG:
-      initial_log_queue_.StoreLog(log_data);
-      break;
+      return &initial_log_queue_;
     case MetricsLog::ONGOING_LOG:
-      ongoing_log_queue_.StoreLog(log_data);
-      break;
+      return &ongoing_log_queue_;
   }
+  NOTREACHED();
+  return &ongoing_log_queue_;
 }
 
 void MetricsLogManager::PersistUnsentLogs() {
@@ -9,10 +9,16 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "components/metrics/metrics_log.h"
 #include "components/metrics/persisted_logs.h"
 
+namespace base {
+class FilePath;
+class SequencedTaskRunner;
+}
+
 namespace metrics {
 
 // Manages all the log objects used by a MetricsService implementation. Keeps
@@ -26,6 +32,13 @@ class MetricsLogManager {
   MetricsLogManager(PrefService* local_state, size_t max_ongoing_log_size);
   ~MetricsLogManager();
 
+  // Persists unsent logs to files in |directory|, written on |task_runner|,
+  // rather than to |local_state|.  Must be called before
+  // LoadPersistedUnsentLogs().
+  void UseLogStoreFiles(
+      const base::FilePath& directory,
+      const scoped_refptr<base::SequencedTaskRunner>& task_runner);
+
   // Makes |log| the current_log. This should only be called if there is not a
   // current log.
   void BeginLoggingWithLog(scoped_ptr<MetricsLog> log);
@@ -91,8 +104,8 @@ class MetricsLogManager {
   void LoadPersistedUnsentLogs();
 
  private:
-  // Saves |log_data| as the given type.
-  void StoreLog(const std::string& log_data, MetricsLog::LogType log_type);
+  // Returns the queue that logs of the given type are saved to.
+  PersistedLogs* GetLogQueue(MetricsLog::LogType log_type);
 
   // Tracks whether unsent logs (if any) have been loaded from the serializer.
   bool unsent_logs_loaded_;
@@ -12,8 +12,10 @@
 #include "base/metrics/sample_vector.h"
 #include "base/prefs/pref_service.h"
 #include "base/prefs/testing_pref_service.h"
+#include "base/sha1.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/time/time.h"
+#include "components/metrics/compression_utils.h"
 #include "components/metrics/metrics_pref_names.h"
 #include "components/metrics/metrics_state_manager.h"
 #include "components/metrics/proto/chrome_user_metrics_extension.pb.h"
@@ -179,6 +181,30 @@ TEST_F(MetricsLogTest, EmptyRecord) {
   EXPECT_EQ(expected.SerializeAsString(), encoded);
 }
 
+TEST_F(MetricsLogTest, CompressedEncodedLog) {
+  TestMetricsServiceClient client;
+  TestMetricsLog log(
+      kClientId, kSessionId, MetricsLog::ONGOING_LOG, &client, &prefs_);
+  log.RecordEnvironment(std::vector<MetricsProvider*>(),
+                        std::vector<variations::ActiveGroupId>(),
+                        kInstallDate);
+  log.CloseLog();
+
+  std::string encoded;
+  log.GetEncodedLog(&encoded);
+
+  std::string compressed;
+  std::string hash;
+  size_t size = 0;
+  ASSERT_TRUE(log.GetCompressedEncodedLog(&compressed, &hash, &size));
+  EXPECT_EQ(encoded.size(), size);
+  EXPECT_EQ(base::SHA1HashString(encoded), hash);
+
+  std::string uncompressed;
+  ASSERT_TRUE(GzipUncompress(compressed, &uncompressed));
+  EXPECT_EQ(encoded, uncompressed);
+}
+
 TEST_F(MetricsLogTest, HistogramBucketFields) {
   // Create buckets: 1-5, 5-7, 7-8, 8-9, 9-10, 10-11, 11-12.
   base::BucketRanges ranges(8);
@@ -167,6 +167,7 @@
 
 #include "base/bind.h"
 #include "base/callback.h"
+#include "base/files/file_path.h"
 #include "base/metrics/histogram.h"
 #include "base/metrics/histogram_base.h"
 #include "base/metrics/histogram_samples.h"
@@ -174,6 +175,7 @@
 #include "base/metrics/statistics_recorder.h"
 #include "base/prefs/pref_registry_simple.h"
 #include "base/prefs/pref_service.h"
+#include "base/sequenced_task_runner.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/platform_thread.h"
@@ -343,6 +345,12 @@ MetricsService::~MetricsService() {
   DisableRecording();
 }
 
+void MetricsService::UseLogStoreFiles(
+    const base::FilePath& directory,
+    const scoped_refptr<base::SequencedTaskRunner>& task_runner) {
+  log_manager_.UseLogStoreFiles(directory, task_runner);
+}
+
 void MetricsService::InitializeMetricsRecordingState() {
   InitializeMetricsState();
 
@@ -14,6 +14,7 @@
 
 #include "base/basictypes.h"
 #include "base/gtest_prod_util.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/memory/weak_ptr.h"
@@ -37,9 +38,11 @@ class PrefRegistrySimple;
 
 namespace base {
 class DictionaryValue;
+class FilePath;
 class HistogramSamples;
 class MessageLoopProxy;
 class PrefService;
+class SequencedTaskRunner;
 }
 
 namespace variations {
@@ -102,6 +105,13 @@ class MetricsService : public base::HistogramFlattener {
                  PrefService* local_state);
   virtual ~MetricsService();
 
+  // Persists unsent logs to files in |directory|, written on |task_runner|,
+  // instead of to Local State.  Must be called before
+  // InitializeMetricsRecordingState().
+  void UseLogStoreFiles(
+      const base::FilePath& directory,
+      const scoped_refptr<base::SequencedTaskRunner>& task_runner);
+
   // Initializes metrics recording state. Updates various bookkeeping values in
   // prefs and sets up the scheduler. This is a separate function rather than
   // being done by the constructor so that field trials could be created before
@@ -4,16 +4,24 @@
 
 #include "components/metrics/persisted_logs.h"
 
+#include <algorithm>
+#include <set>
 #include <string>
 
 #include "base/base64.h"
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/location.h"
 #include "base/md5.h"
 #include "base/metrics/histogram.h"
 #include "base/prefs/pref_service.h"
 #include "base/prefs/scoped_user_pref_update.h"
+#include "base/sequenced_task_runner.h"
 #include "base/sha1.h"
+#include "base/task_runner_util.h"
 #include "base/timer/elapsed_timer.h"
 #include "components/metrics/compression_utils.h"
+#include "components/metrics/log_store_file.h"
 
 namespace metrics {
 
@@ -37,11 +45,25 @@ bool ReadBase64String(const base::ListValue& list_value,
   return base::Base64Decode(base64_result, result);
 }
 
-// Base64-encodes |str| and appends the result to |list_value|.
-void AppendBase64String(const std::string& str, base::ListValue* list_value) {
+// Base64-encodes |str| and appends the result to |list_value|. Returns the
+// length of the encoded string.
+size_t AppendBase64String(const std::string& str,
+                          base::ListValue* list_value) {
   std::string base64_str;
   base::Base64Encode(str, &base64_str);
   list_value->AppendString(base64_str);
+  return base64_str.size();
+}
+
+// Records how well a log of |log_size| bytes compressed to |compressed_size|.
+void RecordCompressionHistograms(size_t log_size, size_t compressed_size) {
+  UMA_HISTOGRAM_PERCENTAGE(
+      "UMA.ProtoCompressionRatio",
+      static_cast<int>(100 * compressed_size / log_size));
+  UMA_HISTOGRAM_CUSTOM_COUNTS(
+      "UMA.ProtoGzippedKBSaved",
+      static_cast<int>((log_size - compressed_size) / 1024),
+      1, 2000, 50);
 }
 
 }  // namespace
@@ -54,13 +76,7 @@ void PersistedLogs::LogHashPair::Init(const std::string& log_data) {
     return;
   }
 
-  UMA_HISTOGRAM_PERCENTAGE(
-      "UMA.ProtoCompressionRatio",
-      static_cast<int>(100 * compressed_log_data.size() / log_data.size()));
-  UMA_HISTOGRAM_CUSTOM_COUNTS(
-      "UMA.ProtoGzippedKBSaved",
-      static_cast<int>((log_data.size() - compressed_log_data.size()) / 1024),
-      1, 2000, 50);
+  RecordCompressionHistograms(log_data.size(), compressed_log_data.size());
 
   hash = base::SHA1HashString(log_data);
 }
@@ -75,20 +91,40 @@ PersistedLogs::PersistedLogs(PrefService* local_state,
       min_log_count_(min_log_count),
       min_log_bytes_(min_log_bytes),
       max_log_size_(max_log_size != 0 ? max_log_size : static_cast<size_t>(-1)),
-      staged_log_index_(-1) {
+      staged_log_index_(-1),
+      pending_store_file_writes_(0),
+      weak_ptr_factory_(this) {
   DCHECK(local_state_);
   // One of the limit arguments must be non-zero.
   DCHECK(min_log_count_ > 0 || min_log_bytes_ > 0);
 }
 
-PersistedLogs::~PersistedLogs() {}
+PersistedLogs::~PersistedLogs() {
+  if (log_store_file_)
+    log_store_task_runner_->DeleteSoon(FROM_HERE, log_store_file_.release());
+}
+
+void PersistedLogs::UseLogStoreFile(
+    const base::FilePath& path,
+    const scoped_refptr<base::SequencedTaskRunner>& task_runner) {
+  DCHECK(list_.empty());
+  DCHECK(!log_store_file_);
+  log_store_file_.reset(new LogStoreFile(path));
+  log_store_task_runner_ = task_runner;
+}
 
-void PersistedLogs::SerializeLogs() const {
+void PersistedLogs::SerializeLogs() {
+  if (log_store_file_) {
+    WriteLogsToStoreFile();
+    return;
+  }
   ListPrefUpdate update(local_state_, pref_name_);
   WriteLogsToPrefList(update.Get());
 }
 
 PersistedLogs::LogReadStatus PersistedLogs::DeserializeLogs() {
+  if (log_store_file_)
+    return ReadLogsFromStoreFile();
   return ReadLogsFromPrefList(*local_state_->GetList(pref_name_));
 }
 
@@ -97,6 +133,18 @@ void PersistedLogs::StoreLog(const std::string& log_data) {
   list_.back().Init(log_data);
 }
 
+void PersistedLogs::StoreCompressedLog(std::string* compressed_log_data,
+                                       const std::string& hash,
+                                       size_t log_size) {
+  DCHECK(!compressed_log_data->empty());
+  DCHECK_GT(log_size, 0U);
+  RecordCompressionHistograms(log_size, compressed_log_data->size());
+
+  list_.push_back(LogHashPair());
+  list_.back().compressed_log_data.swap(*compressed_log_data);
+  list_.back().hash = hash;
+}
+
 void PersistedLogs::StageLog() {
   // CHECK, rather than DCHECK, because swap()ing with an empty list causes
   // hard-to-identify crashes much later.
@@ -113,9 +161,7 @@ void PersistedLogs::DiscardStagedLog() {
   staged_log_index_ = -1;
 }
 
-void PersistedLogs::WriteLogsToPrefList(base::ListValue* list_value) const {
-  list_value->Clear();
-
+void PersistedLogs::GetLogsToPersist(std::vector<size_t>* indices) const {
   // Keep the most recent logs which are smaller than |max_log_size_|.
   // We keep at least |min_log_bytes_| and |min_log_count_| of logs before
   // discarding older logs.
@@ -142,9 +188,23 @@ void PersistedLogs::WriteLogsToPrefList(base::ListValue* list_value) const {
                            static_cast<int>(log_size));
       continue;
     }
-    AppendBase64String(list_[i].compressed_log_data, list_value);
-    AppendBase64String(list_[i].hash, list_value);
+    indices->push_back(i);
+  }
+}
+
+void PersistedLogs::WriteLogsToPrefList(base::ListValue* list_value) const {
+  list_value->Clear();
+
+  std::vector<size_t> indices;
+  GetLogsToPersist(&indices);
+  size_t bytes_written = 0;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    const LogHashPair& log = list_[indices[i]];
+    bytes_written += AppendBase64String(log.compressed_log_data, list_value);
+    bytes_written += AppendBase64String(log.hash, list_value);
   }
+  UMA_HISTOGRAM_COUNTS("UMA.PersistedLogs.PrefBytesWritten",
+                       static_cast<int>(bytes_written));
 }
 
 PersistedLogs::LogReadStatus PersistedLogs::ReadLogsFromPrefList(
@@ -172,4 +232,137 @@ PersistedLogs::LogReadStatus PersistedLogs::ReadLogsFromPrefList(
   return MakeRecallStatusHistogram(RECALL_SUCCESS);
 }
 
+void PersistedLogs::WriteLogsToStoreFile() {
+  std::vector<size_t> indices;
+  GetLogsToPersist(&indices);
+
+  std::vector<std::string> hashes;
+  for (size_t i = 0; i < indices.size(); ++i)
+    hashes.push_back(list_[indices[i]].hash);
+
+  // Logs are only ever added to the end of |list_|, and the file holds them in
+  // the same order, so a single pass over both finds the logs that were
+  // discarded and the logs that are new.  That needs to know what is in the
+  // file, so while an earlier write has not finished, the file is rewritten
+  // instead.
+  std::vector<std::string> removed_hashes;
+  std::vector<LogStoreFile::Log> added_logs;
+  bool in_order = pending_store_file_writes_ == 0;
+  size_t stored = 0;
+  for (size_t i = 0; in_order && i < indices.size(); ++i) {
+    const LogHashPair& log = list_[indices[i]];
+    std::vector<std::string>::const_iterator match = std::find(
+        stored_log_hashes_.begin() + stored, stored_log_hashes_.end(),
+        log.hash);
+    if (match == stored_log_hashes_.end()) {
+      added_logs.push_back(LogStoreFile::Log());
+      added_logs.back().hash = log.hash;
+      added_logs.back().compressed_log_data = log.compressed_log_data;
+      continue;
+    }
+    // A stored log that follows a new one means the new log is older.  That
+    // happens when logs migrated from the preference join a non-empty file,
+    // or when discarding logs brings older ones back within the limits.
+    // Appending would put it out of order, so the file is rewritten instead.
+    if (!added_logs.empty())
+      in_order = false;
+    const size_t match_index = match - stored_log_hashes_.begin();
+    removed_hashes.insert(removed_hashes.end(),
+                          stored_log_hashes_.begin() + stored,
+                          stored_log_hashes_.begin() + match_index);
+    stored = match_index + 1;
+  }
+  removed_hashes.insert(removed_hashes.end(),
+                        stored_log_hashes_.begin() + stored,
+                        stored_log_hashes_.end());
+
+  base::Callback<bool(void)> write;
+  if (!in_order) {
+    std::vector<LogStoreFile::Log> logs(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+      logs[i].hash = list_[indices[i]].hash;
+      logs[i].compressed_log_data = list_[indices[i]].compressed_log_data;
+    }
+    write = base::Bind(&LogStoreFile::Replace,
+                       base::Unretained(log_store_file_.get()), logs);
+  } else if (!removed_hashes.empty() || !added_logs.empty()) {
+    write = base::Bind(&LogStoreFile::Append,
+                       base::Unretained(log_store_file_.get()),
+                       removed_hashes, added_logs);
+  } else {
+    // The file already holds these logs.
+    ClearPreferenceLogs();
+    return;
+  }
+
+  ++pending_store_file_writes_;
+  base::PostTaskAndReplyWithResult(
+      log_store_task_runner_.get(), FROM_HERE, write,
+      base::Bind(&PersistedLogs::OnStoreFileWritten,
+                 weak_ptr_factory_.GetWeakPtr(), hashes));
+}
+
+void PersistedLogs::OnStoreFileWritten(const std::vector<std::string>& hashes,
+                                       bool success) {
+  DCHECK_GT(pending_store_file_writes_, 0);
+  --pending_store_file_writes_;
+  if (!success)
+    return;
+
+  // Writes finish in the order they were made, and a failed write leaves the
+  // file as it was, so the file now holds exactly these logs.
+  stored_log_hashes_ = hashes;
+  ClearPreferenceLogs();
+}
+
+void PersistedLogs::ClearPreferenceLogs() {
+  if (!local_state_->GetList(pref_name_)->empty()) {
+    ListPrefUpdate update(local_state_, pref_name_);
+    update->Clear();
+  }
+}
+
+PersistedLogs::LogReadStatus PersistedLogs::ReadLogsFromStoreFile() {
+  // Logs left in the preference by a build that did not use the file are
+  // older than any in the file, so they go first.
+  const base::ListValue* pref_list = local_state_->GetList(pref_name_);
+  if (!pref_list->empty() &&
+      ReadLogsFromPrefList(*pref_list) != RECALL_SUCCESS) {
+    list_.clear();
+  }
+
+  std::vector<LogStoreFile::Log> logs;
+  LogStoreFile::LoadResult result = log_store_file_->Load(&logs);
+
+  // The preference is only cleared after the logs in it were written to the
+  // file, so if that write finished too late, e.g. at shutdown, they are in
+  // both.
+  if (!list_.empty() && !logs.empty()) {
+    std::set<std::string> file_hashes;
+    for (size_t i = 0; i < logs.size(); ++i)
+      file_hashes.insert(logs[i].hash);
+    std::vector<LogHashPair> pref_logs;
+    pref_logs.swap(list_);
+    for (size_t i = 0; i < pref_logs.size(); ++i) {
+      if (!file_hashes.count(pref_logs[i].hash)) {
+        list_.push_back(LogHashPair());
+        list_.back().compressed_log_data.swap(
+            pref_logs[i].compressed_log_data);
+        list_.back().hash.swap(pref_logs[i].hash);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < logs.size(); ++i) {
+    list_.push_back(LogHashPair());
+    list_.back().compressed_log_data.swap(logs[i].compressed_log_data);
+    list_.back().hash.swap(logs[i].hash);
+    stored_log_hashes_.push_back(list_.back().hash);
+  }
+
+  if (result == LogStoreFile::LOAD_TRUNCATED)
+    return MakeRecallStatusHistogram(CHECKSUM_CORRUPTION);
+  return MakeRecallStatusHistogram(list_.empty() ? LIST_EMPTY : RECALL_SUCCESS);
+}
+
 }  // namespace metrics
@@ -10,12 +10,22 @@
 
 #include "base/basictypes.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
 #include "base/values.h"
 
 class PrefService;
 
+namespace base {
+class FilePath;
+class SequencedTaskRunner;
+}
+
 namespace metrics {
 
+class LogStoreFile;
+
 // Maintains a list of unsent logs that are written and restored from disk.
 class PersistedLogs {
  public:
@@ -54,15 +64,31 @@ class PersistedLogs {
                 size_t max_log_size);
   ~PersistedLogs();
 
+  // Stores the logs in an append-only file at |path| rather than in the
+  // preference.  The file is read synchronously by DeserializeLogs(), and is
+  // written on |task_runner|, which must allow IO.  Logs found in the
+  // preference are moved to the file the next time the logs are serialized.
+  // Must be called before DeserializeLogs().
+  void UseLogStoreFile(
+      const base::FilePath& path,
+      const scoped_refptr<base::SequencedTaskRunner>& task_runner);
+
   // Write list to storage.
-  void SerializeLogs() const;
+  void SerializeLogs();
 
-  // Reads the list from the preference.
+  // Reads the list from storage.
   LogReadStatus DeserializeLogs();
 
   // Adds a log to the list.
   void StoreLog(const std::string& log_data);
 
+  // Adds an already compressed log to the list, taking the contents of
+  // |compressed_log_data|.  |hash| is the SHA1 hash of the uncompressed log,
+  // which was |log_size| bytes long.
+  void StoreCompressedLog(std::string* compressed_log_data,
+                          const std::string& hash,
+                          size_t log_size);
+
   // Stages the most recent log.  The staged_log will remain the same even if
   // additional logs are added.
   void StageLog();
@@ -92,12 +118,32 @@ class PersistedLogs {
   bool empty() const { return list_.empty(); }
 
  private:
+  // Fills |indices| with the indices in |list_| of the logs to persist, in
+  // order.
+  void GetLogsToPersist(std::vector<size_t>* indices) const;
+
   // Writes the list to the ListValue.
   void WriteLogsToPrefList(base::ListValue* list) const;
 
   // Reads the list from the ListValue.
   LogReadStatus ReadLogsFromPrefList(const base::ListValue& list);
 
+  // Brings |log_store_file_| up to date with the list, by appending only the
+  // logs that were added or discarded since it was last written.
+  void WriteLogsToStoreFile();
+
+  // Called when a write to |log_store_file_| finishes.  If it succeeded, the
+  // file holds the logs with |hashes|.
+  void OnStoreFileWritten(const std::vector<std::string>& hashes,
+                          bool success);
+
+  // Clears logs left in the preference, once they are in |log_store_file_|.
+  void ClearPreferenceLogs();
+
+  // Reads the list from |log_store_file_|, after any logs still in the
+  // preference.
+  LogReadStatus ReadLogsFromStoreFile();
+
   // A weak pointer to the PrefService object to read and write the preference
   // from.  Calling code should ensure this object continues to exist for the
   // lifetime of the PersistedLogs object.
@@ -133,6 +179,21 @@ class PersistedLogs {
   // staged, the index will be -1.
   int staged_log_index_;
 
+  // When set by UseLogStoreFile(), the file the logs are persisted to instead
+  // of the preference.  It is only used on |log_store_task_runner_| after the
+  // logs are deserialized, and is deleted there.
+  scoped_ptr<LogStoreFile> log_store_file_;
+  scoped_refptr<base::SequencedTaskRunner> log_store_task_runner_;
+
+  // The hashes of the logs in |log_store_file_|, oldest first, as of the last
+  // time the list was read or successfully written.
+  std::vector<std::string> stored_log_hashes_;
+
+  // The number of writes to |log_store_file_| that have not finished yet.
+  int pending_store_file_writes_;
+
+  base::WeakPtrFactory<PersistedLogs> weak_ptr_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(PersistedLogs);
 };
 
@@ -5,11 +5,16 @@
 #include "components/metrics/persisted_logs.h"
 
 #include "base/base64.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/message_loop/message_loop.h"
 #include "base/prefs/pref_registry_simple.h"
 #include "base/prefs/scoped_user_pref_update.h"
 #include "base/prefs/testing_pref_service.h"
 #include "base/rand_util.h"
+#include "base/run_loop.h"
 #include "base/sha1.h"
+#include "base/test/test_simple_task_runner.h"
 #include "base/values.h"
 #include "components/metrics/compression_utils.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -51,9 +56,18 @@ class PersistedLogsTest : public testing::Test {
   }
 
  protected:
+  // Runs the writes posted to |task_runner|, then their replies.
+  void RunStoreFileWrites(base::TestSimpleTaskRunner* task_runner) {
+    task_runner->RunUntilIdle();
+    base::RunLoop().RunUntilIdle();
+  }
+
   TestingPrefServiceSimple prefs_;
 
  private:
+  // Replies to log store file writes are posted to this loop.
+  base::MessageLoop message_loop_;
+
   DISALLOW_COPY_AND_ASSIGN(PersistedLogsTest);
 };
 
@@ -283,4 +297,173 @@ TEST_F(PersistedLogsTest, Hashes) {
   EXPECT_EQ(foo_hash, persisted_logs.staged_log_hash());
 }
 
+// Check that logs persisted to a log store file are written incrementally and
+// read back, without touching the preference.
+TEST_F(PersistedLogsTest, LogStoreFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath path = temp_dir.path().AppendASCII("logs");
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner(
+      new base::TestSimpleTaskRunner);
+
+  {
+    TestPersistedLogs persisted_logs(&prefs_, kLogByteLimit);
+    persisted_logs.UseLogStoreFile(path, task_runner);
+    EXPECT_EQ(PersistedLogs::LIST_EMPTY, persisted_logs.DeserializeLogs());
+
+    persisted_logs.StoreLog("one");
+    persisted_logs.StoreLog("two");
+    persisted_logs.SerializeLogs();
+    persisted_logs.StageLog();
+    persisted_logs.DiscardStagedLog();
+    persisted_logs.StoreLog("three");
+    persisted_logs.SerializeLogs();
+  }
+  task_runner->RunUntilIdle();
+  EXPECT_EQ(0U, prefs_.GetList(kTestPrefName)->GetSize());
+
+  {
+    TestPersistedLogs result_persisted_logs(&prefs_, kLogByteLimit);
+    result_persisted_logs.UseLogStoreFile(path, task_runner);
+    EXPECT_EQ(PersistedLogs::RECALL_SUCCESS,
+              result_persisted_logs.DeserializeLogs());
+    EXPECT_EQ(2U, result_persisted_logs.size());
+    result_persisted_logs.ExpectNextLog("three");
+    result_persisted_logs.ExpectNextLog("one");
+  }
+  task_runner->RunUntilIdle();
+}
+
+// Check that logs left in the preference are moved to the log store file,
+// ahead of the logs already in the file.
+TEST_F(PersistedLogsTest, LogStoreFileMigration) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath path = temp_dir.path().AppendASCII("logs");
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner(
+      new base::TestSimpleTaskRunner);
+
+  {
+    TestPersistedLogs persisted_logs(&prefs_, kLogByteLimit);
+    persisted_logs.UseLogStoreFile(path, task_runner);
+    persisted_logs.DeserializeLogs();
+    persisted_logs.StoreLog("file");
+    persisted_logs.SerializeLogs();
+  }
+  {
+    TestPersistedLogs persisted_logs(&prefs_, kLogByteLimit);
+    persisted_logs.StoreLog("pref");
+    persisted_logs.SerializeLogs();
+  }
+  task_runner->RunUntilIdle();
+  EXPECT_EQ(2U, prefs_.GetList(kTestPrefName)->GetSize());
+
+  {
+    TestPersistedLogs persisted_logs(&prefs_, kLogByteLimit);
+    persisted_logs.UseLogStoreFile(path, task_runner);
+    EXPECT_EQ(PersistedLogs::RECALL_SUCCESS, persisted_logs.DeserializeLogs());
+    EXPECT_EQ(2U, persisted_logs.size());
+    persisted_logs.SerializeLogs();
+
+    // The preference is only cleared once the file has been written.
+    EXPECT_EQ(2U, prefs_.GetList(kTestPrefName)->GetSize());
+    RunStoreFileWrites(task_runner.get());
+  }
+  EXPECT_EQ(0U, prefs_.GetList(kTestPrefName)->GetSize());
+
+  {
+    TestPersistedLogs result_persisted_logs(&prefs_, kLogByteLimit);
+    result_persisted_logs.UseLogStoreFile(path, task_runner);
+    EXPECT_EQ(PersistedLogs::RECALL_SUCCESS,
+              result_persisted_logs.DeserializeLogs());
+    EXPECT_EQ(2U, result_persisted_logs.size());
+    result_persisted_logs.ExpectNextLog("file");
+    result_persisted_logs.ExpectNextLog("pref");
+  }
+  task_runner->RunUntilIdle();
+}
+
+// Check that logs moved to the log store file are not read twice when the
+// preference could not be cleared before shutdown.
+TEST_F(PersistedLogsTest, LogStoreFileMigrationInterrupted) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath path = temp_dir.path().AppendASCII("logs");
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner(
+      new base::TestSimpleTaskRunner);
+
+  {
+    TestPersistedLogs persisted_logs(&prefs_, kLogByteLimit);
+    persisted_logs.StoreLog("pref");
+    persisted_logs.SerializeLogs();
+  }
+  {
+    TestPersistedLogs persisted_logs(&prefs_, kLogByteLimit);
+    persisted_logs.UseLogStoreFile(path, task_runner);
+    EXPECT_EQ(PersistedLogs::RECALL_SUCCESS, persisted_logs.DeserializeLogs());
+    persisted_logs.SerializeLogs();
+  }
+  // The file is written, but the reply never runs.
+  task_runner->RunUntilIdle();
+  EXPECT_NE(0U, prefs_.GetList(kTestPrefName)->GetSize());
+
+  {
+    TestPersistedLogs result_persisted_logs(&prefs_, kLogByteLimit);
+    result_persisted_logs.UseLogStoreFile(path, task_runner);
+    EXPECT_EQ(PersistedLogs::RECALL_SUCCESS,
+              result_persisted_logs.DeserializeLogs());
+    EXPECT_EQ(1U, result_persisted_logs.size());
+    result_persisted_logs.ExpectNextLog("pref");
+  }
+  task_runner->RunUntilIdle();
+}
+
+// Check that logs are not lost when writing the log store file fails, and
+// that they are written by the next successful write.
+TEST_F(PersistedLogsTest, LogStoreFileWriteFailure) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  // Writes fail until the directory is created.
+  const base::FilePath dir = temp_dir.path().AppendASCII("dir");
+  const base::FilePath path = dir.AppendASCII("logs");
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner(
+      new base::TestSimpleTaskRunner);
+
+  {
+    TestPersistedLogs persisted_logs(&prefs_, kLogByteLimit);
+    persisted_logs.StoreLog("pref");
+    persisted_logs.SerializeLogs();
+  }
+  const size_t pref_size = prefs_.GetList(kTestPrefName)->GetSize();
+  ASSERT_NE(0U, pref_size);
+
+  {
+    TestPersistedLogs persisted_logs(&prefs_, kLogByteLimit);
+    persisted_logs.UseLogStoreFile(path, task_runner);
+    EXPECT_EQ(PersistedLogs::RECALL_SUCCESS, persisted_logs.DeserializeLogs());
+    persisted_logs.StoreLog("file");
+    persisted_logs.SerializeLogs();
+    RunStoreFileWrites(task_runner.get());
+
+    // The logs in the preference stay there until they are in the file.
+    EXPECT_EQ(pref_size, prefs_.GetList(kTestPrefName)->GetSize());
+
+    ASSERT_TRUE(base::CreateDirectory(dir));
+    persisted_logs.SerializeLogs();
+    RunStoreFileWrites(task_runner.get());
+    EXPECT_EQ(0U, prefs_.GetList(kTestPrefName)->GetSize());
+  }
+
+  {
+    TestPersistedLogs result_persisted_logs(&prefs_, kLogByteLimit);
+    result_persisted_logs.UseLogStoreFile(path, task_runner);
+    EXPECT_EQ(PersistedLogs::RECALL_SUCCESS,
+              result_persisted_logs.DeserializeLogs());
+    EXPECT_EQ(2U, result_persisted_logs.size());
+    result_persisted_logs.ExpectNextLog("file");
+    result_persisted_logs.ExpectNextLog("pref");
+  }
+  task_runner->RunUntilIdle();
+}
+
 }  // namespace metrics
@@ -4,11 +4,28 @@
 
 #include "components/rappor/bloom_filter.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "third_party/smhasher/src/City.h"
 
 namespace rappor {
 
+namespace {
+
+// CityHash64WithSeed(s, len, seed) is defined as a mix of CityHash64(s, len)
+// with the seed.  This is the seed CityHash mixes in alongside |seed|.
+const uint64_t kCityHashSeed0 = 0x9ae16a3b2f90404fULL;
+
+// Returns CityHash64WithSeed(s, len, |seed|), given |hash|, which must be
+// CityHash64(s, len).  This lets the string be hashed once for all of the
+// Bloom filter's hash functions.
+uint64_t CityHash64WithSeedFromHash(uint64_t hash, uint64_t seed) {
+  return Hash128to64(uint128(hash - kCityHashSeed0, seed));
+}
+
+}  // namespace
+
 BloomFilter::BloomFilter(uint32_t bytes_size,
                          uint32_t hash_function_count,
                          uint32_t hash_seed_offset)
@@ -21,18 +38,30 @@ BloomFilter::BloomFilter(uint32_t bytes_size,
 BloomFilter::~BloomFilter() {}
 
 void BloomFilter::SetString(const std::string& str) {
-  for (size_t i = 0; i < bytes_.size(); ++i) {
-    bytes_[i] = 0;
-  }
+  std::fill(bytes_.begin(), bytes_.end(), 0);
+  SetBits(str, &bytes_);
+}
+
+void BloomFilter::GetBytesForStrings(const std::vector<std::string>& strs,
+                                     std::vector<ByteVector>* results) const {
+  results->assign(strs.size(), ByteVector(bytes_.size()));
+  for (size_t i = 0; i < strs.size(); ++i)
+    SetBits(strs[i], &(*results)[i]);
+}
+
+void BloomFilter::SetBits(const std::string& str, ByteVector* bytes) const {
+  // Using CityHash here because we have support for it in Dremel.  Many hash
+  // functions, such as MD5, SHA1, or Murmur, would probably also work.  The
+  // seeded hash functions all derive from the same unseeded hash, so it is
+  // computed only once.
+  const uint64_t hash = CityHash64(str.data(), str.size());
   for (size_t i = 0; i < hash_function_count_; ++i) {
-    // Using CityHash here because we have support for it in Dremel.  Many hash
-    // functions, such as MD5, SHA1, or Murmur, would probably also work.
-    uint32_t index =
-        CityHash64WithSeed(str.data(), str.size(), hash_seed_offset_ + i);
+    uint32_t index = static_cast<uint32_t>(
+        CityHash64WithSeedFromHash(hash, hash_seed_offset_ + i));
     // Note that the "bytes" are uint8_t, so they are always 8-bits.
-    uint32_t byte_index = (index / 8) % bytes_.size();
+    uint32_t byte_index = (index / 8) % bytes->size();
     uint32_t bit_index = index % 8;
-    bytes_[byte_index] |= 1 << bit_index;
+    (*bytes)[byte_index] |= 1 << bit_index;
   }
 }
 
@@ -6,6 +6,7 @@
 #define COMPONENTS_RAPPOR_BLOOM_FILTER_H_
 
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/macros.h"
@@ -28,6 +29,13 @@ class BloomFilter {
   // Sets the Bloom filter bits to contain a single string.
   void SetString(const std::string& str);
 
+  // Computes the bits SetString() would produce for each string in |strs|,
+  // without modifying this filter, storing them in |results|.  This is
+  // cheaper than setting the strings one at a time when many strings need
+  // to be hashed.
+  void GetBytesForStrings(const std::vector<std::string>& strs,
+                          std::vector<ByteVector>* results) const;
+
   // Returns the current value of the Bloom filter's bit array.
   const ByteVector& bytes() const { return bytes_; };
 
@@ -35,6 +43,9 @@ class BloomFilter {
   void SetBytesForTesting(const ByteVector& bytes);
 
  private:
+  // Sets the bits for |str| in |bytes|, which must be zeroed.
+  void SetBits(const std::string& str, ByteVector* bytes) const;
+
   // Stores the byte array of the Bloom filter.
   ByteVector bytes_;
 
@@ -51,4 +51,22 @@ TEST(BloomFilterTest, HugeFilter) {
   EXPECT_EQ(1, CountBits(filter.bytes()));
 }
 
+TEST(BloomFilterTest, GetBytesForStrings) {
+  BloomFilter filter(16u, 4u, 12u);
+
+  std::vector<std::string> strs;
+  strs.push_back("Test");
+  strs.push_back("Bar");
+  strs.push_back("");
+  strs.push_back(std::string(100, 'x'));
+
+  std::vector<ByteVector> results;
+  filter.GetBytesForStrings(strs, &results);
+  ASSERT_EQ(strs.size(), results.size());
+  for (size_t i = 0; i < strs.size(); ++i) {
+    filter.SetString(strs[i]);
+    EXPECT_EQ(filter.bytes(), results[i]) << strs[i];
+  }
+}
+
 }  // namespace rappor
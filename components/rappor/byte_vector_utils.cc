@@ -4,6 +4,8 @@
 
 #include "components/rappor/byte_vector_utils.h"
 
+#include <string.h>
+
 #include <string>
 
 #include "base/logging.h"
@@ -15,6 +17,32 @@ namespace rappor {
 
 namespace {
 
+// The number of vectors' worth of random bytes ByteVectorGenerator draws at a
+// time.  This covers the coin flips of a whole report: a 75% and a 25%
+// weighted vector each consume two uniform vectors.
+const size_t kRandomVectorsPerDraw = 4;
+
+// ByteVector operations work on this many bytes at a time.
+const size_t kWordSize = sizeof(uint64_t);
+
+inline uint64_t LoadWord(const uint8_t* p) {
+  uint64_t word;
+  memcpy(&word, p, kWordSize);
+  return word;
+}
+
+inline void StoreWord(uint64_t word, uint8_t* p) {
+  memcpy(p, &word, kWordSize);
+}
+
+// Counts the bits set in |word|.
+inline int PopCount(uint64_t word) {
+  word = word - ((word >> 1) & 0x5555555555555555ULL);
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+}
+
 // Reinterpets a ByteVector as a StringPiece.
 base::StringPiece ByteVectorAsStringPiece(const ByteVector& lhs) {
   return base::StringPiece(reinterpret_cast<const char *>(&lhs[0]), lhs.size());
@@ -78,9 +106,14 @@ bool HMAC_DRBG_Update(const std::string& provided_data,
 
 }  // namespace
 
+// The operations below process whole words and then any remaining bytes.
+
 ByteVector* ByteVectorAnd(const ByteVector& lhs, ByteVector* rhs) {
   DCHECK_EQ(lhs.size(), rhs->size());
-  for (size_t i = 0; i < lhs.size(); ++i) {
+  size_t i = 0;
+  for (; i + kWordSize <= lhs.size(); i += kWordSize)
+    StoreWord(LoadWord(&lhs[i]) & LoadWord(&(*rhs)[i]), &(*rhs)[i]);
+  for (; i < lhs.size(); ++i) {
     (*rhs)[i] = lhs[i] & (*rhs)[i];
   }
   return rhs;
@@ -88,7 +121,10 @@ ByteVector* ByteVectorAnd(const ByteVector& lhs, ByteVector* rhs) {
 
 ByteVector* ByteVectorOr(const ByteVector& lhs, ByteVector* rhs) {
   DCHECK_EQ(lhs.size(), rhs->size());
-  for (size_t i = 0; i < lhs.size(); ++i) {
+  size_t i = 0;
+  for (; i + kWordSize <= lhs.size(); i += kWordSize)
+    StoreWord(LoadWord(&lhs[i]) | LoadWord(&(*rhs)[i]), &(*rhs)[i]);
+  for (; i < lhs.size(); ++i) {
     (*rhs)[i] = lhs[i] | (*rhs)[i];
   }
   return rhs;
@@ -98,7 +134,15 @@ ByteVector* ByteVectorMerge(const ByteVector& mask,
                             const ByteVector& lhs,
                             ByteVector* rhs) {
   DCHECK_EQ(lhs.size(), rhs->size());
-  for (size_t i = 0; i < lhs.size(); ++i) {
+  DCHECK_EQ(mask.size(), rhs->size());
+  size_t i = 0;
+  for (; i + kWordSize <= lhs.size(); i += kWordSize) {
+    uint64_t mask_word = LoadWord(&mask[i]);
+    StoreWord((LoadWord(&lhs[i]) & ~mask_word) |
+                  (LoadWord(&(*rhs)[i]) & mask_word),
+              &(*rhs)[i]);
+  }
+  for (; i < lhs.size(); ++i) {
     (*rhs)[i] = (lhs[i] & ~mask[i]) | ((*rhs)[i] & mask[i]);
   }
   return rhs;
@@ -106,25 +150,30 @@ ByteVector* ByteVectorMerge(const ByteVector& mask,
 
 int CountBits(const ByteVector& vector) {
   int bit_count = 0;
-  for (size_t i = 0; i < vector.size(); ++i) {
-    uint8_t byte = vector[i];
-    for (int j = 0; j < 8 ; ++j) {
-      if (byte & (1 << j))
-        bit_count++;
-    }
-  }
+  size_t i = 0;
+  for (; i + kWordSize <= vector.size(); i += kWordSize)
+    bit_count += PopCount(LoadWord(&vector[i]));
+  for (; i < vector.size(); ++i)
+    bit_count += PopCount(vector[i]);
   return bit_count;
 }
 
 ByteVectorGenerator::ByteVectorGenerator(size_t byte_count)
-    : byte_count_(byte_count) {}
+    : byte_count_(byte_count),
+      random_bytes_used_(0) {}
 
 ByteVectorGenerator::~ByteVectorGenerator() {}
 
 ByteVector ByteVectorGenerator::GetRandomByteVector() {
-  ByteVector bytes(byte_count_);
-  crypto::RandBytes(&bytes[0], bytes.size());
-  return bytes;
+  if (random_bytes_used_ == random_bytes_.size()) {
+    random_bytes_.resize(byte_count_ * kRandomVectorsPerDraw);
+    crypto::RandBytes(&random_bytes_[0], random_bytes_.size());
+    random_bytes_used_ = 0;
+  }
+  ByteVector::const_iterator start =
+      random_bytes_.begin() + random_bytes_used_;
+  random_bytes_used_ += byte_count_;
+  return ByteVector(start, start + byte_count_);
 }
 
 ByteVector ByteVectorGenerator::GetWeightedRandomByteVector(
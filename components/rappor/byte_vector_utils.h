@@ -39,6 +39,8 @@ int CountBits(const ByteVector& vector);
 
 // A utility object for generating random binary data with different
 // likelihood of bits being true, using entropy from crypto::RandBytes().
+// Entropy is drawn for several vectors at a time, so that generating a
+// report costs a single crypto::RandBytes() call.
 class ByteVectorGenerator {
  public:
   explicit ByteVectorGenerator(size_t byte_count);
@@ -59,6 +61,11 @@ class ByteVectorGenerator {
  private:
   size_t byte_count_;
 
+  // Random bytes drawn ahead for later vectors, and how many of them have
+  // been handed out.
+  ByteVector random_bytes_;
+  size_t random_bytes_used_;
+
   DISALLOW_COPY_AND_ASSIGN(ByteVectorGenerator);
 };
 
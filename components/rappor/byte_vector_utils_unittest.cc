@@ -55,6 +55,36 @@ TEST(ByteVectorTest, ByteVectorMerge) {
   EXPECT_EQ(0x35, (*ByteVectorMerge(mask, lhs, &rhs))[1]);
 }
 
+// Checks the word-at-a-time operations against bytewise results on vectors
+// that are not a whole number of words long.
+TEST(ByteVectorTest, ByteVectorOperationsUnaligned) {
+  const size_t kSize = 21;
+  ByteVector lhs(kSize);
+  ByteVector rhs(kSize);
+  ByteVector mask(kSize);
+  int expected_bits = 0;
+  for (size_t i = 0; i < kSize; ++i) {
+    lhs[i] = static_cast<uint8_t>(i * 37 + 1);
+    rhs[i] = static_cast<uint8_t>(i * 91 + 7);
+    mask[i] = static_cast<uint8_t>(i * 13 + 5);
+    for (int j = 0; j < 8; ++j)
+      expected_bits += (lhs[i] >> j) & 1;
+  }
+  EXPECT_EQ(expected_bits, CountBits(lhs));
+
+  ByteVector and_result(rhs);
+  ByteVector or_result(rhs);
+  ByteVector merge_result(rhs);
+  ByteVectorAnd(lhs, &and_result);
+  ByteVectorOr(lhs, &or_result);
+  ByteVectorMerge(mask, lhs, &merge_result);
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_EQ(lhs[i] & rhs[i], and_result[i]);
+    EXPECT_EQ(lhs[i] | rhs[i], or_result[i]);
+    EXPECT_EQ((lhs[i] & ~mask[i]) | (rhs[i] & mask[i]), merge_result[i]);
+  }
+}
+
 TEST(ByteVectorTest, ByteVectorGenerator) {
   ByteVectorGenerator generator(2u);
   ByteVector random_50 = generator.GetWeightedRandomByteVector(PROBABILITY_50);
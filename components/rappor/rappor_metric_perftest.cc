@@ -0,0 +1,80 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/rappor/rappor_metric.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace rappor {
+
+namespace {
+
+const int kNumReports = 20000;
+
+// The parameters of the ETLD_PLUS_ONE_RAPPOR_TYPE metrics.
+const RapporParameters kEtldPlusOneParameters = {
+    128 /* Num cohorts */,
+    16 /* Bloom filter size bytes */,
+    2 /* Bloom filter hash count */,
+    PROBABILITY_50 /* Fake data probability */,
+    PROBABILITY_50 /* Fake one probability */,
+    PROBABILITY_75 /* One coin probability */,
+    PROBABILITY_25 /* Zero coin probability */};
+
+// A larger configuration, to show how report generation scales.
+const RapporParameters kLargeParameters = {
+    128 /* Num cohorts */,
+    256 /* Bloom filter size bytes */,
+    4 /* Bloom filter hash count */,
+    PROBABILITY_75 /* Fake data probability */,
+    PROBABILITY_50 /* Fake one probability */,
+    PROBABILITY_75 /* One coin probability */,
+    PROBABILITY_25 /* Zero coin probability */};
+
+void MeasureReports(const std::string& name,
+                    const RapporParameters& parameters) {
+  const std::string secret = HmacByteVectorGenerator::GenerateEntropyInput();
+  std::vector<std::string> samples;
+  for (int i = 0; i < kNumReports; ++i)
+    samples.push_back("sample" + base::IntToString(i) + ".example.com");
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  BloomFilter filter(parameters.bloom_filter_size_bytes,
+                     parameters.bloom_filter_hash_function_count, 0);
+  std::vector<ByteVector> bloom_bits;
+  filter.GetBytesForStrings(samples, &bloom_bits);
+  double hash_seconds = (base::TimeTicks::Now() - start).InSecondsF();
+  perf_test::PrintResult("bloom_filter", "", name,
+                         kNumReports / hash_seconds, "strings/s", true);
+
+  start = base::TimeTicks::Now();
+  for (int i = 0; i < kNumReports; ++i) {
+    RapporMetric metric("Perf.Metric", parameters, i % parameters.num_cohorts);
+    metric.SetBytesForTesting(bloom_bits[i]);
+    ByteVector report = metric.GetReport(secret);
+    EXPECT_EQ(static_cast<size_t>(parameters.bloom_filter_size_bytes),
+              report.size());
+  }
+  double report_seconds = (base::TimeTicks::Now() - start).InSecondsF();
+  perf_test::PrintResult("report", "", name,
+                         kNumReports / report_seconds, "reports/s", true);
+}
+
+}  // namespace
+
+TEST(RapporMetricPerfTest, EtldPlusOne) {
+  MeasureReports("etld_plus_one", kEtldPlusOneParameters);
+}
+
+TEST(RapporMetricPerfTest, Large) {
+  MeasureReports("large", kLargeParameters);
+}
+
+}  // namespace rappor
@@ -14,6 +14,14 @@
 
 namespace metrics {
 
+namespace {
+
+// The maximum number of cached permuted values.  This should comfortably
+// exceed the number of one-time randomized studies in a seed.
+const int kMaxCacheSize = 100;
+
+}  // namespace
+
 CachingPermutedEntropyProvider::CachingPermutedEntropyProvider(
     PrefService* local_state,
     uint16 low_entropy_source,
@@ -42,6 +50,7 @@ uint16 CachingPermutedEntropyProvider::GetPermutedValue(
     uint32 randomization_seed) const {
   DCHECK(thread_checker_.CalledOnValidThread());
 
+  used_seeds_.insert(randomization_seed);
   uint16 value = 0;
   if (!FindValue(randomization_seed, &value)) {
     value = PermutedEntropyProvider::GetPermutedValue(randomization_seed);
@@ -74,16 +83,26 @@ void CachingPermutedEntropyProvider::UpdateLocalState() const {
 void CachingPermutedEntropyProvider::AddToCache(uint32 randomization_seed,
                                                 uint16 value) const {
   PermutedEntropyCache::Entry* entry;
-  const int kMaxSize = 25;
-  if (cache_.entry_size() >= kMaxSize) {
-    // If the cache is full, evict the first entry, swapping later entries in
-    // to take its place. This effectively creates a FIFO cache, which is good
-    // enough here because the expectation is that there shouldn't be more than
-    // |kMaxSize| field trials at any given time, so eviction should happen very
-    // rarely, only as new trials are introduced, evicting old expired trials.
-    for (int i = 1; i < kMaxSize; ++i)
+  const int size = cache_.entry_size();
+  if (size >= kMaxCacheSize) {
+    // If the cache is full, evict the oldest entry that was not used by this
+    // provider, swapping later entries in to take its place.  This is a FIFO
+    // cache that skips over entries of the studies in the current seed, so
+    // that entries are evicted only as old trials expire.  If every entry is
+    // in use, the seed has more studies than the cache holds; keep the cached
+    // ones rather than evicting entries the next run will look up again.
+    int evicted = -1;
+    for (int i = 0; i < size; ++i) {
+      if (!used_seeds_.count(cache_.entry(i).randomization_seed())) {
+        evicted = i;
+        break;
+      }
+    }
+    if (evicted == -1)
+      return;
+    for (int i = evicted + 1; i < size; ++i)
       cache_.mutable_entry()->SwapElements(i - 1, i);
-    entry = cache_.mutable_entry(kMaxSize - 1);
+    entry = cache_.mutable_entry(size - 1);
   } else {
     entry = cache_.add_entry();
   }
@@ -5,6 +5,8 @@
 #ifndef COMPONENTS_VARIATIONS_CACHING_PERMUTED_ENTROPY_PROVIDER_H_
 #define COMPONENTS_VARIATIONS_CACHING_PERMUTED_ENTROPY_PROVIDER_H_
 
+#include <set>
+
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "base/threading/thread_checker.h"
@@ -57,6 +59,11 @@ class CachingPermutedEntropyProvider : public PermutedEntropyProvider {
   PrefService* local_state_;
   mutable PermutedEntropyCache cache_;
 
+  // The randomization seeds looked up by this provider.  Their cache entries
+  // are never evicted, so that a seed with more permanent studies than the
+  // cache holds does not evict the entries of its own studies every run.
+  mutable std::set<uint32> used_seeds_;
+
   DISALLOW_COPY_AND_ASSIGN(CachingPermutedEntropyProvider);
 };
 
@@ -6,8 +6,10 @@
 
 #include <string>
 
+#include "base/base64.h"
 #include "base/basictypes.h"
 #include "base/prefs/testing_pref_service.h"
+#include "components/variations/pref_names.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace metrics {
@@ -49,4 +51,99 @@ TEST(CachingPermutedEntropyProviderTest, HasConsistentResults) {
   }
 }
 
+// Returns the cache stored in |prefs|.
+PermutedEntropyCache ReadCache(TestingPrefServiceSimple* prefs) {
+  std::string cache_data;
+  EXPECT_TRUE(base::Base64Decode(
+      prefs->GetString(prefs::kVariationsPermutedEntropyCache), &cache_data));
+  PermutedEntropyCache cache;
+  EXPECT_TRUE(cache.ParseFromString(cache_data));
+  return cache;
+}
+
+// Returns whether the cache stored in |prefs| has an entry for
+// |randomization_seed|.
+bool IsCached(TestingPrefServiceSimple* prefs, uint32 randomization_seed) {
+  const PermutedEntropyCache cache = ReadCache(prefs);
+  for (int i = 0; i < cache.entry_size(); ++i) {
+    if (cache.entry(i).randomization_seed() == randomization_seed)
+      return true;
+  }
+  return false;
+}
+
+TEST(CachingPermutedEntropyProviderTest, KeepsEntriesInUse) {
+  TestingPrefServiceSimple prefs;
+  CachingPermutedEntropyProvider::RegisterPrefs(prefs.registry());
+  const int kEntropyValue = 1234;
+
+  // Use more seeds than the cache can hold.  The first ones fill the cache
+  // and are kept, since they are all in use.
+  const uint32 kNumSeeds = 500;
+  {
+    CachingPermutedEntropyProvider cached_provider(
+        &prefs, kEntropyValue, kMaxLowEntropySize);
+    for (uint32 seed = 1; seed <= kNumSeeds; ++seed)
+      cached_provider.GetEntropyForTrial(std::string(), seed);
+  }
+  EXPECT_TRUE(IsCached(&prefs, 1));
+  EXPECT_TRUE(IsCached(&prefs, 2));
+  EXPECT_FALSE(IsCached(&prefs, kNumSeeds));
+
+  // Use the oldest cached seed in a new run along with a new seed.  Adding
+  // the new seed must evict an entry not used in this run.
+  CachingPermutedEntropyProvider cached_provider(
+      &prefs, kEntropyValue, kMaxLowEntropySize);
+  PermutedEntropyProvider provider(kEntropyValue, kMaxLowEntropySize);
+  EXPECT_DOUBLE_EQ(provider.GetEntropyForTrial(std::string(), 1),
+                   cached_provider.GetEntropyForTrial(std::string(), 1));
+  cached_provider.GetEntropyForTrial(std::string(), kNumSeeds + 1);
+  EXPECT_TRUE(IsCached(&prefs, 1));
+  EXPECT_TRUE(IsCached(&prefs, kNumSeeds + 1));
+  EXPECT_FALSE(IsCached(&prefs, 2));
+}
+
+TEST(CachingPermutedEntropyProviderTest, HitsWithMoreSeedsThanCacheSize) {
+  TestingPrefServiceSimple prefs;
+  CachingPermutedEntropyProvider::RegisterPrefs(prefs.registry());
+  const int kEntropyValue = 1234;
+  const uint32 kNumSeeds = 500;
+
+  // Fill the cache from a run over more seeds than the cache can hold.
+  {
+    CachingPermutedEntropyProvider cached_provider(
+        &prefs, kEntropyValue, kMaxLowEntropySize);
+    for (uint32 seed = 1; seed <= kNumSeeds; ++seed)
+      cached_provider.GetEntropyForTrial(std::string(), seed);
+  }
+
+  // Replace the cached values, so that a hit can be told apart from a value
+  // computed again.
+  PermutedEntropyCache cache = ReadCache(&prefs);
+  ASSERT_GT(cache.entry_size(), 0);
+  ASSERT_LT(cache.entry_size(), static_cast<int>(kNumSeeds));
+  for (int i = 0; i < cache.entry_size(); ++i) {
+    PermutedEntropyCache::Entry* entry = cache.mutable_entry(i);
+    entry->set_value((entry->value() + 1) % kMaxLowEntropySize);
+  }
+  std::string serialized;
+  cache.SerializeToString(&serialized);
+  std::string base64_encoded;
+  base::Base64Encode(serialized, &base64_encoded);
+  prefs.SetString(prefs::kVariationsPermutedEntropyCache, base64_encoded);
+
+  // Every cached seed is a hit on the second run.
+  CachingPermutedEntropyProvider cached_provider(
+      &prefs, kEntropyValue, kMaxLowEntropySize);
+  PermutedEntropyProvider provider(kEntropyValue, kMaxLowEntropySize);
+  int hits = 0;
+  for (uint32 seed = 1; seed <= kNumSeeds; ++seed) {
+    if (provider.GetEntropyForTrial(std::string(), seed) !=
+        cached_provider.GetEntropyForTrial(std::string(), seed)) {
+      ++hits;
+    }
+  }
+  EXPECT_EQ(cache.entry_size(), hits);
+}
+
 }  // namespace metrics
@@ -67,6 +67,34 @@ void PermuteMappingUsingRandomizationSeed(uint32 randomization_seed,
   }
 }
 
+uint16 PermuteValueUsingRandomizationSeed(uint32 randomization_seed,
+                                          size_t mapping_size,
+                                          size_t index) {
+  DCHECK_LT(index, mapping_size);
+  SeededRandGenerator generator(randomization_seed);
+
+  // This replays the shuffle in PermuteMappingUsingRandomizationSeed().  Step
+  // i only touches positions up to i, so until step |index| only the first
+  // |index| + 1 positions need to be tracked.
+  std::vector<uint16> prefix(index + 1);
+  for (size_t i = 0; i < prefix.size(); ++i)
+    prefix[i] = static_cast<uint16>(i);
+  for (size_t i = 1; i <= index; ++i) {
+    size_t j = generator(i + 1);
+    std::swap(prefix[i], prefix[j]);
+  }
+
+  // Position i still holds its initial value i when step i exchanges it, so
+  // after step |index| the tracked value only changes when a later step picks
+  // |index|.  The remaining draws are still needed to find those steps.
+  uint16 value = prefix[index];
+  for (size_t i = index + 1; i < mapping_size; ++i) {
+    if (generator(i + 1) == index)
+      value = static_cast<uint16>(i);
+  }
+  return value;
+}
+
 }  // namespace internal
 
 SHA1EntropyProvider::SHA1EntropyProvider(const std::string& entropy_source)
@@ -125,9 +153,8 @@ double PermutedEntropyProvider::GetEntropyForTrial(
 
 uint16 PermutedEntropyProvider::GetPermutedValue(
     uint32 randomization_seed) const {
-  std::vector<uint16> mapping(low_entropy_source_max_);
-  internal::PermuteMappingUsingRandomizationSeed(randomization_seed, &mapping);
-  return mapping[low_entropy_source_];
+  return internal::PermuteValueUsingRandomizationSeed(
+      randomization_seed, low_entropy_source_max_, low_entropy_source_);
 }
 
 }  // namespace metrics
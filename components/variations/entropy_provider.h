@@ -36,6 +36,13 @@ struct SeededRandGenerator : std::unary_function<uint32, uint32> {
 void PermuteMappingUsingRandomizationSeed(uint32 randomization_seed,
                                           std::vector<uint16>* mapping);
 
+// Returns the element at |index| of the mapping of |mapping_size| values that
+// PermuteMappingUsingRandomizationSeed() would produce for
+// |randomization_seed|, without building the whole mapping.
+uint16 PermuteValueUsingRandomizationSeed(uint32 randomization_seed,
+                                          size_t mapping_size,
+                                          size_t index);
+
 }  // namespace internal
 
 // SHA1EntropyProvider is an entropy provider suitable for high entropy
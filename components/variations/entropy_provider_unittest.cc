@@ -314,6 +314,24 @@ TEST(EntropyProviderTest, PermutedEntropyProviderResults) {
                    GeneratePermutedEntropy(5000, kMaxLowEntropySize, "Foo"));
 }
 
+TEST(EntropyProviderTest, PermuteValueMatchesMapping) {
+  // Verifies that computing a single permuted value gives the same result as
+  // indexing into the full permuted mapping.
+  const size_t kMappingSizes[] = { 1, 2, 7, kMaxLowEntropySize };
+  for (size_t i = 0; i < arraysize(kTestTrialNames); ++i) {
+    const uint32 seed = HashName(kTestTrialNames[i]);
+    for (size_t j = 0; j < arraysize(kMappingSizes); ++j) {
+      std::vector<uint16> mapping(kMappingSizes[j]);
+      internal::PermuteMappingUsingRandomizationSeed(seed, &mapping);
+      for (size_t index = 0; index < mapping.size(); index += 1 + index / 4) {
+        EXPECT_EQ(mapping[index],
+                  internal::PermuteValueUsingRandomizationSeed(
+                      seed, mapping.size(), index));
+      }
+    }
+  }
+}
+
 TEST(EntropyProviderTest, SHA1EntropyIsUniform) {
   for (size_t i = 0; i < arraysize(kTestTrialNames); ++i) {
     SHA1EntropyGenerator entropy_generator(kTestTrialNames[i]);
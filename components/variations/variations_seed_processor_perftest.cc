@@ -0,0 +1,98 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/variations/variations_seed_processor.h"
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/metrics/field_trial.h"
+#include "base/prefs/testing_pref_service.h"
+#include "base/strings/string16.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "components/variations/caching_permuted_entropy_provider.h"
+#include "components/variations/variations_associated_data.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace variations {
+
+namespace {
+
+// A seed roughly the shape of a large production seed.
+const int kNumStudies = 300;
+const int kExperimentsPerStudy = 4;
+const int kParamsPerExperiment = 3;
+
+const size_t kMaxLowEntropySize = 8000;
+const uint16 kLowEntropySource = 1234;
+
+void IgnoreOverride(uint32_t hash, const base::string16& string) {
+}
+
+VariationsSeed CreateLargeSeed() {
+  VariationsSeed seed;
+  for (int i = 0; i < kNumStudies; ++i) {
+    Study* study = seed.add_study();
+    study->set_name("Study" + base::IntToString(i));
+    study->set_default_experiment_name("Default");
+    // Most studies in practice are one-time randomized, which is where the
+    // cost of the low entropy permutation comes in.
+    if (i % 4 != 0)
+      study->set_consistency(Study_Consistency_PERMANENT);
+    study->mutable_filter()->add_channel(Study_Channel_STABLE);
+    study->mutable_filter()->set_min_version("20.0.0.0");
+    for (int j = 0; j < kExperimentsPerStudy; ++j) {
+      Study_Experiment* experiment = study->add_experiment();
+      experiment->set_name(j == 0 ? "Default" : "Group" + base::IntToString(j));
+      experiment->set_probability_weight(100 / kExperimentsPerStudy);
+      for (int k = 0; k < kParamsPerExperiment; ++k) {
+        Study_Experiment_Param* param = experiment->add_param();
+        param->set_name("param" + base::IntToString(k));
+        param->set_value("value" + base::IntToString(k));
+      }
+    }
+  }
+  return seed;
+}
+
+// Creates field trials from |seed|, with a low entropy provider caching to
+// |prefs|, and returns the time taken.
+base::TimeDelta TimeCreateTrials(const VariationsSeed& seed,
+                                 TestingPrefServiceSimple* prefs) {
+  testing::ClearAllVariationParams();
+  base::TimeTicks start = base::TimeTicks::Now();
+  base::FieldTrialList field_trial_list(
+      new metrics::CachingPermutedEntropyProvider(prefs, kLowEntropySource,
+                                                  kMaxLowEntropySize));
+  VariationsSeedProcessor seed_processor;
+  seed_processor.CreateTrialsFromSeed(seed, "en-US", base::Time::Now(),
+                                      base::Version("38.0.0.0"),
+                                      Study_Channel_STABLE,
+                                      Study_FormFactor_DESKTOP, "",
+                                      base::Bind(&IgnoreOverride));
+  return base::TimeTicks::Now() - start;
+}
+
+}  // namespace
+
+TEST(VariationsSeedProcessorPerfTest, CreateTrialsFromLargeSeed) {
+  const VariationsSeed seed = CreateLargeSeed();
+  TestingPrefServiceSimple prefs;
+  metrics::CachingPermutedEntropyProvider::RegisterPrefs(prefs.registry());
+
+  // The first run computes every permuted value and caches as many as the
+  // cache holds; later runs model subsequent startups with an unchanged seed.
+  base::TimeDelta cold = TimeCreateTrials(seed, &prefs);
+  base::TimeDelta warm = TimeCreateTrials(seed, &prefs);
+
+  perf_test::PrintResult("create_trials", "", "cold_cache",
+                         cold.InMillisecondsF(), "ms", true);
+  perf_test::PrintResult("create_trials", "", "warm_cache",
+                         warm.InMillisecondsF(), "ms", true);
+}
+
+}  // namespace variations
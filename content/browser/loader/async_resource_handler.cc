@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <vector>
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/containers/hash_tables.h"
 #include "base/debug/alias.h"
@@ -16,13 +17,13 @@
 #include "base/strings/string_number_conversions.h"
 #include "content/browser/devtools/devtools_netlog_observer.h"
 #include "content/browser/host_zoom_map_impl.h"
-#include "content/browser/loader/resource_buffer.h"
 #include "content/browser/loader/resource_dispatcher_host_impl.h"
 #include "content/browser/loader/resource_message_filter.h"
 #include "content/browser/loader/resource_request_info_impl.h"
 #include "content/browser/resource_context_impl.h"
 #include "content/common/resource_messages.h"
 #include "content/common/view_messages.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/resource_dispatcher_host_delegate.h"
 #include "content/public/common/resource_response.h"
 #include "net/base/io_buffer.h"
@@ -36,9 +37,13 @@ using base::TimeTicks;
 namespace content {
 namespace {
 
-static int kBufferSize = 1024 * 512;
+// The ring buffer is shared by all the requests of a renderer.  Each request
+// may hold up to kMaxBytesPerRequest of it, which is what a request used to
+// get as a buffer of its own.
+static int kBufferSize = 1024 * 1024 * 2;
 static int kMinAllocationSize = 1024 * 4;
-static int kMaxAllocationSize = 1024 * 32;
+static int kMaxAllocationSize = 1024 * 64;
+static int kMaxBytesPerRequest = 1024 * 512;
 
 void GetNumericArg(const std::string& name, int* result) {
   const std::string& value =
@@ -56,6 +61,7 @@ void InitializeResourceBufferConstants() {
   GetNumericArg("resource-buffer-size", &kBufferSize);
   GetNumericArg("resource-buffer-min-allocation-size", &kMinAllocationSize);
   GetNumericArg("resource-buffer-max-allocation-size", &kMaxAllocationSize);
+  GetNumericArg("resource-buffer-max-bytes-per-request", &kMaxBytesPerRequest);
 }
 
 int CalcUsedPercentage(int bytes_read, int buffer_size) {
@@ -65,15 +71,29 @@ int CalcUsedPercentage(int bytes_read, int buffer_size) {
 
 }  // namespace
 
+// Keeps the chunk of the ring buffer it points into from being reused while
+// a read may still write into it.
 class DependentIOBuffer : public net::WrappedIOBuffer {
  public:
-  DependentIOBuffer(ResourceBuffer* backing, char* memory)
+  DependentIOBuffer(ResourceRingBuffer* backing, int chunk_offset, char* memory)
       : net::WrappedIOBuffer(memory),
-        backing_(backing) {
+        backing_(backing),
+        chunk_offset_(chunk_offset) {
+    backing_->Pin(chunk_offset_);
   }
  private:
-  virtual ~DependentIOBuffer() {}
-  scoped_refptr<ResourceBuffer> backing_;
+  virtual ~DependentIOBuffer() {
+    // The last reference may be dropped by a read on another thread.
+    if (BrowserThread::CurrentlyOn(BrowserThread::IO)) {
+      backing_->Unpin(chunk_offset_);
+    } else {
+      BrowserThread::PostTask(
+          BrowserThread::IO, FROM_HERE,
+          base::Bind(&ResourceRingBuffer::Unpin, backing_, chunk_offset_));
+    }
+  }
+  scoped_refptr<ResourceRingBuffer> backing_;
+  int chunk_offset_;
 };
 
 AsyncResourceHandler::AsyncResourceHandler(
@@ -84,15 +104,28 @@ AsyncResourceHandler::AsyncResourceHandler(
       rdh_(rdh),
       pending_data_count_(0),
       allocation_size_(0),
+      chunk_offset_(-1),
+      chunk_size_(0),
+      chunk_used_(0),
+      read_size_(0),
+      read_in_flight_(false),
       did_defer_(false),
       has_checked_for_sufficient_resources_(false),
       sent_received_response_msg_(false),
       sent_first_data_msg_(false),
       reported_transfer_size_(0) {
   InitializeResourceBufferConstants();
+  allocation_size_ = kMaxAllocationSize / 4;
 }
 
 AsyncResourceHandler::~AsyncResourceHandler() {
+  if (buffer_.get()) {
+    buffer_->RemoveObserver(this);
+    // Chunks that were sent stay in the ring buffer until the renderer is done
+    // with them.
+    if (chunk_offset_ != -1)
+      buffer_->Abandon(chunk_offset_);
+  }
   if (has_checked_for_sufficient_resources_)
     rdh_->FinishedWithResourcesForRequest(request());
 }
@@ -117,12 +150,27 @@ void AsyncResourceHandler::OnFollowRedirect(int request_id) {
 }
 
 void AsyncResourceHandler::OnDataReceivedACK(int request_id) {
-  if (pending_data_count_) {
-    --pending_data_count_;
+  if (!pending_data_count_)
+    return;
+  --pending_data_count_;
+
+  // This may resume the request, through OnRingBufferSpaceAvailable.
+  buffer_->OnDataReceivedACK(GetRequestID());
+
+  // Send what was read while the renderer was busy.  A read that is still
+  // writing into the chunk sends it from OnReadCompleted instead, since
+  // |pending_data_count_| is now zero.
+  if (!pending_data_count_ && chunk_used_ && !read_in_flight_) {
+    ResourceMessageFilter* filter = GetFilter();
+    if (filter)
+      SendData(filter);
+  }
+}
 
-    buffer_->RecycleLeastRecentlyAllocated();
-    if (buffer_->CanAllocate())
-      ResumeIfDeferred();
+void AsyncResourceHandler::OnRingBufferSpaceAvailable() {
+  if (did_defer_ && CanRead()) {
+    buffer_->RemoveObserver(this);
+    ResumeIfDeferred();
   }
 }
 
@@ -236,12 +284,21 @@ bool AsyncResourceHandler::OnWillRead(scoped_refptr<net::IOBuffer>* buf,
   if (!EnsureResourceBufferIsInitialized())
     return false;
 
-  DCHECK(buffer_->CanAllocate());
-  char* memory = buffer_->Allocate(&allocation_size_);
-  CHECK(memory);
+  if (chunk_offset_ == -1) {
+    DCHECK(buffer_->CanAllocate(GetRequestID()));
+    char* memory = buffer_->Allocate(
+        GetRequestID(), allocation_size_, &chunk_offset_, &chunk_size_);
+    CHECK(memory);
+    chunk_used_ = 0;
+  }
 
-  *buf = new DependentIOBuffer(buffer_.get(), memory);
-  *buf_size = allocation_size_;
+  read_size_ = chunk_size_ - chunk_used_;
+  DCHECK_GE(read_size_, kMinAllocationSize);
+  *buf = new DependentIOBuffer(
+      buffer_.get(), chunk_offset_,
+      buffer_->memory() + chunk_offset_ + chunk_used_);
+  *buf_size = read_size_;
+  read_in_flight_ = true;
 
   UMA_HISTOGRAM_CUSTOM_COUNTS(
       "Net.AsyncResourceHandler_SharedIOBuffer_Alloc",
@@ -251,6 +308,7 @@ bool AsyncResourceHandler::OnWillRead(scoped_refptr<net::IOBuffer>* buf,
 
 bool AsyncResourceHandler::OnReadCompleted(int bytes_read, bool* defer) {
   DCHECK_GE(bytes_read, 0);
+  read_in_flight_ = false;
 
   if (!bytes_read)
     return true;
@@ -259,42 +317,29 @@ bool AsyncResourceHandler::OnReadCompleted(int bytes_read, bool* defer) {
   if (!filter)
     return false;
 
-  buffer_->ShrinkLastAllocation(bytes_read);
-
+  DCHECK_LE(bytes_read, read_size_);
   UMA_HISTOGRAM_CUSTOM_COUNTS(
       "Net.AsyncResourceHandler_SharedIOBuffer_Used",
       bytes_read, 0, kMaxAllocationSize, 100);
   UMA_HISTOGRAM_PERCENTAGE(
       "Net.AsyncResourceHandler_SharedIOBuffer_UsedPercentage",
-      CalcUsedPercentage(bytes_read, allocation_size_));
+      CalcUsedPercentage(bytes_read, read_size_));
 
-  if (!sent_first_data_msg_) {
-    base::SharedMemoryHandle handle;
-    int size;
-    if (!buffer_->ShareToProcess(filter->PeerHandle(), &handle, &size))
+  AdaptAllocationSize(bytes_read);
+  chunk_used_ += bytes_read;
+
+  // Hold the data back while the renderer is busy with earlier data, unless
+  // there is no room left for another read.
+  if (!pending_data_count_ || chunk_size_ - chunk_used_ < kMinAllocationSize) {
+    if (!SendData(filter))
       return false;
-    filter->Send(new ResourceMsg_SetDataBuffer(
-        GetRequestID(), handle, size, filter->peer_pid()));
-    sent_first_data_msg_ = true;
   }
 
-  int data_offset = buffer_->GetLastAllocationOffset();
-
-  int64_t current_transfer_size = request()->GetTotalReceivedBytes();
-  int encoded_data_length = current_transfer_size - reported_transfer_size_;
-  reported_transfer_size_ = current_transfer_size;
-
-  filter->Send(new ResourceMsg_DataReceived(
-      GetRequestID(), data_offset, bytes_read, encoded_data_length));
-  ++pending_data_count_;
-  UMA_HISTOGRAM_CUSTOM_COUNTS(
-      "Net.AsyncResourceHandler_PendingDataCount",
-      pending_data_count_, 0, 100, 100);
-
-  if (!buffer_->CanAllocate()) {
+  if (!CanRead()) {
     UMA_HISTOGRAM_CUSTOM_COUNTS(
         "Net.AsyncResourceHandler_PendingDataCount_WhenFull",
         pending_data_count_, 0, 100, 100);
+    buffer_->AddObserver(this);
     *defer = did_defer_ = true;
     OnDefer();
   }
@@ -355,6 +400,11 @@ void AsyncResourceHandler::OnResponseCompleted(
     error_code = net::ERR_FAILED;
   }
 
+  // Send any data that was held back, unless a cancelled read may still be
+  // writing into its chunk.
+  if (!read_in_flight_)
+    SendData(info->filter());
+
   ResourceMsg_RequestCompleteData request_complete_data;
   request_complete_data.error_code = error_code;
   request_complete_data.was_ignored_by_handler = was_ignored_by_handler;
@@ -368,7 +418,7 @@ void AsyncResourceHandler::OnResponseCompleted(
 }
 
 bool AsyncResourceHandler::EnsureResourceBufferIsInitialized() {
-  if (buffer_.get() && buffer_->IsInitialized())
+  if (buffer_.get())
     return true;
 
   if (!has_checked_for_sufficient_resources_) {
@@ -379,10 +429,70 @@ bool AsyncResourceHandler::EnsureResourceBufferIsInitialized() {
     }
   }
 
-  buffer_ = new ResourceBuffer();
-  return buffer_->Initialize(kBufferSize,
-                             kMinAllocationSize,
-                             kMaxAllocationSize);
+  int child_id = GetRequestInfo()->GetChildID();
+  scoped_refptr<ResourceRingBuffer> buffer =
+      rdh_->GetRingBufferForChild(child_id);
+  if (!buffer.get()) {
+    buffer = new ResourceRingBuffer();
+    if (!buffer->Initialize(kBufferSize,
+                            kMinAllocationSize,
+                            kMaxAllocationSize,
+                            kMaxBytesPerRequest)) {
+      return false;
+    }
+    rdh_->SetRingBufferForChild(child_id, buffer.get());
+  }
+  buffer_ = buffer;
+  return true;
+}
+
+bool AsyncResourceHandler::CanRead() const {
+  if (chunk_offset_ != -1)
+    return chunk_size_ - chunk_used_ >= kMinAllocationSize;
+  return buffer_->CanAllocate(GetRequestID());
+}
+
+bool AsyncResourceHandler::SendData(ResourceMessageFilter* filter) {
+  if (!chunk_used_)
+    return true;
+
+  if (!sent_first_data_msg_) {
+    base::SharedMemoryHandle handle;
+    int size;
+    if (!buffer_->ShareToProcess(filter->PeerHandle(), &handle, &size))
+      return false;
+    filter->Send(new ResourceMsg_SetDataBuffer(
+        GetRequestID(), handle, size, buffer_->id(), filter->peer_pid()));
+    sent_first_data_msg_ = true;
+  }
+
+  int64_t current_transfer_size = request()->GetTotalReceivedBytes();
+  int encoded_data_length = current_transfer_size - reported_transfer_size_;
+  reported_transfer_size_ = current_transfer_size;
+
+  buffer_->Commit(chunk_offset_, chunk_used_);
+  filter->Send(new ResourceMsg_DataReceived(
+      GetRequestID(), chunk_offset_, chunk_used_, encoded_data_length));
+  chunk_offset_ = -1;
+  chunk_size_ = 0;
+  chunk_used_ = 0;
+
+  ++pending_data_count_;
+  UMA_HISTOGRAM_CUSTOM_COUNTS(
+      "Net.AsyncResourceHandler_PendingDataCount",
+      pending_data_count_, 0, 100, 100);
+  return true;
+}
+
+void AsyncResourceHandler::AdaptAllocationSize(int bytes_read) {
+  // A read that fills the space it is offered suggests more data is waiting,
+  // so offer more next time.  One that uses little of it suggests the data
+  // trickles in, and smaller chunks waste less of the ring buffer.
+  if (bytes_read == read_size_) {
+    allocation_size_ = std::min(allocation_size_ * 2, kMaxAllocationSize);
+  } else if (bytes_read < read_size_ / 4) {
+    allocation_size_ = std::max(allocation_size_ / 2, kMinAllocationSize);
+  }
 }
 
 void AsyncResourceHandler::ResumeIfDeferred() {
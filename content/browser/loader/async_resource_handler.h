@@ -10,6 +10,7 @@
 #include "base/memory/ref_counted.h"
 #include "content/browser/loader/resource_handler.h"
 #include "content/browser/loader/resource_message_delegate.h"
+#include "content/browser/loader/resource_ring_buffer.h"
 #include "url/gurl.h"
 
 namespace net {
@@ -17,16 +18,20 @@ class URLRequest;
 }
 
 namespace content {
-class ResourceBuffer;
 class ResourceContext;
 class ResourceDispatcherHostImpl;
 class ResourceMessageFilter;
-class SharedIOBuffer;
 
 // Used to complete an asynchronous resource request in response to resource
 // load events from the resource dispatcher host.
+//
+// Response data is read into chunks of a ResourceRingBuffer shared by all the
+// requests of the renderer.  While the renderer is still busy with data it was
+// sent, further reads are appended to the same chunk and sent in one
+// DataReceived message once the renderer acknowledges, or the chunk fills up.
 class AsyncResourceHandler : public ResourceHandler,
-                             public ResourceMessageDelegate {
+                             public ResourceMessageDelegate,
+                             public ResourceRingBuffer::Observer {
  public:
   AsyncResourceHandler(net::URLRequest* request,
                        ResourceDispatcherHostImpl* rdh);
@@ -52,6 +57,9 @@ class AsyncResourceHandler : public ResourceHandler,
                                    bool* defer) OVERRIDE;
   virtual void OnDataDownloaded(int bytes_downloaded) OVERRIDE;
 
+  // ResourceRingBuffer::Observer implementation:
+  virtual void OnRingBufferSpaceAvailable() OVERRIDE;
+
  private:
   // IPC message handlers:
   void OnFollowRedirect(int request_id);
@@ -61,15 +69,41 @@ class AsyncResourceHandler : public ResourceHandler,
   void ResumeIfDeferred();
   void OnDefer();
 
-  scoped_refptr<ResourceBuffer> buffer_;
+  // Returns true if there is room for the next read, either in the current
+  // chunk or in a new one.
+  bool CanRead() const;
+
+  // Sends the data in the current chunk to the renderer.
+  bool SendData(ResourceMessageFilter* filter);
+
+  // Grows or shrinks the size of new chunks, depending on how much of the
+  // space offered to the last read it used.
+  void AdaptAllocationSize(int bytes_read);
+
+  scoped_refptr<ResourceRingBuffer> buffer_;
   ResourceDispatcherHostImpl* rdh_;
 
   // Number of messages we've sent to the renderer that we haven't gotten an
-  // ACK for. This allows us to avoid having too many messages in flight.
+  // ACK for.  Data read while this is non-zero is held back in the current
+  // chunk, so that it goes out in fewer messages.
   int pending_data_count_;
 
+  // The size of the chunks to allocate in the ring buffer.
   int allocation_size_;
 
+  // The chunk being read into, or -1 if there is none, and how much of it has
+  // been filled.
+  int chunk_offset_;
+  int chunk_size_;
+  int chunk_used_;
+
+  // The size of the IOBuffer handed out for the last read.
+  int read_size_;
+
+  // True between OnWillRead and OnReadCompleted, while the read may be
+  // writing into the current chunk.
+  bool read_in_flight_;
+
   bool did_defer_;
 
   bool has_checked_for_sufficient_resources_;
@@ -0,0 +1,109 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how long a page takes to load many response bodies at once, with
+// all of them flowing through the renderer's shared ring buffer.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/test/browser_test_utils.h"
+#include "content/public/test/content_browser_test.h"
+#include "content/public/test/content_browser_test_utils.h"
+#include "content/shell/browser/shell.h"
+#include "net/test/embedded_test_server/embedded_test_server.h"
+#include "net/test/embedded_test_server/http_request.h"
+#include "net/test/embedded_test_server/http_response.h"
+#include "testing/perf/perf_test.h"
+
+namespace content {
+
+namespace {
+
+const char kPagePath[] = "/page";
+const char kResponsePath[] = "/response?";
+
+// Serves an empty page, and responses of the size given in the query.
+scoped_ptr<net::test_server::HttpResponse> HandleRequest(
+    const net::test_server::HttpRequest& request) {
+  scoped_ptr<net::test_server::BasicHttpResponse> http_response(
+      new net::test_server::BasicHttpResponse);
+  if (request.relative_url == kPagePath) {
+    http_response->set_content_type("text/html");
+    http_response->set_content("<html><body></body></html>");
+    return http_response.PassAs<net::test_server::HttpResponse>();
+  }
+
+  // The query is the size, followed by a number that keeps the URLs apart.
+  if (!StartsWithASCII(request.relative_url, kResponsePath, true))
+    return scoped_ptr<net::test_server::HttpResponse>();
+  std::string query =
+      request.relative_url.substr(arraysize(kResponsePath) - 1);
+  int size;
+  if (!base::StringToInt(query.substr(0, query.find('&')), &size))
+    return scoped_ptr<net::test_server::HttpResponse>();
+  http_response->set_content_type("text/plain");
+  http_response->set_content(std::string(size, 'x'));
+  return http_response.PassAs<net::test_server::HttpResponse>();
+}
+
+// Starts |count| XMLHttpRequests for |size| byte responses at once, and sends
+// the total number of bytes received once all of them are done.
+const char kLoadScript[] =
+    "var remaining = %d;"
+    "var received = 0;"
+    "for (var i = 0; i < %d; ++i) {"
+    "  var xhr = new XMLHttpRequest();"
+    "  xhr.onload = function() {"
+    "    received += this.responseText.length;"
+    "    if (--remaining == 0)"
+    "      window.domAutomationController.send(received);"
+    "  };"
+    "  xhr.open('GET', '/response?%d&' + i);"
+    "  xhr.send();"
+    "}";
+
+}  // namespace
+
+class AsyncResourceHandlerBrowserTest : public ContentBrowserTest {
+ protected:
+  virtual void SetUpOnMainThread() OVERRIDE {
+    ASSERT_TRUE(embedded_test_server()->InitializeAndWaitUntilReady());
+    embedded_test_server()->RegisterRequestHandler(base::Bind(&HandleRequest));
+    NavigateToURL(shell(), embedded_test_server()->GetURL(kPagePath));
+  }
+
+  void LoadResponses(const std::string& trace, int count, int size) {
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    int received = 0;
+    ASSERT_TRUE(ExecuteScriptAndExtractInt(
+        shell()->web_contents(),
+        base::StringPrintf(kLoadScript, count, count, size),
+        &received));
+    base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+    EXPECT_EQ(count * size, received);
+
+    perf_test::PrintResult("async_resource_handler",
+                           "",
+                           trace,
+                           elapsed.InMillisecondsF(),
+                           "ms",
+                           true);
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(AsyncResourceHandlerBrowserTest, ManySmallResponses) {
+  LoadResponses("500x2k", 500, 2 * 1024);
+}
+
+IN_PROC_BROWSER_TEST_F(AsyncResourceHandlerBrowserTest, ManyLargeResponses) {
+  LoadResponses("100x256k", 100, 256 * 1024);
+}
+
+}  // namespace content
@@ -40,6 +40,7 @@
 #include "content/browser/loader/redirect_to_file_resource_handler.h"
 #include "content/browser/loader/resource_message_filter.h"
 #include "content/browser/loader/resource_request_info_impl.h"
+#include "content/browser/loader/resource_ring_buffer.h"
 #include "content/browser/loader/stream_resource_handler.h"
 #include "content/browser/loader/sync_resource_handler.h"
 #include "content/browser/loader/throttling_resource_handler.h"
@@ -852,6 +853,16 @@ bool ResourceDispatcherHostImpl::OnMessageReceived(
       }
     }
 
+    // The renderer acknowledges the data it was sent even after the request's
+    // handler has gone away; the ring buffer the data was in still needs the
+    // space back.
+    if (!handled && message.type() == ResourceHostMsg_DataReceived_ACK::ID) {
+      ResourceRingBuffer* ring_buffer =
+          GetRingBufferForChild(filter_->child_id());
+      if (ring_buffer)
+        ring_buffer->OnDataReceivedACK(request_id);
+    }
+
     // As the unhandled resource message effectively has no consumer, mark it as
     // handled to prevent needless propagation through the filter pipeline.
     handled = true;
@@ -1271,6 +1282,12 @@ void ResourceDispatcherHostImpl::OnUploadProgressACK(int request_id) {
 void ResourceDispatcherHostImpl::OnCancelRequest(int request_id) {
   int child_id = filter_->child_id();
 
+  // The renderer won't read any more of the data it was sent for this
+  // request, so the ring buffer can have that space back.
+  ResourceRingBuffer* ring_buffer = GetRingBufferForChild(child_id);
+  if (ring_buffer)
+    ring_buffer->ReleaseRequest(request_id);
+
   // When the old renderer dies, it sends a message to us to cancel its
   // requests.
   if (IsTransferredNavigation(GlobalRequestID(child_id, request_id)))
@@ -1415,6 +1432,7 @@ void ResourceDispatcherHostImpl::ResumeDeferredNavigation(
 void ResourceDispatcherHostImpl::CancelRequestsForProcess(int child_id) {
   CancelRequestsForRoute(child_id, -1 /* cancel all */);
   registered_temp_files_.erase(child_id);
+  ring_buffers_.erase(child_id);
 }
 
 void ResourceDispatcherHostImpl::CancelRequestsForRoute(int child_id,
@@ -1610,6 +1628,18 @@ void ResourceDispatcherHostImpl::FinishedWithResourcesForRequest(
   IncrementOutstandingRequestsCount(-1, *info);
 }
 
+ResourceRingBuffer* ResourceDispatcherHostImpl::GetRingBufferForChild(
+    int child_id) {
+  RingBufferMap::iterator it = ring_buffers_.find(child_id);
+  return it == ring_buffers_.end() ? NULL : it->second.get();
+}
+
+void ResourceDispatcherHostImpl::SetRingBufferForChild(
+    int child_id,
+    ResourceRingBuffer* ring_buffer) {
+  ring_buffers_[child_id] = ring_buffer;
+}
+
 void ResourceDispatcherHostImpl::NavigationRequest(
     const NavigationRequestInfo& info,
     scoped_refptr<ResourceRequestBody> request_body,
@@ -59,6 +59,7 @@ class ResourceDispatcherHostDelegate;
 class ResourceMessageDelegate;
 class ResourceMessageFilter;
 class ResourceRequestInfoImpl;
+class ResourceRingBuffer;
 class SaveFileManager;
 class WebContentsImpl;
 struct DownloadSaveInfo;
@@ -238,6 +239,14 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
   // elsewhere.
   void FinishedWithResourcesForRequest(const net::URLRequest* request_);
 
+  // Returns the ring buffer that carries response bodies to the child process
+  // |child_id|, or NULL if none has been set.
+  ResourceRingBuffer* GetRingBufferForChild(int child_id);
+
+  // Sets the ring buffer that carries response bodies to the child process
+  // |child_id|.  It is dropped when the child's requests are cancelled.
+  void SetRingBufferForChild(int child_id, ResourceRingBuffer* ring_buffer);
+
   // Called by NavigationRequest to start a navigation request in the node
   // identified by |frame_node_id|.
   void NavigationRequest(const NavigationRequestInfo& info,
@@ -440,6 +449,12 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
       RegisteredTempFiles;  // key is child process id
   RegisteredTempFiles registered_temp_files_;
 
+  // The ring buffers that carry response bodies to each child process, shared
+  // by all of the child's AsyncResourceHandlers.
+  typedef std::map<int, scoped_refptr<ResourceRingBuffer> >
+      RingBufferMap;  // key is child process id
+  RingBufferMap ring_buffers_;
+
   // A timer that periodically calls UpdateLoadStates while pending_requests_
   // is not empty.
   scoped_ptr<base::RepeatingTimer<ResourceDispatcherHostImpl> >
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -417,6 +418,34 @@ class URLRequestTestDelayedCompletionJob : public net::URLRequestTestJob {
   virtual bool NextReadAsync() OVERRIDE { return true; }
 };
 
+// The most URLRequestTestSmallReadJob returns from a single read.
+const int kSmallReadSize = 1000;
+
+// A URLRequestTestDelayedCompletionJob that returns at most kSmallReadSize
+// bytes per read, so that several reads land in the same ring buffer chunk.
+class URLRequestTestSmallReadJob : public URLRequestTestDelayedCompletionJob {
+ public:
+  URLRequestTestSmallReadJob(net::URLRequest* request,
+                             net::NetworkDelegate* network_delegate,
+                             const std::string& response_headers,
+                             const std::string& response_data)
+      : URLRequestTestDelayedCompletionJob(request,
+                                           network_delegate,
+                                           response_headers,
+                                           response_data,
+                                           false) {}
+
+  virtual bool ReadRawData(net::IOBuffer* buf,
+                           int buf_size,
+                           int* bytes_read) OVERRIDE {
+    return URLRequestTestDelayedCompletionJob::ReadRawData(
+        buf, std::min(buf_size, kSmallReadSize), bytes_read);
+  }
+
+ protected:
+  virtual ~URLRequestTestSmallReadJob() {}
+};
+
 class URLRequestBigJob : public net::URLRequestSimpleJob {
  public:
   URLRequestBigJob(net::URLRequest* request,
@@ -467,6 +496,7 @@ class TestURLRequestJobFactory : public net::URLRequestJobFactory {
       : test_fixture_(test_fixture),
         delay_start_(false),
         delay_complete_(false),
+        small_reads_(false),
         network_start_notification_(false),
         url_request_jobs_created_count_(0) {
   }
@@ -487,6 +517,10 @@ class TestURLRequestJobFactory : public net::URLRequestJobFactory {
     delay_complete_ = delay_job_complete;
   }
 
+  void SetSmallReadJobGeneration(bool small_reads) {
+    small_reads_ = small_reads;
+  }
+
   void SetNetworkStartNotificationJobGeneration(bool notification) {
     network_start_notification_ = notification;
   }
@@ -512,6 +546,7 @@ class TestURLRequestJobFactory : public net::URLRequestJobFactory {
   ResourceDispatcherHostTest* test_fixture_;
   bool delay_start_;
   bool delay_complete_;
+  bool small_reads_;
   bool network_start_notification_;
   mutable int url_request_jobs_created_count_;
   std::set<std::string> supported_schemes_;
@@ -2683,6 +2718,65 @@ TEST_F(ResourceDispatcherHostTest, DelayedDataReceivedACKs) {
   }
 }
 
+// An ACK that arrives while a read is writing into the chunk holding back
+// data must not send that chunk; the held data goes out with the read.
+TEST_F(ResourceDispatcherHostTest, DataReceivedACKDuringRead) {
+  EXPECT_EQ(0, host_.pending_requests());
+
+  std::string raw_headers("HTTP\n"
+                          "Content-type: image/jpeg\n\n");
+  std::string response_data(4 * kSmallReadSize, ' ');
+
+  SetResponse(raw_headers, response_data);
+  job_factory_->SetSmallReadJobGeneration(true);
+  HandleScheme("http");
+
+  MakeTestRequestWithResourceType(filter_.get(), 0, 1,
+                                  GURL("http://example.com/blah"),
+                                  RESOURCE_TYPE_IMAGE);
+
+  // The first read is sent right away, the second one is held back while the
+  // renderer has not acknowledged the first, and a third read is started.
+  EXPECT_TRUE(net::URLRequestTestJob::ProcessOnePendingMessage());
+  EXPECT_TRUE(net::URLRequestTestJob::ProcessOnePendingMessage());
+
+  ResourceIPCAccumulator::ClassifiedMessages msgs;
+  accum_.GetClassifiedMessages(&msgs);
+  ASSERT_EQ(3U, msgs[0].size());
+  EXPECT_EQ(ResourceMsg_ReceivedResponse::ID, msgs[0][0].type());
+  EXPECT_EQ(ResourceMsg_SetDataBuffer::ID, msgs[0][1].type());
+  EXPECT_EQ(ResourceMsg_DataReceived::ID, msgs[0][2].type());
+
+  // The ACK arrives between OnWillRead and OnReadCompleted.
+  ResourceHostMsg_DataReceived_ACK msg(1);
+  host_.OnMessageReceived(msg, filter_.get());
+  msgs.clear();
+  accum_.GetClassifiedMessages(&msgs);
+  EXPECT_TRUE(msgs.empty());
+
+  // Completing the read sends both held reads in a single message.
+  EXPECT_TRUE(net::URLRequestTestJob::ProcessOnePendingMessage());
+  msgs.clear();
+  accum_.GetClassifiedMessages(&msgs);
+  ASSERT_EQ(1U, msgs.size());
+  ASSERT_EQ(1U, msgs[0].size());
+  ASSERT_EQ(ResourceMsg_DataReceived::ID, msgs[0][0].type());
+  int data_offset;
+  int data_length;
+  ASSERT_TRUE(
+      ExtractDataOffsetAndLength(msgs[0][0], &data_offset, &data_length));
+  EXPECT_EQ(2 * kSmallReadSize, data_length);
+
+  while (net::URLRequestTestJob::ProcessOnePendingMessage()) {}
+  base::MessageLoop::current()->RunUntilIdle();
+
+  msgs.clear();
+  accum_.GetClassifiedMessages(&msgs);
+  ASSERT_EQ(1U, msgs.size());
+  EXPECT_EQ(ResourceMsg_RequestComplete::ID, msgs[0].back().type());
+  CheckRequestCompleteErrorCode(msgs[0].back(), net::OK);
+}
+
 // Flakyness of this test might indicate memory corruption issues with
 // for example the ResourceBuffer of AsyncResourceHandler.
 TEST_F(ResourceDispatcherHostTest, DataReceivedUnexpectedACKs) {
@@ -2916,6 +3010,10 @@ net::URLRequestJob* TestURLRequestJobFactory::MaybeCreateJobWithProtocolHandler(
           request, network_delegate,
           test_fixture_->response_headers_, test_fixture_->response_data_,
           false);
+    } else if (small_reads_) {
+      return new URLRequestTestSmallReadJob(
+          request, network_delegate,
+          test_fixture_->response_headers_, test_fixture_->response_data_);
     } else {
       return new net::URLRequestTestJob(
           request, network_delegate,
@@ -0,0 +1,241 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/loader/resource_ring_buffer.h"
+
+#include <algorithm>
+
+#include "base/atomic_sequence_num.h"
+#include "base/logging.h"
+
+namespace content {
+
+namespace {
+
+// Ids start at 1, so that 0 can mean "no ring buffer" to the child.
+base::StaticAtomicSequenceNumber g_next_ring_buffer_id;
+
+}  // namespace
+
+// Chunks are kept in address order, and the free space is the gaps between
+// them.  New chunks go in the largest gap, so a chunk that stays allocated for
+// a long time only takes its own space out of use:
+//
+//    XXXX-----[XXXXX]-----XXXXXX--------
+//         ^           ^         ^
+//         gap         gap       largest gap
+//
+// There are at most buf_size_ / min_alloc_size_ chunks, so the gaps are found
+// by walking them.
+
+ResourceRingBuffer::ResourceRingBuffer()
+    : id_(g_next_ring_buffer_id.GetNext() + 1),
+      buf_size_(0),
+      min_alloc_size_(0),
+      max_alloc_size_(0),
+      max_bytes_per_request_(0) {
+}
+
+ResourceRingBuffer::~ResourceRingBuffer() {
+}
+
+bool ResourceRingBuffer::Initialize(int buffer_size,
+                                    int min_allocation_size,
+                                    int max_allocation_size,
+                                    int max_bytes_per_request) {
+  DCHECK(!IsInitialized());
+  DCHECK_GT(min_allocation_size, 0);
+  DCHECK_LE(min_allocation_size, max_allocation_size);
+  DCHECK_LE(max_allocation_size, max_bytes_per_request);
+  DCHECK_LE(max_bytes_per_request, buffer_size);
+
+  buf_size_ = buffer_size;
+  min_alloc_size_ = min_allocation_size;
+  max_alloc_size_ = max_allocation_size;
+  max_bytes_per_request_ = max_bytes_per_request;
+
+  return shared_mem_.CreateAndMapAnonymous(buf_size_);
+}
+
+bool ResourceRingBuffer::IsInitialized() const {
+  return shared_mem_.memory() != NULL;
+}
+
+bool ResourceRingBuffer::ShareToProcess(
+    base::ProcessHandle process_handle,
+    base::SharedMemoryHandle* shared_memory_handle,
+    int* shared_memory_size) {
+  DCHECK(IsInitialized());
+
+  if (!shared_mem_.ShareToProcess(process_handle, shared_memory_handle))
+    return false;
+
+  *shared_memory_size = buf_size_;
+  return true;
+}
+
+bool ResourceRingBuffer::CanAllocate(int request_id) const {
+  DCHECK(IsInitialized());
+
+  if (max_bytes_per_request_ - GetBytesHeld(request_id) < min_alloc_size_)
+    return false;
+
+  int offset;
+  int size;
+  GetFreeRange(&offset, &size);
+  return size >= min_alloc_size_;
+}
+
+char* ResourceRingBuffer::Allocate(int request_id,
+                                   int preferred_size,
+                                   int* offset,
+                                   int* size) {
+  if (!CanAllocate(request_id))
+    return NULL;
+
+  int free_offset;
+  int free_size;
+  GetFreeRange(&free_offset, &free_size);
+
+  int alloc_size = std::max(preferred_size, min_alloc_size_);
+  alloc_size = std::min(alloc_size, max_alloc_size_);
+  alloc_size = std::min(alloc_size, free_size);
+  alloc_size = std::min(alloc_size,
+                        max_bytes_per_request_ - GetBytesHeld(request_id));
+  DCHECK_GE(alloc_size, min_alloc_size_);
+
+  Chunk chunk;
+  chunk.size = alloc_size;
+  chunk.request_id = request_id;
+  chunk.pin_count = 0;
+  chunk.committed = false;
+  chunk.released = false;
+  chunks_[free_offset] = chunk;
+  bytes_held_[request_id] += alloc_size;
+
+  *offset = free_offset;
+  *size = alloc_size;
+  return memory() + free_offset;
+}
+
+void ResourceRingBuffer::Commit(int offset, int used_size) {
+  Chunk* chunk = FindChunk(offset);
+  DCHECK(chunk);
+  DCHECK(!chunk->committed);
+  DCHECK_GT(used_size, 0);
+  DCHECK_LE(used_size, chunk->size);
+
+  const int unused_size = chunk->size - used_size;
+  bytes_held_[chunk->request_id] -= unused_size;
+  chunk->size = used_size;
+  chunk->committed = true;
+  committed_chunks_[chunk->request_id].push_back(offset);
+  if (unused_size)
+    FOR_EACH_OBSERVER(Observer, observers_, OnRingBufferSpaceAvailable());
+}
+
+void ResourceRingBuffer::Abandon(int offset) {
+  DCHECK(FindChunk(offset));
+  DCHECK(!FindChunk(offset)->committed);
+  ReleaseChunk(offset);
+}
+
+void ResourceRingBuffer::OnDataReceivedACK(int request_id) {
+  CommittedChunkMap::iterator it = committed_chunks_.find(request_id);
+  if (it == committed_chunks_.end())
+    return;
+
+  int offset = it->second.front();
+  it->second.pop_front();
+  if (it->second.empty())
+    committed_chunks_.erase(it);
+  ReleaseChunk(offset);
+}
+
+void ResourceRingBuffer::ReleaseRequest(int request_id) {
+  CommittedChunkMap::iterator it = committed_chunks_.find(request_id);
+  if (it == committed_chunks_.end())
+    return;
+
+  std::deque<int> offsets;
+  offsets.swap(it->second);
+  committed_chunks_.erase(it);
+  for (size_t i = 0; i < offsets.size(); ++i)
+    ReleaseChunk(offsets[i]);
+}
+
+void ResourceRingBuffer::Pin(int offset) {
+  Chunk* chunk = FindChunk(offset);
+  DCHECK(chunk);
+  DCHECK(!chunk->released);
+  ++chunk->pin_count;
+}
+
+void ResourceRingBuffer::Unpin(int offset) {
+  Chunk* chunk = FindChunk(offset);
+  DCHECK(chunk);
+  DCHECK_GT(chunk->pin_count, 0);
+  if (--chunk->pin_count == 0 && chunk->released) {
+    chunks_.erase(offset);
+    FOR_EACH_OBSERVER(Observer, observers_, OnRingBufferSpaceAvailable());
+  }
+}
+
+void ResourceRingBuffer::AddObserver(Observer* observer) {
+  if (!observers_.HasObserver(observer))
+    observers_.AddObserver(observer);
+}
+
+void ResourceRingBuffer::RemoveObserver(Observer* observer) {
+  observers_.RemoveObserver(observer);
+}
+
+int ResourceRingBuffer::GetBytesHeld(int request_id) const {
+  BytesHeldMap::const_iterator it = bytes_held_.find(request_id);
+  return it == bytes_held_.end() ? 0 : it->second;
+}
+
+void ResourceRingBuffer::GetFreeRange(int* offset, int* size) const {
+  *offset = 0;
+  *size = 0;
+  int gap_offset = 0;
+  for (ChunkMap::const_iterator it = chunks_.begin(); it != chunks_.end();
+       ++it) {
+    if (it->first - gap_offset > *size) {
+      *offset = gap_offset;
+      *size = it->first - gap_offset;
+    }
+    gap_offset = it->first + it->second.size;
+  }
+  if (buf_size_ - gap_offset > *size) {
+    *offset = gap_offset;
+    *size = buf_size_ - gap_offset;
+  }
+}
+
+ResourceRingBuffer::Chunk* ResourceRingBuffer::FindChunk(int offset) {
+  ChunkMap::iterator it = chunks_.find(offset);
+  return it == chunks_.end() ? NULL : &it->second;
+}
+
+void ResourceRingBuffer::ReleaseChunk(int offset) {
+  Chunk* chunk = FindChunk(offset);
+  DCHECK(chunk);
+  DCHECK(!chunk->released);
+  chunk->released = true;
+
+  BytesHeldMap::iterator it = bytes_held_.find(chunk->request_id);
+  DCHECK(it != bytes_held_.end());
+  it->second -= chunk->size;
+  if (it->second == 0)
+    bytes_held_.erase(it);
+
+  // A pinned chunk is freed when it is unpinned, but the request has its
+  // credit back already.
+  if (chunk->pin_count == 0)
+    chunks_.erase(offset);
+  FOR_EACH_OBSERVER(Observer, observers_, OnRingBufferSpaceAvailable());
+}
+
+}  // namespace content
@@ -0,0 +1,161 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_BROWSER_LOADER_RESOURCE_RING_BUFFER_H_
+#define CONTENT_BROWSER_LOADER_RESOURCE_RING_BUFFER_H_
+
+#include <deque>
+#include <map>
+
+#include "base/containers/hash_tables.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/shared_memory.h"
+#include "base/observer_list.h"
+#include "content/common/content_export.h"
+
+namespace content {
+
+// ResourceRingBuffer is a shared memory buffer that carries the response bodies
+// of all the asynchronous requests of one child process, so that each request
+// doesn't need a shared memory buffer of its own.
+//
+// Requests reserve contiguous chunks of the ring with Allocate, fill them, and
+// Commit them once the chunk has been sent to the child in a DataReceived
+// message.  The child gives a committed chunk back by acknowledging that
+// message (OnDataReceivedACK), or all of a request's chunks at once by
+// cancelling it (ReleaseRequest).  A chunk that was allocated but never sent
+// is given back with Abandon.
+//
+// A chunk's space can be reused as soon as the chunk is given back, whatever
+// the order it was allocated in, so a request the child is slow to acknowledge
+// only holds up its own chunks.  Each request may hold at most
+// |max_bytes_per_request| of the buffer at a time; this is the request's
+// credit.
+//
+// A chunk may be pinned by IOBuffers that point into it.  It is not reused
+// until it has been given back and unpinned, so that a read that is still in
+// flight never writes into memory that belongs to another request.
+//
+// ResourceRingBuffer lives on the IO thread, but is reference-counted so that
+// IOBuffers released on other threads can keep it alive until they unpin.
+class CONTENT_EXPORT ResourceRingBuffer
+    : public base::RefCountedThreadSafe<ResourceRingBuffer> {
+ public:
+  class Observer {
+   public:
+    // Called when a request's chunks have been given back, so that requests
+    // that were waiting for space or credit may be able to allocate again.
+    virtual void OnRingBufferSpaceAvailable() = 0;
+
+   protected:
+    virtual ~Observer() {}
+  };
+
+  ResourceRingBuffer();
+
+  // Creates the shared memory buffer.  It will be |buffer_size| bytes in
+  // length.  Allocations will be at least |min_allocation_size| and at most
+  // |max_allocation_size| bytes.
+  bool Initialize(int buffer_size,
+                  int min_allocation_size,
+                  int max_allocation_size,
+                  int max_bytes_per_request);
+  bool IsInitialized() const;
+
+  // Identifies this buffer to the child, which maps it only once.
+  int id() const { return id_; }
+  int min_allocation_size() const { return min_alloc_size_; }
+  int max_allocation_size() const { return max_alloc_size_; }
+
+  // Returns a shared memory handle that can be passed to the given process.
+  // See ResourceBuffer::ShareToProcess.
+  bool ShareToProcess(base::ProcessHandle process_handle,
+                      base::SharedMemoryHandle* shared_memory_handle,
+                      int* shared_memory_size);
+
+  // Returns true if Allocate will succeed for |request_id|.
+  bool CanAllocate(int request_id) const;
+
+  // Reserves a chunk of up to |preferred_size| bytes for |request_id|, and
+  // returns a pointer to it, or NULL if there isn't enough space or credit.
+  // The chunk is smaller than |preferred_size| if space or credit is short.
+  char* Allocate(int request_id, int preferred_size, int* offset, int* size);
+
+  // Marks the chunk at |offset| as sent to the child, with |used_size| bytes
+  // of data in it.  The rest of the chunk is returned to the buffer.
+  void Commit(int offset, int used_size);
+
+  // Gives back a chunk that was never sent to the child.
+  void Abandon(int offset);
+
+  // Gives back the least recently committed chunk of |request_id|.  Does
+  // nothing if the request has no committed chunks.
+  void OnDataReceivedACK(int request_id);
+
+  // Gives back all the committed chunks of |request_id|, after the child
+  // cancelled it.
+  void ReleaseRequest(int request_id);
+
+  // Pins and unpins the chunk at |offset|.
+  void Pin(int offset);
+  void Unpin(int offset);
+
+  char* memory() const { return static_cast<char*>(shared_mem_.memory()); }
+
+  void AddObserver(Observer* observer);
+  void RemoveObserver(Observer* observer);
+
+  // The number of bytes held by |request_id|.
+  int GetBytesHeld(int request_id) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<ResourceRingBuffer>;
+  ~ResourceRingBuffer();
+
+  struct Chunk {
+    int size;
+    int request_id;
+    int pin_count;
+    bool committed;
+    bool released;
+  };
+
+  // Keyed by offset.
+  typedef std::map<int, Chunk> ChunkMap;
+  typedef base::hash_map<int, int> BytesHeldMap;
+  typedef base::hash_map<int, std::deque<int> > CommittedChunkMap;
+
+  // Returns the offset and size of the largest contiguous free range.
+  void GetFreeRange(int* offset, int* size) const;
+
+  Chunk* FindChunk(int offset);
+
+  // Marks the chunk at |offset| as released, frees it unless it is pinned,
+  // and notifies the observers.
+  void ReleaseChunk(int offset);
+
+  const int id_;
+  base::SharedMemory shared_mem_;
+  int buf_size_;
+  int min_alloc_size_;
+  int max_alloc_size_;
+  int max_bytes_per_request_;
+
+  // The chunks that are allocated or pinned, in address order.
+  ChunkMap chunks_;
+
+  BytesHeldMap bytes_held_;
+
+  // The offsets of each request's committed chunks, in the order they were
+  // sent to the child.
+  CommittedChunkMap committed_chunks_;
+
+  ObserverList<Observer> observers_;
+
+  DISALLOW_COPY_AND_ASSIGN(ResourceRingBuffer);
+};
+
+}  // namespace content
+
+#endif  // CONTENT_BROWSER_LOADER_RESOURCE_RING_BUFFER_H_
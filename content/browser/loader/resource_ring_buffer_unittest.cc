@@ -0,0 +1,163 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/loader/resource_ring_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+
+class CountingObserver : public ResourceRingBuffer::Observer {
+ public:
+  CountingObserver() : count_(0) {}
+  virtual ~CountingObserver() {}
+
+  virtual void OnRingBufferSpaceAvailable() OVERRIDE { ++count_; }
+
+  int count() const { return count_; }
+
+ private:
+  int count_;
+};
+
+}  // namespace
+
+TEST(ResourceRingBufferTest, BasicAllocations) {
+  scoped_refptr<ResourceRingBuffer> buf = new ResourceRingBuffer();
+  EXPECT_TRUE(buf->Initialize(100, 5, 10, 50));
+  EXPECT_NE(0, buf->id());
+  EXPECT_TRUE(buf->CanAllocate(1));
+
+  int offset;
+  int size;
+  char* ptr = buf->Allocate(1, 20, &offset, &size);
+  EXPECT_EQ(buf->memory(), ptr);
+  EXPECT_EQ(0, offset);
+  EXPECT_EQ(10, size);  // Clamped to the max allocation size.
+
+  // The unused end of a chunk goes back to the buffer.
+  buf->Commit(offset, 4);
+  EXPECT_EQ(4, buf->GetBytesHeld(1));
+
+  ptr = buf->Allocate(2, 1, &offset, &size);
+  EXPECT_EQ(buf->memory() + 4, ptr);
+  EXPECT_EQ(4, offset);
+  EXPECT_EQ(5, size);  // Raised to the min allocation size.
+  EXPECT_EQ(5, buf->GetBytesHeld(2));
+
+  // Chunks are only freed once the child acknowledges them.
+  buf->OnDataReceivedACK(1);
+  EXPECT_EQ(0, buf->GetBytesHeld(1));
+  buf->Abandon(offset);
+  EXPECT_EQ(0, buf->GetBytesHeld(2));
+}
+
+TEST(ResourceRingBufferTest, PerRequestCredit) {
+  scoped_refptr<ResourceRingBuffer> buf = new ResourceRingBuffer();
+  EXPECT_TRUE(buf->Initialize(100, 5, 10, 20));
+
+  int offset;
+  int size;
+  EXPECT_TRUE(buf->Allocate(1, 10, &offset, &size));
+  buf->Commit(offset, 10);
+  EXPECT_TRUE(buf->Allocate(1, 10, &offset, &size));
+  buf->Commit(offset, 10);
+
+  // Request 1 used up its credit, but others can still allocate.
+  EXPECT_FALSE(buf->CanAllocate(1));
+  EXPECT_FALSE(buf->Allocate(1, 10, &offset, &size));
+  EXPECT_TRUE(buf->CanAllocate(2));
+
+  // Acknowledging data gives the credit back.
+  buf->OnDataReceivedACK(1);
+  EXPECT_TRUE(buf->CanAllocate(1));
+
+  // So does cancelling the request.
+  buf->ReleaseRequest(1);
+  EXPECT_EQ(0, buf->GetBytesHeld(1));
+}
+
+TEST(ResourceRingBufferTest, AcknowledgingDataNotifiesObservers) {
+  scoped_refptr<ResourceRingBuffer> buf = new ResourceRingBuffer();
+  EXPECT_TRUE(buf->Initialize(100, 5, 10, 20));
+
+  int offset;
+  int size;
+  EXPECT_TRUE(buf->Allocate(1, 10, &offset, &size));
+  buf->Commit(offset, 10);
+  EXPECT_TRUE(buf->Allocate(1, 10, &offset, &size));
+  buf->Commit(offset, 10);
+  EXPECT_FALSE(buf->CanAllocate(1));
+
+  // Request 1 is out of credit while the buffer has plenty of space, and is
+  // woken up when the child acknowledges its oldest chunk.
+  CountingObserver observer;
+  buf->AddObserver(&observer);
+  EXPECT_TRUE(buf->Allocate(2, 10, &offset, &size));
+  buf->Commit(offset, 10);
+  EXPECT_EQ(0, observer.count());
+  buf->OnDataReceivedACK(1);
+  EXPECT_EQ(1, observer.count());
+  EXPECT_TRUE(buf->CanAllocate(1));
+  buf->RemoveObserver(&observer);
+}
+
+TEST(ResourceRingBufferTest, OutOfOrderRelease) {
+  scoped_refptr<ResourceRingBuffer> buf = new ResourceRingBuffer();
+  EXPECT_TRUE(buf->Initialize(30, 5, 10, 30));
+
+  int offsets[3];
+  int size;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(buf->Allocate(i + 1, 10, &offsets[i], &size));
+    EXPECT_EQ(10, size);
+    buf->Commit(offsets[i], 10);
+  }
+  EXPECT_FALSE(buf->CanAllocate(4));
+
+  // A request the child doesn't acknowledge doesn't hold up the others: the
+  // space of the second chunk is reused while the first is still held.
+  CountingObserver observer;
+  buf->AddObserver(&observer);
+  buf->OnDataReceivedACK(2);
+  EXPECT_EQ(1, observer.count());
+  int offset;
+  EXPECT_TRUE(buf->Allocate(4, 30, &offset, &size));
+  EXPECT_EQ(offsets[1], offset);
+  EXPECT_EQ(10, size);
+  buf->Commit(offset, 5);
+  EXPECT_EQ(2, observer.count());
+
+  // The new chunk gave back the space it didn't use, which joins the space of
+  // the third chunk once that is freed.
+  buf->OnDataReceivedACK(3);
+  EXPECT_TRUE(buf->Allocate(5, 30, &offset, &size));
+  EXPECT_EQ(offsets[1] + 5, offset);
+  EXPECT_EQ(10, size);
+  buf->RemoveObserver(&observer);
+}
+
+TEST(ResourceRingBufferTest, PinnedChunksAreNotReused) {
+  scoped_refptr<ResourceRingBuffer> buf = new ResourceRingBuffer();
+  EXPECT_TRUE(buf->Initialize(20, 5, 10, 20));
+
+  int offset;
+  int size;
+  EXPECT_TRUE(buf->Allocate(1, 10, &offset, &size));
+  buf->Pin(offset);
+  buf->Abandon(offset);
+  EXPECT_TRUE(buf->Allocate(2, 10, &offset, &size));
+  buf->Commit(offset, 10);
+  EXPECT_FALSE(buf->CanAllocate(3));
+
+  CountingObserver observer;
+  buf->AddObserver(&observer);
+  buf->Unpin(0);
+  EXPECT_EQ(1, observer.count());
+  EXPECT_TRUE(buf->CanAllocate(3));
+  buf->RemoveObserver(&observer);
+}
+
+}  // namespace content
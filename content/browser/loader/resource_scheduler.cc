@@ -2,16 +2,19 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include <set>
+#include <algorithm>
+#include <vector>
 
 #include "content/browser/loader/resource_scheduler.h"
 
+#include "base/command_line.h"
 #include "base/stl_util.h"
 #include "content/common/resource_messages.h"
 #include "content/browser/loader/resource_message_delegate.h"
 #include "content/public/browser/resource_controller.h"
 #include "content/public/browser/resource_request_info.h"
 #include "content/public/browser/resource_throttle.h"
+#include "content/public/common/content_switches.h"
 #include "ipc/ipc_message_macros.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/load_flags.h"
@@ -27,6 +30,19 @@ static const size_t kMaxNumDelayableRequestsPerClient = 10;
 static const size_t kMaxNumDelayableRequestsPerHost = 6;
 static const size_t kMaxNumThrottledRequestsPerClient = 1;
 
+// Bandwidth-aware scheduling gives each request in flight about this much of
+// the estimated throughput before it holds back delayable requests, within the
+// bounds below.
+static const double kKbpsPerRequestInFlight = 128.0;
+static const size_t kMinNumRequestsInFlightForDelayable = 2;
+static const size_t kMaxNumRequestsInFlightForDelayable = 16;
+
+// Throughput is sampled over windows of at least this long, or until no
+// requests are in flight.  Windows with too few bytes are too noisy to use.
+static const int64 kThroughputWindowMs = 1000;
+static const int64 kMinThroughputSampleBytes = 32 * 1024;
+static const double kThroughputSampleWeight = 0.25;
+
 struct ResourceScheduler::RequestPriorityParams {
   RequestPriorityParams()
     : priority(net::DEFAULT_PRIORITY),
@@ -57,10 +73,42 @@ struct ResourceScheduler::RequestPriorityParams {
   int intra_priority;
 };
 
+// A binary heap of the pending requests of a Client, with the next request to
+// consider at the top.  Each request knows its index in the heap, so it can be
+// removed or moved after a priority change in O(log n).
 class ResourceScheduler::RequestQueue {
  public:
-  typedef std::multiset<ScheduledResourceRequest*, ScheduledResourceSorter>
-      NetQueue;
+  typedef std::vector<ScheduledResourceRequest*> NetQueue;
+
+  // Visits the queued requests from the highest priority down, without
+  // removing them.  Any change to the queue invalidates the iterator.
+  class Iterator {
+   public:
+    explicit Iterator(const RequestQueue* queue);
+
+    bool IsAtEnd() const { return frontier_.empty(); }
+    ScheduledResourceRequest* value() const {
+      return queue_->queue_[frontier_.front()];
+    }
+    void Advance();
+
+   private:
+    // Orders heap indices so that |frontier_| is itself a heap with the index
+    // of the highest priority request at the front.
+    struct IndexSorter {
+      explicit IndexSorter(const NetQueue* queue) : queue(queue) {}
+      bool operator()(size_t a, size_t b) const {
+        return ScheduledResourceSorter()((*queue)[b], (*queue)[a]);
+      }
+      const NetQueue* queue;
+    };
+
+    const RequestQueue* queue_;
+    // The heap indices of the requests whose parent has been visited, but
+    // which haven't been visited themselves.  The next request to visit is
+    // always one of these.
+    std::vector<size_t> frontier_;
+  };
 
   RequestQueue() : fifo_ordering_ids_(0) {}
   ~RequestQueue() {}
@@ -69,45 +117,36 @@ class ResourceScheduler::RequestQueue {
   void Insert(ScheduledResourceRequest* request);
 
   // Removes |request| from the queue.
-  void Erase(ScheduledResourceRequest* request) {
-    PointerMap::iterator it = pointers_.find(request);
-    DCHECK(it != pointers_.end());
-    if (it == pointers_.end())
-      return;
-    queue_.erase(it->second);
-    pointers_.erase(it);
-  }
-
-  NetQueue::iterator GetNextHighestIterator() {
-    return queue_.begin();
-  }
+  void Erase(ScheduledResourceRequest* request);
 
-  NetQueue::iterator End() {
-    return queue_.end();
-  }
+  // Moves |request| to its new place after its priority changed.  Like a
+  // newly inserted request, it goes behind the requests that already have its
+  // priority.
+  void Reprioritize(ScheduledResourceRequest* request);
 
   // Returns true if |request| is queued.
-  bool IsQueued(ScheduledResourceRequest* request) const {
-    return ContainsKey(pointers_, request);
-  }
+  bool IsQueued(const ScheduledResourceRequest* request) const;
 
   // Returns true if no requests are queued.
-  bool IsEmpty() const { return queue_.size() == 0; }
+  bool IsEmpty() const { return queue_.empty(); }
 
  private:
-  typedef std::map<ScheduledResourceRequest*, NetQueue::iterator> PointerMap;
-
   uint32 MakeFifoOrderingId() {
     fifo_ordering_ids_ += 1;
     return fifo_ordering_ids_;
   }
 
+  // Restore the heap property after the request at |index| moved up or down
+  // in the order.
+  void SiftUp(size_t index);
+  void SiftDown(size_t index);
+  void Swap(size_t a, size_t b);
+
   // Used to create an ordering ID for scheduled resources so that resources
   // with same priority/intra_priority stay in fifo order.
   uint32 fifo_ordering_ids_;
 
   NetQueue queue_;
-  PointerMap pointers_;
 };
 
 // This is the handle we return to the ResourceDispatcherHostImpl so it can
@@ -128,17 +167,22 @@ class ResourceScheduler::ScheduledResourceRequest
         classification_(NORMAL_REQUEST),
         scheduler_(scheduler),
         priority_(priority),
-        fifo_ordering_(0) {
+        fifo_ordering_(0),
+        queue_index_(-1) {
     TRACE_EVENT_ASYNC_BEGIN1("net", "URLRequest", request_,
                              "url", request->url().spec());
   }
 
   virtual ~ScheduledResourceRequest() {
+    if (ready_)
+      scheduler_->OnRequestFinished(request_->GetTotalReceivedBytes());
     scheduler_->RemoveRequest(this);
   }
 
   void Start() {
     TRACE_EVENT_ASYNC_STEP_PAST0("net", "URLRequest", request_, "Queued");
+    if (!ready_)
+      scheduler_->OnRequestStarted();
     ready_ = true;
     if (deferred_ && request_->status().is_success()) {
       deferred_ = false;
@@ -159,6 +203,9 @@ class ResourceScheduler::ScheduledResourceRequest
   void set_fifo_ordering(uint32 fifo_ordering) {
     fifo_ordering_ = fifo_ordering;
   }
+  // The index of this request in its Client's RequestQueue, or -1.
+  int queue_index() const { return queue_index_; }
+  void set_queue_index(int queue_index) { queue_index_ = queue_index; }
   RequestClassification classification() const {
     return classification_;
   }
@@ -199,6 +246,7 @@ class ResourceScheduler::ScheduledResourceRequest
   ResourceScheduler* scheduler_;
   RequestPriorityParams priority_;
   uint32 fifo_ordering_;
+  int queue_index_;
 
   DISALLOW_COPY_AND_ASSIGN(ScheduledResourceRequest);
 };
@@ -215,15 +263,109 @@ bool ResourceScheduler::ScheduledResourceSorter::operator()(
         b->get_request_priority_params());
 
   // If priority/intra_priority is the same, fall back to fifo ordering.
-  // std::multiset doesn't guarantee this until c++11.
   return a->fifo_ordering() < b->fifo_ordering();
 }
 
+ResourceScheduler::RequestQueue::Iterator::Iterator(const RequestQueue* queue)
+    : queue_(queue) {
+  if (!queue_->IsEmpty())
+    frontier_.push_back(0);
+}
+
+void ResourceScheduler::RequestQueue::Iterator::Advance() {
+  DCHECK(!IsAtEnd());
+  IndexSorter sorter(&queue_->queue_);
+  size_t index = frontier_.front();
+  std::pop_heap(frontier_.begin(), frontier_.end(), sorter);
+  frontier_.pop_back();
+
+  // The children of a request come after it, so they are the only requests
+  // that can be next besides the ones already in the frontier.
+  for (size_t child = 2 * index + 1;
+       child <= 2 * index + 2 && child < queue_->queue_.size(); ++child) {
+    frontier_.push_back(child);
+    std::push_heap(frontier_.begin(), frontier_.end(), sorter);
+  }
+}
+
 void ResourceScheduler::RequestQueue::Insert(
     ScheduledResourceRequest* request) {
-  DCHECK(!ContainsKey(pointers_, request));
+  DCHECK(!IsQueued(request));
+  request->set_fifo_ordering(MakeFifoOrderingId());
+  request->set_queue_index(queue_.size());
+  queue_.push_back(request);
+  SiftUp(queue_.size() - 1);
+}
+
+void ResourceScheduler::RequestQueue::Erase(
+    ScheduledResourceRequest* request) {
+  DCHECK(IsQueued(request));
+  if (!IsQueued(request))
+    return;
+
+  size_t index = request->queue_index();
+  request->set_queue_index(-1);
+  ScheduledResourceRequest* last = queue_.back();
+  queue_.pop_back();
+  if (index == queue_.size())
+    return;
+
+  // Fill the hole with the last request, and move it to its place.
+  queue_[index] = last;
+  last->set_queue_index(index);
+  SiftUp(index);
+  SiftDown(last->queue_index());
+}
+
+void ResourceScheduler::RequestQueue::Reprioritize(
+    ScheduledResourceRequest* request) {
+  DCHECK(IsQueued(request));
   request->set_fifo_ordering(MakeFifoOrderingId());
-  pointers_[request] = queue_.insert(request);
+  SiftUp(request->queue_index());
+  SiftDown(request->queue_index());
+}
+
+bool ResourceScheduler::RequestQueue::IsQueued(
+    const ScheduledResourceRequest* request) const {
+  // The index alone isn't enough: a request outlives the Client that queued
+  // it, and another Client may be created with the same id.
+  int index = request->queue_index();
+  return index >= 0 && static_cast<size_t>(index) < queue_.size() &&
+      queue_[index] == request;
+}
+
+void ResourceScheduler::RequestQueue::SiftUp(size_t index) {
+  ScheduledResourceSorter sorter;
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (!sorter(queue_[index], queue_[parent]))
+      break;
+    Swap(index, parent);
+    index = parent;
+  }
+}
+
+void ResourceScheduler::RequestQueue::SiftDown(size_t index) {
+  ScheduledResourceSorter sorter;
+  for (;;) {
+    size_t first = index;
+    size_t left = 2 * index + 1;
+    size_t right = left + 1;
+    if (left < queue_.size() && sorter(queue_[left], queue_[first]))
+      first = left;
+    if (right < queue_.size() && sorter(queue_[right], queue_[first]))
+      first = right;
+    if (first == index)
+      break;
+    Swap(index, first);
+    index = first;
+  }
+}
+
+void ResourceScheduler::RequestQueue::Swap(size_t a, size_t b) {
+  std::swap(queue_[a], queue_[b]);
+  queue_[a]->set_queue_index(a);
+  queue_[b]->set_queue_index(b);
 }
 
 // Each client represents a tab.
@@ -379,8 +521,7 @@ class ResourceScheduler::Client {
       return;
     }
 
-    pending_requests_.Erase(request);
-    pending_requests_.Insert(request);
+    pending_requests_.Reprioritize(request);
 
     if (new_priority_params.priority > old_priority_params.priority) {
       // Check if this request is now able to load at its new priority.
@@ -466,10 +607,9 @@ class ResourceScheduler::Client {
         classification_request_count++;
     }
     if (include_pending) {
-      for (RequestQueue::NetQueue::const_iterator
-           it = pending_requests_.GetNextHighestIterator();
-           it != pending_requests_.End(); ++it) {
-        if ((*it)->classification() == classification)
+      for (RequestQueue::Iterator it(&pending_requests_); !it.IsAtEnd();
+           it.Advance()) {
+        if (it.value()->classification() == classification)
           classification_request_count++;
       }
     }
@@ -575,6 +715,9 @@ class ResourceScheduler::Client {
   //     loading delayable requests.
   //   * Never exceed 10 delayable requests in flight per client.
   //   * Never exceed 6 delayable requests for a given host.
+  //   * With bandwidth-aware scheduling, only start delayable requests while
+  //     the client has fewer requests in flight, of any priority, than the
+  //     throughput estimate allows (between 2 and 16).
   //
   //  THROTTLED Clients follow these rules:
   //   * Non-delayable and SPDY-capable requests are issued immediately.
@@ -640,6 +783,14 @@ class ResourceScheduler::Client {
       return DO_NOT_START_REQUEST_AND_STOP_SEARCHING;
     }
 
+    // On a slow network, the requests already in flight use up the bandwidth
+    // that a delayable request would compete with them for.
+    if (scheduler_->bandwidth_aware() &&
+        in_flight_requests_.size() >=
+            scheduler_->GetMaxRequestsInFlightForDelayable()) {
+      return DO_NOT_START_REQUEST_AND_STOP_SEARCHING;
+    }
+
     if (ShouldKeepSearching(host_port_pair)) {
       // There may be other requests for other hosts we'd allow,
       // so keep checking.
@@ -666,11 +817,10 @@ class ResourceScheduler::Client {
     //     the previous request still in the list.
     // 3) We do not start the request, same as above, but StartRequest() tells
     //     us there's no point in checking any further requests.
-    RequestQueue::NetQueue::iterator request_iter =
-        pending_requests_.GetNextHighestIterator();
+    RequestQueue::Iterator request_iter(&pending_requests_);
 
-    while (request_iter != pending_requests_.End()) {
-      ScheduledResourceRequest* request = *request_iter;
+    while (!request_iter.IsAtEnd()) {
+      ScheduledResourceRequest* request = request_iter.value();
       ShouldStartReqResult query_result = ShouldStartRequest(request);
 
       if (query_result == START_REQUEST) {
@@ -678,14 +828,10 @@ class ResourceScheduler::Client {
         StartRequest(request);
 
         // StartRequest can modify the pending list, so we (re)start evaluation
-        // from the currently highest priority request. Avoid copying a singular
-        // iterator, which would trigger undefined behavior.
-        if (pending_requests_.GetNextHighestIterator() ==
-            pending_requests_.End())
-          break;
-        request_iter = pending_requests_.GetNextHighestIterator();
+        // from the currently highest priority request.
+        request_iter = RequestQueue::Iterator(&pending_requests_);
       } else if (query_result == DO_NOT_START_REQUEST_AND_KEEP_SEARCHING) {
-        ++request_iter;
+        request_iter.Advance();
         continue;
       } else {
         DCHECK(query_result == DO_NOT_START_REQUEST_AND_STOP_SEARCHING);
@@ -713,10 +859,15 @@ class ResourceScheduler::Client {
 ResourceScheduler::ResourceScheduler()
     : should_coalesce_(false),
       should_throttle_(false),
+      bandwidth_aware_(base::CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kEnableBandwidthAwareResourceScheduling)),
       active_clients_loading_(0),
       coalesced_clients_(0),
       coalescing_timer_(new base::Timer(true /* retain_user_task */,
-                                        true /* is_repeating */)) {
+                                        true /* is_repeating */)),
+      throughput_kbps_(-1.0),
+      requests_in_flight_(0),
+      throughput_window_bytes_(0) {
 }
 
 ResourceScheduler::~ResourceScheduler() {
@@ -731,6 +882,20 @@ void ResourceScheduler::SetThrottleOptionsForTesting(bool should_throttle,
   OnLoadingActiveClientsStateChangedForAllClients();
 }
 
+void ResourceScheduler::SetThroughputEstimateForTesting(double kbps) {
+  bandwidth_aware_ = true;
+  throughput_kbps_ = kbps;
+}
+
+size_t ResourceScheduler::GetMaxRequestsInFlightForDelayable() const {
+  if (throughput_kbps_ < 0)
+    return kMaxNumRequestsInFlightForDelayable;
+  size_t max_requests =
+      static_cast<size_t>(throughput_kbps_ / kKbpsPerRequestInFlight);
+  return std::max(kMinNumRequestsInFlightForDelayable,
+                  std::min(kMaxNumRequestsInFlightForDelayable, max_requests));
+}
+
 ResourceScheduler::ClientThrottleState
 ResourceScheduler::GetClientStateForTesting(int child_id, int route_id) {
   Client* client = GetClient(child_id, route_id);
@@ -780,6 +945,43 @@ void ResourceScheduler::RemoveRequest(ScheduledResourceRequest* request) {
   client->RemoveRequest(request);
 }
 
+void ResourceScheduler::OnRequestStarted() {
+  if (!bandwidth_aware_)
+    return;
+  if (requests_in_flight_++ == 0) {
+    throughput_window_start_ = base::TimeTicks::Now();
+    throughput_window_bytes_ = 0;
+  }
+}
+
+void ResourceScheduler::OnRequestFinished(int64 received_bytes) {
+  if (!bandwidth_aware_)
+    return;
+  DCHECK_NE(0u, requests_in_flight_);
+  --requests_in_flight_;
+  throughput_window_bytes_ += received_bytes;
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::TimeDelta elapsed = now - throughput_window_start_;
+  if (requests_in_flight_ &&
+      elapsed < base::TimeDelta::FromMilliseconds(kThroughputWindowMs)) {
+    return;
+  }
+
+  if (throughput_window_bytes_ >= kMinThroughputSampleBytes &&
+      elapsed > base::TimeDelta()) {
+    double kbps = throughput_window_bytes_ * 8 / elapsed.InMillisecondsF();
+    if (throughput_kbps_ < 0) {
+      throughput_kbps_ = kbps;
+    } else {
+      throughput_kbps_ = (1 - kThroughputSampleWeight) * throughput_kbps_ +
+          kThroughputSampleWeight * kbps;
+    }
+  }
+  throughput_window_start_ = now;
+  throughput_window_bytes_ = 0;
+}
+
 void ResourceScheduler::OnClientCreated(int child_id, int route_id) {
   DCHECK(CalledOnValidThread());
   ClientId client_id = MakeClientId(child_id, route_id);
@@ -5,16 +5,16 @@
 #ifndef CONTENT_BROWSER_LOADER_RESOURCE_SCHEDULER_H_
 #define CONTENT_BROWSER_LOADER_RESOURCE_SCHEDULER_H_
 
-#include <map>
 #include <set>
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/containers/hash_tables.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/threading/non_thread_safe.h"
+#include "base/time/time.h"
 #include "base/timer/timer.h"
 #include "content/common/content_export.h"
-#include "net/base/priority_queue.h"
 #include "net/base/request_priority.h"
 
 namespace net {
@@ -51,6 +51,12 @@ class ResourceThrottle;
 // The scheduler may defer issuing the request via the ResourceThrottle
 // interface or it may alter the request's priority by calling set_priority() on
 // the URLRequest.
+//
+// With bandwidth-aware scheduling (--enable-bandwidth-aware-resource-
+// scheduling), the scheduler also estimates the network throughput from the
+// requests it has seen complete, and lets fewer requests load at once on a slow
+// network so that delayable requests don't compete with the ones that block
+// layout.
 class CONTENT_EXPORT ResourceScheduler : public base::NonThreadSafe {
  public:
   enum ClientThrottleState {
@@ -100,6 +106,22 @@ class CONTENT_EXPORT ResourceScheduler : public base::NonThreadSafe {
   bool should_coalesce() const { return should_coalesce_; }
   bool should_throttle() const { return should_throttle_; }
 
+  // Turns on bandwidth-aware scheduling, with |kbps| as the throughput
+  // estimate.  A negative |kbps| means there is no estimate yet.  Must be
+  // called before any requests start.
+  void SetThroughputEstimateForTesting(double kbps);
+
+  bool bandwidth_aware() const { return bandwidth_aware_; }
+
+  // Returns the estimated network throughput in kilobits per second, or a
+  // negative value if there isn't enough data for an estimate yet.
+  double throughput_kbps() const { return throughput_kbps_; }
+
+  // Returns the number of requests a client may have in flight before it
+  // stops starting delayable requests.  This is derived from the throughput
+  // estimate.
+  size_t GetMaxRequestsInFlightForDelayable() const;
+
   ClientThrottleState GetClientStateForTesting(int child_id, int route_id);
 
   // Requests that this ResourceScheduler schedule, and eventually loads, the
@@ -155,12 +177,19 @@ class CONTENT_EXPORT ResourceScheduler : public base::NonThreadSafe {
   class Client;
 
   typedef int64 ClientId;
-  typedef std::map<ClientId, Client*> ClientMap;
+  typedef base::hash_map<ClientId, Client*> ClientMap;
   typedef std::set<ScheduledResourceRequest*> RequestSet;
 
   // Called when a ScheduledResourceRequest is destroyed.
   void RemoveRequest(ScheduledResourceRequest* request);
 
+  // Called when a request starts loading, and when a request that started
+  // loading is destroyed after receiving |received_bytes|.  These feed the
+  // throughput estimate, and do nothing unless bandwidth-aware scheduling is
+  // on.
+  void OnRequestStarted();
+  void OnRequestFinished(int64 received_bytes);
+
   // These calls may update the ThrottleState of all clients, and have the
   // potential to be re-entrant.
   // Called when a Client newly becomes active loading.
@@ -185,9 +214,9 @@ class CONTENT_EXPORT ResourceScheduler : public base::NonThreadSafe {
   // Update the queue position for |request|, possibly causing it to start
   // loading.
   //
-  // Queues are maintained for each priority level. When |request| is
-  // reprioritized, it will move to the end of the queue for that priority
-  // level.
+  // Pending requests are kept in a heap ordered by priority, then by arrival.
+  // When |request| is reprioritized, it will move behind the requests that
+  // already have its new priority level.
   void ReprioritizeRequest(ScheduledResourceRequest* request,
                            net::RequestPriority new_priority,
                            int intra_priority_value);
@@ -200,12 +229,20 @@ class CONTENT_EXPORT ResourceScheduler : public base::NonThreadSafe {
 
   bool should_coalesce_;
   bool should_throttle_;
+  bool bandwidth_aware_;
   ClientMap client_map_;
   size_t active_clients_loading_;
   size_t coalesced_clients_;
   // This is a repeating timer to initiate requests on COALESCED Clients.
   scoped_ptr<base::Timer> coalescing_timer_;
   RequestSet unowned_requests_;
+
+  // The throughput estimate, an exponentially weighted moving average of the
+  // throughput measured over windows of time in which requests were loading.
+  double throughput_kbps_;
+  size_t requests_in_flight_;
+  base::TimeTicks throughput_window_start_;
+  int64 throughput_window_bytes_;
 };
 
 }  // namespace content
@@ -0,0 +1,381 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Replays the loading of a page through the ResourceScheduler over simulated
+// networks, and reports when the resources that block the first paint finish
+// loading, with and without bandwidth-aware scheduling.  Time is simulated, so
+// the results are deterministic.  Also measures how long the scheduler takes
+// to reprioritize many pending requests.
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "content/browser/browser_thread_impl.h"
+#include "content/browser/loader/resource_dispatcher_host_impl.h"
+#include "content/browser/loader/resource_message_filter.h"
+#include "content/browser/loader/resource_request_info_impl.h"
+#include "content/browser/loader/resource_scheduler.h"
+#include "content/common/resource_messages.h"
+#include "content/public/browser/resource_context.h"
+#include "content/public/browser/resource_controller.h"
+#include "content/public/browser/resource_throttle.h"
+#include "content/public/common/process_type.h"
+#include "content/public/common/resource_type.h"
+#include "net/base/request_priority.h"
+#include "net/http/http_server_properties_impl.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace content {
+
+namespace {
+
+const int kChildId = 30;
+const int kRouteId = 75;
+
+// A resource of the replayed page.
+struct PageResource {
+  const char* host;
+  net::RequestPriority priority;
+  int size_kb;
+  // When the renderer discovers the resource, in milliseconds.
+  int discovered_ms;
+  // Whether the first paint waits for the resource.
+  bool blocks_paint;
+};
+
+// A news-like page: a few stylesheets and scripts in the <head>, dozens of
+// images, and a late script that the parser only finds after the images.
+const PageResource kPage[] = {
+  { "static.example.com", net::HIGHEST, 40, 0, true },
+  { "static.example.com", net::MEDIUM, 90, 0, true },
+  { "cdn.example.com", net::MEDIUM, 30, 10, true },
+  { "img.example.com", net::LOWEST, 25, 20, false },
+  { "img.example.com", net::LOWEST, 60, 20, false },
+  { "img.example.com", net::LOWEST, 15, 20, false },
+  { "img.example.com", net::LOWEST, 80, 25, false },
+  { "img2.example.com", net::LOWEST, 45, 25, false },
+  { "img2.example.com", net::LOWEST, 20, 25, false },
+  { "img2.example.com", net::LOWEST, 70, 30, false },
+  { "ads.example.net", net::LOWEST, 35, 30, false },
+  { "ads.example.net", net::LOWEST, 50, 30, false },
+  { "img.example.com", net::LOWEST, 30, 35, false },
+  { "img.example.com", net::LOWEST, 40, 35, false },
+  { "img2.example.com", net::LOWEST, 55, 40, false },
+  { "img2.example.com", net::LOWEST, 25, 40, false },
+  { "cdn.example.com", net::MEDIUM, 60, 120, true },
+  { "fonts.example.com", net::MEDIUM, 35, 150, true },
+  { "img.example.com", net::LOWEST, 90, 160, false },
+  { "img.example.com", net::LOWEST, 20, 160, false },
+  { "img2.example.com", net::LOWEST, 65, 170, false },
+  { "ads.example.net", net::IDLE, 100, 200, false },
+};
+
+// When the renderer inserts <body>, in milliseconds.
+const int kBodyInsertedMs = 60;
+
+// A simulated network: every request waits one round trip, and then the
+// requests that are transferring share the bandwidth equally.
+struct Network {
+  const char* name;
+  int kbps;
+  int rtt_ms;
+};
+
+const Network kNetworks[] = {
+  { "2g", 250, 600 },
+  { "3g", 1600, 150 },
+  { "cable", 20000, 30 },
+};
+
+class SimulatedRequest : public ResourceController {
+ public:
+  SimulatedRequest(scoped_ptr<ResourceThrottle> throttle,
+                   scoped_ptr<net::URLRequest> url_request,
+                   const PageResource& resource)
+      : started_(false),
+        start_ms_(0),
+        bytes_left_(resource.size_kb * 1024.0),
+        throttle_(throttle.Pass()),
+        url_request_(url_request.Pass()),
+        resource_(resource) {
+    throttle_->set_controller_for_testing(this);
+    bool deferred = false;
+    throttle_->WillStartRequest(&deferred);
+    started_ = !deferred;
+  }
+  virtual ~SimulatedRequest() {}
+
+  bool started() const { return started_; }
+  bool finished() const { return !throttle_; }
+  const PageResource& resource() const { return resource_; }
+
+  int start_ms() const { return start_ms_; }
+  void set_start_ms(int start_ms) { start_ms_ = start_ms; }
+
+  double bytes_left() const { return bytes_left_; }
+  void Transfer(double bytes) { bytes_left_ -= bytes; }
+
+  // Destroying the throttle tells the scheduler that the load is done.
+  void Finish() { throttle_.reset(); }
+
+  // ResourceController interface:
+  virtual void Cancel() OVERRIDE { Finish(); }
+  virtual void CancelAndIgnore() OVERRIDE {}
+  virtual void CancelWithError(int error_code) OVERRIDE {}
+  virtual void Resume() OVERRIDE { started_ = true; }
+
+ private:
+  bool started_;
+  int start_ms_;
+  double bytes_left_;
+  scoped_ptr<ResourceThrottle> throttle_;
+  scoped_ptr<net::URLRequest> url_request_;
+  const PageResource& resource_;
+};
+
+class FakeResourceContext : public ResourceContext {
+ private:
+  virtual net::HostResolver* GetHostResolver() OVERRIDE { return NULL; }
+  virtual net::URLRequestContext* GetRequestContext() OVERRIDE { return NULL; }
+  virtual bool AllowMicAccess(const GURL& origin) OVERRIDE { return false; }
+  virtual bool AllowCameraAccess(const GURL& origin) OVERRIDE { return false; }
+};
+
+class FakeResourceMessageFilter : public ResourceMessageFilter {
+ public:
+  explicit FakeResourceMessageFilter(int child_id)
+      : ResourceMessageFilter(
+          child_id,
+          PROCESS_TYPE_RENDERER,
+          NULL  /* appcache_service */,
+          NULL  /* blob_storage_context */,
+          NULL  /* file_system_context */,
+          NULL  /* service_worker_context */,
+          base::Bind(&FakeResourceMessageFilter::GetContexts,
+                     base::Unretained(this))) {
+  }
+
+ private:
+  virtual ~FakeResourceMessageFilter() {}
+
+  void GetContexts(const ResourceHostMsg_Request& request,
+                   ResourceContext** resource_context,
+                   net::URLRequestContext** request_context) {
+    *resource_context = &context_;
+    *request_context = NULL;
+  }
+
+  FakeResourceContext context_;
+};
+
+}  // namespace
+
+class ResourceSchedulerPerfTest : public testing::Test {
+ protected:
+  ResourceSchedulerPerfTest()
+      : next_request_id_(0),
+        ui_thread_(BrowserThread::UI, &message_loop_),
+        io_thread_(BrowserThread::IO, &message_loop_) {
+    context_.set_http_server_properties(http_server_properties_.GetWeakPtr());
+  }
+
+  scoped_ptr<net::URLRequest> NewURLRequest(const std::string& url,
+                                            net::RequestPriority priority) {
+    scoped_ptr<net::URLRequest> url_request(
+        context_.CreateRequest(GURL(url), priority, NULL, NULL));
+    ResourceRequestInfoImpl* info = new ResourceRequestInfoImpl(
+        PROCESS_TYPE_RENDERER,                   // process_type
+        kChildId,                                // child_id
+        kRouteId,                                // route_id
+        0,                                       // origin_pid
+        ++next_request_id_,                      // request_id
+        MSG_ROUTING_NONE,                        // render_frame_id
+        false,                                   // is_main_frame
+        false,                                   // parent_is_main_frame
+        0,                                       // parent_render_frame_id
+        RESOURCE_TYPE_SUB_RESOURCE,              // resource_type
+        PAGE_TRANSITION_LINK,                    // transition_type
+        false,                                   // should_replace_current_entry
+        false,                                   // is_download
+        false,                                   // is_stream
+        true,                                    // allow_download
+        false,                                   // has_user_gesture
+        false,                                   // enable_load_timing
+        blink::WebReferrerPolicyDefault,         // referrer_policy
+        blink::WebPageVisibilityStateVisible,    // visibility_state
+        NULL,                                    // context
+        base::WeakPtr<ResourceMessageFilter>(),  // filter
+        true);                                   // is_async
+    info->AssociateWithRequest(url_request.get());
+    return url_request.Pass();
+  }
+
+  // Loads kPage over |network| with a new scheduler, and returns the time at
+  // which the last resource that blocks the first paint finished loading.
+  int ReplayPageLoad(const Network& network, bool bandwidth_aware) {
+    ResourceScheduler scheduler;
+    if (bandwidth_aware)
+      scheduler.SetThroughputEstimateForTesting(network.kbps);
+    scheduler.OnClientCreated(kChildId, kRouteId);
+    scheduler.OnVisibilityChanged(kChildId, kRouteId, true);
+
+    ScopedVector<SimulatedRequest> requests;
+    size_t next_resource = 0;
+    size_t paint_blockers_left = 0;
+    for (size_t i = 0; i < arraysize(kPage); ++i)
+      paint_blockers_left += kPage[i].blocks_paint;
+
+    const double bytes_per_ms = network.kbps * 1000.0 / 8 / 1000;
+    int paint_ms = -1;
+    for (int now_ms = 0; paint_ms < 0; ++now_ms) {
+      if (now_ms == kBodyInsertedMs)
+        scheduler.OnWillInsertBody(kChildId, kRouteId);
+
+      while (next_resource < arraysize(kPage) &&
+             kPage[next_resource].discovered_ms <= now_ms) {
+        const PageResource& resource = kPage[next_resource];
+        std::string url = base::StringPrintf(
+            "http://%s/%d", resource.host, static_cast<int>(next_resource));
+        scoped_ptr<net::URLRequest> url_request(
+            NewURLRequest(url, resource.priority));
+        scoped_ptr<ResourceThrottle> throttle(scheduler.ScheduleRequest(
+            kChildId, kRouteId, url_request.get()));
+        requests.push_back(new SimulatedRequest(
+            throttle.Pass(), url_request.Pass(), resource));
+        requests.back()->set_start_ms(now_ms);
+        ++next_resource;
+      }
+
+      // Share this millisecond's bandwidth between the requests past their
+      // first round trip.
+      int transferring = 0;
+      for (size_t i = 0; i < requests.size(); ++i) {
+        SimulatedRequest* request = requests[i];
+        if (request->started() && !request->finished() &&
+            now_ms - request->start_ms() >= network.rtt_ms) {
+          ++transferring;
+        }
+      }
+      for (size_t i = 0; i < requests.size(); ++i) {
+        SimulatedRequest* request = requests[i];
+        if (!request->started() || request->finished() ||
+            now_ms - request->start_ms() < network.rtt_ms) {
+          continue;
+        }
+        request->Transfer(bytes_per_ms / transferring);
+        if (request->bytes_left() > 0)
+          continue;
+        if (request->resource().blocks_paint && --paint_blockers_left == 0)
+          paint_ms = now_ms;
+        // This may start other requests.
+        request->Finish();
+      }
+
+      // Requests started by the scheduler during this millisecond begin their
+      // round trip now.
+      for (size_t i = 0; i < requests.size(); ++i) {
+        SimulatedRequest* request = requests[i];
+        if (!request->started())
+          request->set_start_ms(now_ms + 1);
+      }
+    }
+
+    requests.clear();
+    scheduler.OnClientDeleted(kChildId, kRouteId);
+    return paint_ms;
+  }
+
+  int next_request_id_;
+  base::MessageLoopForIO message_loop_;
+  BrowserThreadImpl ui_thread_;
+  BrowserThreadImpl io_thread_;
+  ResourceDispatcherHostImpl rdh_;
+  net::HttpServerPropertiesImpl http_server_properties_;
+  net::TestURLRequestContext context_;
+};
+
+TEST_F(ResourceSchedulerPerfTest, PageLoadReplay) {
+  for (size_t i = 0; i < arraysize(kNetworks); ++i) {
+    const Network& network = kNetworks[i];
+    perf_test::PrintResult("time_to_paint_critical_resources",
+                           network.name,
+                           "default",
+                           ReplayPageLoad(network, false),
+                           "ms",
+                           true);
+    perf_test::PrintResult("time_to_paint_critical_resources",
+                           network.name,
+                           "bandwidth_aware",
+                           ReplayPageLoad(network, true),
+                           "ms",
+                           true);
+  }
+}
+
+TEST_F(ResourceSchedulerPerfTest, Reprioritize) {
+  const int kNumRequests = 5000;
+  ResourceScheduler scheduler;
+  scheduler.OnClientCreated(kChildId, kRouteId);
+  scheduler.OnVisibilityChanged(kChildId, kRouteId, true);
+
+  // A high priority request before <body> keeps the rest queued.
+  const PageResource kBlocker = { "host", net::HIGHEST, 1, 0, true };
+  const PageResource kQueued = { "host", net::IDLE, 1, 0, false };
+  scoped_ptr<net::URLRequest> blocker_url_request(
+      NewURLRequest("http://host/blocker", net::HIGHEST));
+  scoped_ptr<ResourceThrottle> blocker_throttle(scheduler.ScheduleRequest(
+      kChildId, kRouteId, blocker_url_request.get()));
+  SimulatedRequest blocker(
+      blocker_throttle.Pass(), blocker_url_request.Pass(), kBlocker);
+  scoped_ptr<net::URLRequest> low_url_request(
+      NewURLRequest("http://host/low", net::LOWEST));
+  scoped_ptr<ResourceThrottle> low_throttle(
+      scheduler.ScheduleRequest(kChildId, kRouteId, low_url_request.get()));
+  SimulatedRequest low(low_throttle.Pass(), low_url_request.Pass(), kQueued);
+
+  ScopedVector<SimulatedRequest> requests;
+  std::vector<int> request_ids;
+  for (int i = 0; i < kNumRequests; ++i) {
+    std::string url = "http://host/" + base::IntToString(i);
+    scoped_ptr<net::URLRequest> url_request(NewURLRequest(url, net::IDLE));
+    request_ids.push_back(next_request_id_);
+    scoped_ptr<ResourceThrottle> throttle(
+        scheduler.ScheduleRequest(kChildId, kRouteId, url_request.get()));
+    requests.push_back(
+        new SimulatedRequest(throttle.Pass(), url_request.Pass(), kQueued));
+    ASSERT_FALSE(requests.back()->started());
+  }
+
+  scoped_refptr<FakeResourceMessageFilter> filter(
+      new FakeResourceMessageFilter(kChildId));
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kNumRequests; ++i) {
+    ResourceHostMsg_DidChangePriority msg(request_ids[i], net::IDLE, i + 1);
+    rdh_.OnMessageReceived(msg, filter.get());
+  }
+  base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+  perf_test::PrintResult("reprioritize",
+                         "",
+                         base::IntToString(kNumRequests) + "_pending",
+                         elapsed.InMicroseconds() /
+                             static_cast<double>(kNumRequests),
+                         "us",
+                         true);
+
+  requests.clear();
+  blocker.Finish();
+  low.Finish();
+  scheduler.OnClientDeleted(kChildId, kRouteId);
+}
+
+}  // namespace content
@@ -443,6 +443,117 @@ TEST_F(ResourceSchedulerTest, LimitedNumberOfDelayableRequestsInFlight) {
   EXPECT_FALSE(last_differenthost->started());
 }
 
+TEST_F(ResourceSchedulerTest, MaxRequestsInFlightForDelayable) {
+  // Should match the .cc.
+  const size_t kMinNumRequestsInFlightForDelayable = 2;
+  const size_t kMaxNumRequestsInFlightForDelayable = 16;
+
+  // Without an estimate, the network isn't assumed to be slow.
+  scheduler_.SetThroughputEstimateForTesting(-1.0);
+  EXPECT_EQ(kMaxNumRequestsInFlightForDelayable,
+            scheduler_.GetMaxRequestsInFlightForDelayable());
+
+  scheduler_.SetThroughputEstimateForTesting(0.0);
+  EXPECT_EQ(kMinNumRequestsInFlightForDelayable,
+            scheduler_.GetMaxRequestsInFlightForDelayable());
+
+  scheduler_.SetThroughputEstimateForTesting(1000.0);
+  EXPECT_LT(kMinNumRequestsInFlightForDelayable,
+            scheduler_.GetMaxRequestsInFlightForDelayable());
+  EXPECT_GT(kMaxNumRequestsInFlightForDelayable,
+            scheduler_.GetMaxRequestsInFlightForDelayable());
+
+  scheduler_.SetThroughputEstimateForTesting(100000.0);
+  EXPECT_EQ(kMaxNumRequestsInFlightForDelayable,
+            scheduler_.GetMaxRequestsInFlightForDelayable());
+}
+
+TEST_F(ResourceSchedulerTest, SlowNetworkHoldsBackDelayableRequests) {
+  scheduler_.SetThroughputEstimateForTesting(0.0);
+  scheduler_.OnWillInsertBody(kChildId, kRouteId);
+
+  // High priority requests count against the limit, but aren't held back by
+  // it.
+  scoped_ptr<TestRequest> high(NewRequest("http://host/high", net::HIGHEST));
+  scoped_ptr<TestRequest> high2(NewRequest("http://host/high2", net::HIGHEST));
+  EXPECT_TRUE(high->started());
+  EXPECT_TRUE(high2->started());
+
+  scoped_ptr<TestRequest> low(NewRequest("http://host1/low", net::LOWEST));
+  scoped_ptr<TestRequest> low2(NewRequest("http://host2/low", net::LOWEST));
+  EXPECT_FALSE(low->started());
+  EXPECT_FALSE(low2->started());
+
+  high.reset();
+  EXPECT_TRUE(low->started());
+  EXPECT_FALSE(low2->started());
+  high2.reset();
+  EXPECT_TRUE(low2->started());
+
+  scoped_ptr<TestRequest> low3(NewRequest("http://host3/low", net::LOWEST));
+  EXPECT_FALSE(low3->started());
+}
+
+TEST_F(ResourceSchedulerTest, FastNetworkKeepsDelayableLimit) {
+  scheduler_.SetThroughputEstimateForTesting(100000.0);
+  scheduler_.OnWillInsertBody(kChildId, kRouteId);
+
+  const int kMaxNumDelayableRequestsPerClient = 10;  // Should match the .cc.
+  ScopedVector<TestRequest> lows;
+  for (int i = 0; i < kMaxNumDelayableRequestsPerClient; ++i) {
+    string url = "http://host" + base::IntToString(i) + "/low";
+    lows.push_back(NewRequest(url.c_str(), net::LOWEST));
+    EXPECT_TRUE(lows[i]->started());
+  }
+
+  scoped_ptr<TestRequest> last(NewRequest("http://host_new/last",
+                                          net::LOWEST));
+  EXPECT_FALSE(last->started());
+}
+
+// Queued requests start in priority order, then in the order they were queued
+// or last reprioritized.
+TEST_F(ResourceSchedulerTest, PendingRequestsStartInPriorityOrder) {
+  // Only let one delayable request load at a time next to |high|.
+  scheduler_.SetThroughputEstimateForTesting(0.0);
+  scheduler_.OnWillInsertBody(kChildId, kRouteId);
+  scoped_ptr<TestRequest> high(NewRequest("http://host/high", net::HIGHEST));
+  scoped_ptr<TestRequest> low(NewRequest("http://host/low", net::LOWEST));
+  EXPECT_TRUE(low->started());
+
+  const int kNumRequests = 8;
+  ScopedVector<TestRequest> requests;
+  for (int i = 0; i < kNumRequests; ++i) {
+    string url = "http://host" + base::IntToString(i) + "/req";
+    requests.push_back(NewRequest(url.c_str(), net::IDLE));
+    EXPECT_FALSE(requests[i]->started());
+  }
+
+  ChangeRequestPriority(requests[5], net::LOWEST);
+  ChangeRequestPriority(requests[2], net::LOWEST);
+  ChangeRequestPriority(requests[7], net::LOWEST);
+  ChangeRequestPriority(requests[7], net::IDLE);
+  ChangeRequestPriority(requests[0], net::IDLE, 1);
+
+  const int kExpectedOrder[] = { 5, 2, 0, 1, 3, 4, 6, 7 };
+  TestRequest* in_flight = low.get();
+  for (size_t i = 0; i < arraysize(kExpectedOrder); ++i) {
+    TestRequest* next = requests[kExpectedOrder[i]];
+    EXPECT_FALSE(next->started()) << i;
+    in_flight->Cancel();
+    EXPECT_TRUE(next->started()) << i;
+    for (int j = 0; j < kNumRequests; ++j) {
+      if (!requests[j]->started())
+        continue;
+      bool expected_started = false;
+      for (size_t k = 0; k <= i; ++k)
+        expected_started |= kExpectedOrder[k] == j;
+      EXPECT_TRUE(expected_started) << i << " " << j;
+    }
+    in_flight = next;
+  }
+}
+
 TEST_F(ResourceSchedulerTest, RaisePriorityAndStart) {
   // Dummies to enforce scheduling.
   scoped_ptr<TestRequest> high(NewRequest("http://host/high", net::HIGHEST));
@@ -270,6 +270,7 @@ void IPCResourceLoaderBridge::SyncLoad(SyncLoadResponse* response) {
 
 ResourceDispatcher::ResourceDispatcher(IPC::Sender* sender)
     : message_sender_(sender),
+      shared_buffer_id_(0),
       weak_factory_(this),
       delegate_(NULL),
       io_timestamp_(base::TimeTicks()) {
@@ -390,6 +391,7 @@ void ResourceDispatcher::OnReceivedCachedMetadata(
 void ResourceDispatcher::OnSetDataBuffer(int request_id,
                                          base::SharedMemoryHandle shm_handle,
                                          int shm_size,
+                                         int buffer_id,
                                          base::ProcessId renderer_pid) {
   TRACE_EVENT0("loader", "ResourceDispatcher::OnSetDataBuffer");
   PendingRequestInfo* request_info = GetPendingRequestInfo(request_id);
@@ -399,6 +401,16 @@ void ResourceDispatcher::OnSetDataBuffer(int request_id,
   bool shm_valid = base::SharedMemory::IsHandleValid(shm_handle);
   CHECK((shm_valid && shm_size > 0) || (!shm_valid && !shm_size));
 
+  // The buffer is already mapped for an earlier request.
+  if (buffer_id && buffer_id == shared_buffer_id_) {
+    if (shm_valid)
+      base::SharedMemory::CloseHandle(shm_handle);
+    CHECK_GE(static_cast<int>(shared_buffer_->mapped_size()), shm_size);
+    request_info->buffer = shared_buffer_;
+    request_info->buffer_size = shm_size;
+    return;
+  }
+
   request_info->buffer.reset(
       new base::SharedMemory(shm_handle, true));  // read only
 
@@ -416,6 +428,11 @@ void ResourceDispatcher::OnSetDataBuffer(int request_id,
   }
 
   request_info->buffer_size = shm_size;
+
+  if (buffer_id) {
+    shared_buffer_ = request_info->buffer;
+    shared_buffer_id_ = buffer_id;
+  }
 }
 
 void ResourceDispatcher::OnReceivedData(int request_id,
@@ -599,6 +616,15 @@ bool ResourceDispatcher::RemovePendingRequest(int request_id) {
 
   bool release_downloaded_file = request_info.download_to_file;
 
+  // The host keeps the data of DataReceived messages in a buffer it shares
+  // between requests until they are acknowledged, so acknowledge the ones that
+  // will never be dispatched.
+  for (MessageQueue::const_iterator msg_it =
+           request_info.deferred_message_queue.begin();
+       msg_it != request_info.deferred_message_queue.end(); ++msg_it) {
+    if ((*msg_it)->type() == ResourceMsg_DataReceived::ID)
+      message_sender_->Send(new ResourceHostMsg_DataReceived_ACK(request_id));
+  }
   ReleaseResourcesInMessageQueue(&request_info.deferred_message_queue);
   pending_requests_.erase(it);
 
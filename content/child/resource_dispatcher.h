@@ -165,6 +165,7 @@ class CONTENT_EXPORT ResourceDispatcher : public IPC::Listener {
   void OnSetDataBuffer(int request_id,
                        base::SharedMemoryHandle shm_handle,
                        int shm_size,
+                       int buffer_id,
                        base::ProcessId renderer_pid);
   void OnReceivedData(int request_id,
                       int data_offset,
@@ -214,6 +215,11 @@ class CONTENT_EXPORT ResourceDispatcher : public IPC::Listener {
   // All pending requests issued to the host
   PendingRequestList pending_requests_;
 
+  // The most recently mapped buffer the host shares between requests, and the
+  // id the host gave it.  Requests that are sent the same id use this mapping.
+  linked_ptr<base::SharedMemory> shared_buffer_;
+  int shared_buffer_id_;
+
   base::WeakPtrFactory<ResourceDispatcher> weak_factory_;
 
   ResourceDispatcherDelegate* delegate_;
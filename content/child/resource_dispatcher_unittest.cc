@@ -284,7 +284,7 @@ class ResourceDispatcherTest : public testing::Test, public IPC::Sender {
         base::Process::Current().handle(), &duplicate_handle));
     EXPECT_TRUE(dispatcher_.OnMessageReceived(
         ResourceMsg_SetDataBuffer(request_id, duplicate_handle,
-                                  shared_memory->requested_size(), 0)));
+                                  shared_memory->requested_size(), 0, 0)));
   }
 
   void NotifyDataReceived(int request_id, std::string data) {
@@ -427,6 +427,56 @@ TEST_F(ResourceDispatcherTest, MultipleRequests) {
   EXPECT_EQ(0u, queued_messages());
 }
 
+// Tests that requests that are sent the same buffer id share one mapping.
+TEST_F(ResourceDispatcherTest, SharedDataBuffer) {
+  const char kTestPageContents2[] = "Not kTestPageContents";
+  const int kBufferId = 7;
+  const size_t kBufferSize = 1024;
+  const int kOffset2 = 512;
+
+  scoped_ptr<ResourceLoaderBridge> bridge1(CreateBridge());
+  TestRequestPeer peer1(bridge1.get());
+  scoped_ptr<ResourceLoaderBridge> bridge2(CreateBridge());
+  TestRequestPeer peer2(bridge2.get());
+
+  EXPECT_TRUE(bridge1->Start(&peer1));
+  int id1 = ConsumeRequestResource();
+  EXPECT_TRUE(bridge2->Start(&peer2));
+  int id2 = ConsumeRequestResource();
+  NotifyReceivedResponse(id1);
+  NotifyReceivedResponse(id2);
+
+  base::SharedMemory shared_memory;
+  ASSERT_TRUE(shared_memory.CreateAndMapAnonymous(kBufferSize));
+  char* memory = static_cast<char*>(shared_memory.memory());
+  memcpy(memory, kTestPageContents, strlen(kTestPageContents));
+  memcpy(memory + kOffset2, kTestPageContents2, strlen(kTestPageContents2));
+
+  int ids[] = { id1, id2 };
+  for (size_t i = 0; i < arraysize(ids); ++i) {
+    base::SharedMemoryHandle duplicate_handle;
+    EXPECT_TRUE(shared_memory.ShareToProcess(
+        base::Process::Current().handle(), &duplicate_handle));
+    EXPECT_TRUE(dispatcher_.OnMessageReceived(
+        ResourceMsg_SetDataBuffer(ids[i], duplicate_handle, kBufferSize,
+                                  kBufferId, 0)));
+  }
+
+  EXPECT_TRUE(dispatcher_.OnMessageReceived(ResourceMsg_DataReceived(
+      id2, kOffset2, strlen(kTestPageContents2),
+      strlen(kTestPageContents2))));
+  ConsumeDataReceived_ACK(id2);
+  EXPECT_TRUE(dispatcher_.OnMessageReceived(ResourceMsg_DataReceived(
+      id1, 0, strlen(kTestPageContents), strlen(kTestPageContents))));
+  ConsumeDataReceived_ACK(id1);
+
+  NotifyRequestComplete(id1, strlen(kTestPageContents));
+  EXPECT_EQ(kTestPageContents, peer1.data());
+  NotifyRequestComplete(id2, strlen(kTestPageContents2));
+  EXPECT_EQ(kTestPageContents2, peer2.data());
+  EXPECT_EQ(0u, queued_messages());
+}
+
 // Tests that the cancel method prevents other messages from being received.
 TEST_F(ResourceDispatcherTest, Cancel) {
   scoped_ptr<ResourceLoaderBridge> bridge(CreateBridge());
@@ -12,16 +12,40 @@
 #include "content/common/gpu/gpu_messages.h"
 #include "content/common/gpu/sync_point_manager.h"
 #include "content/common/message_router.h"
+#include "content/public/common/content_client.h"
+#include "gpu/command_buffer/common/constants.h"
 #include "gpu/command_buffer/service/feature_info.h"
 #include "gpu/command_buffer/service/gpu_switches.h"
 #include "gpu/command_buffer/service/mailbox_manager.h"
 #include "gpu/command_buffer/service/memory_program_cache.h"
+#include "gpu/command_buffer/service/shader_cache_store.h"
 #include "gpu/command_buffer/service/shader_translator_cache.h"
 #include "ui/gl/gl_bindings.h"
 #include "ui/gl/gl_share_group.h"
 
 namespace content {
 
+namespace {
+
+// Returns a store in |name| under the directory given on the command line, or
+// NULL if there is none.  Translations are keyed by the product version,
+// since ANGLE's output can change between builds.
+scoped_ptr<gpu::gles2::ShaderCacheStore> CreateShaderCacheStore(
+    const base::FilePath::CharType* name,
+    size_t max_size_bytes) {
+  const CommandLine* command_line = CommandLine::ForCurrentProcess();
+  const base::FilePath directory =
+      command_line->GetSwitchValuePath(switches::kGpuShaderCacheDir);
+  if (directory.empty())
+    return scoped_ptr<gpu::gles2::ShaderCacheStore>();
+  return make_scoped_ptr(new gpu::gles2::ShaderCacheStore(
+      directory.Append(name),
+      max_size_bytes,
+      GetContentClient()->GetProduct()));
+}
+
+}  // namespace
+
 GpuChannelManager::GpuMemoryBufferOperation::GpuMemoryBufferOperation(
     int32 sync_point,
     base::Closure callback)
@@ -65,7 +89,9 @@ gpu::gles2::ProgramCache* GpuChannelManager::program_cache() {
        gfx::g_driver_gl.ext.b_GL_OES_get_program_binary) &&
       !CommandLine::ForCurrentProcess()->HasSwitch(
           switches::kDisableGpuProgramCache)) {
-    program_cache_.reset(new gpu::gles2::MemoryProgramCache());
+    program_cache_.reset(new gpu::gles2::MemoryProgramCache(
+        CreateShaderCacheStore(FILE_PATH_LITERAL("Programs"),
+                               gpu::kDefaultMaxProgramCacheDiskBytes)));
   }
   return program_cache_.get();
 }
@@ -73,7 +99,10 @@ gpu::gles2::ProgramCache* GpuChannelManager::program_cache() {
 gpu::gles2::ShaderTranslatorCache*
 GpuChannelManager::shader_translator_cache() {
   if (!shader_translator_cache_.get())
-    shader_translator_cache_ = new gpu::gles2::ShaderTranslatorCache;
+    shader_translator_cache_ = new gpu::gles2::ShaderTranslatorCache(
+        CreateShaderCacheStore(
+            FILE_PATH_LITERAL("Translations"),
+            gpu::kDefaultMaxShaderTranslationCacheDiskBytes));
   return shader_translator_cache_.get();
 }
 
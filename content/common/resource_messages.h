@@ -279,16 +279,21 @@ IPC_MESSAGE_CONTROL3(ResourceMsg_ReceivedRedirect,
 // shared memory buffer.  The shared memory buffer should be retained by the
 // renderer until the resource request completes.
 //
+// The buffer is shared by all the requests of the renderer.  Requests that are
+// sent the same non-zero |buffer_id| may use the mapping made for an earlier
+// one, and close the handle they were sent.
+//
 // NOTE: The shared memory handle should already be mapped into the process
 // that receives this message.
 //
 // TODO(darin): The |renderer_pid| parameter is just a temporary parameter,
 // added to help in debugging crbug/160401.
 //
-IPC_MESSAGE_CONTROL4(ResourceMsg_SetDataBuffer,
+IPC_MESSAGE_CONTROL5(ResourceMsg_SetDataBuffer,
                      int /* request_id */,
                      base::SharedMemoryHandle /* shm_handle */,
                      int /* shm_size */,
+                     int /* buffer_id */,
                      base::ProcessId /* renderer_pid */)
 
 // Sent when some data from a resource request is ready.  The data offset and
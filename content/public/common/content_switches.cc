@@ -293,6 +293,11 @@ const char kEnableLayerSquashing[] =
 // Enable experimental container node culling.
 const char kEnableContainerCulling[]        = "enable-container-culling";
 
+// Size the number of concurrent resource loads from an estimate of the
+// network throughput, so that low priority loads hold back on slow networks.
+const char kEnableBandwidthAwareResourceScheduling[] =
+    "enable-bandwidth-aware-resource-scheduling";
+
 // Use a BeginFrame signal from browser to renderer to schedule rendering.
 const char kEnableBeginFrameScheduling[]    = "enable-begin-frame-scheduling";
 
@@ -4,8 +4,12 @@
 
 #include "courgette/third_party/bsdiff.h"
 
+#include "base/file_util.h"
+#include "base/files/file.h"
+#include "base/files/scoped_temp_dir.h"
 #include "courgette/base_test_unittest.h"
 #include "courgette/courgette.h"
+#include "courgette/crc.h"
 #include "courgette/streams.h"
 
 class BSDiffMemoryTest : public BaseTest {
@@ -36,6 +40,31 @@ void BSDiffMemoryTest::GenerateAndTestPatch(const std::string& old_text,
   EXPECT_EQ(courgette::OK, status);
   EXPECT_EQ(new_text.length(), new2.Length());
   EXPECT_EQ(0, memcmp(new_text.c_str(), new2.Buffer(), new_text.length()));
+
+  // Applying the patch by streaming to a file must give the same result.
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath new_path = temp_dir.path().AppendASCII("new");
+  courgette::SourceStream old3;
+  courgette::SourceStream patch3;
+  old3.Init(old_text.c_str(), old_text.length());
+  patch3.Init(patch1);
+  uint32 new_crc = 0;
+  {
+    base::File new_file(new_path,
+                        base::File::FLAG_CREATE_ALWAYS |
+                            base::File::FLAG_WRITE);
+    ASSERT_TRUE(new_file.IsValid());
+    status = ApplyBinaryPatchToFile(&old3, &patch3, &new_file, &new_crc);
+    EXPECT_EQ(courgette::OK, status);
+  }
+  std::string new3;
+  ASSERT_TRUE(base::ReadFileToString(new_path, &new3));
+  EXPECT_EQ(new_text, new3);
+  EXPECT_EQ(courgette::CalculateCrc(
+                reinterpret_cast<const uint8*>(new_text.c_str()),
+                new_text.length()),
+            new_crc);
 }
 
 std::string BSDiffMemoryTest::GenerateSyntheticInput(size_t length, int seed)
@@ -45,6 +45,7 @@
       'simple_delta.h',
       'streams.cc',
       'streams.h',
+      'suffix_array.h',
       'types_elf.h',
       'types_win_pe.h',
       'patch_generator_x86_32.h',
@@ -106,6 +107,7 @@
         'encode_decode_unittest.cc',
         'ensemble_unittest.cc',
         'streams_unittest.cc',
+        'suffix_array_unittest.cc',
         'typedrva_unittest.cc',
         'versioning_unittest.cc',
         'third_party/paged_array_unittest.cc'
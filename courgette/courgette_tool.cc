@@ -11,9 +11,13 @@
 #include "base/file_util.h"
 #include "base/files/file_path.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/process/process_handle.h"
+#include "base/process/process_metrics.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
 #include "courgette/courgette.h"
 #include "courgette/streams.h"
 #include "courgette/third_party/bsdiff.h"
@@ -28,6 +32,9 @@ void PrintHelp() {
     "  courgette -disadj <executable_file> <reference> <binary_assembly_file>\n"
     "  courgette -gen <v1> <v2> <patch>\n"
     "  courgette -apply <v1> <patch> <v2>\n"
+    "\n"
+    "Add -timing to report the wall time and peak memory of each operation.\n"
+    "-gen also logs the wall and CPU time of each stage of patch generation.\n"
     "\n");
 }
 
@@ -407,21 +414,31 @@ void GenerateBSDiffPatch(const base::FilePath& old_file,
 void ApplyBSDiffPatch(const base::FilePath& old_file,
                       const base::FilePath& patch_file,
                       const base::FilePath& new_file) {
-  std::string old_buffer = ReadOrFail(old_file, "'old' input");
-  std::string patch_buffer = ReadOrFail(patch_file, "'patch' input");
-
-  courgette::SourceStream old_stream;
-  courgette::SourceStream patch_stream;
-  old_stream.Init(old_buffer);
-  patch_stream.Init(patch_buffer);
-
-  courgette::SinkStream new_stream;
+  // Use the file based entry point, which memory maps the inputs and streams
+  // the output, so that -timing measures the same path as the installer.
   courgette::BSDiffStatus status =
-      courgette::ApplyBinaryPatch(&old_stream, &patch_stream, &new_stream);
+      courgette::ApplyBinaryPatch(old_file, patch_file, new_file);
 
   if (status != courgette::OK) Problem("-applybsdiff failed.");
+}
 
-  WriteSinkToFile(&new_stream, new_file);
+// Reports the time taken by one iteration of a command started at
+// |start_time|, and the peak memory used by the process so far.  Run one
+// command per process to get a meaningful peak for that command.
+void ReportTiming(const base::TimeTicks& start_time) {
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start_time;
+#if !defined(OS_MACOSX) || defined(OS_IOS)
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+#else
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle(), NULL));
+#endif
+  size_t peak_bytes = metrics->GetPeakWorkingSetSize();
+  fprintf(stderr, "Time: %.3fs  Peak working set: %.1fMB\n",
+          elapsed.InSecondsF(), peak_bytes / (1024.0 * 1024.0));
 }
 
 int main(int argc, const char* argv[]) {
@@ -445,6 +462,7 @@ int main(int argc, const char* argv[]) {
   bool cmd_apply_bsdiff_patch = command_line.HasSwitch("applybsdiff");
   bool cmd_spread_1_adjusted = command_line.HasSwitch("gen1a");
   bool cmd_spread_1_unadjusted = command_line.HasSwitch("gen1u");
+  bool report_timing = command_line.HasSwitch("timing");
 
   std::vector<base::FilePath> values;
   const CommandLine::StringVector& args = command_line.GetArgs();
@@ -470,6 +488,7 @@ int main(int argc, const char* argv[]) {
         " or -applybsdiff.");
 
   while (repeat_count-- > 0) {
+    base::TimeTicks start_time = base::TimeTicks::Now();
     if (cmd_sup) {
       if (values.size() != 1)
         UsageProblem("-supported <executable_file>");
@@ -510,6 +529,8 @@ int main(int argc, const char* argv[]) {
     } else {
       UsageProblem("No operation specified");
     }
+    if (report_timing)
+      ReportTiming(start_time);
   }
 
   return 0;
@@ -31,4 +31,31 @@ uint32 CalculateCrc(const uint8* buffer, size_t size) {
   return ~crc;
 }
 
+CrcAccumulator::CrcAccumulator() {
+#ifdef COURGETTE_USE_CRC_LIB
+  crc_ = crc32(0, NULL, 0);
+#else
+  CrcGenerateTable();
+  crc_ = CRC_INIT_VAL;
+#endif
+}
+
+void CrcAccumulator::Update(const uint8* buffer, size_t size) {
+#ifdef COURGETTE_USE_CRC_LIB
+  crc_ = crc32(crc_, buffer, size);
+#else
+  crc_ = CrcUpdate(crc_, buffer, size);
+#endif
+}
+
+uint32 CrcAccumulator::crc() const {
+#ifdef COURGETTE_USE_CRC_LIB
+  return ~crc_;
+#else
+  // CalculateCrc returns the complement of the finished CRC, which is the
+  // unfinished register value.
+  return crc_;
+#endif
+}
+
 }  // namespace
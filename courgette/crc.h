@@ -13,5 +13,20 @@ namespace courgette {
 //
 uint32 CalculateCrc(const uint8* buffer, size_t size);
 
+// Computes the same value as CalculateCrc for data that is supplied in
+// several pieces.
+class CrcAccumulator {
+ public:
+  CrcAccumulator();
+
+  void Update(const uint8* buffer, size_t size);
+
+  // Returns the CRC of all the data passed to Update so far.
+  uint32 crc() const;
+
+ private:
+  uint32 crc_;
+};
+
 }  // namespace courgette
 #endif  // COURGETTE_CRC_H_
@@ -8,7 +8,9 @@
 
 #include "courgette/difference_estimator.h"
 
-#include "base/containers/hash_tables.h"
+#include <algorithm>
+
+#include "base/logging.h"
 
 namespace courgette {
 
@@ -16,6 +18,13 @@ namespace courgette {
 // don't occur in Base.
 const int kTupleSize = 4;
 
+// Number of values kept in the bottom-k MinHash sketch of each region.
+const size_t kSketchSize = 256;
+
+// When a Subject has this many times fewer distinct tuples than the Base,
+// Measure looks each tuple up by binary search instead of merging.
+const size_t kBinarySearchRatio = 16;
+
 namespace {
 
 COMPILE_ASSERT(kTupleSize >= 4 && kTupleSize <= 8, kTupleSize_between_4_and_8);
@@ -27,12 +36,79 @@ size_t HashTuple(const uint8* source) {
   return hash;
 }
 
+// Scrambles a tuple hash so that the smallest values form an unbiased sample
+// of the tuples.  This is the 64 bit finalizer of MurmurHash3.
+uint64 MixHash(size_t hash) {
+  uint64 h = hash;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
 bool RegionsEqual(const Region& a, const Region& b) {
   if (a.length() != b.length())
     return false;
   return memcmp(a.start(), b.start(), a.length()) == 0;
 }
 
+// Fills |hashes| with the sorted hashes of all tuples in |region|, including
+// duplicates.
+void HashRegion(const Region& region, std::vector<size_t>* hashes) {
+  hashes->clear();
+  if (region.length() < static_cast<size_t>(kTupleSize))
+    return;
+  const uint8* start = region.start();
+  const uint8* end = region.end() - (kTupleSize - 1);
+  hashes->reserve(end - start);
+  for (const uint8* p = start;  p < end;  ++p)
+    hashes->push_back(HashTuple(p));
+  std::sort(hashes->begin(), hashes->end());
+}
+
+// Computes the bottom-k sketch of the distinct tuple hashes in |hashes|.
+void MakeSketch(const std::vector<size_t>& hashes,
+                std::vector<uint64>* sketch) {
+  sketch->clear();
+  sketch->reserve(hashes.size());
+  for (size_t i = 0;  i < hashes.size();  ++i)
+    sketch->push_back(MixHash(hashes[i]));
+  if (sketch->size() > kSketchSize) {
+    std::nth_element(sketch->begin(), sketch->begin() + kSketchSize,
+                     sketch->end());
+    sketch->resize(kSketchSize);
+  }
+  std::sort(sketch->begin(), sketch->end());
+  std::vector<uint64>(*sketch).swap(*sketch);
+}
+
+// Estimates the Jaccard similarity of two sets from their bottom-k sketches by
+// counting how many of the k smallest values of the union are in both sets.
+double EstimateJaccard(const std::vector<uint64>& a,
+                       const std::vector<uint64>& b) {
+  size_t i = 0;
+  size_t j = 0;
+  size_t union_count = 0;
+  size_t shared = 0;
+  while (union_count < kSketchSize && (i < a.size() || j < b.size())) {
+    if (j == b.size() || (i < a.size() && a[i] < b[j])) {
+      ++i;
+    } else if (i == a.size() || b[j] < a[i]) {
+      ++j;
+    } else {
+      ++shared;
+      ++i;
+      ++j;
+    }
+    ++union_count;
+  }
+  if (union_count == 0)
+    return 1.0;
+  return static_cast<double>(shared) / union_count;
+}
+
 }  // anonymous namepace
 
 class DifferenceEstimator::Base {
@@ -40,19 +116,18 @@ class DifferenceEstimator::Base {
   explicit Base(const Region& region) : region_(region) { }
 
   void Init() {
-    const uint8* start = region_.start();
-    const uint8* end = region_.end() - (kTupleSize - 1);
-    for (const uint8* p = start;  p < end;  ++p) {
-      size_t hash = HashTuple(p);
-      hashes_.insert(hash);
-    }
+    HashRegion(region_, &hashes_);
+    hashes_.erase(std::unique(hashes_.begin(), hashes_.end()), hashes_.end());
+    std::vector<size_t>(hashes_).swap(hashes_);
+    MakeSketch(hashes_, &sketch_);
   }
 
   const Region& region() const { return region_; }
 
  private:
   Region region_;
-  base::hash_set<size_t> hashes_;
+  std::vector<size_t> hashes_;  // Sorted distinct tuple hashes.
+  std::vector<uint64> sketch_;
 
   friend class DifferenceEstimator;
   DISALLOW_COPY_AND_ASSIGN(Base);
@@ -62,11 +137,29 @@ class DifferenceEstimator::Subject {
  public:
   explicit Subject(const Region& region) : region_(region) {}
 
+  void Init() {
+    std::vector<size_t> all_hashes;
+    HashRegion(region_, &all_hashes);
+    for (size_t i = 0;  i < all_hashes.size();  ) {
+      size_t j = i + 1;
+      while (j < all_hashes.size() && all_hashes[j] == all_hashes[i])
+        ++j;
+      hashes_.push_back(all_hashes[i]);
+      counts_.push_back(static_cast<uint32>(j - i));
+      i = j;
+    }
+    MakeSketch(hashes_, &sketch_);
+  }
+
   const Region& region() const { return region_; }
 
  private:
   Region region_;
+  std::vector<size_t> hashes_;  // Sorted distinct tuple hashes.
+  std::vector<uint32> counts_;  // Occurrences of each of |hashes_|.
+  std::vector<uint64> sketch_;
 
+  friend class DifferenceEstimator;
   DISALLOW_COPY_AND_ASSIGN(Subject);
 };
 
@@ -89,30 +182,53 @@ DifferenceEstimator::Base* DifferenceEstimator::MakeBase(const Region& region) {
 DifferenceEstimator::Subject* DifferenceEstimator::MakeSubject(
     const Region& region) {
   Subject* subject = new Subject(region);
+  subject->Init();
   owned_subjects_.push_back(subject);
   return subject;
 }
 
 size_t DifferenceEstimator::Measure(Base* base, Subject* subject) {
   size_t mismatches = 0;
-  const uint8* start = subject->region().start();
-  const uint8* end = subject->region().end() - (kTupleSize - 1);
-
-  const uint8* p = start;
-  while (p < end) {
-    size_t hash = HashTuple(p);
-    if (base->hashes_.find(hash) == base->hashes_.end()) {
-      ++mismatches;
+
+  const std::vector<size_t>& base_hashes = base->hashes_;
+  const std::vector<size_t>& subject_hashes = subject->hashes_;
+  const std::vector<uint32>& counts = subject->counts_;
+
+  if (subject_hashes.size() * kBinarySearchRatio < base_hashes.size()) {
+    for (size_t i = 0;  i < subject_hashes.size();  ++i) {
+      if (!std::binary_search(base_hashes.begin(), base_hashes.end(),
+                              subject_hashes[i])) {
+        mismatches += counts[i];
+      }
+    }
+  } else {
+    // Both hash lists are sorted, so walk them together.
+    size_t j = 0;
+    for (size_t i = 0;  i < subject_hashes.size();  ++i) {
+      while (j < base_hashes.size() && base_hashes[j] < subject_hashes[i])
+        ++j;
+      if (j == base_hashes.size() || base_hashes[j] != subject_hashes[i])
+        mismatches += counts[i];
     }
-    p += 1;
   }
 
   if (mismatches == 0) {
     if (RegionsEqual(base->region(), subject->region()))
       return 0;
   }
+
   ++mismatches;  // Guarantee not zero.
   return mismatches;
 }
 
+size_t DifferenceEstimator::EstimateDifference(Base* base, Subject* subject) {
+  double jaccard = EstimateJaccard(base->sketch_, subject->sketch_);
+  double base_size = static_cast<double>(base->hashes_.size());
+  double subject_size = static_cast<double>(subject->hashes_.size());
+  // |A n B| = J (|A| + |B|) / (1 + J)
+  double shared = jaccard * (base_size + subject_size) / (1.0 + jaccard);
+  double missing = std::max(0.0, subject_size - shared);
+  return static_cast<size_t>(missing + 0.5);
+}
+
 }  // namespace
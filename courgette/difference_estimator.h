@@ -26,7 +26,9 @@ namespace courgette {
 // The comparison is staged: first make Base and Subject objects for the regions
 // and then call 'Measure' to get the estimate.  The staging allows multiple
 // comparisons to be more efficient by precomputing information used in the
-// comparison.
+// comparison: both Base and Subject keep a sorted array of the hashes of their
+// tuples, so Measure is a linear merge, and a small MinHash sketch for
+// EstimateDifference.
 //
 class DifferenceEstimator {
  public:
@@ -47,6 +49,12 @@ class DifferenceEstimator {
   // are bytewise identical.
   size_t Measure(Base* base,  Subject* subject);
 
+  // Returns an approximation of the number of distinct tuples of |subject|
+  // that do not occur in |base|, computed in constant time from MinHash
+  // sketches of the regions.  This is useful for choosing which pairs are
+  // worth measuring when there are many candidates.
+  size_t EstimateDifference(Base* base, Subject* subject);
+
  private:
   std::vector<Base*> owned_bases_;
   std::vector<Subject*> owned_subjects_;
@@ -56,3 +56,31 @@ TEST(DifferenceEstimatorTest, TestDifferentSubstring) {
       difference_estimator.MakeSubject(Region(kString2, sizeof(kString2)-1));
   EXPECT_EQ(1U, difference_estimator.Measure(base, subject));
 }
+
+TEST(DifferenceEstimatorTest, TestEstimateDifference) {
+  std::string text1;
+  std::string text2;
+  std::string text3;
+  for (int i = 0;  i < 20000;  ++i) {
+    char c = static_cast<char>((i * 7919) >> 5);
+    text1.push_back(c);
+    text2.push_back(i % 100 == 0 ? 'x' : c);
+    text3.push_back(static_cast<char>((i * 104729) >> 3));
+  }
+
+  DifferenceEstimator difference_estimator;
+  DifferenceEstimator::Base* base =
+      difference_estimator.MakeBase(Region(text1.c_str(), text1.length()));
+  DifferenceEstimator::Subject* identical =
+      difference_estimator.MakeSubject(Region(text1.c_str(), text1.length()));
+  DifferenceEstimator::Subject* similar =
+      difference_estimator.MakeSubject(Region(text2.c_str(), text2.length()));
+  DifferenceEstimator::Subject* unrelated =
+      difference_estimator.MakeSubject(Region(text3.c_str(), text3.length()));
+
+  EXPECT_EQ(0U, difference_estimator.EstimateDifference(base, identical));
+  EXPECT_LT(difference_estimator.EstimateDifference(base, similar),
+            difference_estimator.EstimateDifference(base, unrelated));
+  EXPECT_LT(difference_estimator.Measure(base, similar),
+            difference_estimator.Measure(base, unrelated));
+}
@@ -135,6 +135,19 @@ struct CourgettePatchFile {
   static const uint32 kVersion = 20110216;
 };
 
+// The most elements GenerateEnsemblePatch() transforms at the same time.
+// While an element is transformed, the disassembled and encoded programs of
+// both its old and new versions are held in memory, which takes several times
+// the size of the element. Peak memory therefore grows with the number of
+// elements transformed at once.
+const int kMaxTransformThreads = 4;
+
+// Like GenerateEnsemblePatch() in courgette.h, but transforms at most
+// |max_transform_threads| elements at the same time. The patch is the same
+// whatever the number of threads.
+Status GenerateEnsemblePatch(SourceStream* old, SourceStream* target,
+                             SinkStream* patch, int max_transform_threads);
+
 // For any transform you would implement both a TransformationPatcher and a
 // TransformationPatchGenerator.
 //
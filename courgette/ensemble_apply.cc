@@ -8,6 +8,7 @@
 
 #include "base/basictypes.h"
 #include "base/file_util.h"
+#include "base/files/file.h"
 #include "base/files/memory_mapped_file.h"
 #include "base/logging.h"
 #include "courgette/crc.h"
@@ -53,6 +54,11 @@ class EnsemblePatchApplication {
                              SourceStream* correction,
                              SinkStream* corrected_ensemble);
 
+  // As SubpatchFinalOutput, but streams the corrected ensemble to a file.
+  Status SubpatchFinalOutputToFile(SourceStream* original,
+                                   SourceStream* correction,
+                                   base::File* corrected_ensemble);
+
  private:
   Status SubpatchStreamSets(SinkStreamSet* predicted_items,
                             SourceStream* correction,
@@ -279,6 +285,22 @@ Status EnsemblePatchApplication::SubpatchFinalOutput(
   return C_OK;
 }
 
+Status EnsemblePatchApplication::SubpatchFinalOutputToFile(
+    SourceStream* original,
+    SourceStream* correction,
+    base::File* corrected_ensemble) {
+  uint32 checksum = 0;
+  Status delta_status = ApplySimpleDeltaToFile(original, correction,
+                                               corrected_ensemble, &checksum);
+  if (delta_status != C_OK)
+    return delta_status;
+
+  if (checksum != target_checksum_)
+    return C_BAD_ENSEMBLE_CRC;
+
+  return C_OK;
+}
+
 Status EnsemblePatchApplication::SubpatchStreamSets(
     SinkStreamSet* predicted_items,
     SourceStream* correction,
@@ -304,9 +326,12 @@ Status EnsemblePatchApplication::SubpatchStreamSets(
   return C_OK;
 }
 
-Status ApplyEnsemblePatch(SourceStream* base,
-                          SourceStream* patch,
-                          SinkStream* output) {
+// Applies |patch| to |base|.  The patched ensemble is written to |output| if
+// it is not NULL, otherwise it is streamed to |output_file|.
+static Status ApplyEnsemblePatchInternal(SourceStream* base,
+                                         SourceStream* patch,
+                                         SinkStream* output,
+                                         base::File* output_file) {
   Status status;
   EnsemblePatchApplication patch_process;
 
@@ -370,14 +395,26 @@ Status ApplyEnsemblePatch(SourceStream* base,
 
   SourceStream final_patch_prediction;
   final_patch_prediction.Init(original_ensemble_and_corrected_base_elements);
-  status = patch_process.SubpatchFinalOutput(&final_patch_prediction,
-                                             ensemble_correction, output);
+  if (output) {
+    status = patch_process.SubpatchFinalOutput(&final_patch_prediction,
+                                               ensemble_correction, output);
+  } else {
+    status = patch_process.SubpatchFinalOutputToFile(&final_patch_prediction,
+                                                     ensemble_correction,
+                                                     output_file);
+  }
   if (status != C_OK)
     return status;
 
   return C_OK;
 }
 
+Status ApplyEnsemblePatch(SourceStream* base,
+                          SourceStream* patch,
+                          SinkStream* output) {
+  return ApplyEnsemblePatchInternal(base, patch, output, NULL);
+}
+
 Status ApplyEnsemblePatch(const base::FilePath::CharType* old_file_name,
                           const base::FilePath::CharType* patch_file_name,
                           const base::FilePath::CharType* new_file_name) {
@@ -402,28 +439,26 @@ Status ApplyEnsemblePatch(const base::FilePath::CharType* old_file_name,
   if (!old_file.Initialize(old_file_path))
     return C_READ_ERROR;
 
-  // Apply patch on streams.
+  // Apply patch on streams.  The final output is written to |new_file_name|
+  // in chunks as it is produced rather than being assembled in memory.
+  base::FilePath new_file_path(new_file_name);
+  base::File new_file(new_file_path,
+                      base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+  if (!new_file.IsValid())
+    return C_WRITE_OPEN_ERROR;
+
   SourceStream old_source_stream;
   SourceStream patch_source_stream;
   old_source_stream.Init(old_file.data(), old_file.length());
   patch_source_stream.Init(patch_file.data(), patch_file.length());
-  SinkStream new_sink_stream;
-  status = ApplyEnsemblePatch(&old_source_stream, &patch_source_stream,
-                              &new_sink_stream);
-  if (status != C_OK)
+  status = ApplyEnsemblePatchInternal(&old_source_stream, &patch_source_stream,
+                                      NULL, &new_file);
+  if (status != C_OK) {
+    // Don't leave partial output behind.
+    new_file.Close();
+    base::DeleteFile(new_file_path, false);
     return status;
-
-  // Write the patched data to |new_file_name|.
-  base::FilePath new_file_path(new_file_name);
-  int written =
-      base::WriteFile(
-          new_file_path,
-          reinterpret_cast<const char*>(new_sink_stream.Buffer()),
-          static_cast<int>(new_sink_stream.Length()));
-  if (written == -1)
-    return C_WRITE_OPEN_ERROR;
-  if (static_cast<size_t>(written) != new_sink_stream.Length())
-    return C_WRITE_ERROR;
+  }
 
   return C_OK;
 }
@@ -14,11 +14,17 @@
 
 #include "courgette/ensemble.h"
 
+#include <algorithm>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "base/basictypes.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/strings/stringprintf.h"
+#include "base/sys_info.h"
+#include "base/threading/simple_thread.h"
 #include "base/time/time.h"
 
 #include "courgette/crc.h"
@@ -33,6 +39,109 @@
 
 namespace courgette {
 
+namespace {
+
+// Measures the wall time of a stage of patch generation, and the CPU time
+// spent in it by the calling thread.  Work done on other threads is added
+// with AddCPUTime().
+class StageTimer {
+ public:
+  explicit StageTimer(const char* name)
+      : name_(name),
+        start_wall_(base::TimeTicks::Now()),
+        start_cpu_(ThreadCPUNow()) {
+  }
+
+  void AddCPUTime(base::TimeDelta cpu) { other_cpu_ += cpu; }
+
+  void Report() const {
+    base::TimeDelta cpu = ThreadCPUNow() - start_cpu_ + other_cpu_;
+    VLOG(1) << base::StringPrintf(
+        "stage %-24s wall %8.3fs  cpu %8.3fs", name_,
+        (base::TimeTicks::Now() - start_wall_).InSecondsF(),
+        cpu.InSecondsF());
+  }
+
+  // Returns the CPU time of the calling thread, or a null TimeTicks if the
+  // platform does not support measuring it.
+  static base::TimeTicks ThreadCPUNow() {
+    if (!base::TimeTicks::IsThreadNowSupported())
+      return base::TimeTicks();
+    return base::TimeTicks::ThreadNow();
+  }
+
+ private:
+  const char* name_;
+  base::TimeTicks start_wall_;
+  base::TimeTicks start_cpu_;
+  base::TimeDelta other_cpu_;
+
+  DISALLOW_COPY_AND_ASSIGN(StageTimer);
+};
+
+// Runs TransformationPatchGenerator::Transform for one element.  The
+// transformations of different elements are independent, so they can run
+// concurrently on a thread pool.  The results are kept in the task and
+// collected in the original element order to keep the patch deterministic.
+class ElementTransformTask : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit ElementTransformTask(TransformationPatchGenerator* generator)
+      : generator_(generator),
+        status_(C_GENERAL_ERROR) {
+  }
+
+  virtual void Run() OVERRIDE {
+    base::TimeTicks start_cpu = StageTimer::ThreadCPUNow();
+    status_ = generator_->Transform(&parameters_,
+                                    &predicted_transformed_element_,
+                                    &corrected_transformed_element_);
+    cpu_time_ = StageTimer::ThreadCPUNow() - start_cpu;
+  }
+
+  SourceStreamSet* parameters() { return &parameters_; }
+  SinkStreamSet* predicted_transformed_element() {
+    return &predicted_transformed_element_;
+  }
+  SinkStreamSet* corrected_transformed_element() {
+    return &corrected_transformed_element_;
+  }
+  Status status() const { return status_; }
+  base::TimeDelta cpu_time() const { return cpu_time_; }
+
+ private:
+  TransformationPatchGenerator* generator_;
+  SourceStreamSet parameters_;
+  SinkStreamSet predicted_transformed_element_;
+  SinkStreamSet corrected_transformed_element_;
+  Status status_;
+  base::TimeDelta cpu_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(ElementTransformTask);
+};
+
+// Runs all |tasks|, on a pool of at most |max_threads| worker threads if there
+// is more than one task and more than one processor.
+void RunElementTransformTasks(
+    const std::vector<ElementTransformTask*>& tasks,
+    int max_threads) {
+  int thread_count = std::min(base::SysInfo::NumberOfProcessors(),
+                              static_cast<int>(tasks.size()));
+  thread_count = std::min(thread_count, max_threads);
+  if (thread_count <= 1) {
+    for (size_t i = 0;  i < tasks.size();  ++i)
+      tasks[i]->Run();
+    return;
+  }
+
+  base::DelegateSimpleThreadPool pool("CourgetteTransform", thread_count);
+  for (size_t i = 0;  i < tasks.size();  ++i)
+    pool.AddWork(tasks[i]);
+  pool.Start();
+  pool.JoinAll();
+}
+
+}  // namespace
+
 TransformationPatchGenerator::TransformationPatchGenerator(
     Element* old_element,
     Element* new_element,
@@ -133,6 +242,10 @@ bool UnsafeDifference(Element* old_element, Element* new_element) {
   return true;
 }
 
+// Maximum number of old elements that are compared exactly against each new
+// element.
+const size_t kMaxMeasuredCandidates = 8;
+
 // FindGenerators finds TransformationPatchGenerators for the elements of
 // |new_ensemble|.  For each element of |new_ensemble| we find the closest
 // matching element from |old_ensemble| and use that as the basis for
@@ -169,19 +282,8 @@ Status FindGenerators(Ensemble* old_ensemble, Ensemble* new_ensemble,
     DifferenceEstimator::Subject* new_subject =
         difference_estimator.MakeSubject(new_element->region());
 
-    // Search through old elements to find the best match.
-    //
-    // TODO(sra): This is O(N x M), i.e. O(N^2) since old_ensemble and
-    // new_ensemble probably have a very similar structure.  We can make the
-    // search faster by making the comparison provided by DifferenceEstimator
-    // more nuanced, returning early if the measured difference is greater than
-    // the current best.  This will be most effective if we can arrange that the
-    // first elements we try to match are likely the 'right' ones.  We could
-    // prioritize elements that are of a similar size or similar position in the
-    // sequence of elements.
-    //
-    Element* best_old_element = NULL;
-    size_t best_difference = std::numeric_limits<size_t>::max();
+    // Collect the old elements that could be the basis for |new_element|.
+    std::vector<size_t> candidates;
     for (size_t old_index = 0;  old_index < old_elements.size();  ++old_index) {
       Element* old_element = old_elements[old_index];
       // Elements of different kinds are incompatible.
@@ -191,8 +293,40 @@ Status FindGenerators(Ensemble* old_ensemble, Ensemble* new_ensemble,
       if (UnsafeDifference(old_element, new_element))
         continue;
 
+      candidates.push_back(old_index);
+    }
+
+    // Measuring every pair is O(N x M), i.e. O(N^2) since old_ensemble and
+    // new_ensemble probably have a very similar structure.  When there are
+    // many candidates, rank them by the constant time sketch estimate and only
+    // measure the most promising ones.
+    if (candidates.size() > kMaxMeasuredCandidates) {
+      std::vector<std::pair<size_t, size_t> > ranked;
+      for (size_t i = 0;  i < candidates.size();  ++i) {
+        size_t old_index = candidates[i];
+        ranked.push_back(std::make_pair(
+            difference_estimator.EstimateDifference(bases[old_index],
+                                                    new_subject),
+            old_index));
+      }
+      std::partial_sort(ranked.begin(),
+                        ranked.begin() + kMaxMeasuredCandidates,
+                        ranked.end());
+      candidates.clear();
+      for (size_t i = 0;  i < kMaxMeasuredCandidates;  ++i)
+        candidates.push_back(ranked[i].second);
+      // Keep ties between equally good matches resolved in element order.
+      std::sort(candidates.begin(), candidates.end());
+    }
+
+    // Search through the candidates to find the best match.
+    Element* best_old_element = NULL;
+    size_t best_difference = std::numeric_limits<size_t>::max();
+    for (size_t i = 0;  i < candidates.size();  ++i) {
+      Element* old_element = old_elements[candidates[i]];
+
       base::Time start_compare = base::Time::Now();
-      DifferenceEstimator::Base* old_base = bases[old_index];
+      DifferenceEstimator::Base* old_base = bases[candidates[i]];
       size_t difference = difference_estimator.Measure(old_base, new_subject);
 
       VLOG(1) << "Compare " << old_element->Name()
@@ -243,6 +377,14 @@ void FreeGenerators(std::vector<TransformationPatchGenerator*>* generators) {
 Status GenerateEnsemblePatch(SourceStream* base,
                              SourceStream* update,
                              SinkStream* final_patch) {
+  return GenerateEnsemblePatch(base, update, final_patch,
+                               kMaxTransformThreads);
+}
+
+Status GenerateEnsemblePatch(SourceStream* base,
+                             SourceStream* update,
+                             SinkStream* final_patch,
+                             int max_transform_threads) {
   VLOG(1) << "start GenerateEnsemblePatch";
   base::Time start_time = base::Time::Now();
 
@@ -251,10 +393,12 @@ Status GenerateEnsemblePatch(SourceStream* base,
   Ensemble old_ensemble(old_region, "old");
   Ensemble new_ensemble(new_region, "new");
   std::vector<TransformationPatchGenerator*> generators;
+  StageTimer find_timer("find generators");
   Status generators_status = FindGenerators(&old_ensemble, &new_ensemble,
                                             &generators);
   if (generators_status != C_OK)
     return generators_status;
+  find_timer.Report();
 
   SinkStreamSet patch_streams;
 
@@ -283,6 +427,7 @@ Status GenerateEnsemblePatch(SourceStream* base,
   //
   // Generate sub-patch for parameters.
   //
+  StageTimer parameters_timer("parameters");
   SinkStreamSet predicted_parameters_sink;
   SinkStreamSet corrected_parameters_sink;
 
@@ -323,6 +468,7 @@ Status GenerateEnsemblePatch(SourceStream* base,
                                              parameter_correction);
   if (delta1_status != C_OK)
     return delta1_status;
+  parameters_timer.Report();
 
   //
   // Generate sub-patch for elements.
@@ -335,27 +481,33 @@ Status GenerateEnsemblePatch(SourceStream* base,
   SinkStreamSet predicted_transformed_elements;
   SinkStreamSet corrected_transformed_elements;
 
+  StageTimer transform_timer("transform elements");
+  ScopedVector<ElementTransformTask> transform_tasks;
   for (size_t i = 0;  i < number_of_transformations;  ++i) {
-    SourceStreamSet single_parameters;
-    if (!corrected_parameters_source_set.ReadSet(&single_parameters))
+    ElementTransformTask* task = new ElementTransformTask(generators[i]);
+    transform_tasks.push_back(task);
+    if (!corrected_parameters_source_set.ReadSet(task->parameters()))
       return C_STREAM_ERROR;
-    SinkStreamSet single_predicted_transformed_element;
-    SinkStreamSet single_corrected_transformed_element;
-    Status status = generators[i]->Transform(
-        &single_parameters,
-        &single_predicted_transformed_element,
-        &single_corrected_transformed_element);
-    if (status != C_OK)
-      return status;
-    if (!single_parameters.Empty())
+  }
+
+  RunElementTransformTasks(transform_tasks.get(), max_transform_threads);
+
+  for (size_t i = 0;  i < number_of_transformations;  ++i) {
+    ElementTransformTask* task = transform_tasks[i];
+    transform_timer.AddCPUTime(task->cpu_time());
+    if (task->status() != C_OK)
+      return task->status();
+    if (!task->parameters()->Empty())
       return C_STREAM_NOT_CONSUMED;
     if (!predicted_transformed_elements.WriteSet(
-            &single_predicted_transformed_element))
+            task->predicted_transformed_element()))
       return C_STREAM_ERROR;
     if (!corrected_transformed_elements.WriteSet(
-            &single_corrected_transformed_element))
+            task->corrected_transformed_element()))
       return C_STREAM_ERROR;
   }
+  transform_tasks.clear();
+  transform_timer.Report();
 
   if (!corrected_parameters_source_set.Empty())
     return C_STREAM_NOT_CONSUMED;
@@ -377,12 +529,14 @@ Status GenerateEnsemblePatch(SourceStream* base,
   corrected_transformed_elements_source
       .Init(linearized_corrected_transformed_elements);
 
+  StageTimer elements_delta_timer("transformed elements delta");
   Status delta2_status =
       GenerateSimpleDelta(&predicted_transformed_elements_source,
                           &corrected_transformed_elements_source,
                           transformed_elements_correction);
   if (delta2_status != C_OK)
     return delta2_status;
+  elements_delta_timer.Report();
 
   // Last use, free storage.
   linearized_predicted_transformed_elements.Retire();
@@ -390,6 +544,7 @@ Status GenerateEnsemblePatch(SourceStream* base,
   //
   // Generate sub-patch for whole enchilada.
   //
+  StageTimer reform_timer("reform");
   SinkStream predicted_ensemble;
 
   if (!predicted_ensemble.Write(base->Buffer(), base->Remaining()))
@@ -422,7 +577,9 @@ Status GenerateEnsemblePatch(SourceStream* base,
   linearized_corrected_transformed_elements.Retire();
 
   FreeGenerators(&generators);
+  reform_timer.Report();
 
+  StageTimer ensemble_delta_timer("ensemble delta");
   size_t final_patch_input_size = predicted_ensemble.Length();
   SourceStream predicted_ensemble_source;
   predicted_ensemble_source.Init(predicted_ensemble);
@@ -431,6 +588,7 @@ Status GenerateEnsemblePatch(SourceStream* base,
                                              ensemble_correction);
   if (delta3_status != C_OK)
     return delta3_status;
+  ensemble_delta_timer.Report();
 
   //
   // Final output stream has a header followed by a StreamSet.
@@ -4,6 +4,7 @@
 
 #include "courgette/base_test_unittest.h"
 #include "courgette/courgette.h"
+#include "courgette/ensemble.h"
 #include "courgette/streams.h"
 
 class EnsembleTest : public BaseTest {
@@ -103,6 +104,45 @@ void EnsembleTest::Pe64Ensemble() const {
   TestEnsemble(src_bytes, tgt_bytes);
 }
 
+// The elements of an ensemble are transformed in parallel. Check that the
+// patch is the same as when they are transformed one at a time.
+TEST_F(EnsembleTest, ParallelTransformMatchesSequential) {
+  std::string elf_1 = FileContents("elf-32-1");
+  std::string elf_2 = FileContents("elf-32-2");
+
+  std::string src_bytes = "aaabbbccc" + elf_1 + "dddeeefff" + elf_1;
+  std::string tgt_bytes = "aaagggccc" + elf_2 + "dddeeefff" + elf_1;
+
+  courgette::SinkStream patches[2];
+  for (int i = 0; i < 2; ++i) {
+    courgette::SourceStream source;
+    courgette::SourceStream target;
+    source.Init(src_bytes);
+    target.Init(tgt_bytes);
+    int max_transform_threads = i == 0 ? 1 : courgette::kMaxTransformThreads;
+    EXPECT_EQ(courgette::C_OK,
+              courgette::GenerateEnsemblePatch(&source, &target, &patches[i],
+                                               max_transform_threads));
+  }
+
+  ASSERT_EQ(patches[0].Length(), patches[1].Length());
+  EXPECT_FALSE(memcmp(patches[0].Buffer(), patches[1].Buffer(),
+                      patches[0].Length()));
+
+  // And that it applies.
+  courgette::SourceStream source;
+  source.Init(src_bytes);
+  courgette::SourceStream patch_source;
+  patch_source.Init(patches[1].Buffer(), patches[1].Length());
+  courgette::SinkStream patch_result;
+  EXPECT_EQ(courgette::C_OK,
+            courgette::ApplyEnsemblePatch(&source, &patch_source,
+                                          &patch_result));
+  EXPECT_EQ(tgt_bytes.length(), patch_result.Length());
+  EXPECT_FALSE(memcmp(tgt_bytes.data(), patch_result.Buffer(),
+                      tgt_bytes.length()));
+}
+
 // Ensemble tests still take too long on Windows so disabling for now
 // TODO(dgarrett) http://code.google.com/p/chromium/issues/detail?id=101614
 
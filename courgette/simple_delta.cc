@@ -20,6 +20,7 @@ Status BSDiffStatusToStatus(BSDiffStatus status) {
   switch (status) {
     case OK: return C_OK;
     case CRC_ERROR: return C_BINARY_DIFF_CRC_ERROR;
+    case WRITE_ERROR: return C_WRITE_ERROR;
     default: return C_GENERAL_ERROR;
   }
 }
@@ -31,6 +32,12 @@ Status ApplySimpleDelta(SourceStream* old, SourceStream* delta,
   return BSDiffStatusToStatus(ApplyBinaryPatch(old, delta, target));
 }
 
+Status ApplySimpleDeltaToFile(SourceStream* old, SourceStream* delta,
+                              base::File* target, uint32* target_crc) {
+  return BSDiffStatusToStatus(
+      ApplyBinaryPatchToFile(old, delta, target, target_crc));
+}
+
 Status GenerateSimpleDelta(SourceStream* old, SourceStream* target,
                            SinkStream* delta) {
   VLOG(1) << "GenerateSimpleDelta " << old->Remaining()
@@ -10,11 +10,20 @@
 #include "courgette/courgette.h"
 #include "courgette/streams.h"
 
+namespace base {
+class File;
+}
+
 namespace courgette {
 
 Status ApplySimpleDelta(SourceStream* old, SourceStream* delta,
                         SinkStream* target);
 
+// As ApplySimpleDelta, but streams the result to |target| instead of holding
+// it in memory.  |target_crc| receives the CRC of the written data.
+Status ApplySimpleDeltaToFile(SourceStream* old, SourceStream* delta,
+                              base::File* target, uint32* target_crc);
+
 Status GenerateSimpleDelta(SourceStream* old, SourceStream* target,
                            SinkStream* delta);
 
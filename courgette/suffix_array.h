@@ -0,0 +1,210 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Linear time suffix array construction using the SA-IS algorithm described in
+// "Two Efficient Algorithms for Linear Time Suffix Array Construction" by Ge
+// Nong, Sen Zhang and Wai Hong Chan.
+//
+// Unlike the Larsson-Sadakane qsufsort previously used by bsdiff, SA-IS needs
+// no inverse suffix array.  The only large working storage is the suffix array
+// itself (4 bytes per input byte) plus one bit per input byte for the suffix
+// types.  The reduced problem of the recursion is stored inside the suffix
+// array, so the array type only needs to support operator[].  This allows the
+// suffix array to live in a PagedArray.
+
+#ifndef COURGETTE_SUFFIX_ARRAY_H_
+#define COURGETTE_SUFFIX_ARRAY_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+
+namespace courgette {
+
+namespace suffix_array_internal {
+
+// Presents a byte string of |size| bytes as a string of |size| + 1 symbols
+// over the alphabet [0, 256], terminated by a unique smallest sentinel symbol.
+class SentinelByteString {
+ public:
+  SentinelByteString(const uint8* data, int size) : data_(data), size_(size) {}
+
+  int operator[](int i) const { return i < size_ ? data_[i] + 1 : 0; }
+
+ private:
+  const uint8* data_;
+  int size_;
+};
+
+// Presents a region of an int array starting at |offset| as a string.  The
+// reduced strings of the SA-IS recursion are stored in this way at the end of
+// the suffix array.
+template<typename Array>
+class ArraySuffix {
+ public:
+  ArraySuffix(Array* array, int offset) : array_(array), offset_(offset) {}
+
+  int operator[](int i) const { return (*array_)[offset_ + i]; }
+
+ private:
+  Array* array_;
+  int offset_;
+};
+
+// Computes the start (|end| is false) or one past the end (|end| is true) of
+// each bucket of symbols in |s|.
+template<typename String>
+void GetBuckets(const String& s, int n, int k, bool end,
+                std::vector<int>* buckets) {
+  buckets->assign(k + 1, 0);
+  for (int i = 0; i < n; ++i)
+    ++(*buckets)[s[i]];
+  int sum = 0;
+  for (int i = 0; i <= k; ++i) {
+    sum += (*buckets)[i];
+    (*buckets)[i] = end ? sum : sum - (*buckets)[i];
+  }
+}
+
+inline bool IsLMS(const std::vector<bool>& is_s_type, int i) {
+  return i > 0 && is_s_type[i] && !is_s_type[i - 1];
+}
+
+// Induces the order of L-type suffixes and then of S-type suffixes from the
+// sorted LMS suffixes placed at the ends of their buckets in |sa|.
+template<typename String, typename Array>
+void InduceSA(const String& s, const std::vector<bool>& is_s_type, int n, int k,
+              std::vector<int>* buckets, Array* sa) {
+  GetBuckets(s, n, k, false, buckets);
+  for (int i = 0; i < n; ++i) {
+    int j = (*sa)[i] - 1;
+    if (j >= 0 && !is_s_type[j])
+      (*sa)[(*buckets)[s[j]]++] = j;
+  }
+  GetBuckets(s, n, k, true, buckets);
+  for (int i = n - 1; i >= 0; --i) {
+    int j = (*sa)[i] - 1;
+    if (j >= 0 && is_s_type[j])
+      (*sa)[--(*buckets)[s[j]]] = j;
+  }
+}
+
+// Sorts the suffixes of |s|, a string of |n| symbols over the alphabet [0, k].
+// The last symbol of |s| must be a unique smallest sentinel.  Writes the
+// result to the first |n| elements of |sa|.
+template<typename String, typename Array>
+void SAIS(const String& s, int n, int k, Array* sa) {
+  if (n == 1) {
+    (*sa)[0] = 0;
+    return;
+  }
+
+  // Classify each suffix as S-type (smaller than the following suffix) or
+  // L-type (larger).  The sentinel is S-type by definition.
+  std::vector<bool> is_s_type(n);
+  is_s_type[n - 1] = true;
+  for (int i = n - 2; i >= 0; --i) {
+    is_s_type[i] = s[i] < s[i + 1] ||
+                   (s[i] == s[i + 1] && is_s_type[i + 1]);
+  }
+
+  // Stage 1: Sort the LMS substrings by placing the LMS positions at the ends
+  // of their buckets and inducing.
+  std::vector<int> buckets;
+  GetBuckets(s, n, k, true, &buckets);
+  for (int i = 0; i < n; ++i)
+    (*sa)[i] = -1;
+  for (int i = 1; i < n; ++i) {
+    if (IsLMS(is_s_type, i))
+      (*sa)[--buckets[s[i]]] = i;
+  }
+  InduceSA(s, is_s_type, n, k, &buckets, sa);
+
+  // Compact the sorted LMS substrings into the first |n1| elements.
+  int n1 = 0;
+  for (int i = 0; i < n; ++i) {
+    int pos = (*sa)[i];
+    if (IsLMS(is_s_type, pos))
+      (*sa)[n1++] = pos;
+  }
+
+  // Name the LMS substrings.  No two LMS positions are adjacent, so position
+  // |pos| can be stored at index n1 + pos / 2 without collisions.
+  for (int i = n1; i < n; ++i)
+    (*sa)[i] = -1;
+  int name = 0;
+  int prev = -1;
+  for (int i = 0; i < n1; ++i) {
+    int pos = (*sa)[i];
+    bool diff = false;
+    for (int d = 0; d < n; ++d) {
+      if (prev == -1 || s[pos + d] != s[prev + d] ||
+          is_s_type[pos + d] != is_s_type[prev + d]) {
+        diff = true;
+        break;
+      }
+      if (d > 0 && (IsLMS(is_s_type, pos + d) || IsLMS(is_s_type, prev + d)))
+        break;
+    }
+    if (diff) {
+      ++name;
+      prev = pos;
+    }
+    (*sa)[n1 + pos / 2] = name - 1;
+  }
+  for (int i = n - 1, j = n - 1; i >= n1; --i) {
+    if ((*sa)[i] >= 0)
+      (*sa)[j--] = (*sa)[i];
+  }
+
+  // Stage 2: Sort the reduced string, recursing if the names are not unique.
+  // The reduced string occupies the last |n1| elements of |sa| and its suffix
+  // array is built in the first |n1| elements.
+  const int reduced_offset = n - n1;
+  if (name < n1) {
+    SAIS(ArraySuffix<Array>(sa, reduced_offset), n1, name - 1, sa);
+  } else {
+    for (int i = 0; i < n1; ++i)
+      (*sa)[(*sa)[reduced_offset + i]] = i;
+  }
+
+  // Stage 3: Induce the full suffix array from the sorted LMS suffixes.  The
+  // reduced string is no longer needed, so its storage is reused to map
+  // reduced indexes back to positions in |s|.
+  for (int i = 1, j = 0; i < n; ++i) {
+    if (IsLMS(is_s_type, i))
+      (*sa)[reduced_offset + j++] = i;
+  }
+  for (int i = 0; i < n1; ++i)
+    (*sa)[i] = (*sa)[reduced_offset + (*sa)[i]];
+  for (int i = n1; i < n; ++i)
+    (*sa)[i] = -1;
+  GetBuckets(s, n, k, true, &buckets);
+  for (int i = n1 - 1; i >= 0; --i) {
+    int j = (*sa)[i];
+    (*sa)[i] = -1;
+    (*sa)[--buckets[s[j]]] = j;
+  }
+  InduceSA(s, is_s_type, n, k, &buckets, sa);
+}
+
+}  // namespace suffix_array_internal
+
+// Builds the suffix array of the |size| bytes at |data|, including the empty
+// suffix, into |sa|, which must have room for |size| + 1 elements.  On return
+// sa[0] is |size| (the empty suffix sorts first) and sa[1..size] are the
+// starting positions of the non-empty suffixes in lexicographic order.  This
+// is the layout bsdiff expects for its I[] array.
+template<typename Array>
+void BuildSuffixArray(const uint8* data, int size, Array* sa) {
+  DCHECK_GE(size, 0);
+  suffix_array_internal::SAIS(
+      suffix_array_internal::SentinelByteString(data, size), size + 1, 256,
+      sa);
+}
+
+}  // namespace courgette
+
+#endif  // COURGETTE_SUFFIX_ARRAY_H_
@@ -0,0 +1,91 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "courgette/suffix_array.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "courgette/third_party/paged_array.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Orders suffix start positions of |text_| by comparing the suffixes.
+class SuffixLess {
+ public:
+  explicit SuffixLess(const std::string& text) : text_(text) {}
+
+  bool operator()(int a, int b) const {
+    return text_.compare(a, std::string::npos,
+                         text_, b, std::string::npos) < 0;
+  }
+
+ private:
+  const std::string& text_;
+};
+
+void CheckSuffixArray(const std::string& text) {
+  const int size = static_cast<int>(text.length());
+  std::vector<int> expected(size + 1);
+  for (int i = 0; i <= size; ++i)
+    expected[i] = i;
+  std::sort(expected.begin(), expected.end(), SuffixLess(text));
+
+  courgette::PagedArray<int> sa;
+  ASSERT_TRUE(sa.Allocate(size + 1));
+  courgette::BuildSuffixArray(reinterpret_cast<const uint8*>(text.data()),
+                              size, &sa);
+  for (int i = 0; i <= size; ++i)
+    EXPECT_EQ(expected[i], sa[i]) << "text: '" << text << "' index " << i;
+
+  // The same result must be produced in a plain vector.
+  std::vector<int> flat(size + 1);
+  courgette::BuildSuffixArray(reinterpret_cast<const uint8*>(text.data()),
+                              size, &flat);
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), flat.begin()));
+}
+
+std::string GenerateSyntheticInput(size_t length, int alphabet, uint32 seed) {
+  std::string result;
+  while (result.length() < length) {
+    // Unsigned so that the arithmetic wraps around instead of overflowing.
+    seed = (seed + 17) * 1049 + (seed >> 27);
+    result.push_back(static_cast<char>((seed >> 8) % alphabet));
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(SuffixArrayTest, Empty) {
+  CheckSuffixArray(std::string());
+}
+
+TEST(SuffixArrayTest, SmallStrings) {
+  CheckSuffixArray("a");
+  CheckSuffixArray("aa");
+  CheckSuffixArray("ab");
+  CheckSuffixArray("ba");
+  CheckSuffixArray("banana");
+  CheckSuffixArray("mississippi");
+  CheckSuffixArray("abracadabra");
+  CheckSuffixArray(std::string("\0\0\xff\0\xff", 5));
+}
+
+TEST(SuffixArrayTest, Repetitive) {
+  CheckSuffixArray(std::string(1000, 'x'));
+  std::string periodic;
+  for (int i = 0; i < 300; ++i)
+    periodic.append("abcab");
+  CheckSuffixArray(periodic);
+}
+
+TEST(SuffixArrayTest, Synthetic) {
+  for (int alphabet = 2; alphabet <= 256; alphabet *= 4) {
+    for (int seed = 1; seed < 4; ++seed)
+      CheckSuffixArray(GenerateSyntheticInput(5000, alphabet, seed));
+  }
+}
@@ -32,6 +32,8 @@
  *                --Stephen Adams <sra@chromium.org>
  * 2013-04-10 - Added wrapper to apply a patch directly to files.
  *                --Joshua Pawlicki <waffles@chromium.org>
+ * 2014-10-20 - Added ApplyBinaryPatchToFile to stream the output to a file
+ *              in bounded chunks.
  */
 
 #ifndef COURGETTE_BSDIFF_H_
@@ -40,6 +42,10 @@
 #include "base/basictypes.h"
 #include "base/file_util.h"
 
+namespace base {
+class File;
+}
+
 namespace courgette {
 
 enum BSDiffStatus {
@@ -68,7 +74,17 @@ BSDiffStatus ApplyBinaryPatch(SourceStream* old_stream,
                               SourceStream* patch_stream,
                               SinkStream* new_stream);
 
-// As above, but simply takes the file paths.
+// As above, but writes the patched data to |new_file| in chunks instead of
+// assembling it in memory, so the memory used for the output is bounded by the
+// chunk size.  |new_crc| receives the CalculateCrc value of the written data.
+// On failure, |new_file| may contain partial output.
+BSDiffStatus ApplyBinaryPatchToFile(SourceStream* old_stream,
+                                    SourceStream* patch_stream,
+                                    base::File* new_file,
+                                    uint32* new_crc);
+
+// As above, but simply takes the file paths.  The old and patch files are
+// memory mapped and the output is streamed to |new_stream|.
 BSDiffStatus ApplyBinaryPatch(const base::FilePath& old_stream,
                               const base::FilePath& patch_stream,
                               const base::FilePath& new_stream);
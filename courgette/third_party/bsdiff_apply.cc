@@ -36,12 +36,79 @@
 
 #include "courgette/third_party/bsdiff.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "base/files/file.h"
 #include "base/files/memory_mapped_file.h"
 #include "courgette/crc.h"
 #include "courgette/streams.h"
 
 namespace courgette {
 
+namespace {
+
+// Size of the buffer used to stream patched data to a file.
+const size_t kOutputChunkSize = 1 << 20;  // 1MB
+
+// Collects patched bytes in a fixed size buffer and writes the buffer to a
+// file each time it fills up.  Has the same Write and Reserve interface as
+// SinkStream so that MBS_ApplyPatch can write to either.
+class ChunkedFileWriter {
+ public:
+  explicit ChunkedFileWriter(base::File* file)
+      : file_(file), used_(0), failed_(false) {
+    buffer_.resize(kOutputChunkSize);
+  }
+
+  bool Reserve(size_t length) { return true; }
+
+  bool Write(const void* data, size_t byte_count) {
+    const uint8* bytes = static_cast<const uint8*>(data);
+    while (byte_count > 0) {
+      if (used_ == buffer_.size() && !Flush())
+        return false;
+      size_t count = std::min(byte_count, buffer_.size() - used_);
+      memcpy(&buffer_[used_], bytes, count);
+      used_ += count;
+      bytes += count;
+      byte_count -= count;
+    }
+    return true;
+  }
+
+  // Writes any buffered bytes to the file.
+  bool Flush() {
+    if (failed_)
+      return false;
+    if (used_ == 0)
+      return true;
+    crc_.Update(&buffer_[0], used_);
+    int written = file_->WriteAtCurrentPos(
+        reinterpret_cast<const char*>(&buffer_[0]), static_cast<int>(used_));
+    if (written != static_cast<int>(used_)) {
+      failed_ = true;
+      return false;
+    }
+    used_ = 0;
+    return true;
+  }
+
+  bool failed() const { return failed_; }
+  uint32 crc() const { return crc_.crc(); }
+
+ private:
+  base::File* file_;
+  std::vector<uint8> buffer_;
+  size_t used_;
+  bool failed_;
+  CrcAccumulator crc_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChunkedFileWriter);
+};
+
+}  // namespace
+
 BSDiffStatus MBS_ReadHeader(SourceStream* stream, MBSPatchHeader* header) {
   if (!stream->Read(header->tag, sizeof(header->tag))) return READ_ERROR;
   if (!stream->ReadVarint32(&header->slen)) return READ_ERROR;
@@ -57,10 +124,12 @@ BSDiffStatus MBS_ReadHeader(SourceStream* stream, MBSPatchHeader* header) {
   return OK;
 }
 
+// |Output| is either a SinkStream or a ChunkedFileWriter.
+template<typename Output>
 BSDiffStatus MBS_ApplyPatch(const MBSPatchHeader *header,
                             SourceStream* patch_stream,
                             const uint8* old_start, size_t old_size,
-                            SinkStream* new_stream) {
+                            Output* new_stream) {
   const uint8* old_end = old_start + old_size;
 
   SourceStreamSet patch_streams;
@@ -151,9 +220,12 @@ BSDiffStatus MBS_ApplyPatch(const MBSPatchHeader *header,
   return OK;
 }
 
-BSDiffStatus ApplyBinaryPatch(SourceStream* old_stream,
-                              SourceStream* patch_stream,
-                              SinkStream* new_stream) {
+// Reads and validates the patch header against |old_stream|, then applies
+// the patch to |new_stream|.
+template<typename Output>
+BSDiffStatus ApplyBinaryPatchTo(SourceStream* old_stream,
+                                SourceStream* patch_stream,
+                                Output* new_stream) {
   MBSPatchHeader header;
   BSDiffStatus ret = MBS_ReadHeader(patch_stream, &header);
   if (ret != OK) return ret;
@@ -166,8 +238,27 @@ BSDiffStatus ApplyBinaryPatch(SourceStream* old_stream,
   if (CalculateCrc(old_start, old_size) != header.scrc32)
     return CRC_ERROR;
 
-  MBS_ApplyPatch(&header, patch_stream, old_start, old_size, new_stream);
+  return MBS_ApplyPatch(&header, patch_stream, old_start, old_size,
+                        new_stream);
+}
+
+BSDiffStatus ApplyBinaryPatch(SourceStream* old_stream,
+                              SourceStream* patch_stream,
+                              SinkStream* new_stream) {
+  return ApplyBinaryPatchTo(old_stream, patch_stream, new_stream);
+}
 
+BSDiffStatus ApplyBinaryPatchToFile(SourceStream* old_stream,
+                                    SourceStream* patch_stream,
+                                    base::File* new_file,
+                                    uint32* new_crc) {
+  ChunkedFileWriter writer(new_file);
+  BSDiffStatus status = ApplyBinaryPatchTo(old_stream, patch_stream, &writer);
+  if (writer.failed() || !writer.Flush())
+    return WRITE_ERROR;
+  if (status != OK)
+    return status;
+  *new_crc = writer.crc();
   return OK;
 }
 
@@ -190,23 +281,21 @@ BSDiffStatus ApplyBinaryPatch(const base::FilePath& old_file_path,
   SourceStream patch_file_stream;
   patch_file_stream.Init(patch_file.data(), patch_file.length());
 
-  // Set up the new stream and apply the patch.
-  SinkStream new_sink_stream;
-  BSDiffStatus status = ApplyBinaryPatch(&old_file_stream,
-                                         &patch_file_stream,
-                                         &new_sink_stream);
+  // Stream the patched data to the new file.
+  base::File new_file(new_file_path,
+                      base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+  if (!new_file.IsValid())
+    return WRITE_ERROR;
+  uint32 new_crc = 0;
+  BSDiffStatus status = ApplyBinaryPatchToFile(&old_file_stream,
+                                               &patch_file_stream,
+                                               &new_file, &new_crc);
   if (status != OK) {
-    return status;
+    // Don't leave partial output behind.
+    new_file.Close();
+    base::DeleteFile(new_file_path, false);
   }
-
-  // Write the stream to disk.
-  int written = base::WriteFile(
-      new_file_path,
-      reinterpret_cast<const char*>(new_sink_stream.Buffer()),
-      static_cast<int>(new_sink_stream.Length()));
-  if (written != static_cast<int>(new_sink_stream.Length()))
-    return WRITE_ERROR;
-  return OK;
+  return status;
 }
 
 }  // namespace
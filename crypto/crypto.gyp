@@ -224,6 +224,28 @@
         }],
       ],
     },
+    {
+      'target_name': 'crypto_perftests',
+      'type': '<(gtest_target_type)',
+      'sources': [
+        'sha2_perftest.cc',
+      ],
+      'dependencies': [
+        'crypto',
+        '../base/base.gyp:base',
+        '../base/base.gyp:test_support_base',
+        '../base/base.gyp:test_support_perf',
+        '../testing/gtest.gyp:gtest',
+        '../testing/perf/perf_test.gyp:perf_test',
+      ],
+      'conditions': [
+        ['OS == "android"', {
+          'dependencies': [
+            '../testing/android/native_test.gyp:native_test_native_code',
+          ],
+        }],
+      ],
+    },
   ],
   'conditions': [
     ['OS == "win" and target_arch=="ia32"', {
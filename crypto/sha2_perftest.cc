@@ -0,0 +1,89 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+#include "crypto/sha2.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace crypto {
+
+namespace {
+
+// Each measurement hashes this many bytes in total, split into messages of
+// the size being measured.
+const size_t kBytesPerRun = 64 * 1024 * 1024;
+
+const size_t kMessageSizes[] = { 32, 256, 4096, 64 * 1024, 1024 * 1024 };
+
+class HashPerfTest : public testing::Test {
+ protected:
+  // Fills |messages_| with messages of |size| bytes.
+  void MakeMessages(size_t size) {
+    messages_.assign(kBytesPerRun / size, std::string(size, 0));
+    for (size_t i = 0; i < messages_.size(); ++i) {
+      for (size_t j = 0; j < size; ++j)
+        messages_[i][j] = static_cast<char>(i + j);
+    }
+  }
+
+  void PrintResults(const std::string& name,
+                    size_t size,
+                    base::TimeDelta elapsed) {
+    double seconds = elapsed.InSecondsF();
+    std::string trace = name + "_" + base::Uint64ToString(size) + "B";
+    perf_test::PrintResult("throughput", "", trace,
+                           kBytesPerRun / seconds / (1024 * 1024), "MB/s",
+                           true);
+    perf_test::PrintResult("messages", "", trace,
+                           messages_.size() / seconds, "messages/s", true);
+  }
+
+  std::vector<std::string> messages_;
+};
+
+}  // namespace
+
+TEST_F(HashPerfTest, SHA256) {
+  for (size_t i = 0; i < arraysize(kMessageSizes); ++i) {
+    MakeMessages(kMessageSizes[i]);
+    std::string hash;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (size_t j = 0; j < messages_.size(); ++j)
+      hash = SHA256HashString(messages_[j]);
+    PrintResults("sha256", kMessageSizes[i], base::TimeTicks::Now() - start);
+  }
+}
+
+TEST_F(HashPerfTest, SHA256Batch) {
+  for (size_t i = 0; i < arraysize(kMessageSizes); ++i) {
+    MakeMessages(kMessageSizes[i]);
+    std::vector<base::StringPiece> inputs(messages_.begin(), messages_.end());
+    std::vector<std::string> hashes;
+    base::TimeTicks start = base::TimeTicks::Now();
+    SHA256HashStrings(inputs, &hashes);
+    PrintResults("sha256_batch", kMessageSizes[i],
+                 base::TimeTicks::Now() - start);
+  }
+}
+
+TEST_F(HashPerfTest, SHA1) {
+  for (size_t i = 0; i < arraysize(kMessageSizes); ++i) {
+    MakeMessages(kMessageSizes[i]);
+    std::string hash;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (size_t j = 0; j < messages_.size(); ++j)
+      hash = base::SHA1HashString(messages_[j]);
+    PrintResults("sha1", kMessageSizes[i], base::TimeTicks::Now() - start);
+  }
+}
+
+}  // namespace crypto
@@ -4,7 +4,11 @@
 
 #include "crypto/sha2.h"
 
+#include <string>
+#include <vector>
+
 #include "base/basictypes.h"
+#include "base/strings/string_piece.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 TEST(Sha256Test, Test1) {
@@ -98,3 +102,36 @@ TEST(Sha256Test, Test3) {
   for (size_t i = 0; i < sizeof(output_truncated3); i++)
     EXPECT_EQ(expected3[i], static_cast<int>(output_truncated3[i]));
 }
+
+TEST(Sha256Test, HashStrings) {
+  // Inputs of every length around the one and two block padding boundaries,
+  // plus some multi-block inputs, hashed as one batch so that messages of
+  // different lengths share the parallel lanes.
+  std::vector<std::string> inputs;
+  for (size_t size = 0; size <= 130; ++size) {
+    std::string input(size, 0);
+    for (size_t i = 0; i < size; ++i)
+      input[i] = static_cast<char>(size * 31 + i);
+    inputs.push_back(input);
+  }
+  inputs.push_back(std::string(1000, 'a'));
+  inputs.push_back(std::string(4096, 'b'));
+  inputs.push_back(std::string(100000, 'c'));
+
+  std::vector<base::StringPiece> pieces(inputs.begin(), inputs.end());
+  std::vector<std::string> outputs;
+  crypto::SHA256HashStrings(pieces, &outputs);
+  ASSERT_EQ(inputs.size(), outputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i)
+    EXPECT_EQ(crypto::SHA256HashString(inputs[i]), outputs[i]) << i;
+
+  // Batches smaller than the number of lanes.
+  for (size_t count = 0; count < 4; ++count) {
+    std::vector<base::StringPiece> few(pieces.begin() + 50,
+                                       pieces.begin() + 50 + count);
+    crypto::SHA256HashStrings(few, &outputs);
+    ASSERT_EQ(count, outputs.size());
+    for (size_t i = 0; i < count; ++i)
+      EXPECT_EQ(crypto::SHA256HashString(inputs[50 + i]), outputs[i]);
+  }
+}
@@ -4,23 +4,47 @@
 
 #include "extensions/browser/computed_hashes.h"
 
-#include "base/base64.h"
+#include <string.h>
+
+#include <algorithm>
+
 #include "base/file_util.h"
 #include "base/files/file_path.h"
-#include "base/json/json_reader.h"
-#include "base/json/json_writer.h"
-#include "base/stl_util.h"
-#include "base/values.h"
-#include "crypto/secure_hash.h"
+#include "base/logging.h"
 #include "crypto/sha2.h"
 
+// The file starts with a header, followed by a table with one entry per file,
+// sorted by path, followed by the paths and the block hashes they point to.
+// All integers are uint32s in native byte order, since the file is only ever
+// read on the machine that wrote it.
+//
+//   header: <magic> <version> <entry count>
+//   entry:  <path offset> <path length> <block size> <hash count>
+//           <hashes offset>
+//
+// Offsets are from the start of the file, paths are UTF-8 with forward
+// slashes, and each hash is crypto::kSHA256Length raw bytes.
+
 namespace {
-const char kBlockHashesKey[] = "block_hashes";
-const char kBlockSizeKey[] = "block_size";
-const char kFileHashesKey[] = "file_hashes";
-const char kPathKey[] = "path";
-const char kVersionKey[] = "version";
-const int kVersion = 2;
+const uint32 kMagic = 0x48534843;  // "CHSH"
+const uint32 kVersion = 3;
+const size_t kHeaderSize = 3 * sizeof(uint32);
+const size_t kEntrySize = 5 * sizeof(uint32);
+
+uint32 ReadUint32(const uint8* data) {
+  uint32 value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void AppendUint32(uint32 value, std::string* output) {
+  output->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Returns true if the |length| bytes at |offset| are within a file of |size|.
+bool InBounds(uint64 offset, uint64 length, size_t size) {
+  return offset <= size && length <= size - offset;
+}
 }  // namespace
 
 namespace extensions {
@@ -32,84 +56,87 @@ ComputedHashes::Reader::~Reader() {
 }
 
 bool ComputedHashes::Reader::InitFromFile(const base::FilePath& path) {
-  std::string contents;
-  if (!base::ReadFileToString(path, &contents))
-    return false;
-
-  base::DictionaryValue* top_dictionary = NULL;
-  scoped_ptr<base::Value> value(base::JSONReader::Read(contents));
-  if (!value.get() || !value->GetAsDictionary(&top_dictionary))
+  if (!file_.Initialize(path))
     return false;
+  const uint8* data = file_.data();
+  size_t size = file_.length();
 
   // For now we don't support forwards or backwards compatability in the
   // format, so we return false on version mismatch.
-  int version = 0;
-  if (!top_dictionary->GetInteger(kVersionKey, &version) || version != kVersion)
+  if (size < kHeaderSize || ReadUint32(data) != kMagic ||
+      ReadUint32(data + sizeof(uint32)) != kVersion)
     return false;
 
-  base::ListValue* all_hashes = NULL;
-  if (!top_dictionary->GetList(kFileHashesKey, &all_hashes))
+  uint32 count = ReadUint32(data + 2 * sizeof(uint32));
+  if (!InBounds(kHeaderSize, static_cast<uint64>(count) * kEntrySize, size))
     return false;
 
-  for (size_t i = 0; i < all_hashes->GetSize(); i++) {
-    base::DictionaryValue* dictionary = NULL;
-    if (!all_hashes->GetDictionary(i, &dictionary))
+  std::vector<Entry> entries(count);
+  for (uint32 i = 0; i < count; i++) {
+    const uint8* table_entry = data + kHeaderSize + i * kEntrySize;
+    uint32 path_offset = ReadUint32(table_entry);
+    uint32 path_length = ReadUint32(table_entry + sizeof(uint32));
+    uint32 block_size = ReadUint32(table_entry + 2 * sizeof(uint32));
+    uint32 hash_count = ReadUint32(table_entry + 3 * sizeof(uint32));
+    uint32 hashes_offset = ReadUint32(table_entry + 4 * sizeof(uint32));
+
+    if (!InBounds(path_offset, path_length, size) ||
+        !InBounds(hashes_offset,
+                  static_cast<uint64>(hash_count) * crypto::kSHA256Length,
+                  size))
       return false;
 
-    std::string relative_path_utf8;
-    if (!dictionary->GetString(kPathKey, &relative_path_utf8))
-      return false;
-
-    int block_size;
-    if (!dictionary->GetInteger(kBlockSizeKey, &block_size))
-      return false;
-    if (block_size <= 0 || ((block_size % 1024) != 0)) {
+    if (block_size == 0 || block_size > kint32max ||
+        (block_size % 1024) != 0) {
       LOG(ERROR) << "Invalid block size: " << block_size;
-      block_size = 0;
       return false;
     }
 
-    base::ListValue* hashes_list = NULL;
-    if (!dictionary->GetList(kBlockHashesKey, &hashes_list))
-      return false;
-
-    base::FilePath relative_path =
-        base::FilePath::FromUTF8Unsafe(relative_path_utf8);
-    relative_path = relative_path.NormalizePathSeparatorsTo('/');
-
-    data_[relative_path] = HashInfo(block_size, std::vector<std::string>());
-    std::vector<std::string>* hashes = &(data_[relative_path].second);
-
-    for (size_t j = 0; j < hashes_list->GetSize(); j++) {
-      std::string encoded;
-      if (!hashes_list->GetString(j, &encoded))
-        return false;
+    Entry& entry = entries[i];
+    entry.path = base::StringPiece(
+        reinterpret_cast<const char*>(data + path_offset), path_length);
+    entry.block_size = static_cast<int>(block_size);
+    entry.hash_count = hash_count;
+    entry.hashes = data + hashes_offset;
 
-      hashes->push_back(std::string());
-      std::string* decoded = &hashes->back();
-      if (!base::Base64Decode(encoded, decoded)) {
-        hashes->clear();
-        return false;
-      }
-    }
+    // GetHashes() relies on the entries being sorted.
+    if (i > 0 && !(entries[i - 1].path < entry.path))
+      return false;
   }
+
+  entries_.swap(entries);
   return true;
 }
 
 bool ComputedHashes::Reader::GetHashes(const base::FilePath& relative_path,
                                        int* block_size,
                                        std::vector<std::string>* hashes) {
-  base::FilePath path = relative_path.NormalizePathSeparatorsTo('/');
-  std::map<base::FilePath, HashInfo>::iterator i = data_.find(path);
-  if (i == data_.end())
+  std::string path =
+      relative_path.NormalizePathSeparatorsTo('/').AsUTF8Unsafe();
+  std::vector<Entry>::const_iterator i = std::lower_bound(
+      entries_.begin(), entries_.end(), base::StringPiece(path),
+      &EntryPathLess);
+  if (i == entries_.end() || i->path != path)
     return false;
-  HashInfo& info = i->second;
-  *block_size = info.first;
-  *hashes = info.second;
+
+  *block_size = i->block_size;
+  hashes->clear();
+  hashes->reserve(i->hash_count);
+  for (uint32 j = 0; j < i->hash_count; j++) {
+    hashes->push_back(std::string(
+        reinterpret_cast<const char*>(i->hashes + j * crypto::kSHA256Length),
+        crypto::kSHA256Length));
+  }
   return true;
 }
 
-ComputedHashes::Writer::Writer() : file_list_(new base::ListValue) {
+// static
+bool ComputedHashes::Reader::EntryPathLess(const Entry& entry,
+                                           const base::StringPiece& path) {
+  return entry.path < path;
+}
+
+ComputedHashes::Writer::Writer() {
 }
 
 ComputedHashes::Writer::~Writer() {
@@ -118,35 +145,45 @@ ComputedHashes::Writer::~Writer() {
 void ComputedHashes::Writer::AddHashes(const base::FilePath& relative_path,
                                        int block_size,
                                        const std::vector<std::string>& hashes) {
-  base::DictionaryValue* dict = new base::DictionaryValue();
-  base::ListValue* block_hashes = new base::ListValue();
-  file_list_->Append(dict);
-  dict->SetString(kPathKey,
-                  relative_path.NormalizePathSeparatorsTo('/').AsUTF8Unsafe());
-  dict->SetInteger(kBlockSizeKey, block_size);
-  dict->Set(kBlockHashesKey, block_hashes);
-
-  for (std::vector<std::string>::const_iterator i = hashes.begin();
-       i != hashes.end();
-       ++i) {
-    std::string encoded;
-    base::Base64Encode(*i, &encoded);
-    block_hashes->AppendString(encoded);
-  }
+  std::string path =
+      relative_path.NormalizePathSeparatorsTo('/').AsUTF8Unsafe();
+  DCHECK(data_.find(path) == data_.end());
+  data_[path] = HashInfo(block_size, hashes);
 }
 
 bool ComputedHashes::Writer::WriteToFile(const base::FilePath& path) {
-  std::string json;
-  base::DictionaryValue top_dictionary;
-  top_dictionary.SetInteger(kVersionKey, kVersion);
-  top_dictionary.Set(kFileHashesKey, file_list_.release());
+  std::string table;
+  std::string contents;
+  size_t data_offset = kHeaderSize + data_.size() * kEntrySize;
+  for (std::map<std::string, HashInfo>::const_iterator i = data_.begin();
+       i != data_.end();
+       ++i) {
+    const std::vector<std::string>& hashes = i->second.second;
+    AppendUint32(static_cast<uint32>(data_offset + contents.size()), &table);
+    AppendUint32(static_cast<uint32>(i->first.size()), &table);
+    contents.append(i->first);
+    AppendUint32(i->second.first, &table);
+    AppendUint32(static_cast<uint32>(hashes.size()), &table);
+    AppendUint32(static_cast<uint32>(data_offset + contents.size()), &table);
+    for (size_t j = 0; j < hashes.size(); j++) {
+      DCHECK_EQ(crypto::kSHA256Length, hashes[j].size());
+      contents.append(hashes[j]);
+    }
+  }
 
-  if (!base::JSONWriter::Write(&top_dictionary, &json))
-    return false;
-  int written = base::WriteFile(path, json.data(), json.size());
-  if (static_cast<unsigned>(written) != json.size()) {
+  std::string output;
+  output.reserve(data_offset + contents.size());
+  AppendUint32(kMagic, &output);
+  AppendUint32(kVersion, &output);
+  AppendUint32(static_cast<uint32>(data_.size()), &output);
+  output.append(table);
+  output.append(contents);
+
+  int written = base::WriteFile(path, output.data(), output.size());
+  if (static_cast<unsigned>(written) != output.size()) {
     LOG(ERROR) << "Error writing " << path.AsUTF8Unsafe()
-               << " ; write result:" << written << " expected:" << json.size();
+               << " ; write result:" << written
+               << " expected:" << output.size();
     return false;
   }
   return true;
@@ -155,21 +192,17 @@ bool ComputedHashes::Writer::WriteToFile(const base::FilePath& path) {
 void ComputedHashes::ComputeHashesForContent(const std::string& contents,
                                              size_t block_size,
                                              std::vector<std::string>* hashes) {
+  // Split |contents| into blocks and hash them together, which lets
+  // SHA256HashStrings() hash several blocks in parallel.  Even when the
+  // contents is empty, we want to output at least one hash block (the hash of
+  // the empty string).
+  std::vector<base::StringPiece> blocks;
   size_t offset = 0;
-  // Even when the contents is empty, we want to output at least one hash
-  // block (the hash of the empty string).
   do {
-    const char* block_start = contents.data() + offset;
     DCHECK(offset <= contents.size());
     size_t bytes_to_read = std::min(contents.size() - offset, block_size);
-    scoped_ptr<crypto::SecureHash> hash(
-        crypto::SecureHash::Create(crypto::SecureHash::SHA256));
-    hash->Update(block_start, bytes_to_read);
-
-    hashes->push_back(std::string());
-    std::string* buffer = &(hashes->back());
-    buffer->resize(crypto::kSHA256Length);
-    hash->Finish(string_as_array(buffer), buffer->size());
+    blocks.push_back(
+        base::StringPiece(contents.data() + offset, bytes_to_read));
 
     // If |contents| is empty, then we want to just exit here.
     if (bytes_to_read == 0)
@@ -177,6 +210,10 @@ void ComputedHashes::ComputeHashesForContent(const std::string& contents,
 
     offset += bytes_to_read;
   } while (offset < contents.size());
+
+  std::vector<std::string> block_hashes;
+  crypto::SHA256HashStrings(blocks, &block_hashes);
+  hashes->insert(hashes->end(), block_hashes.begin(), block_hashes.end());
 }
 
 }  // namespace extensions
@@ -7,13 +7,15 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include "base/memory/scoped_ptr.h"
+#include "base/basictypes.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/strings/string_piece.h"
 
 namespace base {
 class FilePath;
-class ListValue;
 }
 
 namespace extensions {
@@ -26,6 +28,10 @@ class ComputedHashes {
    public:
     Reader();
     ~Reader();
+
+    // Maps the file at |path| into memory and checks that it is well formed.
+    // The hashes themselves are only copied out by GetHashes(), so this is
+    // cheap even for extensions with many files.
     bool InitFromFile(const base::FilePath& path);
 
     // The block size and hashes for |relative_path| will be copied into the
@@ -35,10 +41,21 @@ class ComputedHashes {
                    std::vector<std::string>* hashes);
 
    private:
-    typedef std::pair<int, std::vector<std::string> > HashInfo;
+    // Points into |file_|.
+    struct Entry {
+      base::StringPiece path;
+      int block_size;
+      uint32 hash_count;
+      const uint8* hashes;
+    };
+
+    static bool EntryPathLess(const Entry& entry,
+                              const base::StringPiece& path);
 
-    // This maps a relative path to a pair of (block size, hashes)
-    std::map<base::FilePath, HashInfo> data_;
+    base::MemoryMappedFile file_;
+
+    // Sorted by path.
+    std::vector<Entry> entries_;
   };
 
   class Writer {
@@ -55,9 +72,12 @@ class ComputedHashes {
     bool WriteToFile(const base::FilePath& path);
 
    private:
-    // Each element of this list contains the path and block hashes for one
-    // file.
-    scoped_ptr<base::ListValue> file_list_;
+    typedef std::pair<int, std::vector<std::string> > HashInfo;
+
+    // This maps a relative path, with forward slashes and encoded as UTF-8,
+    // to a pair of (block size, hashes). Keeping it sorted lets the reader
+    // do a binary search.
+    std::map<std::string, HashInfo> data_;
   };
 
   // Computes the SHA256 hash of each |block_size| chunk in |contents|, placing
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include "base/base64.h"
+#include "base/file_util.h"
 #include "base/files/file_path.h"
 #include "base/files/scoped_temp_dir.h"
 #include "crypto/sha2.h"
@@ -26,7 +27,7 @@ TEST(ComputedHashes, ComputedHashes) {
   base::ScopedTempDir scoped_dir;
   ASSERT_TRUE(scoped_dir.CreateUniqueTempDir());
   base::FilePath computed_hashes =
-      scoped_dir.path().AppendASCII("computed_hashes.json");
+      scoped_dir.path().AppendASCII("computed_hashes.bin");
 
   // We'll add hashes for 2 files, one of which uses a subdirectory
   // path. The first file will have a list of 1 block hash, and the
@@ -69,6 +70,45 @@ TEST(ComputedHashes, ComputedHashes) {
   block_size = 0;
   EXPECT_TRUE(reader.GetHashes(path2_fwd_slashes, &block_size, &read_hashes2));
   EXPECT_EQ(hashes2, read_hashes2);
+
+  // Paths that weren't written aren't found.
+  EXPECT_FALSE(reader.GetHashes(base::FilePath(FILE_PATH_LITERAL("bar.txt")),
+                                &block_size, &read_hashes2));
+  EXPECT_FALSE(reader.GetHashes(base::FilePath(FILE_PATH_LITERAL("foo")),
+                                &block_size, &read_hashes2));
+}
+
+TEST(ComputedHashes, InvalidFile) {
+  base::ScopedTempDir scoped_dir;
+  ASSERT_TRUE(scoped_dir.CreateUniqueTempDir());
+  base::FilePath computed_hashes =
+      scoped_dir.path().AppendASCII("computed_hashes.bin");
+
+  std::vector<std::string> hashes;
+  hashes.push_back(crypto::SHA256HashString("first"));
+  hashes.push_back(crypto::SHA256HashString("second"));
+  ComputedHashes::Writer writer;
+  writer.AddHashes(base::FilePath(FILE_PATH_LITERAL("foo.txt")), 4096, hashes);
+  ASSERT_TRUE(writer.WriteToFile(computed_hashes));
+
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(computed_hashes, &contents));
+
+  // Cutting off the last hash leaves the table pointing past the end of the
+  // file.
+  std::string truncated = contents.substr(0, contents.size() - 1);
+  ASSERT_EQ(static_cast<int>(truncated.size()),
+            base::WriteFile(computed_hashes, truncated.data(),
+                            truncated.size()));
+  ComputedHashes::Reader truncated_reader;
+  EXPECT_FALSE(truncated_reader.InitFromFile(computed_hashes));
+
+  // The old JSON format isn't understood.
+  const char kJson[] = "{\"file_hashes\":[],\"version\":2}";
+  ASSERT_EQ(static_cast<int>(arraysize(kJson) - 1),
+            base::WriteFile(computed_hashes, kJson, arraysize(kJson) - 1));
+  ComputedHashes::Reader json_reader;
+  EXPECT_FALSE(json_reader.InitFromFile(computed_hashes));
 }
 
 // Note: the expected hashes used in this test were generated using linux
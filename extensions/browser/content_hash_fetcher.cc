@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "base/barrier_closure.h"
 #include "base/base64.h"
 #include "base/file_util.h"
 #include "base/files/file_enumerator.h"
@@ -14,7 +15,8 @@
 #include "base/metrics/histogram.h"
 #include "base/synchronization/lock.h"
 #include "base/task_runner_util.h"
-#include "base/timer/elapsed_timer.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "base/time/time.h"
 #include "base/version.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/browser_thread.h"
@@ -35,13 +37,28 @@ namespace {
 
 typedef std::set<base::FilePath> SortedFilePathSet;
 
+// The number of blocking pool tasks that hash the files of one extension.
+const size_t kMaxHashingTasks = 4;
+
+// The JSON file that computed hashes were kept in before
+// computed_hashes.bin. It is deleted when the new file is written.
+const base::FilePath::CharType kOldComputedHashesFilename[] =
+    FILE_PATH_LITERAL("computed_hashes.json");
+
+// Posts |task| to the blocking pool sequence that content hash fetcher jobs
+// do their disk I/O on.
+void PostSequencedTask(const base::Closure& task) {
+  content::BrowserThread::PostBlockingPoolSequencedTask(
+      "ContentHashFetcher", FROM_HERE, task);
+}
+
 }  // namespace
 
 namespace extensions {
 
 // This class takes care of doing the disk and network I/O work to ensure we
 // have both verified_contents.json files from the webstore and
-// computed_hashes.json files computed over the files in an extension's
+// computed_hashes.bin files computed over the files in an extension's
 // directory.
 class ContentHashFetcherJob
     : public base::RefCountedThreadSafe<ContentHashFetcherJob>,
@@ -84,6 +101,18 @@ class ContentHashFetcherJob
   friend class base::RefCountedThreadSafe<ContentHashFetcherJob>;
   virtual ~ContentHashFetcherJob();
 
+  // The block hashes of one file, and the tree hash root they should have.
+  struct FileHashes {
+    FileHashes() : read_failed(false) {}
+
+    base::FilePath full_path;
+    base::FilePath relative_path;
+    std::string expected_root;
+    std::vector<std::string> hashes;
+    std::string root;
+    bool read_failed;
+  };
+
   // Tries to load a verified_contents.json file at |path|. On successfully
   // reading and validing the file, the verified_contents_ member variable will
   // be set and this function will return true. If the file does not exist, or
@@ -114,10 +143,22 @@ class ContentHashFetcherJob
   // webstore).
   void MaybeCreateHashes();
 
-  // Computes hashes for all files in |extension_path_|, and uses a
-  // ComputedHashes::Writer to write that information into
-  // |hashes_file|. Returns true on success.
-  bool CreateHashes(const base::FilePath& hashes_file);
+  // Starts computing hashes for all files in |extension_path_|. The files are
+  // hashed in parallel on the blocking pool, after which
+  // FinishCreatingHashes() writes the hashes into |hashes_file|. Returns
+  // false if the hashes can't be computed.
+  bool StartCreatingHashes(const base::FilePath& hashes_file);
+
+  // Computes the hashes of every |stride|th file of |file_hashes_|, starting
+  // with |first|, and then runs |done|. Runs on any thread of the blocking
+  // pool.
+  void ComputeFileHashes(size_t first, size_t stride,
+                         const base::Closure& done);
+
+  // Called when all the files have been hashed. Uses a ComputedHashes::Writer
+  // to write the hashes of all the files that match their expected tree hash
+  // root into |hashes_file_|, and then calls the callback.
+  void FinishCreatingHashes();
 
   // Will call the callback, if we haven't been cancelled.
   void DispatchCallback();
@@ -153,6 +194,13 @@ class ContentHashFetcherJob
   // The block size to use for hashing.
   int block_size_;
 
+  // The files being hashed by StartCreatingHashes(), in sorted order. Each
+  // one is only touched by the ComputeFileHashes() task it was given to until
+  // all of them are done.
+  std::vector<FileHashes> file_hashes_;
+  base::FilePath hashes_file_;
+  base::TimeTicks hashing_start_time_;
+
   // Note: this may be accessed from multiple threads, so all access should
   // be protected by |cancelled_lock_|.
   bool cancelled_;
@@ -310,9 +358,7 @@ void ContentHashFetcherJob::DoneFetchingVerifiedContents(bool success) {
     return;
   }
 
-  content::BrowserThread::PostBlockingPoolSequencedTask(
-      "ContentHashFetcher",
-      FROM_HERE,
+  PostSequencedTask(
       base::Bind(&ContentHashFetcherJob::MaybeCreateHashes, this));
 }
 
@@ -327,7 +373,10 @@ void ContentHashFetcherJob::MaybeCreateHashes() {
   } else {
     if (force_)
       base::DeleteFile(hashes_file, false /* recursive */);
-    success_ = CreateHashes(hashes_file);
+    // FinishCreatingHashes() calls the callback once the files are hashed.
+    if (StartCreatingHashes(hashes_file))
+      return;
+    success_ = false;
   }
 
   content::BrowserThread::PostTask(
@@ -336,8 +385,9 @@ void ContentHashFetcherJob::MaybeCreateHashes() {
       base::Bind(&ContentHashFetcherJob::DispatchCallback, this));
 }
 
-bool ContentHashFetcherJob::CreateHashes(const base::FilePath& hashes_file) {
-  base::ElapsedTimer timer;
+bool ContentHashFetcherJob::StartCreatingHashes(
+    const base::FilePath& hashes_file) {
+  hashing_start_time_ = base::TimeTicks::Now();
   if (IsCancelled())
     return false;
   // Make sure the directory exists.
@@ -348,9 +398,10 @@ bool ContentHashFetcherJob::CreateHashes(const base::FilePath& hashes_file) {
     base::FilePath verified_contents_path =
         file_util::GetVerifiedContentsPath(extension_path_);
     verified_contents_.reset(new VerifiedContents(key_.data, key_.size));
-    if (!verified_contents_->InitFrom(verified_contents_path, false))
+    if (!verified_contents_->InitFrom(verified_contents_path, false)) {
+      verified_contents_.reset();
       return false;
-    verified_contents_.reset();
+    }
   }
 
   base::FileEnumerator enumerator(extension_path_,
@@ -368,12 +419,9 @@ bool ContentHashFetcherJob::CreateHashes(const base::FilePath& hashes_file) {
     paths.insert(full_path);
   }
 
-  // Now iterate over all the paths in sorted order and compute the block hashes
-  // for each one.
-  ComputedHashes::Writer writer;
+  // Now collect the paths that have a known tree hash root, in sorted order.
+  file_hashes_.clear();
   for (SortedFilePathSet::iterator i = paths.begin(); i != paths.end(); ++i) {
-    if (IsCancelled())
-      return false;
     const base::FilePath& full_path = *i;
     base::FilePath relative_path;
     extension_path_.AppendRelativePath(full_path, &relative_path);
@@ -384,30 +432,92 @@ bool ContentHashFetcherJob::CreateHashes(const base::FilePath& hashes_file) {
     if (!expected_root)
       continue;
 
+    file_hashes_.push_back(FileHashes());
+    FileHashes& file = file_hashes_.back();
+    file.full_path = full_path;
+    file.relative_path = relative_path;
+    file.expected_root = *expected_root;
+  }
+  hashes_file_ = hashes_file;
+
+  // Hash the files in parallel, in a few tasks so that an extension with many
+  // files doesn't flood the blocking pool. The last task to finish posts
+  // FinishCreatingHashes() back to our sequence. Skipping the hashing on
+  // shutdown means the hashes file is never written, so it will be created
+  // again the next time.
+  const size_t num_tasks = std::min(kMaxHashingTasks, file_hashes_.size());
+  base::Closure done = base::BarrierClosure(
+      num_tasks,
+      base::Bind(&PostSequencedTask,
+                 base::Bind(&ContentHashFetcherJob::FinishCreatingHashes,
+                            this)));
+  base::SequencedWorkerPool* pool = content::BrowserThread::GetBlockingPool();
+  for (size_t i = 0; i < num_tasks; ++i) {
+    pool->PostWorkerTaskWithShutdownBehavior(
+        FROM_HERE,
+        base::Bind(&ContentHashFetcherJob::ComputeFileHashes,
+                   this, i, num_tasks, done),
+        base::SequencedWorkerPool::SKIP_ON_SHUTDOWN);
+  }
+  return true;
+}
+
+void ContentHashFetcherJob::ComputeFileHashes(size_t first,
+                                              size_t stride,
+                                              const base::Closure& done) {
+  for (size_t i = first; i < file_hashes_.size(); i += stride) {
+    if (IsCancelled())
+      break;
+    FileHashes& file = file_hashes_[i];
     std::string contents;
-    if (!base::ReadFileToString(full_path, &contents)) {
-      LOG(ERROR) << "Could not read " << full_path.MaybeAsASCII();
-      continue;
+    if (base::ReadFileToString(file.full_path, &contents)) {
+      // Iterate through taking the hash of each block of size (block_size_)
+      // of the file.
+      ComputedHashes::ComputeHashesForContent(
+          contents, block_size_, &file.hashes);
+      file.root = ComputeTreeHashRoot(file.hashes,
+                                      block_size_ / crypto::kSHA256Length);
+    } else {
+      LOG(ERROR) << "Could not read " << file.full_path.MaybeAsASCII();
+      file.read_failed = true;
     }
+  }
+  done.Run();
+}
 
-    // Iterate through taking the hash of each block of size (block_size_) of
-    // the file.
-    std::vector<std::string> hashes;
-    ComputedHashes::ComputeHashesForContent(contents, block_size_, &hashes);
-    std::string root =
-        ComputeTreeHashRoot(hashes, block_size_ / crypto::kSHA256Length);
-    if (expected_root && *expected_root != root) {
-      VLOG(1) << "content mismatch for " << relative_path.AsUTF8Unsafe();
-      hash_mismatch_paths_.insert(relative_path);
+void ContentHashFetcherJob::FinishCreatingHashes() {
+  if (IsCancelled())
+    return;
+
+  ComputedHashes::Writer writer;
+  for (size_t i = 0; i < file_hashes_.size(); ++i) {
+    const FileHashes& file = file_hashes_[i];
+    if (file.read_failed)
+      continue;
+    if (file.expected_root != file.root) {
+      VLOG(1) << "content mismatch for " << file.relative_path.AsUTF8Unsafe();
+      hash_mismatch_paths_.insert(file.relative_path);
       continue;
     }
 
-    writer.AddHashes(relative_path, block_size_, hashes);
+    writer.AddHashes(file.relative_path, block_size_, file.hashes);
+  }
+  file_hashes_.clear();
+
+  success_ = writer.WriteToFile(hashes_file_);
+  if (success_) {
+    base::FilePath old_hashes_file =
+        hashes_file_.DirName().Append(kOldComputedHashesFilename);
+    if (!base::DeleteFile(old_hashes_file, false))
+      LOG(WARNING) << "Failed to delete " << old_hashes_file.value();
   }
-  bool result = writer.WriteToFile(hashes_file);
   UMA_HISTOGRAM_TIMES("ExtensionContentHashFetcher.CreateHashesTime",
-                      timer.Elapsed());
-  return result;
+                      base::TimeTicks::Now() - hashing_start_time_);
+
+  content::BrowserThread::PostTask(
+      creation_thread_,
+      FROM_HERE,
+      base::Bind(&ContentHashFetcherJob::DispatchCallback, this));
 }
 
 void ContentHashFetcherJob::DispatchCallback() {
@@ -34,7 +34,7 @@ class ContentHashFetcher {
   // A callback for when a fetch is complete. This reports back:
   // -extension id
   // -whether we were successful or not (have verified_contents.json and
-  // -computed_hashes.json files)
+  // -computed_hashes.bin files)
   // -was it a forced check?
   // -a set of paths whose contents didn't match expected values
   typedef base::Callback<
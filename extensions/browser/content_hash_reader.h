@@ -41,7 +41,7 @@ class ContentHashReader : public base::RefCountedThreadSafe<ContentHashReader> {
   bool Init();
 
   // These return whether we found valid verified_contents.json /
-  // computed_hashes.json files respectively. Note that both of these can be
+  // computed_hashes.bin files respectively. Note that both of these can be
   // true but we still didn't find an entry for |relative_path_| in them.
   bool have_verified_contents() { return have_verified_contents_; }
   bool have_computed_hashes() { return have_computed_hashes_; }
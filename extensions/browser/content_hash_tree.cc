@@ -4,9 +4,10 @@
 
 #include "extensions/browser/content_hash_tree.h"
 
-#include "base/memory/scoped_ptr.h"
-#include "base/stl_util.h"
-#include "crypto/secure_hash.h"
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/strings/string_piece.h"
 #include "crypto/sha2.h"
 
 namespace extensions {
@@ -24,27 +25,38 @@ std::string ComputeTreeHashRoot(const std::vector<std::string>& leaf_hashes,
   // |leaf_hashes|, but thereafter it points at |current_nodes|.
   const std::vector<std::string>* current = &leaf_hashes;
 
+  // The concatenated hashes of the current level, and the pieces of it that
+  // are hashed together to form each parent node. All parent nodes of a level
+  // are hashed in one go, which lets SHA256HashStrings() compute several of
+  // them in parallel.
+  std::string level;
+  std::vector<base::StringPiece> children;
+
   // Where we're inserting new hashes computed from the current level.
   std::vector<std::string> parent_nodes;
 
   while (current->size() > 1) {
-    // Iterate over the current level of hashes, computing the hash of up to
-    // |branch_factor| elements to form the hash of each parent node.
-    std::vector<std::string>::const_iterator i = current->begin();
-    while (i != current->end()) {
-      scoped_ptr<crypto::SecureHash> hash(
-          crypto::SecureHash::Create(crypto::SecureHash::SHA256));
-      for (int j = 0; j < branch_factor && i != current->end(); j++) {
-        DCHECK_EQ(i->size(), crypto::kSHA256Length);
-        hash->Update(i->data(), i->size());
-        ++i;
-      }
-      parent_nodes.push_back(std::string(crypto::kSHA256Length, 0));
-      std::string* output = &(parent_nodes.back());
-      hash->Finish(string_as_array(output), output->size());
+    level.clear();
+    level.reserve(current->size() * crypto::kSHA256Length);
+    for (std::vector<std::string>::const_iterator i = current->begin();
+         i != current->end();
+         ++i) {
+      DCHECK_EQ(i->size(), crypto::kSHA256Length);
+      level.append(*i);
     }
-    current_nodes.swap(parent_nodes);
+
+    // Group up to |branch_factor| elements of the current level of hashes to
+    // form the hash of each parent node.
+    const size_t group_size = branch_factor * crypto::kSHA256Length;
+    children.clear();
+    for (size_t offset = 0; offset < level.size(); offset += group_size) {
+      children.push_back(base::StringPiece(
+          level.data() + offset, std::min(group_size, level.size() - offset)));
+    }
+
     parent_nodes.clear();
+    crypto::SHA256HashStrings(children, &parent_nodes);
+    current_nodes.swap(parent_nodes);
     current = &current_nodes;
   }
   DCHECK_EQ(1u, current->size());
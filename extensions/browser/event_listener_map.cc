@@ -101,6 +101,7 @@ bool EventListenerMap::AddListener(scoped_ptr<EventListener> listener) {
   }
   linked_ptr<EventListener> listener_ptr(listener.release());
   listeners_[listener_ptr->event_name()].push_back(listener_ptr);
+  IncrementListenerCounts(listener_ptr.get());
 
   delegate_->OnListenerAdded(listener_ptr.get());
 
@@ -114,6 +115,9 @@ scoped_ptr<EventMatcher> EventListenerMap::ParseEventMatcher(
 }
 
 bool EventListenerMap::RemoveListener(const EventListener* listener) {
+  if (!event_extension_counts_.count(std::make_pair(
+          listener->event_name(), listener->extension_id())))
+    return false;
   ListenerList& listeners = listeners_[listener->event_name()];
   for (ListenerList::iterator it = listeners.begin(); it != listeners.end();
        it++) {
@@ -137,19 +141,14 @@ bool EventListenerMap::HasListenerForEvent(const std::string& event_name) {
 bool EventListenerMap::HasListenerForExtension(
     const std::string& extension_id,
     const std::string& event_name) {
-  ListenerMap::iterator it = listeners_.find(event_name);
-  if (it == listeners_.end())
-    return false;
-
-  for (ListenerList::iterator it2 = it->second.begin();
-       it2 != it->second.end(); it2++) {
-    if ((*it2)->extension_id() == extension_id)
-      return true;
-  }
-  return false;
+  return event_extension_counts_.count(
+      std::make_pair(event_name, extension_id)) > 0u;
 }
 
 bool EventListenerMap::HasListener(const EventListener* listener) {
+  if (!event_extension_counts_.count(std::make_pair(
+          listener->event_name(), listener->extension_id())))
+    return false;
   ListenerMap::iterator it = listeners_.find(listener->event_name());
   if (it == listeners_.end())
     return false;
@@ -164,16 +163,8 @@ bool EventListenerMap::HasListener(const EventListener* listener) {
 
 bool EventListenerMap::HasProcessListener(content::RenderProcessHost* process,
                                           const std::string& extension_id) {
-  for (ListenerMap::iterator it = listeners_.begin(); it != listeners_.end();
-       it++) {
-    for (ListenerList::iterator it2 = it->second.begin();
-         it2 != it->second.end(); it2++) {
-      if ((*it2)->process() == process &&
-          (*it2)->extension_id() == extension_id)
-        return true;
-    }
-  }
-  return false;
+  return process_extension_counts_.count(
+      std::make_pair(process, extension_id)) > 0u;
 }
 
 void EventListenerMap::RemoveLazyListenersForExtension(
@@ -264,7 +255,31 @@ void EventListenerMap::RemoveListenersForProcess(
   }
 }
 
+void EventListenerMap::IncrementListenerCounts(const EventListener* listener) {
+  event_extension_counts_[std::make_pair(listener->event_name(),
+                                         listener->extension_id())]++;
+  process_extension_counts_[std::make_pair(listener->process(),
+                                           listener->extension_id())]++;
+}
+
+void EventListenerMap::DecrementListenerCounts(const EventListener* listener) {
+  EventExtensionCounts::iterator event_count = event_extension_counts_.find(
+      std::make_pair(listener->event_name(), listener->extension_id()));
+  CHECK(event_count != event_extension_counts_.end());
+  if (--event_count->second == 0)
+    event_extension_counts_.erase(event_count);
+
+  ProcessExtensionCounts::iterator process_count =
+      process_extension_counts_.find(
+          std::make_pair(listener->process(), listener->extension_id()));
+  CHECK(process_count != process_extension_counts_.end());
+  if (--process_count->second == 0)
+    process_extension_counts_.erase(process_count);
+}
+
 void EventListenerMap::CleanupListener(EventListener* listener) {
+  DecrementListenerCounts(listener);
+
   // If the listener doesn't have a filter then we have nothing to clean up.
   if (listener->matcher_id() == -1)
     return;
@@ -8,6 +8,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/memory/scoped_ptr.h"
@@ -175,6 +176,19 @@ class EventListenerMap {
   // The key here is an event name.
   typedef std::map<std::string, ListenerList> ListenerMap;
 
+  // Number of listeners per (event name, extension id) and per
+  // (process, extension id), so that the Has*Listener*() queries don't have
+  // to look at every listener.
+  typedef std::map<std::pair<std::string, std::string>, int>
+      EventExtensionCounts;
+  typedef std::map<std::pair<const content::RenderProcessHost*, std::string>,
+                   int> ProcessExtensionCounts;
+
+  // Updates the counts when |listener| is added or removed.
+  void IncrementListenerCounts(const EventListener* listener);
+  void DecrementListenerCounts(const EventListener* listener);
+
+  // Called for every listener removed from |listeners_|.
   void CleanupListener(EventListener* listener);
   bool IsFilteredEvent(const Event& event) const;
   scoped_ptr<EventMatcher> ParseEventMatcher(
@@ -185,6 +199,8 @@ class EventListenerMap {
 
   std::set<std::string> filtered_events_;
   ListenerMap listeners_;
+  EventExtensionCounts event_extension_counts_;
+  ProcessExtensionCounts process_extension_counts_;
 
   std::map<EventFilter::MatcherID, EventListener*> listeners_by_matcher_id_;
 
@@ -347,6 +347,28 @@ TEST_F(EventListenerMapTest, HasListenerForExtension) {
   ASSERT_FALSE(listeners_->HasListenerForExtension(kExt1Id, kEvent1Name));
 }
 
+TEST_F(EventListenerMapTest, HasProcessListener) {
+  ASSERT_FALSE(listeners_->HasProcessListener(process_.get(), kExt1Id));
+
+  listeners_->AddListener(EventListener::ForExtension(
+      kEvent1Name, kExt1Id, process_.get(), scoped_ptr<DictionaryValue>()));
+  listeners_->AddListener(EventListener::ForExtension(
+      kEvent2Name, kExt1Id, process_.get(), CreateHostSuffixFilter("a.com")));
+
+  ASSERT_TRUE(listeners_->HasProcessListener(process_.get(), kExt1Id));
+  ASSERT_FALSE(listeners_->HasProcessListener(process_.get(), kExt2Id));
+  ASSERT_FALSE(listeners_->HasProcessListener(NULL, kExt1Id));
+
+  // The process still has a listener until the last one is removed.
+  scoped_ptr<EventListener> listener(EventListener::ForExtension(
+      kEvent1Name, kExt1Id, process_.get(), scoped_ptr<DictionaryValue>()));
+  ASSERT_TRUE(listeners_->RemoveListener(listener.get()));
+  ASSERT_TRUE(listeners_->HasProcessListener(process_.get(), kExt1Id));
+  listeners_->RemoveListenersForProcess(process_.get());
+  ASSERT_FALSE(listeners_->HasProcessListener(process_.get(), kExt1Id));
+  ASSERT_FALSE(listeners_->HasListenerForExtension(kExt1Id, kEvent2Name));
+}
+
 TEST_F(EventListenerMapTest, AddLazyListenersFromPreferences) {
   scoped_ptr<DictionaryValue> filter1(CreateHostSuffixFilter("google.com"));
   scoped_ptr<DictionaryValue> filter2(CreateHostSuffixFilter("yahoo.com"));
@@ -24,7 +24,7 @@ const base::FilePath::CharType kMetadataFolder[] =
 const base::FilePath::CharType kVerifiedContentsFilename[] =
     FILE_PATH_LITERAL("verified_contents.json");
 const base::FilePath::CharType kComputedHashesFilename[] =
-    FILE_PATH_LITERAL("computed_hashes.json");
+    FILE_PATH_LITERAL("computed_hashes.bin");
 
 const char kInstallDirectoryName[] = "Extensions";
 
@@ -111,6 +111,18 @@ TEST_F(EventFilterUnittest, RemovingAnEventMatcherStopsItMatching) {
   ASSERT_TRUE(matches.empty());
 }
 
+TEST_F(EventFilterUnittest, ReaddingAnEventMatcherAfterRemovingAllMatches) {
+  int id1 = event_filter_.AddEventMatcher("event1", AllURLs());
+  event_filter_.RemoveEventMatcher(id1);
+  ASSERT_EQ(0, event_filter_.GetMatcherCountForEvent("event1"));
+
+  int id2 = event_filter_.AddEventMatcher("event1", AllURLs());
+  std::set<int> matches = event_filter_.MatchEvent("event1",
+      google_event_, MSG_ROUTING_NONE);
+  ASSERT_EQ(1u, matches.size());
+  ASSERT_EQ(1u, matches.count(id2));
+}
+
 TEST_F(EventFilterUnittest, MultipleEventMatches) {
   int id1 = event_filter_.AddEventMatcher("event1", AllURLs());
   int id2 = event_filter_.AddEventMatcher("event1", AllURLs());
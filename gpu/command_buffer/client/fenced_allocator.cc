@@ -39,27 +39,24 @@ FencedAllocator::FencedAllocator(unsigned int size,
     : helper_(helper),
       poll_callback_(poll_callback),
       bytes_in_use_(0) {
-  Block block = { FREE, 0, RoundDown(size), kUnusedToken };
-  blocks_.push_back(block);
+  Block block = { FREE, RoundDown(size), kUnusedToken, pending_blocks_.end() };
+  blocks_.insert(std::make_pair(0, block));
+  free_blocks_.insert(std::make_pair(block.size, 0));
 }
 
 FencedAllocator::~FencedAllocator() {
   // Free blocks pending tokens.
-  for (unsigned int i = 0; i < blocks_.size(); ++i) {
-    if (blocks_[i].state == FREE_PENDING_TOKEN) {
-      i = WaitForTokenAndFreeBlock(i);
-    }
-  }
+  while (!pending_blocks_.empty())
+    WaitForOldestTokenAndFreeBlocks();
 
   DCHECK_EQ(blocks_.size(), 1u);
-  DCHECK_EQ(blocks_[0].state, FREE);
+  DCHECK_EQ(blocks_.begin()->second.state, FREE);
 }
 
-// Looks for a non-allocated block that is big enough. Search in the FREE
-// blocks first (for direct usage), first-fit, then in the FREE_PENDING_TOKEN
-// blocks, waiting for them. The current implementation isn't smart about
-// optimizing what to wait for, just looks inside the block in order (first-fit
-// as well).
+// Looks for the smallest FREE block that is big enough (best-fit), preferring
+// the lowest offset among blocks of the same size. If there is none, waits
+// for the pending tokens in the order they were issued, retrying after each,
+// so that the wait is no longer than needed.
 FencedAllocator::Offset FencedAllocator::Alloc(unsigned int size) {
   // size of 0 is not allowed because it would be inconsistent to only sometimes
   // have it succeed. Example: Alloc(SizeOfBuffer), Alloc(0).
@@ -70,61 +67,45 @@ FencedAllocator::Offset FencedAllocator::Alloc(unsigned int size) {
   // Round up the allocation size to ensure alignment.
   size = RoundUp(size);
 
-  // Try first to allocate in a free block.
-  for (unsigned int i = 0; i < blocks_.size(); ++i) {
-    Block &block = blocks_[i];
-    if (block.state == FREE && block.size >= size) {
-      return AllocInBlock(i, size);
-    }
-  }
-
-  // No free block is available. Look for blocks pending tokens, and wait for
-  // them to be re-usable.
-  for (unsigned int i = 0; i < blocks_.size(); ++i) {
-    if (blocks_[i].state != FREE_PENDING_TOKEN)
-      continue;
-    i = WaitForTokenAndFreeBlock(i);
-    if (blocks_[i].size >= size)
-      return AllocInBlock(i, size);
+  for (;;) {
+    FreeBlockSet::iterator free_it =
+        free_blocks_.lower_bound(std::make_pair(size, 0u));
+    if (free_it != free_blocks_.end())
+      return AllocInBlock(blocks_.find(free_it->second), size);
+    if (pending_blocks_.empty())
+      return kInvalidOffset;
+    WaitForOldestTokenAndFreeBlocks();
   }
-  return kInvalidOffset;
 }
 
 // Looks for the corresponding block, mark it FREE, and collapse it if
 // necessary.
 void FencedAllocator::Free(FencedAllocator::Offset offset) {
-  BlockIndex index = GetBlockByOffset(offset);
-  DCHECK_NE(blocks_[index].state, FREE);
-  Block &block = blocks_[index];
-
-  if (block.state == IN_USE)
-    bytes_in_use_ -= block.size;
-
-  block.state = FREE;
-  CollapseFreeBlock(index);
+  BlockIterator it = GetBlockByOffset(offset);
+  DCHECK_NE(it->second.state, FREE);
+  if (it->second.state == IN_USE)
+    bytes_in_use_ -= it->second.size;
+  MarkBlockFree(it);
 }
 
 // Looks for the corresponding block, mark it FREE_PENDING_TOKEN.
 void FencedAllocator::FreePendingToken(
     FencedAllocator::Offset offset, int32 token) {
-  BlockIndex index = GetBlockByOffset(offset);
-  Block &block = blocks_[index];
-  if (block.state == IN_USE)
+  BlockIterator it = GetBlockByOffset(offset);
+  Block &block = it->second;
+  DCHECK_NE(block.state, FREE);
+  if (block.state == IN_USE) {
     bytes_in_use_ -= block.size;
+    block.pending_it = pending_blocks_.insert(pending_blocks_.end(), offset);
+  }
   block.state = FREE_PENDING_TOKEN;
   block.token = token;
 }
 
-// Gets the max of the size of the blocks marked as free.
+// The free blocks are sorted by size, so the largest is the last one.
 unsigned int FencedAllocator::GetLargestFreeSize() {
   FreeUnused();
-  unsigned int max_size = 0;
-  for (unsigned int i = 0; i < blocks_.size(); ++i) {
-    Block &block = blocks_[i];
-    if (block.state == FREE)
-      max_size = std::max(max_size, block.size);
-  }
-  return max_size;
+  return free_blocks_.empty() ? 0 : free_blocks_.rbegin()->first;
 }
 
 // Gets the size of the largest segment of blocks that are either FREE or
@@ -132,8 +113,8 @@ unsigned int FencedAllocator::GetLargestFreeSize() {
 unsigned int FencedAllocator::GetLargestFreeOrPendingSize() {
   unsigned int max_size = 0;
   unsigned int current_size = 0;
-  for (unsigned int i = 0; i < blocks_.size(); ++i) {
-    Block &block = blocks_[i];
+  for (BlockIterator it = blocks_.begin(); it != blocks_.end(); ++it) {
+    Block &block = it->second;
     if (block.state == IN_USE) {
       max_size = std::max(max_size, current_size);
       current_size = 0;
@@ -149,58 +130,99 @@ unsigned int FencedAllocator::GetLargestFreeOrPendingSize() {
 // - there is at least one block.
 // - there are no contiguous FREE blocks (they should have been collapsed).
 // - the successive offsets match the block sizes, and they are in order.
+// - the FREE and FREE_PENDING_TOKEN blocks are exactly the ones indexed in
+//   |free_blocks_| and |pending_blocks_|.
 bool FencedAllocator::CheckConsistency() {
   if (blocks_.size() < 1) return false;
-  for (unsigned int i = 0; i < blocks_.size() - 1; ++i) {
-    Block &current = blocks_[i];
-    Block &next = blocks_[i + 1];
-    // This test is NOT included in the next one, because offset is unsigned.
-    if (next.offset <= current.offset)
-      return false;
-    if (next.offset != current.offset + current.size)
-      return false;
-    if (current.state == FREE && next.state == FREE)
+  size_t free_count = 0;
+  size_t pending_count = 0;
+  Offset next_offset = 0;
+  State previous_state = IN_USE;
+  for (BlockIterator it = blocks_.begin(); it != blocks_.end(); ++it) {
+    const Block &block = it->second;
+    if (it->first != next_offset)
       return false;
+    if (block.state == FREE) {
+      if (previous_state == FREE)
+        return false;
+      if (!free_blocks_.count(std::make_pair(block.size, it->first)))
+        return false;
+      ++free_count;
+    } else if (block.state == FREE_PENDING_TOKEN) {
+      if (block.pending_it == pending_blocks_.end() ||
+          *block.pending_it != it->first) {
+        return false;
+      }
+      ++pending_count;
+    }
+    next_offset = it->first + block.size;
+    previous_state = block.state;
   }
-  return true;
+  return free_count == free_blocks_.size() &&
+         pending_count == pending_blocks_.size();
 }
 
 // Returns false if all blocks are actually FREE, in which
 // case they would be coalesced into one block, true otherwise.
 bool FencedAllocator::InUse() {
-  return blocks_.size() != 1 || blocks_[0].state != FREE;
-}
-
-// Collapse the block to the next one, then to the previous one. Provided the
-// structure is consistent, those are the only blocks eligible for collapse.
-FencedAllocator::BlockIndex FencedAllocator::CollapseFreeBlock(
-    BlockIndex index) {
-  if (index + 1 < blocks_.size()) {
-    Block &next = blocks_[index + 1];
-    if (next.state == FREE) {
-      blocks_[index].size += next.size;
-      blocks_.erase(blocks_.begin() + index + 1);
-    }
+  return blocks_.size() != 1 || blocks_.begin()->second.state != FREE;
+}
+
+// Marks the block FREE, then collapses it with the next one and the previous
+// one. Provided the structure is consistent, those are the only blocks
+// eligible for collapse.
+FencedAllocator::BlockIterator FencedAllocator::MarkBlockFree(
+    BlockIterator it) {
+  Block &block = it->second;
+  DCHECK_NE(block.state, FREE);
+  if (block.state == FREE_PENDING_TOKEN) {
+    pending_blocks_.erase(block.pending_it);
+    block.pending_it = pending_blocks_.end();
+  }
+  block.state = FREE;
+  block.token = kUnusedToken;
+
+  BlockIterator next = it;
+  ++next;
+  if (next != blocks_.end() && next->second.state == FREE) {
+    free_blocks_.erase(std::make_pair(next->second.size, next->first));
+    block.size += next->second.size;
+    blocks_.erase(next);
   }
-  if (index > 0) {
-    Block &prev = blocks_[index - 1];
-    if (prev.state == FREE) {
-      prev.size += blocks_[index].size;
-      blocks_.erase(blocks_.begin() + index);
-      --index;
+  if (it != blocks_.begin()) {
+    BlockIterator prev = it;
+    --prev;
+    if (prev->second.state == FREE) {
+      free_blocks_.erase(std::make_pair(prev->second.size, prev->first));
+      prev->second.size += block.size;
+      blocks_.erase(it);
+      it = prev;
     }
   }
-  return index;
+  free_blocks_.insert(std::make_pair(it->second.size, it->first));
+  return it;
 }
 
-// Waits for the block's token, then mark the block as free, then collapse it.
-FencedAllocator::BlockIndex FencedAllocator::WaitForTokenAndFreeBlock(
-    BlockIndex index) {
-  Block &block = blocks_[index];
-  DCHECK_EQ(block.state, FREE_PENDING_TOKEN);
-  helper_->WaitForToken(block.token);
-  block.state = FREE;
-  return CollapseFreeBlock(index);
+// Waits for the token of the block freed first; all the tokens inserted before
+// it have then passed too.
+void FencedAllocator::WaitForOldestTokenAndFreeBlocks() {
+  DCHECK(!pending_blocks_.empty());
+  BlockIterator it = GetBlockByOffset(pending_blocks_.front());
+  DCHECK_EQ(it->second.state, FREE_PENDING_TOKEN);
+  helper_->WaitForToken(it->second.token);
+  MarkBlockFree(it);
+  FreeBlocksWithPassedTokens();
+}
+
+void FencedAllocator::FreeBlocksWithPassedTokens() {
+  for (PendingBlockList::iterator pending_it = pending_blocks_.begin();
+       pending_it != pending_blocks_.end();) {
+    BlockIterator it = GetBlockByOffset(*pending_it);
+    // Advance first, as freeing the block removes it from the list.
+    ++pending_it;
+    if (helper_->HasTokenPassed(it->second.token))
+      MarkBlockFree(it);
+  }
 }
 
 // Frees any blocks pending a token for which the token has been read.
@@ -208,46 +230,36 @@ void FencedAllocator::FreeUnused() {
   // Free any potential blocks that has its lifetime handled outside.
   poll_callback_.Run();
 
-  for (unsigned int i = 0; i < blocks_.size();) {
-    Block& block = blocks_[i];
-    if (block.state == FREE_PENDING_TOKEN &&
-        helper_->HasTokenPassed(block.token)) {
-      block.state = FREE;
-      i = CollapseFreeBlock(i);
-    } else {
-      ++i;
-    }
-  }
+  FreeBlocksWithPassedTokens();
 }
 
 // If the block is exactly the requested size, simply mark it IN_USE, otherwise
 // split it and mark the first one (of the requested size) IN_USE.
-FencedAllocator::Offset FencedAllocator::AllocInBlock(BlockIndex index,
+FencedAllocator::Offset FencedAllocator::AllocInBlock(BlockIterator it,
                                                       unsigned int size) {
-  Block &block = blocks_[index];
+  Block &block = it->second;
   DCHECK_GE(block.size, size);
   DCHECK_EQ(block.state, FREE);
-  Offset offset = block.offset;
+  Offset offset = it->first;
+  free_blocks_.erase(std::make_pair(block.size, offset));
   bytes_in_use_ += size;
-  if (block.size == size) {
-    block.state = IN_USE;
-    return offset;
-  }
-  Block newblock = { FREE, offset + size, block.size - size, kUnusedToken};
   block.state = IN_USE;
+  if (block.size == size)
+    return offset;
+  Block newblock = {
+    FREE, block.size - size, kUnusedToken, pending_blocks_.end()
+  };
   block.size = size;
-  // this is the last thing being done because it may invalidate block;
-  blocks_.insert(blocks_.begin() + index + 1, newblock);
+  blocks_.insert(it, std::make_pair(offset + size, newblock));
+  free_blocks_.insert(std::make_pair(newblock.size, offset + size));
   return offset;
 }
 
-// The blocks are in offset order, so we can do a binary search.
-FencedAllocator::BlockIndex FencedAllocator::GetBlockByOffset(Offset offset) {
-  Block templ = { IN_USE, offset, 0, kUnusedToken };
-  Container::iterator it = std::lower_bound(blocks_.begin(), blocks_.end(),
-                                            templ, OffsetCmp());
-  DCHECK(it != blocks_.end() && it->offset == offset);
-  return it-blocks_.begin();
+FencedAllocator::BlockIterator FencedAllocator::GetBlockByOffset(
+    Offset offset) {
+  BlockIterator it = blocks_.find(offset);
+  DCHECK(it != blocks_.end());
+  return it;
 }
 
 }  // namespace gpu
@@ -9,7 +9,10 @@
 
 #include <stdint.h>
 
-#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <utility>
 
 #include "base/bind.h"
 #include "base/logging.h"
@@ -98,50 +101,53 @@ class GPU_EXPORT FencedAllocator {
     FREE_PENDING_TOKEN
   };
 
+  // Offsets of the FREE_PENDING_TOKEN blocks, in the order they were freed.
+  // Tokens are inserted in increasing order, so the oldest token is first.
+  typedef std::list<Offset> PendingBlockList;
+
   // Book-keeping sturcture that describes a block of memory.
   struct Block {
     State state;
-    Offset offset;
     unsigned int size;
     int32_t token;  // token to wait for in the FREE_PENDING_TOKEN case.
+    // Position in |pending_blocks_| in the FREE_PENDING_TOKEN case.
+    PendingBlockList::iterator pending_it;
   };
 
-  // Comparison functor for memory block sorting.
-  class OffsetCmp {
-   public:
-    bool operator() (const Block &left, const Block &right) {
-      return left.offset < right.offset;
-    }
-  };
+  // The blocks, keyed by offset. They cover the whole buffer.
+  typedef std::map<Offset, Block> Container;
+  typedef Container::iterator BlockIterator;
 
-  typedef std::vector<Block> Container;
-  typedef unsigned int BlockIndex;
+  // The FREE blocks as (size, offset) pairs, so that the smallest block that
+  // fits an allocation can be found in logarithmic time.
+  typedef std::set<std::pair<unsigned int, Offset> > FreeBlockSet;
 
   static const int32_t kUnusedToken = 0;
 
-  // Gets the index of a memory block, given its offset.
-  BlockIndex GetBlockByOffset(Offset offset);
+  // Gets a memory block, given its offset.
+  BlockIterator GetBlockByOffset(Offset offset);
+
+  // Marks a block that is not FREE as FREE and collapses it with its
+  // neighbours if they are free. Returns the collapsed block.
+  BlockIterator MarkBlockFree(BlockIterator it);
 
-  // Collapse a free block with its neighbours if they are free. Returns the
-  // index of the collapsed block.
-  // NOTE: this will invalidate block indices.
-  BlockIndex CollapseFreeBlock(BlockIndex index);
+  // Waits for the oldest token that blocks are pending on, then frees all the
+  // blocks whose token has passed.
+  void WaitForOldestTokenAndFreeBlocks();
 
-  // Waits for a FREE_PENDING_TOKEN block to be usable, and free it. Returns
-  // the new index of that block (since it may have been collapsed).
-  // NOTE: this will invalidate block indices.
-  BlockIndex WaitForTokenAndFreeBlock(BlockIndex index);
+  // Frees the FREE_PENDING_TOKEN blocks whose token has passed.
+  void FreeBlocksWithPassedTokens();
 
-  // Allocates a block of memory inside a given block, splitting it in two
+  // Allocates a block of memory inside a given FREE block, splitting it in two
   // (unless that block is of the exact requested size).
-  // NOTE: this will invalidate block indices.
-  // Returns the offset of the allocated block (NOTE: this is different from
-  // the other functions that return a block index).
-  Offset AllocInBlock(BlockIndex index, unsigned int size);
+  // Returns the offset of the allocated block.
+  Offset AllocInBlock(BlockIterator it, unsigned int size);
 
   CommandBufferHelper *helper_;
   base::Closure poll_callback_;
   Container blocks_;
+  FreeBlockSet free_blocks_;
+  PendingBlockList pending_blocks_;
   size_t bytes_in_use_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(FencedAllocator);
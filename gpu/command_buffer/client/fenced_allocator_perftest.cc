@@ -0,0 +1,131 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This file contains microbenchmarks for the FencedAllocator class.
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/rand_util.h"
+#include "base/time/time.h"
+#include "gpu/command_buffer/client/fenced_allocator.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace gpu {
+
+namespace {
+
+// The size of the default transfer buffer.
+const unsigned int kBufferSize = 16 * 1024 * 1024;
+const unsigned int kMaxAllocSize = 64 * 1024;
+const int kNumIterations = 100000;
+
+void EmptyPoll() {
+}
+
+unsigned int RandAllocSize() {
+  return static_cast<unsigned int>(base::RandInt(1, kMaxAllocSize));
+}
+
+}  // namespace
+
+// Nothing is freed pending a token, so the allocator never needs a
+// CommandBufferHelper.
+class FencedAllocatorPerfTest : public testing::Test {
+ protected:
+  FencedAllocatorPerfTest()
+      : allocator_(kBufferSize, NULL, base::Bind(&EmptyPoll)) {}
+
+  virtual void TearDown() OVERRIDE {
+    for (size_t i = 0; i < live_.size(); ++i)
+      allocator_.Free(live_[i]);
+    EXPECT_FALSE(allocator_.InUse());
+  }
+
+  // Fills the buffer with randomly sized blocks, then frees every other one,
+  // leaving it fragmented into many holes of different sizes.
+  void Fragment() {
+    for (;;) {
+      FencedAllocator::Offset offset = allocator_.Alloc(RandAllocSize());
+      if (offset == FencedAllocator::kInvalidOffset)
+        break;
+      live_.push_back(offset);
+    }
+    std::vector<FencedAllocator::Offset> kept;
+    for (size_t i = 0; i < live_.size(); ++i) {
+      if (i % 2)
+        allocator_.Free(live_[i]);
+      else
+        kept.push_back(live_[i]);
+    }
+    live_.swap(kept);
+    ASSERT_TRUE(allocator_.CheckConsistency());
+  }
+
+  void PrintTime(const std::string& trace,
+                 base::TimeDelta elapsed,
+                 int operations) {
+    perf_test::PrintResult("fenced_allocator",
+                           "",
+                           trace,
+                           elapsed.InMicrosecondsF() * 1000 / operations,
+                           "ns/op",
+                           true);
+  }
+
+  FencedAllocator allocator_;
+  std::vector<FencedAllocator::Offset> live_;
+};
+
+// Allocates and immediately frees blocks in a fragmented buffer, which is the
+// pattern of transfer buffer uploads.
+TEST_F(FencedAllocatorPerfTest, AllocFreeFragmented) {
+  Fragment();
+  std::vector<unsigned int> sizes;
+  for (int i = 0; i < kNumIterations; ++i)
+    sizes.push_back(RandAllocSize());
+
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kNumIterations; ++i) {
+    FencedAllocator::Offset offset = allocator_.Alloc(sizes[i]);
+    if (offset != FencedAllocator::kInvalidOffset)
+      allocator_.Free(offset);
+  }
+  PrintTime("alloc_free_fragmented",
+            base::TimeTicks::HighResNow() - start,
+            kNumIterations);
+}
+
+// Replaces random live blocks with new ones, so that the holes keep changing.
+TEST_F(FencedAllocatorPerfTest, Churn) {
+  Fragment();
+  ASSERT_FALSE(live_.empty());
+  std::vector<int> indices;
+  std::vector<unsigned int> sizes;
+  for (int i = 0; i < kNumIterations; ++i) {
+    indices.push_back(base::RandInt(0, live_.size() - 1));
+    sizes.push_back(RandAllocSize());
+  }
+
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kNumIterations; ++i) {
+    FencedAllocator::Offset* slot = &live_[indices[i]];
+    if (*slot != FencedAllocator::kInvalidOffset)
+      allocator_.Free(*slot);
+    *slot = allocator_.Alloc(sizes[i]);
+  }
+  PrintTime("churn", base::TimeTicks::HighResNow() - start, kNumIterations);
+
+  std::vector<FencedAllocator::Offset> kept;
+  for (size_t i = 0; i < live_.size(); ++i) {
+    if (live_[i] != FencedAllocator::kInvalidOffset)
+      kept.push_back(live_[i]);
+  }
+  live_.swap(kept);
+  EXPECT_TRUE(allocator_.CheckConsistency());
+}
+
+}  // namespace gpu
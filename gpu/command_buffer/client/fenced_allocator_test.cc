@@ -399,6 +399,33 @@ TEST_F(FencedAllocatorTest, TestGetLargestFreeOrPendingSize) {
   EXPECT_EQ(kBufferSize, allocator_->GetLargestFreeSize());
 }
 
+// Checks that allocations go to the smallest hole they fit in.
+TEST_F(FencedAllocatorTest, TestBestFit) {
+  const unsigned int kSize = 16;
+  FencedAllocator::Offset large_hole = allocator_->Alloc(4 * kSize);
+  FencedAllocator::Offset offset1 = allocator_->Alloc(kSize);
+  FencedAllocator::Offset small_hole = allocator_->Alloc(2 * kSize);
+  FencedAllocator::Offset offset2 = allocator_->Alloc(kSize);
+  ASSERT_NE(FencedAllocator::kInvalidOffset, large_hole);
+  ASSERT_NE(FencedAllocator::kInvalidOffset, offset1);
+  ASSERT_NE(FencedAllocator::kInvalidOffset, small_hole);
+  ASSERT_NE(FencedAllocator::kInvalidOffset, offset2);
+  allocator_->Free(large_hole);
+  allocator_->Free(small_hole);
+  EXPECT_TRUE(allocator_->CheckConsistency());
+
+  // The small hole fits exactly, so the large one stays whole.
+  EXPECT_EQ(small_hole, allocator_->Alloc(2 * kSize));
+  EXPECT_EQ(large_hole, allocator_->Alloc(3 * kSize));
+  EXPECT_TRUE(allocator_->CheckConsistency());
+
+  allocator_->Free(large_hole);
+  allocator_->Free(offset1);
+  allocator_->Free(small_hole);
+  allocator_->Free(offset2);
+  EXPECT_FALSE(allocator_->InUse());
+}
+
 class FencedAllocatorPollTest : public BaseFencedAllocatorTest {
  public:
   static const unsigned int kAllocSize = 128;
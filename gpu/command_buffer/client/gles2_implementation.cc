@@ -91,6 +91,7 @@ GLES2Implementation::GLES2Implementation(
     GpuControl* gpu_control)
     : helper_(helper),
       transfer_buffer_(transfer_buffer),
+      max_transfer_buffer_allocation_(0),
       angle_pack_reverse_row_order_status_(kUnknownExtensionStatus),
       chromium_framebuffer_multisample_(kUnknownExtensionStatus),
       pack_alignment_(4),
@@ -150,6 +151,7 @@ bool GLES2Implementation::Initialize(
   DCHECK_LE(starting_transfer_buffer_size, max_transfer_buffer_size);
   DCHECK_GE(min_transfer_buffer_size, kStartingOffset);
 
+  max_transfer_buffer_allocation_ = max_transfer_buffer_size - kStartingOffset;
   if (!transfer_buffer_->Initialize(
       starting_transfer_buffer_size,
       kStartingOffset,
@@ -349,6 +351,7 @@ uint32 GLES2Implementation::GetResultShmOffset() {
 
 void GLES2Implementation::FreeUnusedSharedMemory() {
   mapped_memory_->FreeUnused();
+  transfer_buffer_->ShrinkToDefaultSize();
 }
 
 void GLES2Implementation::FreeEverything() {
@@ -1435,6 +1438,14 @@ void GLES2Implementation::BufferDataHelper(
     return;
   }
 
+  // Data that can't fit in the transfer buffer at all is sent separately.
+  if (static_cast<unsigned int>(size) > max_transfer_buffer_allocation_) {
+    helper_->BufferData(target, size, 0, 0, usage);
+    BufferSubDataHelper(target, 0, size, data);
+    CheckGLError();
+    return;
+  }
+
   // See if we can send all at once.
   ScopedTransferBufferPtr buffer(size, helper_, transfer_buffer_);
   if (!buffer.valid()) {
@@ -1504,10 +1515,30 @@ void GLES2Implementation::BufferSubDataHelper(
     return;
   }
 
+  if (static_cast<unsigned int>(size) > max_transfer_buffer_allocation_ &&
+      BufferSubDataWithMappedMemory(target, offset, size, data)) {
+    return;
+  }
+
   ScopedTransferBufferPtr buffer(size, helper_, transfer_buffer_);
   BufferSubDataHelperImpl(target, offset, size, data, &buffer);
 }
 
+// Going through the transfer buffer would split the data into chunks, each
+// waiting for the service to be done with the previous one.
+bool GLES2Implementation::BufferSubDataWithMappedMemory(
+    GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+  int32 shm_id;
+  unsigned int shm_offset;
+  void* mem = mapped_memory_->Alloc(size, &shm_id, &shm_offset);
+  if (!mem)
+    return false;
+  memcpy(mem, data, size);
+  helper_->BufferSubData(target, offset, size, shm_id, shm_offset);
+  mapped_memory_->FreePendingToken(mem, helper_->InsertToken());
+  return true;
+}
+
 void GLES2Implementation::BufferSubDataHelperImpl(
     GLenum target, GLintptr offset, GLsizeiptr size, const void* data,
     ScopedTransferBufferPtr* buffer) {
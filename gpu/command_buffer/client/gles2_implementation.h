@@ -545,6 +545,10 @@ class GLES2_IMPL_EXPORT GLES2Implementation
   void BufferSubDataHelperImpl(
       GLenum target, GLintptr offset, GLsizeiptr size, const void* data,
       ScopedTransferBufferPtr* buffer);
+  // Sends data too large for the transfer buffer through mapped memory, in a
+  // single command. Returns false if there isn't enough mapped memory.
+  bool BufferSubDataWithMappedMemory(
+      GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
 
   GLuint CreateImageCHROMIUMHelper(GLsizei width,
                                    GLsizei height,
@@ -665,6 +669,8 @@ class GLES2_IMPL_EXPORT GLES2Implementation
   GLES2Util util_;
   GLES2CmdHelper* helper_;
   TransferBufferInterface* transfer_buffer_;
+  // The largest transfer buffer allocation that can ever succeed.
+  unsigned int max_transfer_buffer_allocation_;
   std::string last_error_;
   DebugMarkerManager debug_marker_manager_;
   std::string this_in_hex_;
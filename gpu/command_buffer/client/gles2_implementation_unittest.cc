@@ -133,6 +133,7 @@ class MockTransferBuffer : public TransferBufferInterface {
   virtual void* Alloc(unsigned int size) OVERRIDE;
   virtual RingBuffer::Offset GetOffset(void* pointer) const OVERRIDE;
   virtual void FreePendingToken(void* p, unsigned int /* token */) OVERRIDE;
+  virtual void ShrinkToDefaultSize() OVERRIDE {}
 
   size_t MaxTransferBufferSize() {
     return size_ - result_size_;
@@ -2892,34 +2893,48 @@ TEST_F(GLES2ImplementationTest, CreateProgram) {
   EXPECT_EQ(kProgramsAndShadersStartId, id);
 }
 
+// Data larger than the transfer buffer is sent through mapped memory in one
+// command, instead of in chunks.
 TEST_F(GLES2ImplementationTest, BufferDataLargerThanTransferBuffer) {
   struct Cmds {
     cmds::BufferData set_size;
-    cmds::BufferSubData copy_data1;
-    cmd::SetToken set_token1;
-    cmds::BufferSubData copy_data2;
-    cmd::SetToken set_token2;
+    cmds::BufferSubData copy_data;
+    cmd::SetToken set_token;
   };
   const unsigned kUsableSize =
       kTransferBufferSize - GLES2Implementation::kStartingOffset;
   uint8 buf[kUsableSize * 2] = { 0, };
 
-  ExpectedMemoryInfo mem1 = GetExpectedMemory(kUsableSize);
-  ExpectedMemoryInfo mem2 = GetExpectedMemory(kUsableSize);
-
   Cmds expected;
   expected.set_size.Init(
       GL_ARRAY_BUFFER, arraysize(buf), 0, 0, GL_DYNAMIC_DRAW);
-  expected.copy_data1.Init(
-      GL_ARRAY_BUFFER, 0, kUsableSize, mem1.id, mem1.offset);
-  expected.set_token1.Init(GetNextToken());
-  expected.copy_data2.Init(
-      GL_ARRAY_BUFFER, kUsableSize, kUsableSize, mem2.id, mem2.offset);
-  expected.set_token2.Init(GetNextToken());
+  expected.copy_data.Init(
+      GL_ARRAY_BUFFER, 0, arraysize(buf),
+      command_buffer()->GetNextFreeTransferBufferId(), 0);
+  expected.set_token.Init(GetNextToken());
   gl_->BufferData(GL_ARRAY_BUFFER, arraysize(buf), buf, GL_DYNAMIC_DRAW);
   EXPECT_EQ(0, memcmp(&expected, commands_, sizeof(expected)));
 }
 
+TEST_F(GLES2ImplementationTest, BufferSubDataLargerThanTransferBuffer) {
+  struct Cmds {
+    cmds::BufferSubData copy_data;
+    cmd::SetToken set_token;
+  };
+  const unsigned kUsableSize =
+      kTransferBufferSize - GLES2Implementation::kStartingOffset;
+  const GLintptr kOffset = 16;
+  uint8 buf[kUsableSize * 2] = { 0, };
+
+  Cmds expected;
+  expected.copy_data.Init(
+      GL_ARRAY_BUFFER, kOffset, arraysize(buf),
+      command_buffer()->GetNextFreeTransferBufferId(), 0);
+  expected.set_token.Init(GetNextToken());
+  gl_->BufferSubData(GL_ARRAY_BUFFER, kOffset, arraysize(buf), buf);
+  EXPECT_EQ(0, memcmp(&expected, commands_, sizeof(expected)));
+}
+
 TEST_F(GLES2ImplementationTest, CapabilitiesAreCached) {
   static const GLenum kStates[] = {
     GL_DITHER,
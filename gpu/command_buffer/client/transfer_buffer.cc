@@ -33,6 +33,14 @@ TransferBuffer::~TransferBuffer() {
   Free();
 }
 
+TransferBuffer::RetiredBuffer::RetiredBuffer()
+    : buffer_id(-1),
+      token(0) {
+}
+
+TransferBuffer::RetiredBuffer::~RetiredBuffer() {
+}
+
 bool TransferBuffer::Initialize(
     unsigned int default_buffer_size,
     unsigned int result_size,
@@ -62,6 +70,7 @@ void TransferBuffer::Free() {
     ring_buffer_.reset();
     bytes_since_last_flush_ = 0;
   }
+  DestroyRetiredBuffers(true);
 }
 
 bool TransferBuffer::HaveBuffer() const {
@@ -81,6 +90,41 @@ void TransferBuffer::FreePendingToken(void* p, unsigned int token) {
   }
 }
 
+void TransferBuffer::ShrinkToDefaultSize() {
+  if (HaveBuffer() && buffer_->size() > default_buffer_size_)
+    RetireBuffer();
+  DestroyRetiredBuffers(false);
+}
+
+void TransferBuffer::RetireBuffer() {
+  DCHECK(HaveBuffer());
+  RetiredBuffer retired;
+  retired.ring_buffer = make_linked_ptr(ring_buffer_.release());
+  retired.buffer = buffer_;
+  retired.buffer_id = buffer_id_;
+  retired.token = helper_->InsertToken();
+  retired_buffers_.push_back(retired);
+  buffer_id_ = -1;
+  buffer_ = NULL;
+  result_buffer_ = NULL;
+  result_shm_offset_ = 0;
+}
+
+void TransferBuffer::DestroyRetiredBuffers(bool wait) {
+  while (!retired_buffers_.empty()) {
+    RetiredBuffer& retired = retired_buffers_.front();
+    if (wait)
+      helper_->WaitForToken(retired.token);
+    else if (!helper_->HasTokenPassed(retired.token))
+      return;
+    // All the blocks of the ring buffer are pending tokens that passed before
+    // the retirement token, so destroying it doesn't wait.
+    retired.ring_buffer.reset();
+    helper_->command_buffer()->DestroyTransferBuffer(retired.buffer_id);
+    retired_buffers_.pop_front();
+  }
+}
+
 void TransferBuffer::AllocateRingBuffer(unsigned int size) {
   for (;size >= min_buffer_size_; size /= 2) {
     int32 id = -1;
@@ -111,6 +155,9 @@ static unsigned int ComputePOTSize(unsigned int dimension) {
 }
 
 void TransferBuffer::ReallocateRingBuffer(unsigned int size) {
+  if (!retired_buffers_.empty())
+    DestroyRetiredBuffers(false);
+
   // What size buffer would we ask for if we needed a new one?
   unsigned int needed_buffer_size = ComputePOTSize(size + result_size_);
   needed_buffer_size = std::max(needed_buffer_size, min_buffer_size_);
@@ -118,10 +165,12 @@ void TransferBuffer::ReallocateRingBuffer(unsigned int size) {
   needed_buffer_size = std::min(needed_buffer_size, max_buffer_size_);
 
   if (usable_ && (!HaveBuffer() || needed_buffer_size > buffer_->size())) {
-    if (HaveBuffer()) {
-      Free();
-    }
+    // Rather than waiting for the service to be done with the current buffer,
+    // keep it around until then and move on to a new one.
+    if (HaveBuffer())
+      RetireBuffer();
     AllocateRingBuffer(needed_buffer_size);
+    DestroyRetiredBuffers(false);
   }
 }
 
@@ -5,7 +5,10 @@
 #ifndef GPU_COMMAND_BUFFER_CLIENT_TRANSFER_BUFFER_H_
 #define GPU_COMMAND_BUFFER_CLIENT_TRANSFER_BUFFER_H_
 
+#include <deque>
+
 #include "base/compiler_specific.h"
+#include "base/memory/linked_ptr.h"
 #include "base/memory/scoped_ptr.h"
 #include "gpu/command_buffer/client/ring_buffer.h"
 #include "gpu/command_buffer/common/buffer.h"
@@ -48,6 +51,10 @@ class GPU_EXPORT TransferBufferInterface {
   virtual RingBuffer::Offset GetOffset(void* pointer) const = 0;
 
   virtual void FreePendingToken(void* p, unsigned int token) = 0;
+
+  // Gives back memory the buffer grew past its starting size for, without
+  // waiting for the service. Must not be called with allocations in use.
+  virtual void ShrinkToDefaultSize() = 0;
 };
 
 // Class that manages the transfer buffer.
@@ -74,6 +81,7 @@ class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
   virtual void* Alloc(unsigned int size) OVERRIDE;
   virtual RingBuffer::Offset GetOffset(void* pointer) const OVERRIDE;
   virtual void FreePendingToken(void* p, unsigned int token) OVERRIDE;
+  virtual void ShrinkToDefaultSize() OVERRIDE;
 
   // These are for testing.
   unsigned int GetCurrentMaxAllocationWithoutRealloc() const;
@@ -85,9 +93,32 @@ class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
 
   void AllocateRingBuffer(unsigned int size);
 
+  // Stops allocating from the current buffer, and keeps it until the service
+  // has processed the commands that may use it.
+  void RetireBuffer();
+
+  // Destroys the retired buffers the service is done with. If |wait| is true,
+  // waits for all of them.
+  void DestroyRetiredBuffers(bool wait);
+
+  // A buffer that was replaced, and the token inserted when it was retired.
+  // Its ring buffer may still have blocks pending earlier tokens.
+  struct RetiredBuffer {
+    RetiredBuffer();
+    ~RetiredBuffer();
+
+    linked_ptr<RingBuffer> ring_buffer;
+    scoped_refptr<gpu::Buffer> buffer;
+    int32 buffer_id;
+    int32 token;
+  };
+
   CommandBufferHelper* helper_;
   scoped_ptr<RingBuffer> ring_buffer_;
 
+  // Retired buffers, oldest first.
+  std::deque<RetiredBuffer> retired_buffers_;
+
   // size reserved for results
   unsigned int result_size_;
 
@@ -0,0 +1,166 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This file contains a benchmark of uploads through the TransferBuffer, with
+// an in-process command buffer service that ignores the commands.
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/message_loop/message_loop.h"
+#include "base/time/time.h"
+#include "gpu/command_buffer/client/cmd_buffer_helper.h"
+#include "gpu/command_buffer/client/transfer_buffer.h"
+#include "gpu/command_buffer/service/command_buffer_service.h"
+#include "gpu/command_buffer/service/gpu_scheduler.h"
+#include "gpu/command_buffer/service/mocks.h"
+#include "gpu/command_buffer/service/transfer_buffer_manager.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+#if defined(OS_MACOSX)
+#include "base/mac/scoped_nsautorelease_pool.h"
+#endif
+
+namespace gpu {
+
+using testing::DoAll;
+using testing::Invoke;
+using testing::Return;
+using testing::_;
+
+namespace {
+
+const int32 kCommandBufferSize = 1024 * 1024;
+
+// The sizes the GLES2 client uses by default.
+const unsigned int kStartTransferBufferSize = 1024 * 1024;
+const unsigned int kMinTransferBufferSize = 256 * 1024;
+const unsigned int kMaxTransferBufferSize = 16 * 1024 * 1024;
+const unsigned int kResultSize = 64;
+const unsigned int kAlignment = 4;
+const unsigned int kSizeToFlush = 256 * 1024;
+
+}  // namespace
+
+class TransferBufferPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    api_mock_.reset(new AsyncAPIMock);
+    EXPECT_CALL(*api_mock_, DoCommand(cmd::kNoop, 0, _))
+        .WillRepeatedly(Return(error::kNoError));
+    EXPECT_CALL(*api_mock_.get(), DoCommand(cmd::kSetToken, 1, _))
+        .WillRepeatedly(DoAll(Invoke(api_mock_.get(), &AsyncAPIMock::SetToken),
+                              Return(error::kNoError)));
+
+    TransferBufferManager* manager = new TransferBufferManager();
+    transfer_buffer_manager_.reset(manager);
+    ASSERT_TRUE(manager->Initialize());
+    command_buffer_.reset(
+        new CommandBufferService(transfer_buffer_manager_.get()));
+    ASSERT_TRUE(command_buffer_->Initialize());
+
+    gpu_scheduler_.reset(new GpuScheduler(
+        command_buffer_.get(), api_mock_.get(), NULL));
+    command_buffer_->SetPutOffsetChangeCallback(base::Bind(
+        &GpuScheduler::PutChanged, base::Unretained(gpu_scheduler_.get())));
+    command_buffer_->SetGetBufferChangeCallback(base::Bind(
+        &GpuScheduler::SetGetBuffer, base::Unretained(gpu_scheduler_.get())));
+    api_mock_->set_engine(gpu_scheduler_.get());
+
+    helper_.reset(new CommandBufferHelper(command_buffer_.get()));
+    ASSERT_TRUE(helper_->Initialize(kCommandBufferSize));
+
+    transfer_buffer_.reset(new TransferBuffer(helper_.get()));
+    ASSERT_TRUE(transfer_buffer_->Initialize(kStartTransferBufferSize,
+                                             kResultSize,
+                                             kMinTransferBufferSize,
+                                             kMaxTransferBufferSize,
+                                             kAlignment,
+                                             kSizeToFlush));
+  }
+
+  virtual void TearDown() OVERRIDE {
+    transfer_buffer_.reset();
+    helper_.reset();
+    base::MessageLoop::current()->RunUntilIdle();
+  }
+
+  // Copies |size| bytes into the transfer buffer, in as many pieces as it
+  // takes, the way GLES2Implementation uploads data. Returns the time spent
+  // getting space in the transfer buffer.
+  base::TimeDelta Upload(const std::vector<char>& data) {
+    base::TimeDelta stall_time;
+    size_t offset = 0;
+    while (offset < data.size()) {
+      unsigned int size_allocated = 0;
+      base::TimeTicks start = base::TimeTicks::HighResNow();
+      void* ptr = transfer_buffer_->AllocUpTo(data.size() - offset,
+                                              &size_allocated);
+      stall_time += base::TimeTicks::HighResNow() - start;
+      EXPECT_TRUE(ptr);
+      if (!ptr)
+        break;
+      memcpy(ptr, &data[offset], size_allocated);
+      transfer_buffer_->FreePendingToken(ptr, helper_->InsertToken());
+      offset += size_allocated;
+    }
+    return stall_time;
+  }
+
+#if defined(OS_MACOSX)
+  base::mac::ScopedNSAutoreleasePool autorelease_pool_;
+#endif
+  base::MessageLoop message_loop_;
+  scoped_ptr<AsyncAPIMock> api_mock_;
+  scoped_ptr<TransferBufferManagerInterface> transfer_buffer_manager_;
+  scoped_ptr<CommandBufferService> command_buffer_;
+  scoped_ptr<GpuScheduler> gpu_scheduler_;
+  scoped_ptr<CommandBufferHelper> helper_;
+  scoped_ptr<TransferBuffer> transfer_buffer_;
+};
+
+// Uploads a mix of sizes, with an occasional large one that makes the buffer
+// grow, and gives memory back between rounds as a client under memory
+// pressure would.
+TEST_F(TransferBufferPerfTest, MixedUploads) {
+  const size_t kUploadSizes[] = {
+    16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024, 4 * 1024 * 1024,
+  };
+  const int kRounds = 20;
+
+  std::vector<std::vector<char> > uploads;
+  for (size_t i = 0; i < arraysize(kUploadSizes); ++i)
+    uploads.push_back(std::vector<char>(kUploadSizes[i], static_cast<char>(i)));
+
+  base::TimeDelta stall_time;
+  size_t bytes_uploaded = 0;
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < uploads.size(); ++i) {
+      stall_time += Upload(uploads[i]);
+      bytes_uploaded += uploads[i].size();
+    }
+    transfer_buffer_->ShrinkToDefaultSize();
+  }
+  base::TimeDelta total_time = base::TimeTicks::HighResNow() - start;
+
+  const double megabytes = bytes_uploaded / (1024.0 * 1024.0);
+  perf_test::PrintResult("transfer_buffer",
+                         "",
+                         "stall_per_mb",
+                         stall_time.InMillisecondsF() / megabytes,
+                         "ms/MB",
+                         true);
+  perf_test::PrintResult("transfer_buffer",
+                         "",
+                         "upload_rate",
+                         megabytes / total_time.InSecondsF(),
+                         "MB/s",
+                         false);
+}
+
+}  // namespace gpu
@@ -55,6 +55,11 @@ const int32_t kCommandBufferSharedMemoryId = 4;
 // The size to set for the program cache.
 const size_t kDefaultMaxProgramCacheMemoryBytes = 6 * 1024 * 1024;
 
+// The sizes of the on-disk caches of program binaries and of translated
+// shaders.
+const size_t kDefaultMaxProgramCacheDiskBytes = 32 * 1024 * 1024;
+const size_t kDefaultMaxShaderTranslationCacheDiskBytes = 8 * 1024 * 1024;
+
 }  // namespace gpu
 
 #endif  // GPU_COMMAND_BUFFER_COMMON_CONSTANTS_H_
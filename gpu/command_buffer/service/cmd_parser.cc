@@ -80,6 +80,28 @@ error::Error CommandParser::ProcessCommand() {
   return result;
 }
 
+// Process a run of commands with a single call to the handler. The handler
+// validates the headers as it goes, so that each one is only read once.
+error::Error CommandParser::ProcessCommands(int num_commands) {
+  CommandBufferOffset get = get_;
+  if (get == put_)
+    return error::kNoError;
+
+  // Only hand the handler the entries up to the end of the buffer; the rest
+  // is processed once get wraps.
+  int num_entries = put_ < get ? entry_count_ - get : put_ - get;
+  int entries_processed = 0;
+  error::Error result = handler_->DoCommands(
+      num_commands, buffer_ + get, num_entries, &entries_processed);
+  DCHECK_LE(entries_processed, num_entries);
+
+  // If get was not set somewhere else advance it.
+  if (get == get_)
+    get_ = (get + entries_processed) % entry_count_;
+
+  return result;
+}
+
 void CommandParser::ReportError(unsigned int command_id,
                                 error::Error result) {
   DVLOG(1) << "Error: " << result << " for Command "
@@ -97,4 +119,53 @@ error::Error CommandParser::ProcessAllCommands() {
   return error::kNoError;
 }
 
+error::Error AsyncAPIInterface::DoCommands(unsigned int num_commands,
+                                          const void* buffer,
+                                          int num_entries,
+                                          int* entries_processed) {
+  const CommandBufferEntry* cmd_data =
+      static_cast<const CommandBufferEntry*>(buffer);
+  int process_pos = 0;
+  error::Error result = error::kNoError;
+
+  for (unsigned int i = 0; i < num_commands && process_pos < num_entries;
+       ++i) {
+    CommandHeader header = cmd_data->value_header;
+    if (header.size == 0) {
+      DVLOG(1) << "Error: zero sized command in command buffer";
+      result = error::kInvalidSize;
+      break;
+    }
+
+    if (static_cast<int>(header.size) + process_pos > num_entries) {
+      DVLOG(1) << "Error: get offset out of bounds";
+      result = error::kOutOfBounds;
+      break;
+    }
+
+    TRACE_EVENT0(TRACE_DISABLED_BY_DEFAULT("cb_command"),
+                 GetCommandName(header.command));
+
+    result = DoCommand(header.command, header.size - 1, cmd_data);
+    if (result != error::kDeferCommandUntilLater) {
+      process_pos += header.size;
+      cmd_data += header.size;
+    }
+
+    if (result != error::kNoError) {
+      if (error::IsError(result)) {
+        DVLOG(1) << "Error: " << result << " for Command "
+                 << GetCommandName(header.command);
+      }
+      break;
+    }
+
+    if (descheduled())
+      break;
+  }
+
+  *entries_processed = process_pos;
+  return result;
+}
+
 }  // namespace gpu
@@ -19,6 +19,10 @@ class AsyncAPIInterface;
 // buffer, to implement some asynchronous RPC mechanism.
 class GPU_EXPORT CommandParser {
  public:
+  // The number of commands the scheduler processes between checks for
+  // preemption.
+  static const int kParseCommandsSlice = 20;
+
   explicit CommandParser(AsyncAPIInterface* handler);
 
   // Sets the buffer to read commands from.
@@ -57,6 +61,11 @@ class GPU_EXPORT CommandParser {
   // if there are no commands in the buffer.
   error::Error ProcessCommand();
 
+  // Processes up to |num_commands| commands in one call to the handler,
+  // updating the get pointer. Stops at the end of the buffer, or when a
+  // command fails or has to be retried later.
+  error::Error ProcessCommands(int num_commands);
+
   // Processes all commands until get == put.
   error::Error ProcessAllCommands();
 
@@ -73,9 +82,9 @@ class GPU_EXPORT CommandParser {
 
 // This class defines the interface for an asynchronous API handler, that
 // is responsible for de-multiplexing commands and their arguments.
-class AsyncAPIInterface {
+class GPU_EXPORT AsyncAPIInterface {
  public:
-  AsyncAPIInterface() {}
+  AsyncAPIInterface() : descheduled_(false) {}
   virtual ~AsyncAPIInterface() {}
 
   // Executes a command.
@@ -91,8 +100,34 @@ class AsyncAPIInterface {
       unsigned int arg_count,
       const void* cmd_data) = 0;
 
+  // Executes a run of commands. The default implementation validates each
+  // header and calls DoCommand. The run ends early if a command deschedules
+  // the handler.
+  // Parameters:
+  //    num_commands: the maximum number of commands to execute.
+  //    buffer: the first command.
+  //    num_entries: the number of CommandBufferEntry available in |buffer|.
+  //    entries_processed: set to the number of entries consumed by the
+  //        commands that were executed.
+  // Returns:
+  //   error::kNoError if all the commands were executed, the error of the
+  //   command that stopped the run otherwise. A command that returns
+  //   error::kDeferCommandUntilLater is not counted in |entries_processed|.
+  virtual error::Error DoCommands(unsigned int num_commands,
+                                  const void* buffer,
+                                  int num_entries,
+                                  int* entries_processed);
+
   // Returns a name for a command. Useful for logging / debuging.
   virtual const char* GetCommandName(unsigned int command_id) const = 0;
+
+  // Set by the scheduler while it waits to be rescheduled, so that
+  // DoCommands doesn't run any more commands.
+  void set_descheduled(bool descheduled) { descheduled_ = descheduled; }
+  bool descheduled() const { return descheduled_; }
+
+ private:
+  bool descheduled_;
 };
 
 }  // namespace gpu
@@ -0,0 +1,247 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how many commands per second the CommandParser hands to a decoder,
+// one at a time and in slices.  The decoder does almost no work per command,
+// so the parsing and dispatch overhead dominates.
+
+#include "gpu/command_buffer/service/cmd_parser.h"
+
+#include <string>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace gpu {
+
+namespace {
+
+const int kNumEntries = 64 * 1024;
+const int kNumIterations = 100;
+
+// Commands shaped like small GL calls, with 1, 2 and 4 arguments.
+enum TestCommandId {
+  kTestCommand1 = 256,
+  kTestCommand2,
+  kTestCommand4,
+  kNumTestCommands
+};
+
+struct TestCommand1 {
+  static const TestCommandId kCmdId = kTestCommand1;
+  CommandHeader header;
+  uint32 a;
+};
+
+struct TestCommand2 {
+  static const TestCommandId kCmdId = kTestCommand2;
+  CommandHeader header;
+  uint32 a;
+  uint32 b;
+};
+
+struct TestCommand4 {
+  static const TestCommandId kCmdId = kTestCommand4;
+  CommandHeader header;
+  uint32 a;
+  uint32 b;
+  uint32 c;
+  uint32 d;
+};
+
+// A decoder that sums the arguments of the commands it gets.  DoCommand
+// switches on the command id, and DoCommands goes through a table of
+// handlers, the way GLES2DecoderImpl does.
+class TestDecoder : public AsyncAPIInterface {
+ public:
+  TestDecoder() : sum_(0) {}
+  virtual ~TestDecoder() {}
+
+  virtual error::Error DoCommand(unsigned int command,
+                                 unsigned int arg_count,
+                                 const void* cmd_data) OVERRIDE {
+    switch (command) {
+      case kTestCommand1:
+        return Handle(*static_cast<const TestCommand1*>(cmd_data));
+      case kTestCommand2:
+        return Handle(*static_cast<const TestCommand2*>(cmd_data));
+      case kTestCommand4:
+        return Handle(*static_cast<const TestCommand4*>(cmd_data));
+    }
+    return error::kUnknownCommand;
+  }
+
+  virtual error::Error DoCommands(unsigned int num_commands,
+                                  const void* buffer,
+                                  int num_entries,
+                                  int* entries_processed) OVERRIDE {
+    const CommandBufferEntry* cmd_data =
+        static_cast<const CommandBufferEntry*>(buffer);
+    int process_pos = 0;
+    error::Error result = error::kNoError;
+    for (unsigned int i = 0; i < num_commands && process_pos < num_entries;
+         ++i) {
+      CommandHeader header = cmd_data->value_header;
+      if (header.size == 0) {
+        result = error::kInvalidSize;
+        break;
+      }
+      if (static_cast<int>(header.size) + process_pos > num_entries) {
+        result = error::kOutOfBounds;
+        break;
+      }
+      unsigned int command_index = header.command - kTestCommand1;
+      if (command_index >= arraysize(command_info_)) {
+        result = error::kUnknownCommand;
+        break;
+      }
+      const CommandInfo& info = command_info_[command_index];
+      if (header.size - 1 != info.arg_count) {
+        result = error::kInvalidArguments;
+        break;
+      }
+      result = (this->*info.handler)(cmd_data);
+      if (result != error::kNoError)
+        break;
+      process_pos += header.size;
+      cmd_data += header.size;
+    }
+    *entries_processed = process_pos;
+    return result;
+  }
+
+  virtual const char* GetCommandName(unsigned int command_id) const OVERRIDE {
+    return "";
+  }
+
+  uint32 sum() const { return sum_; }
+
+ private:
+  typedef error::Error (TestDecoder::*Handler)(const void* cmd_data);
+
+  struct CommandInfo {
+    Handler handler;
+    unsigned int arg_count;
+  };
+
+  template <typename T>
+  error::Error Dispatch(const void* cmd_data) {
+    return Handle(*static_cast<const T*>(cmd_data));
+  }
+
+  error::Error Handle(const TestCommand1& c) {
+    sum_ += c.a;
+    return error::kNoError;
+  }
+
+  error::Error Handle(const TestCommand2& c) {
+    sum_ += c.a + c.b;
+    return error::kNoError;
+  }
+
+  error::Error Handle(const TestCommand4& c) {
+    sum_ += c.a + c.b + c.c + c.d;
+    return error::kNoError;
+  }
+
+  static const CommandInfo command_info_[kNumTestCommands - kTestCommand1];
+
+  uint32 sum_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestDecoder);
+};
+
+#define TEST_COMMAND_INFO(name) \
+  { &TestDecoder::Dispatch<name>, \
+    sizeof(name) / sizeof(CommandBufferEntry) - 1 }
+
+const TestDecoder::CommandInfo
+    TestDecoder::command_info_[kNumTestCommands - kTestCommand1] = {
+  TEST_COMMAND_INFO(TestCommand1),
+  TEST_COMMAND_INFO(TestCommand2),
+  TEST_COMMAND_INFO(TestCommand4),
+};
+
+#undef TEST_COMMAND_INFO
+
+template <typename T>
+void AddCommand(CommandBufferEntry* buffer, int* put) {
+  T* cmd = reinterpret_cast<T*>(buffer + *put);
+  cmd->header.command = T::kCmdId;
+  cmd->header.size = sizeof(T) / sizeof(CommandBufferEntry);
+  cmd->a = *put;
+  *put += cmd->header.size;
+}
+
+}  // namespace
+
+class CommandParserPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    buffer_.reset(new CommandBufferEntry[kNumEntries]);
+    parser_.reset(new CommandParser(&decoder_));
+    parser_->SetBuffer(buffer_.get(),
+                       kNumEntries * sizeof(CommandBufferEntry),
+                       0,
+                       kNumEntries * sizeof(CommandBufferEntry));
+
+    // Fill the buffer with a mix of commands, leaving room so that put never
+    // catches up with get.
+    put_ = 0;
+    num_commands_ = 0;
+    while (put_ + 3 * 6 < kNumEntries - 1) {
+      AddCommand<TestCommand1>(buffer_.get(), &put_);
+      AddCommand<TestCommand2>(buffer_.get(), &put_);
+      AddCommand<TestCommand4>(buffer_.get(), &put_);
+      num_commands_ += 3;
+    }
+  }
+
+  void PrintRate(const std::string& trace, base::TimeDelta elapsed) {
+    perf_test::PrintResult(
+        "cmd_parser",
+        "",
+        trace,
+        static_cast<double>(num_commands_) * kNumIterations /
+            elapsed.InSecondsF(),
+        "commands/s",
+        true);
+  }
+
+  TestDecoder decoder_;
+  scoped_ptr<CommandBufferEntry[]> buffer_;
+  scoped_ptr<CommandParser> parser_;
+  int put_;
+  int num_commands_;
+};
+
+TEST_F(CommandParserPerfTest, ProcessCommand) {
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kNumIterations; ++i) {
+    ASSERT_TRUE(parser_->set_get(0));
+    parser_->set_put(put_);
+    while (!parser_->IsEmpty())
+      ASSERT_EQ(error::kNoError, parser_->ProcessCommand());
+  }
+  PrintRate("process_command", base::TimeTicks::HighResNow() - start);
+  EXPECT_NE(0u, decoder_.sum());
+}
+
+TEST_F(CommandParserPerfTest, ProcessCommands) {
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kNumIterations; ++i) {
+    ASSERT_TRUE(parser_->set_get(0));
+    parser_->set_put(put_);
+    while (!parser_->IsEmpty()) {
+      ASSERT_EQ(error::kNoError,
+                parser_->ProcessCommands(CommandParser::kParseCommandsSlice));
+    }
+  }
+  PrintRate("process_commands", base::TimeTicks::HighResNow() - start);
+  EXPECT_NE(0u, decoder_.sum());
+}
+
+}  // namespace gpu
@@ -316,4 +316,116 @@ TEST_F(CommandParserTest, SetBuffer) {
   EXPECT_EQ(0, parser->put());
 }
 
+// Tests processing commands in slices.
+TEST_F(CommandParserTest, TestProcessCommands) {
+  scoped_ptr<CommandParser> parser(MakeParser(10));
+  CommandBufferOffset put = parser->put();
+  CommandHeader header;
+
+  // add 4 commands, the last with 1 arg.
+  for (unsigned int i = 0; i < 3; ++i) {
+    header.size = 1;
+    header.command = i;
+    buffer()[put++].value_header = header;
+  }
+  header.size = 2;
+  header.command = 3;
+  buffer()[put++].value_header = header;
+  buffer()[put++].value_int32 = 5;
+  parser->set_put(put);
+
+  // Only 2 of them fit in the first slice.
+  AddDoCommandExpect(error::kNoError, 0, 0, NULL);
+  AddDoCommandExpect(error::kNoError, 1, 0, NULL);
+  EXPECT_EQ(error::kNoError, parser->ProcessCommands(2));
+  EXPECT_EQ(2, parser->get());
+  Mock::VerifyAndClearExpectations(api_mock());
+
+  // A deferred command is not consumed, and ends the slice.
+  AddDoCommandExpect(error::kNoError, 2, 0, NULL);
+  CommandBufferEntry param;
+  param.value_int32 = 5;
+  AddDoCommandExpect(error::kDeferCommandUntilLater, 3, 1, &param);
+  EXPECT_EQ(error::kDeferCommandUntilLater, parser->ProcessCommands(10));
+  EXPECT_EQ(3, parser->get());
+  Mock::VerifyAndClearExpectations(api_mock());
+
+  AddDoCommandExpect(error::kNoError, 3, 1, &param);
+  EXPECT_EQ(error::kNoError, parser->ProcessCommands(10));
+  EXPECT_EQ(put, parser->get());
+  Mock::VerifyAndClearExpectations(api_mock());
+}
+
+// Tests that a slice stops at the end of the buffer, and that the next one
+// starts from the beginning.
+TEST_F(CommandParserTest, TestProcessCommandsWrap) {
+  scoped_ptr<CommandParser> parser(MakeParser(5));
+  CommandHeader header;
+  header.size = 1;
+  header.command = 1;
+  ASSERT_TRUE(parser->set_get(3));
+  buffer()[3].value_header = header;
+  buffer()[4].value_header = header;
+  header.command = 2;
+  buffer()[0].value_header = header;
+  parser->set_put(1);
+
+  AddDoCommandExpect(error::kNoError, 1, 0, NULL);
+  AddDoCommandExpect(error::kNoError, 1, 0, NULL);
+  EXPECT_EQ(error::kNoError, parser->ProcessCommands(10));
+  EXPECT_EQ(0, parser->get());
+  Mock::VerifyAndClearExpectations(api_mock());
+
+  AddDoCommandExpect(error::kNoError, 2, 0, NULL);
+  EXPECT_EQ(error::kNoError, parser->ProcessCommands(10));
+  EXPECT_EQ(1, parser->get());
+  Mock::VerifyAndClearExpectations(api_mock());
+}
+
+// Tests that a bad header stops a slice after the commands before it.
+TEST_F(CommandParserTest, TestProcessCommandsError) {
+  scoped_ptr<CommandParser> parser(MakeParser(5));
+  CommandBufferOffset put = parser->put();
+  CommandHeader header;
+  header.size = 1;
+  header.command = 3;
+  buffer()[put++].value_header = header;
+  // This one extends past put.
+  header.size = 3;
+  buffer()[put++].value_header = header;
+  parser->set_put(put);
+
+  AddDoCommandExpect(error::kNoError, 3, 0, NULL);
+  EXPECT_EQ(error::kOutOfBounds, parser->ProcessCommands(10));
+  EXPECT_EQ(1, parser->get());
+  Mock::VerifyAndClearExpectations(api_mock());
+}
+
+// Tests that a slice stops after each command while the handler is
+// descheduled.
+TEST_F(CommandParserTest, TestProcessCommandsDescheduled) {
+  scoped_ptr<CommandParser> parser(MakeParser(10));
+  CommandBufferOffset put = parser->put();
+  CommandHeader header;
+  header.size = 1;
+  for (unsigned int i = 0; i < 3; ++i) {
+    header.command = i;
+    buffer()[put++].value_header = header;
+  }
+  parser->set_put(put);
+
+  api_mock()->set_descheduled(true);
+  AddDoCommandExpect(error::kNoError, 0, 0, NULL);
+  EXPECT_EQ(error::kNoError, parser->ProcessCommands(10));
+  EXPECT_EQ(1, parser->get());
+  Mock::VerifyAndClearExpectations(api_mock());
+
+  api_mock()->set_descheduled(false);
+  AddDoCommandExpect(error::kNoError, 1, 0, NULL);
+  AddDoCommandExpect(error::kNoError, 2, 0, NULL);
+  EXPECT_EQ(error::kNoError, parser->ProcessCommands(10));
+  EXPECT_EQ(put, parser->get());
+  Mock::VerifyAndClearExpectations(api_mock());
+}
+
 }  // namespace gpu
@@ -248,26 +248,6 @@ bool ComputeDataSize(
   return true;
 }
 
-// A struct to hold info about each command.
-struct CommandInfo {
-  uint8 arg_flags;   // How to handle the arguments for this command
-  uint8 cmd_flags;   // How to handle this command
-  uint16 arg_count;  // How many arguments are expected for this command.
-};
-
-//     cmds::name::cmd_flags,
-// A table of CommandInfo for all the commands.
-const CommandInfo g_command_info[] = {
-  #define GLES2_CMD_OP(name) {                                             \
-    cmds::name::kArgFlags,                                                 \
-    cmds::name::cmd_flags,                                                 \
-    sizeof(cmds::name) / sizeof(CommandBufferEntry) - 1, },  /* NOLINT */
-
-  GLES2_COMMAND_LIST(GLES2_CMD_OP)
-
-  #undef GLES2_CMD_OP
-};
-
 // Return true if a character belongs to the ASCII subset as defined in
 // GLSL ES 1.0 spec section 3.1.
 static bool CharacterIsValidForGLES(unsigned char c) {
@@ -592,6 +572,12 @@ class GLES2DecoderImpl : public GLES2Decoder,
                           unsigned int arg_count,
                           const void* args) OVERRIDE;
 
+  // Overridden from AsyncAPIInterface.
+  virtual Error DoCommands(unsigned int num_commands,
+                           const void* buffer,
+                           int num_entries,
+                           int* entries_processed) OVERRIDE;
+
   // Overridden from AsyncAPIInterface.
   virtual const char* GetCommandName(unsigned int command_id) const OVERRIDE;
 
@@ -1670,6 +1656,29 @@ class GLES2DecoderImpl : public GLES2Decoder,
 
   #undef GLES2_CMD_OP
 
+  typedef Error (GLES2DecoderImpl::*CmdHandler)(uint32 immediate_data_size,
+                                                const void* cmd_data);
+
+  // Casts |cmd_data| to the command type and calls its handler. One of these
+  // is instantiated for each command, so the table below needs no switch.
+  template <typename T,
+            Error (GLES2DecoderImpl::*Handler)(uint32, const T&)>
+  Error DispatchCommand(uint32 immediate_data_size, const void* cmd_data) {
+    return (this->*Handler)(immediate_data_size,
+                            *static_cast<const T*>(cmd_data));
+  }
+
+  // A struct to hold info about each command.
+  struct CommandInfo {
+    CmdHandler cmd_handler;
+    uint8 arg_flags;   // How to handle the arguments for this command
+    uint8 cmd_flags;   // How to handle this command
+    uint16 arg_count;  // How many arguments are expected for this command.
+  };
+
+  // A table of CommandInfo for all the commands, indexed by command id.
+  static const CommandInfo command_info[kNumCommands - kStartPoint - 1];
+
   // The GL context this decoder renders to on behalf of the client.
   scoped_refptr<gfx::GLSurface> surface_;
   scoped_refptr<gfx::GLContext> context_;
@@ -3730,6 +3739,20 @@ const char* GLES2DecoderImpl::GetCommandName(unsigned int command_id) const {
   return GetCommonCommandName(static_cast<cmd::CommandId>(command_id));
 }
 
+// static
+const GLES2DecoderImpl::CommandInfo GLES2DecoderImpl::command_info[] = {
+  #define GLES2_CMD_OP(name) {                                             \
+    &GLES2DecoderImpl::DispatchCommand<cmds::name,                         \
+                                       &GLES2DecoderImpl::Handle ## name>, \
+    cmds::name::kArgFlags,                                                 \
+    cmds::name::cmd_flags,                                                 \
+    sizeof(cmds::name) / sizeof(CommandBufferEntry) - 1, },  /* NOLINT */
+
+  GLES2_COMMAND_LIST(GLES2_CMD_OP)
+
+  #undef GLES2_CMD_OP
+};
+
 // Decode command with its arguments, and call the corresponding GL function.
 // Note: args is a pointer to the command buffer. As such, it could be changed
 // by a (malicious) client at any time, so if validation has to happen, it
@@ -3746,8 +3769,8 @@ error::Error GLES2DecoderImpl::DoCommand(
                << GetCommandName(command);
   }
   unsigned int command_index = command - kStartPoint - 1;
-  if (command_index < arraysize(g_command_info)) {
-    const CommandInfo& info = g_command_info[command_index];
+  if (command_index < arraysize(command_info)) {
+    const CommandInfo& info = command_info[command_index];
     unsigned int info_arg_count = static_cast<unsigned int>(info.arg_count);
     if ((info.arg_flags == cmd::kFixed && arg_count == info_arg_count) ||
         (info.arg_flags == cmd::kAtLeastN && arg_count >= info_arg_count)) {
@@ -3761,17 +3784,7 @@ error::Error GLES2DecoderImpl::DoCommand(
 
       uint32 immediate_data_size =
           (arg_count - info_arg_count) * sizeof(CommandBufferEntry);  // NOLINT
-      switch (command) {
-        #define GLES2_CMD_OP(name)                                 \
-          case cmds::name::kCmdId:                                 \
-            result = Handle ## name(                               \
-                immediate_data_size,                               \
-                *static_cast<const gles2::cmds::name*>(cmd_data)); \
-            break;                                                 \
-
-        GLES2_COMMAND_LIST(GLES2_CMD_OP)
-        #undef GLES2_CMD_OP
-      }
+      result = (this->*info.cmd_handler)(immediate_data_size, cmd_data);
 
       if (doing_gpu_trace)
         gpu_tracer_->End(kTraceDecoder);
@@ -3798,6 +3811,75 @@ error::Error GLES2DecoderImpl::DoCommand(
   return result;
 }
 
+// Decode a run of commands without going through DoCommand for each one.
+// Logging, tracing and checking for GL errors after each command are left to
+// DoCommand. As in DoCommand, the headers are copied before they are
+// validated.
+error::Error GLES2DecoderImpl::DoCommands(unsigned int num_commands,
+                                          const void* buffer,
+                                          int num_entries,
+                                          int* entries_processed) {
+  if (log_commands() || gpu_trace_commands_ || debug()) {
+    return GLES2Decoder::DoCommands(
+        num_commands, buffer, num_entries, entries_processed);
+  }
+
+  const CommandBufferEntry* cmd_data =
+      static_cast<const CommandBufferEntry*>(buffer);
+  int process_pos = 0;
+  error::Error result = error::kNoError;
+
+  for (unsigned int i = 0; i < num_commands && process_pos < num_entries;
+       ++i) {
+    CommandHeader header = cmd_data->value_header;
+    if (header.size == 0) {
+      result = error::kInvalidSize;
+      break;
+    }
+    if (static_cast<int>(header.size) + process_pos > num_entries) {
+      result = error::kOutOfBounds;
+      break;
+    }
+
+    const unsigned int command = header.command;
+    const unsigned int arg_count = header.size - 1;
+    unsigned int command_index = command - kStartPoint - 1;
+    if (command_index < arraysize(command_info)) {
+      const CommandInfo& info = command_info[command_index];
+      unsigned int info_arg_count = static_cast<unsigned int>(info.arg_count);
+      if ((info.arg_flags == cmd::kFixed && arg_count == info_arg_count) ||
+          (info.arg_flags == cmd::kAtLeastN && arg_count >= info_arg_count)) {
+        uint32 immediate_data_size =
+            (arg_count - info_arg_count) * sizeof(CommandBufferEntry);  // NOLINT
+        result = (this->*info.cmd_handler)(immediate_data_size, cmd_data);
+      } else {
+        result = error::kInvalidArguments;
+      }
+    } else {
+      result = DoCommonCommand(command, arg_count, cmd_data);
+    }
+    if (result == error::kNoError &&
+        current_decoder_error_ != error::kNoError) {
+      result = current_decoder_error_;
+      current_decoder_error_ = error::kNoError;
+    }
+
+    if (result != error::kDeferCommandUntilLater) {
+      process_pos += header.size;
+      cmd_data += header.size;
+    }
+    if (result != error::kNoError)
+      break;
+
+    // The scheduler has to notice before the next command runs.
+    if (descheduled())
+      break;
+  }
+
+  *entries_processed = process_pos;
+  return result;
+}
+
 void GLES2DecoderImpl::RemoveBuffer(GLuint client_id) {
   buffer_manager()->RemoveBuffer(client_id);
 }
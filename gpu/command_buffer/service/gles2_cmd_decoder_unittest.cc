@@ -209,6 +209,50 @@ TEST_P(GLES2DecoderWithShaderTest, GetMaxValueInBufferCHROMIUM) {
   EXPECT_NE(error::kNoError, ExecuteCmd(cmd));
 }
 
+// Runs a slice of commands through DoCommands, both through the command table
+// and, with logging on, through DoCommand.
+TEST_P(GLES2DecoderTest, DoCommands) {
+  struct Cmds {
+    DepthRangef depth_range;
+    BlendColor blend_color;
+    ClearStencil clear_stencil;
+  };
+  Cmds cmds;
+  const int kNumEntries = ComputeNumEntries(sizeof(cmds));
+  const int kDepthRangeEntries = ComputeNumEntries(sizeof(cmds.depth_range));
+
+  for (int i = 0; i < 2; ++i) {
+    SCOPED_TRACE(testing::Message() << "log_commands: " << i);
+    decoder_->set_log_commands(i == 1);
+    // The decoder skips state that doesn't change, so each run sets new
+    // values.
+    const int value = i + 1;
+    cmds.depth_range.Init(0, 1);
+    cmds.blend_color.Init(value, value, value, value);
+    cmds.clear_stencil.Init(value);
+    {
+      InSequence sequence;
+      EXPECT_CALL(*gl_, DepthRange(0, 1)).RetiresOnSaturation();
+      EXPECT_CALL(*gl_, BlendColor(value, value, value, value))
+          .RetiresOnSaturation();
+      EXPECT_CALL(*gl_, ClearStencil(value)).RetiresOnSaturation();
+    }
+    int entries_processed = 0;
+    EXPECT_EQ(error::kNoError,
+              decoder_->DoCommands(3, &cmds, kNumEntries, &entries_processed));
+    EXPECT_EQ(kNumEntries, entries_processed);
+
+    // A descheduled decoder stops after the command that is running.
+    decoder_->set_descheduled(true);
+    EXPECT_CALL(*gl_, DepthRange(0, 1)).RetiresOnSaturation();
+    EXPECT_EQ(error::kNoError,
+              decoder_->DoCommands(3, &cmds, kNumEntries, &entries_processed));
+    EXPECT_EQ(kDepthRangeEntries, entries_processed);
+    decoder_->set_descheduled(false);
+  }
+  decoder_->set_log_commands(false);
+}
+
 TEST_P(GLES2DecoderTest, SharedIds) {
   GenSharedIdsCHROMIUM gen_cmd;
   RegisterSharedIdsCHROMIUM reg_cmd;
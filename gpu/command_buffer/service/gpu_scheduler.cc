@@ -78,18 +78,19 @@ void GpuScheduler::PutChanged() {
     DCHECK(IsScheduled());
     DCHECK(unschedule_fences_.empty());
 
-    error = parser_->ProcessCommand();
-
-    if (error == error::kDeferCommandUntilLater) {
-      DCHECK_GT(unscheduled_count_, 0);
-      break;
-    }
+    error = parser_->ProcessCommands(CommandParser::kParseCommandsSlice);
 
     // TODO(piman): various classes duplicate various pieces of state, leading
     // to needlessly complex update logic. It should be possible to simply
     // share the state across all of them.
     command_buffer_->SetGetOffset(static_cast<int32>(parser_->get()));
 
+    // The commands of the slice before the deferred one did run.
+    if (error == error::kDeferCommandUntilLater) {
+      DCHECK_GT(unscheduled_count_, 0);
+      break;
+    }
+
     if (error::IsError(error)) {
       LOG(ERROR) << "[" << decoder_ << "] "
                  << "GPU PARSE ERROR: " << error;
@@ -136,6 +137,7 @@ void GpuScheduler::SetScheduled(bool scheduled) {
     if (unscheduled_count_ == 0) {
       TRACE_EVENT_ASYNC_END1("gpu", "ProcessingSwap", this,
                              "GpuScheduler", this);
+      handler_->set_descheduled(false);
       // When the scheduler transitions from the unscheduled to the scheduled
       // state, cancel the task that would reschedule it after a timeout.
       reschedule_task_factory_.InvalidateWeakPtrs();
@@ -148,6 +150,9 @@ void GpuScheduler::SetScheduled(bool scheduled) {
     if (unscheduled_count_ == 1) {
       TRACE_EVENT_ASYNC_BEGIN1("gpu", "ProcessingSwap", this,
                                "GpuScheduler", this);
+      // Stops the command that is running from being followed by the rest
+      // of its slice.
+      handler_->set_descheduled(true);
 #if defined(OS_WIN)
       if (base::win::GetVersion() < base::win::VERSION_VISTA) {
         // When the scheduler transitions from scheduled to unscheduled, post a
@@ -18,6 +18,7 @@
 using testing::_;
 using testing::DoAll;
 using testing::Invoke;
+using testing::InvokeWithoutArgs;
 using testing::NiceMock;
 using testing::Return;
 using testing::SetArgumentPointee;
@@ -67,6 +68,12 @@ class GpuSchedulerTest : public testing::Test {
     return command_buffer_->GetLastState().error;
   }
 
+  // Acts like a command that has to wait, e.g. for a fence.
+  error::Error DescheduleAndDefer() {
+    scheduler_->SetScheduled(false);
+    return error::kDeferCommandUntilLater;
+  }
+
 #if defined(OS_MACOSX)
   base::mac::ScopedNSAutoreleasePool autorelease_pool_;
 #endif
@@ -145,10 +152,10 @@ TEST_F(GpuSchedulerTest, ProcessesTwoCommands) {
   EXPECT_CALL(*command_buffer_, GetLastState())
     .WillRepeatedly(Return(state));
 
+  // Both commands are processed in one slice, so the get offset is only
+  // updated once.
   EXPECT_CALL(*decoder_, DoCommand(7, 1, &buffer_[0]))
     .WillOnce(Return(error::kNoError));
-  EXPECT_CALL(*command_buffer_, SetGetOffset(2));
-
   EXPECT_CALL(*decoder_, DoCommand(8, 0, &buffer_[2]))
     .WillOnce(Return(error::kNoError));
   EXPECT_CALL(*command_buffer_, SetGetOffset(3));
@@ -156,6 +163,33 @@ TEST_F(GpuSchedulerTest, ProcessesTwoCommands) {
   scheduler_->PutChanged();
 }
 
+TEST_F(GpuSchedulerTest, UpdatesGetOffsetWhenDeferred) {
+  CommandHeader* header = reinterpret_cast<CommandHeader*>(&buffer_[0]);
+  header[0].command = 7;
+  header[0].size = 2;
+  buffer_[1] = 123;
+  header[2].command = 8;
+  header[2].size = 1;
+
+  CommandBuffer::State state;
+
+  state.put_offset = 3;
+  EXPECT_CALL(*command_buffer_, GetLastState())
+    .WillRepeatedly(Return(state));
+
+  // The first command ran, so the get offset moves past it even though the
+  // second one is deferred.
+  EXPECT_CALL(*decoder_, DoCommand(7, 1, &buffer_[0]))
+    .WillOnce(Return(error::kNoError));
+  EXPECT_CALL(*decoder_, DoCommand(8, 0, &buffer_[2]))
+    .WillOnce(InvokeWithoutArgs(this,
+                                &GpuSchedulerTest::DescheduleAndDefer));
+  EXPECT_CALL(*command_buffer_, SetGetOffset(2));
+
+  scheduler_->PutChanged();
+  EXPECT_FALSE(scheduler_->IsScheduled());
+}
+
 TEST_F(GpuSchedulerTest, SetsErrorCodeOnCommandBuffer) {
   CommandHeader* header = reinterpret_cast<CommandHeader*>(&buffer_[0]);
   header[0].command = 7;
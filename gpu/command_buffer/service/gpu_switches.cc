@@ -52,6 +52,10 @@ const char kGpuProgramCacheSizeKb[]         = "gpu-program-cache-size-kb";
 // Disables the GPU shader on disk cache.
 const char kDisableGpuShaderDiskCache[]     = "disable-gpu-shader-disk-cache";
 
+// Directory in which the GPU process keeps translated shaders and program
+// binaries between runs.
+const char kGpuShaderCacheDir[]             = "gpu-shader-cache-dir";
+
 // Allows async texture uploads (off main thread) via GL context sharing.
 const char kEnableShareGroupAsyncTextureUpload[] =
     "enable-share-group-async-texture-upload";
@@ -71,6 +75,7 @@ const char* kGpuSwitches[] = {
   kGpuDriverBugWorkarounds,
   kGpuProgramCacheSizeKb,
   kDisableGpuShaderDiskCache,
+  kGpuShaderCacheDir,
   kEnableShareGroupAsyncTextureUpload,
 };
 
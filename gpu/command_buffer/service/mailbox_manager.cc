@@ -4,8 +4,6 @@
 
 #include "gpu/command_buffer/service/mailbox_manager.h"
 
-#include <algorithm>
-
 #include "crypto/random.h"
 #include "gpu/command_buffer/service/mailbox_synchronizer.h"
 #include "gpu/command_buffer/service/texture_manager.h"
@@ -13,9 +11,14 @@
 namespace gpu {
 namespace gles2 {
 
+MailboxTargetName::MailboxTargetName(unsigned target, const Mailbox& mailbox)
+    : target(target),
+      mailbox(mailbox) {
+}
+
 MailboxManager::MailboxManager()
-    : mailbox_to_textures_(std::ptr_fun(&MailboxManager::TargetNameLess)),
-      sync_(MailboxSynchronizer::GetInstance()) {
+    : sync_(MailboxSynchronizer::GetInstance()),
+      last_pulled_sync_generation_(-1) {
 }
 
 MailboxManager::~MailboxManager() {
@@ -29,7 +32,7 @@ Texture* MailboxManager::ConsumeTexture(unsigned target,
   MailboxToTextureMap::iterator it =
       mailbox_to_textures_.find(target_name);
   if (it != mailbox_to_textures_.end())
-    return it->second->first;
+    return it->second;
 
   if (sync_) {
     // See if it's visible in another mailbox manager, and if so make it visible
@@ -51,20 +54,32 @@ void MailboxManager::ProduceTexture(unsigned target,
   TargetName target_name(target, mailbox);
   MailboxToTextureMap::iterator it = mailbox_to_textures_.find(target_name);
   if (it != mailbox_to_textures_.end()) {
-    if (it->second->first == texture)
+    if (it->second == texture)
       return;
-    TextureToMailboxMap::iterator texture_it = it->second;
+    // Unlink the mailbox from the texture it named before.  Textures rarely
+    // have more than a few mailboxes, so scanning them is cheap.
+    std::pair<TextureToMailboxMap::iterator,
+              TextureToMailboxMap::iterator> range =
+        textures_to_mailboxes_.equal_range(it->second);
+    for (TextureToMailboxMap::iterator texture_it = range.first;
+         texture_it != range.second; ++texture_it) {
+      if (texture_it->second == target_name) {
+        textures_to_mailboxes_.erase(texture_it);
+        break;
+      }
+    }
     mailbox_to_textures_.erase(it);
-    textures_to_mailboxes_.erase(texture_it);
   }
   InsertTexture(target_name, texture);
 }
 
 void MailboxManager::InsertTexture(TargetName target_name, Texture* texture) {
   texture->SetMailboxManager(this);
-  TextureToMailboxMap::iterator texture_it =
-      textures_to_mailboxes_.insert(std::make_pair(texture, target_name));
-  mailbox_to_textures_.insert(std::make_pair(target_name, texture_it));
+  // The texture may be behind its synchronized definition, so make the next
+  // pull look at it even if no definition changed since the last one.
+  last_pulled_sync_generation_ = -1;
+  textures_to_mailboxes_.insert(std::make_pair(texture, target_name));
+  mailbox_to_textures_.insert(std::make_pair(target_name, texture));
   DCHECK_EQ(mailbox_to_textures_.size(), textures_to_mailboxes_.size());
 }
 
@@ -94,15 +109,5 @@ void MailboxManager::PullTextureUpdates() {
     sync_->PullTextureUpdates(this);
 }
 
-MailboxManager::TargetName::TargetName(unsigned target, const Mailbox& mailbox)
-    : target(target),
-      mailbox(mailbox) {
-}
-
-bool MailboxManager::TargetNameLess(const MailboxManager::TargetName& lhs,
-                                    const MailboxManager::TargetName& rhs) {
-  return memcmp(&lhs, &rhs, sizeof(lhs)) < 0;
-}
-
 }  // namespace gles2
 }  // namespace gpu
@@ -5,10 +5,8 @@
 #ifndef GPU_COMMAND_BUFFER_SERVICE_MAILBOX_MANAGER_H_
 #define GPU_COMMAND_BUFFER_SERVICE_MAILBOX_MANAGER_H_
 
-#include <functional>
-#include <map>
-
-#include "base/memory/linked_ptr.h"
+#include "base/containers/hash_tables.h"
+#include "base/hash.h"
 #include "base/memory/ref_counted.h"
 #include "gpu/command_buffer/common/constants.h"
 #include "gpu/command_buffer/common/mailbox.h"
@@ -23,6 +21,51 @@ class MailboxSynchronizer;
 class Texture;
 class TextureManager;
 
+// A mailbox name together with the texture target it is used with.
+struct MailboxTargetName {
+  MailboxTargetName(unsigned target, const Mailbox& mailbox);
+  bool operator<(const MailboxTargetName& rhs) const {
+    return memcmp(this, &rhs, sizeof(rhs)) < 0;
+  }
+  bool operator!=(const MailboxTargetName& rhs) const {
+    return memcmp(this, &rhs, sizeof(rhs)) != 0;
+  }
+  bool operator==(const MailboxTargetName& rhs) const {
+    return !operator!=(rhs);
+  }
+  unsigned target;
+  Mailbox mailbox;
+};
+
+}  // namespace gles2
+}  // namespace gpu
+
+namespace BASE_HASH_NAMESPACE {
+#if defined(COMPILER_MSVC)
+inline size_t hash_value(const gpu::gles2::MailboxTargetName& key) {
+  return base::Hash(reinterpret_cast<const char*>(&key), sizeof(key));
+}
+#elif defined(COMPILER_GCC)
+template <>
+struct hash<gpu::gles2::MailboxTargetName> {
+  size_t operator()(const gpu::gles2::MailboxTargetName& key) const {
+    return base::Hash(reinterpret_cast<const char*>(&key), sizeof(key));
+  }
+};
+template <>
+struct hash<gpu::gles2::Texture*> {
+  size_t operator()(gpu::gles2::Texture* ptr) const {
+    return hash<size_t>()(reinterpret_cast<size_t>(ptr));
+  }
+};
+#else
+#error define a hash function for your compiler
+#endif  // COMPILER
+}  // namespace BASE_HASH_NAMESPACE
+
+namespace gpu {
+namespace gles2 {
+
 // Manages resources scoped beyond the context or context group level.
 class GPU_EXPORT MailboxManager : public base::RefCounted<MailboxManager> {
  public:
@@ -53,31 +96,24 @@ class GPU_EXPORT MailboxManager : public base::RefCounted<MailboxManager> {
 
   ~MailboxManager();
 
-  struct TargetName {
-    TargetName(unsigned target, const Mailbox& mailbox);
-    unsigned target;
-    Mailbox mailbox;
-  };
+  typedef MailboxTargetName TargetName;
   void InsertTexture(TargetName target_name, Texture* texture);
 
-  static bool TargetNameLess(const TargetName& lhs, const TargetName& rhs);
-
   // This is a bidirectional map between mailbox and textures. We can have
-  // multiple mailboxes per texture, but one texture per mailbox. We keep an
-  // iterator in the MailboxToTextureMap to be able to manage changes to
-  // the TextureToMailboxMap efficiently.
-  typedef std::multimap<Texture*, TargetName> TextureToMailboxMap;
-  typedef std::map<TargetName,
-                   TextureToMailboxMap::iterator,
-                   std::pointer_to_binary_function<const TargetName&,
-                                                   const TargetName&,
-                                                   bool> > MailboxToTextureMap;
+  // multiple mailboxes per texture, but one texture per mailbox. Both
+  // directions are hashed so that produce and consume don't depend on the
+  // number of live mailboxes.
+  typedef base::hash_multimap<Texture*, TargetName> TextureToMailboxMap;
+  typedef base::hash_map<TargetName, Texture*> MailboxToTextureMap;
 
   MailboxToTextureMap mailbox_to_textures_;
   TextureToMailboxMap textures_to_mailboxes_;
 
   MailboxSynchronizer* sync_;
 
+  // The MailboxSynchronizer generation this manager last pulled updates at.
+  int last_pulled_sync_generation_;
+
   DISALLOW_COPY_AND_ASSIGN(MailboxManager);
 };
 }  // namespage gles2
@@ -0,0 +1,122 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/mailbox_manager.h"
+
+#include <string>
+#include <vector>
+
+#include "base/time/time.h"
+#include "gpu/command_buffer/service/gpu_service_test.h"
+#include "gpu/command_buffer/service/texture_manager.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+// Enough live mailboxes to make a linear lookup show up.
+const size_t kNumMailboxes = 4096;
+const int kNumIterations = 100;
+
+}  // namespace
+
+// Measures produce and consume throughput with many live mailboxes.  The
+// textures are never bound, so the mock GL sees no calls.
+class MailboxManagerPerfTest : public GpuServiceTest {
+ public:
+  MailboxManagerPerfTest() {}
+  virtual ~MailboxManagerPerfTest() {}
+
+ protected:
+  virtual void SetUp() OVERRIDE {
+    GpuServiceTest::SetUp();
+    manager_ = new MailboxManager;
+    for (size_t i = 0; i < kNumMailboxes; ++i) {
+      textures_.push_back(new Texture(static_cast<GLuint>(i + 1)));
+      names_.push_back(Mailbox::Generate());
+    }
+  }
+
+  virtual void TearDown() OVERRIDE {
+    for (size_t i = 0; i < textures_.size(); ++i)
+      delete textures_[i];
+    textures_.clear();
+    manager_ = NULL;
+    GpuServiceTest::TearDown();
+  }
+
+  void PrintRate(const std::string& trace,
+                 int64 operations,
+                 base::TimeDelta elapsed) {
+    perf_test::PrintResult("mailbox_manager",
+                           "",
+                           trace,
+                           operations / elapsed.InSecondsF(),
+                           "ops/s",
+                           true);
+  }
+
+  scoped_refptr<MailboxManager> manager_;
+  std::vector<Texture*> textures_;
+  std::vector<Mailbox> names_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MailboxManagerPerfTest);
+};
+
+TEST_F(MailboxManagerPerfTest, ProduceConsume) {
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (size_t i = 0; i < kNumMailboxes; ++i)
+    manager_->ProduceTexture(GL_TEXTURE_2D, names_[i], textures_[i]);
+  PrintRate("produce", kNumMailboxes, base::TimeTicks::HighResNow() - start);
+
+  start = base::TimeTicks::HighResNow();
+  for (int iteration = 0; iteration < kNumIterations; ++iteration) {
+    for (size_t i = 0; i < kNumMailboxes; ++i) {
+      EXPECT_EQ(textures_[i],
+                manager_->ConsumeTexture(GL_TEXTURE_2D, names_[i]));
+    }
+  }
+  PrintRate("consume",
+            static_cast<int64>(kNumMailboxes) * kNumIterations,
+            base::TimeTicks::HighResNow() - start);
+
+  // Misses are what a renderer sees for mailboxes produced in another share
+  // group.
+  start = base::TimeTicks::HighResNow();
+  for (int iteration = 0; iteration < kNumIterations; ++iteration) {
+    for (size_t i = 0; i < kNumMailboxes; ++i) {
+      EXPECT_EQ(NULL, manager_->ConsumeTexture(GL_TEXTURE_CUBE_MAP,
+                                               names_[i]));
+    }
+  }
+  PrintRate("consume_miss",
+            static_cast<int64>(kNumMailboxes) * kNumIterations,
+            base::TimeTicks::HighResNow() - start);
+}
+
+// Moves every mailbox to a different texture, as happens when a producer
+// recycles its textures each frame.
+TEST_F(MailboxManagerPerfTest, Reproduce) {
+  for (size_t i = 0; i < kNumMailboxes; ++i)
+    manager_->ProduceTexture(GL_TEXTURE_2D, names_[i], textures_[i]);
+
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int iteration = 1; iteration <= kNumIterations; ++iteration) {
+    for (size_t i = 0; i < kNumMailboxes; ++i) {
+      manager_->ProduceTexture(GL_TEXTURE_2D,
+                               names_[i],
+                               textures_[(i + iteration) % kNumMailboxes]);
+    }
+  }
+  PrintRate("reproduce",
+            static_cast<int64>(kNumMailboxes) * kNumIterations,
+            base::TimeTicks::HighResNow() - start);
+}
+
+}  // namespace gles2
+}  // namespace gpu
@@ -465,7 +465,45 @@ TEST_F(MailboxManagerSyncTest, ProduceConsumeBidirectional) {
   DestroyTexture(new_texture2);
 }
 
-// TODO: different texture into same mailbox
+// Produces a different texture into a mailbox that was already shared, and
+// makes sure the other manager picks up the new texture.
+TEST_F(MailboxManagerSyncTest, ProduceDifferentTextureIntoSameMailbox) {
+  const GLuint kNewTextureId = 1234;
+  InSequence sequence;
+
+  Texture* texture1 = DefineTexture();
+  Texture* texture2 = DefineTexture();
+  EXPECT_EQ(static_cast<GLenum>(GL_NO_ERROR),
+            SetParameter(texture2, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+  Mailbox name = Mailbox::Generate();
+
+  manager_->ProduceTexture(GL_TEXTURE_2D, name, texture1);
+  manager_->PushTextureUpdates();
+  manager_->ProduceTexture(GL_TEXTURE_2D, name, texture2);
+  manager_->PushTextureUpdates();
+
+  // The mailbox no longer refers to texture1, so deleting it doesn't affect
+  // the mailbox.
+  DestroyTexture(texture1);
+  EXPECT_EQ(texture2, manager_->ConsumeTexture(GL_TEXTURE_2D, name));
+
+  EXPECT_CALL(*gl_, GenTextures(1, _))
+      .WillOnce(SetArgPointee<1>(kNewTextureId));
+  SetupUpdateTexParamExpectations(
+      kNewTextureId, GL_NEAREST, GL_LINEAR, GL_REPEAT, GL_REPEAT);
+  Texture* new_texture = manager2_->ConsumeTexture(GL_TEXTURE_2D, name);
+  EXPECT_FALSE(new_texture == NULL);
+  EXPECT_EQ(kNewTextureId, new_texture->service_id());
+
+  // Nothing changed since the last push, so pulling doesn't touch the texture.
+  manager2_->PullTextureUpdates();
+  manager2_->PullTextureUpdates();
+
+  DestroyTexture(texture2);
+  DestroyTexture(new_texture);
+  EXPECT_EQ(NULL, manager_->ConsumeTexture(GL_TEXTURE_2D, name));
+  EXPECT_EQ(NULL, manager2_->ConsumeTexture(GL_TEXTURE_2D, name));
+}
 
 // TODO: same texture, multiple mailboxes
 
@@ -60,10 +60,6 @@ MailboxSynchronizer* MailboxSynchronizer::GetInstance() {
   return g_instance;
 }
 
-MailboxSynchronizer::TargetName::TargetName(unsigned target,
-                                            const Mailbox& mailbox)
-    : target(target), mailbox(mailbox) {}
-
 MailboxSynchronizer::TextureGroup::TextureGroup(
     const TextureDefinition& definition)
     : definition(definition) {}
@@ -71,51 +67,43 @@ MailboxSynchronizer::TextureGroup::TextureGroup(
 MailboxSynchronizer::TextureGroup::~TextureGroup() {}
 
 MailboxSynchronizer::TextureVersion::TextureVersion(
-    linked_ptr<TextureGroup> group)
+    scoped_refptr<TextureGroup> group)
     : version(group->definition.version()), group(group) {}
 
 MailboxSynchronizer::TextureVersion::~TextureVersion() {}
 
-MailboxSynchronizer::MailboxSynchronizer() {}
+MailboxSynchronizer::MailboxSynchronizer() : generation_(0) {}
 
 MailboxSynchronizer::~MailboxSynchronizer() {
   DCHECK_EQ(0U, textures_.size());
+  DCHECK_EQ(0U, mailbox_to_group_.size());
 }
 
 void MailboxSynchronizer::ReassociateMailboxLocked(
     const TargetName& target_name,
     TextureGroup* group) {
   lock_.AssertAcquired();
-  for (TextureMap::iterator it = textures_.begin(); it != textures_.end();
-       it++) {
-    std::set<TargetName>::iterator mb_it =
-        it->second.group->mailboxes.find(target_name);
-    if (it->second.group != group &&
-        mb_it != it->second.group->mailboxes.end()) {
-      it->second.group->mailboxes.erase(mb_it);
-    }
-  }
+  TextureGroup*& mailbox_group = mailbox_to_group_[target_name];
+  if (mailbox_group && mailbox_group != group)
+    mailbox_group->mailboxes.erase(target_name);
+  mailbox_group = group;
   group->mailboxes.insert(target_name);
 }
 
-linked_ptr<MailboxSynchronizer::TextureGroup>
+scoped_refptr<MailboxSynchronizer::TextureGroup>
 MailboxSynchronizer::GetGroupForMailboxLocked(const TargetName& target_name) {
   lock_.AssertAcquired();
-  for (TextureMap::iterator it = textures_.begin(); it != textures_.end();
-       it++) {
-    std::set<TargetName>::const_iterator mb_it =
-        it->second.group->mailboxes.find(target_name);
-    if (mb_it != it->second.group->mailboxes.end())
-      return it->second.group;
-  }
-  return make_linked_ptr<MailboxSynchronizer::TextureGroup>(NULL);
+  MailboxToGroupMap::const_iterator it = mailbox_to_group_.find(target_name);
+  if (it != mailbox_to_group_.end())
+    return it->second;
+  return NULL;
 }
 
 Texture* MailboxSynchronizer::CreateTextureFromMailbox(unsigned target,
                                                        const Mailbox& mailbox) {
   base::AutoLock lock(lock_);
   TargetName target_name(target, mailbox);
-  linked_ptr<TextureGroup> group = GetGroupForMailboxLocked(target_name);
+  scoped_refptr<TextureGroup> group = GetGroupForMailboxLocked(target_name);
   if (group.get()) {
     Texture* new_texture = group->definition.CreateTexture();
     if (new_texture)
@@ -132,6 +120,18 @@ void MailboxSynchronizer::TextureDeleted(Texture* texture) {
   if (it != textures_.end()) {
     // TODO: We could avoid the update if this was the last ref.
     UpdateTextureLocked(it->first, it->second);
+    TextureGroup* group = it->second.group.get();
+    if (group->HasOneRef()) {
+      // The group goes away with its last texture, and its mailboxes with it.
+      for (std::set<TargetName>::const_iterator mb_it =
+               group->mailboxes.begin();
+           mb_it != group->mailboxes.end(); ++mb_it) {
+        MailboxToGroupMap::iterator group_it = mailbox_to_group_.find(*mb_it);
+        DCHECK(group_it != mailbox_to_group_.end());
+        DCHECK_EQ(group, group_it->second);
+        mailbox_to_group_.erase(group_it);
+      }
+    }
     textures_.erase(it);
   }
 }
@@ -142,8 +142,8 @@ void MailboxSynchronizer::PushTextureUpdates(MailboxManager* manager) {
            manager->mailbox_to_textures_.begin();
        texture_it != manager->mailbox_to_textures_.end();
        texture_it++) {
-    TargetName target_name(texture_it->first.target, texture_it->first.mailbox);
-    Texture* texture = texture_it->second->first;
+    const TargetName& target_name = texture_it->first;
+    Texture* texture = texture_it->second;
     // TODO(sievers): crbug.com/352274
     // Should probably only fail if it already *has* mipmaps, while allowing
     // incomplete textures here. Also reconsider how to fail otherwise.
@@ -171,8 +171,8 @@ void MailboxSynchronizer::PushTextureUpdates(MailboxManager* manager) {
       if (texture->pool() == GL_TEXTURE_POOL_MANAGED_CHROMIUM)
         continue;
 
-      linked_ptr<TextureGroup> group = make_linked_ptr(new TextureGroup(
-          TextureDefinition(target_name.target, texture, 1, NULL)));
+      scoped_refptr<TextureGroup> group = new TextureGroup(
+          TextureDefinition(target_name.target, texture, 1, NULL));
 
       // Unlink other textures from this mailbox in case the name is not new.
       ReassociateMailboxLocked(target_name, group.get());
@@ -206,15 +206,26 @@ void MailboxSynchronizer::UpdateTextureLocked(Texture* texture,
                                         texture,
                                         ++texture_version.version,
                                         gl_image ? image_buffer : NULL);
+  base::subtle::Barrier_AtomicIncrement(&generation_, 1);
 }
 
 void MailboxSynchronizer::PullTextureUpdates(MailboxManager* manager) {
+  // Definitions only change when a manager pushes updates or deletes a
+  // texture, so most pulls have nothing to do.  Check for that without
+  // contending for |lock_|.
+  if (base::subtle::Acquire_Load(&generation_) ==
+      manager->last_pulled_sync_generation_) {
+    return;
+  }
+
   base::AutoLock lock(lock_);
+  manager->last_pulled_sync_generation_ =
+      base::subtle::NoBarrier_Load(&generation_);
   for (MailboxManager::MailboxToTextureMap::const_iterator texture_it =
            manager->mailbox_to_textures_.begin();
        texture_it != manager->mailbox_to_textures_.end();
        texture_it++) {
-    Texture* texture = texture_it->second->first;
+    Texture* texture = texture_it->second;
     TextureMap::iterator it = textures_.find(texture);
     if (it != textures_.end()) {
       TextureDefinition& definition = it->second.group->definition;
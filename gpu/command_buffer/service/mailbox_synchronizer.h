@@ -10,15 +10,17 @@
 #include <map>
 #include <set>
 
-#include "base/memory/linked_ptr.h"
+#include "base/atomicops.h"
+#include "base/containers/hash_tables.h"
+#include "base/memory/ref_counted.h"
 #include "base/synchronization/lock.h"
+#include "gpu/command_buffer/service/mailbox_manager.h"
 #include "gpu/command_buffer/service/texture_definition.h"
 #include "gpu/gpu_export.h"
 
 namespace gpu {
 namespace gles2 {
 
-class MailboxManager;
 class Texture;
 
 // A thread-safe proxy that can be used to emulate texture sharing across
@@ -42,44 +44,43 @@ class MailboxSynchronizer {
  private:
   MailboxSynchronizer();
 
-  struct TargetName {
-    TargetName(unsigned target, const Mailbox& mailbox);
-    bool operator<(const TargetName& rhs) const {
-      return memcmp(this, &rhs, sizeof(rhs)) < 0;
-    }
-    bool operator!=(const TargetName& rhs) const {
-      return memcmp(this, &rhs, sizeof(rhs)) != 0;
-    }
-    bool operator==(const TargetName& rhs) const {
-      return !operator!=(rhs);
-    }
-    unsigned target;
-    Mailbox mailbox;
-  };
+  typedef MailboxTargetName TargetName;
 
   base::Lock lock_;
 
-  struct TextureGroup {
+  struct TextureGroup : public base::RefCounted<TextureGroup> {
     explicit TextureGroup(const TextureDefinition& definition);
-    ~TextureGroup();
 
     TextureDefinition definition;
     std::set<TargetName> mailboxes;
    private:
+    friend class base::RefCounted<TextureGroup>;
+    ~TextureGroup();
+
     DISALLOW_COPY_AND_ASSIGN(TextureGroup);
   };
 
   struct TextureVersion {
-    explicit TextureVersion(linked_ptr<TextureGroup> group);
+    explicit TextureVersion(scoped_refptr<TextureGroup> group);
     ~TextureVersion();
 
     unsigned int version;
-    linked_ptr<TextureGroup> group;
+    scoped_refptr<TextureGroup> group;
   };
   typedef std::map<Texture*, TextureVersion> TextureMap;
   TextureMap textures_;
 
-  linked_ptr<TextureGroup> GetGroupForMailboxLocked(
+  // The group each mailbox currently belongs to.  A mailbox is in at most one
+  // group, so this replaces searching the groups of all textures.
+  typedef base::hash_map<TargetName, TextureGroup*> MailboxToGroupMap;
+  MailboxToGroupMap mailbox_to_group_;
+
+  // Incremented whenever a texture definition changes, so that managers can
+  // tell without taking |lock_| that there is nothing new to pull.  Only
+  // written while holding |lock_|.
+  base::subtle::Atomic32 generation_;
+
+  scoped_refptr<TextureGroup> GetGroupForMailboxLocked(
       const TargetName& target_name);
   void ReassociateMailboxLocked(
       const TargetName& target_name,
@@ -88,15 +88,33 @@ void FillShaderProto(ShaderProto* proto, const char* sha,
   StoreShaderInfo(VARYING_MAP, proto, shader->varying_map());
 }
 
-void RunShaderCallback(const ShaderCacheCallback& callback,
-                       GpuProgramProto* proto,
-                       std::string sha_string) {
-  std::string shader;
-  proto->SerializeToString(&shader);
+std::string SerializeProgram(const char* sha,
+                             GLenum format,
+                             const char* binary,
+                             GLsizei length,
+                             const char* a_sha,
+                             const Shader* shader_a,
+                             const char* b_sha,
+                             const Shader* shader_b) {
+  scoped_ptr<GpuProgramProto> proto(GpuProgramProto::default_instance().New());
+  proto->set_sha(sha, ProgramCache::kHashLength);
+  proto->set_format(format);
+  proto->set_program(binary, length);
+
+  FillShaderProto(proto->mutable_vertex_shader(), a_sha, shader_a);
+  FillShaderProto(proto->mutable_fragment_shader(), b_sha, shader_b);
 
+  std::string program;
+  proto->SerializeToString(&program);
+  return program;
+}
+
+void RunShaderCallback(const ShaderCacheCallback& callback,
+                       const std::string& program,
+                       const std::string& sha_string) {
   std::string key;
   base::Base64Encode(sha_string, &key);
-  callback.Run(key, shader);
+  callback.Run(key, program);
 }
 
 }  // namespace
@@ -113,6 +131,14 @@ MemoryProgramCache::MemoryProgramCache(const size_t max_cache_size_bytes)
       store_(ProgramMRUCache::NO_AUTO_EVICT) {
 }
 
+MemoryProgramCache::MemoryProgramCache(
+    scoped_ptr<ShaderCacheStore> cache_store)
+    : max_size_bytes_(GetCacheSizeBytes()),
+      curr_size_bytes_(0),
+      store_(ProgramMRUCache::NO_AUTO_EVICT),
+      cache_store_(cache_store.Pass()) {
+}
+
 MemoryProgramCache::~MemoryProgramCache() {}
 
 void MemoryProgramCache::ClearBackend() {
@@ -120,6 +146,34 @@ void MemoryProgramCache::ClearBackend() {
   DCHECK_EQ(0U, curr_size_bytes_);
 }
 
+bool MemoryProgramCache::IsProgramStored(
+    const std::string& program_hash) const {
+  return cache_store_ && cache_store_->Contains(GetStoreKey(program_hash));
+}
+
+bool MemoryProgramCache::LoadFromCacheStore(const std::string& program_hash) {
+  std::string program;
+  if (!cache_store_ ||
+      !cache_store_->Get(GetStoreKey(program_hash), &program)) {
+    return false;
+  }
+  LoadProgram(program);
+  return true;
+}
+
+std::string MemoryProgramCache::GetStoreKey(
+    const std::string& program_hash) const {
+  if (driver_id_.empty()) {
+    const char* renderer =
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version =
+        reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    driver_id_ = std::string(":Renderer:") + (renderer ? renderer : "") +
+                 ":Version:" + (version ? version : "");
+  }
+  return base::SHA1HashString(program_hash + driver_id_);
+}
+
 ProgramCache::ProgramLoadResult MemoryProgramCache::LoadLinkedProgram(
     GLuint program,
     Shader* shader_a,
@@ -145,6 +199,8 @@ ProgramCache::ProgramLoadResult MemoryProgramCache::LoadLinkedProgram(
   const std::string sha_string(sha, kHashLength);
 
   ProgramMRUCache::iterator found = store_.Get(sha_string);
+  if (found == store_.end() && LoadFromCacheStore(sha_string))
+    found = store_.Get(sha_string);
   if (found == store_.end()) {
     return PROGRAM_LOAD_FAILURE;
   }
@@ -168,15 +224,11 @@ ProgramCache::ProgramLoadResult MemoryProgramCache::LoadLinkedProgram(
   if (!shader_callback.is_null() &&
       !CommandLine::ForCurrentProcess()->HasSwitch(
           switches::kDisableGpuShaderDiskCache)) {
-    scoped_ptr<GpuProgramProto> proto(
-        GpuProgramProto::default_instance().New());
-    proto->set_sha(sha, kHashLength);
-    proto->set_format(value->format());
-    proto->set_program(value->data(), value->length());
-
-    FillShaderProto(proto->mutable_vertex_shader(), a_sha, shader_a);
-    FillShaderProto(proto->mutable_fragment_shader(), b_sha, shader_b);
-    RunShaderCallback(shader_callback, proto.get(), sha_string);
+    RunShaderCallback(shader_callback,
+                      SerializeProgram(sha, value->format(), value->data(),
+                                       value->length(), a_sha, shader_a,
+                                       b_sha, shader_b),
+                      sha_string);
   }
 
   return PROGRAM_LOAD_SUCCESS;
@@ -234,18 +286,17 @@ void MemoryProgramCache::SaveLinkedProgram(
     store_.Erase(store_.rbegin());
   }
 
-  if (!shader_callback.is_null() &&
+  const bool run_shader_callback =
+      !shader_callback.is_null() &&
       !CommandLine::ForCurrentProcess()->HasSwitch(
-          switches::kDisableGpuShaderDiskCache)) {
-    scoped_ptr<GpuProgramProto> proto(
-        GpuProgramProto::default_instance().New());
-    proto->set_sha(sha, kHashLength);
-    proto->set_format(format);
-    proto->set_program(binary.get(), length);
-
-    FillShaderProto(proto->mutable_vertex_shader(), a_sha, shader_a);
-    FillShaderProto(proto->mutable_fragment_shader(), b_sha, shader_b);
-    RunShaderCallback(shader_callback, proto.get(), sha_string);
+          switches::kDisableGpuShaderDiskCache);
+  if (run_shader_callback || cache_store_) {
+    const std::string program = SerializeProgram(
+        sha, format, binary.get(), length, a_sha, shader_a, b_sha, shader_b);
+    if (run_shader_callback)
+      RunShaderCallback(shader_callback, program, sha_string);
+    if (cache_store_)
+      cache_store_->Put(GetStoreKey(sha_string), program);
   }
 
   store_.Put(sha_string,
@@ -305,8 +356,19 @@ void MemoryProgramCache::LoadProgram(const std::string& program) {
                          &fragment_varyings);
     }
 
-    scoped_ptr<char[]> binary(new char[proto->program().length()]);
-    memcpy(binary.get(), proto->program().c_str(), proto->program().length());
+    const size_t length = proto->program().length();
+    if (length > max_size_bytes_)
+      return;
+    ProgramMRUCache::iterator existing = store_.Peek(proto->sha());
+    if (existing != store_.end())
+      store_.Erase(existing);
+    while (curr_size_bytes_ + length > max_size_bytes_) {
+      DCHECK(!store_.empty());
+      store_.Erase(store_.rbegin());
+    }
+
+    scoped_ptr<char[]> binary(new char[length]);
+    memcpy(binary.get(), proto->program().c_str(), length);
 
     store_.Put(proto->sha(),
                new ProgramCacheValue(proto->program().length(),
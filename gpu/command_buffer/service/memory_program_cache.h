@@ -14,16 +14,19 @@
 #include "base/memory/scoped_ptr.h"
 #include "gpu/command_buffer/service/gles2_cmd_decoder.h"
 #include "gpu/command_buffer/service/program_cache.h"
+#include "gpu/command_buffer/service/shader_cache_store.h"
 #include "gpu/command_buffer/service/shader_translator.h"
 
 namespace gpu {
 namespace gles2 {
 
-// Program cache that stores binaries completely in-memory
+// Program cache that stores binaries completely in-memory, optionally backed
+// by a ShaderCacheStore that programs are loaded from when they're first used.
 class GPU_EXPORT MemoryProgramCache : public ProgramCache {
  public:
   MemoryProgramCache();
   explicit MemoryProgramCache(const size_t max_cache_size_bytes);
+  explicit MemoryProgramCache(scoped_ptr<ShaderCacheStore> cache_store);
   virtual ~MemoryProgramCache();
 
   virtual ProgramLoadResult LoadLinkedProgram(
@@ -47,6 +50,14 @@ class GPU_EXPORT MemoryProgramCache : public ProgramCache {
 
  private:
   virtual void ClearBackend() OVERRIDE;
+  virtual bool IsProgramStored(const std::string& program_hash) const OVERRIDE;
+
+  // Loads the program for |program_hash| from |cache_store_| into |store_|.
+  bool LoadFromCacheStore(const std::string& program_hash);
+
+  // Returns the key of |program_hash| in |cache_store_|.  It also covers the
+  // GL driver, since a binary saved by one driver may not load in another.
+  std::string GetStoreKey(const std::string& program_hash) const;
 
   class ProgramCacheValue : public base::RefCounted<ProgramCacheValue> {
    public:
@@ -138,6 +149,10 @@ class GPU_EXPORT MemoryProgramCache : public ProgramCache {
   const size_t max_size_bytes_;
   size_t curr_size_bytes_;
   ProgramMRUCache store_;
+  scoped_ptr<ShaderCacheStore> cache_store_;
+
+  // GL_RENDERER and GL_VERSION, read the first time a store key is needed.
+  mutable std::string driver_id_;
 
   DISALLOW_COPY_AND_ASSIGN(MemoryProgramCache);
 };
@@ -5,6 +5,7 @@
 #include "gpu/command_buffer/service/memory_program_cache.h"
 
 #include "base/bind.h"
+#include "base/files/scoped_temp_dir.h"
 #include "gpu/command_buffer/common/gles2_cmd_format.h"
 #include "gpu/command_buffer/service/gl_utils.h"
 #include "gpu/command_buffer/service/gpu_service_test.h"
@@ -17,6 +18,7 @@
 using ::testing::_;
 using ::testing::ElementsAreArray;
 using ::testing::Invoke;
+using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::SetArrayArgument;
 
@@ -162,6 +164,14 @@ class MemoryProgramCacheTest : public GpuServiceTest {
                 .WillOnce(SetArgPointee<2>(GL_TRUE));
   }
 
+  // A cache with a store reads the driver strings once.
+  void SetExpectationsForGetDriverStrings(const char* gl_version) const {
+    EXPECT_CALL(*gl_.get(), GetString(GL_RENDERER))
+        .WillOnce(Return(reinterpret_cast<const GLubyte*>("Test Renderer")));
+    EXPECT_CALL(*gl_.get(), GetString(GL_VERSION))
+        .WillOnce(Return(reinterpret_cast<const GLubyte*>(gl_version)));
+  }
+
   void SetExpectationsForLoadLinkedProgramFailure(
       const GLint program_id,
       ProgramBinaryEmulator* emulator) const {
@@ -299,6 +309,116 @@ TEST_F(MemoryProgramCacheTest, CacheLoadMatchesSave) {
 #endif
 }
 
+// Programs saved with a cache store are loaded from it by a new cache, as
+// they would be after the GPU process restarts.
+TEST_F(MemoryProgramCacheTest, LoadFromCacheStore) {
+  const GLenum kFormat = 1;
+  const int kProgramId = 10;
+  const int kBinaryLength = 20;
+  const size_t kStoreSizeBytes = 64 * 1024;
+  char test_binary[kBinaryLength];
+  for (int i = 0; i < kBinaryLength; ++i) {
+    test_binary[i] = i;
+  }
+  ProgramBinaryEmulator emulator(kBinaryLength, kFormat, test_binary);
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  cache_.reset(new MemoryProgramCache(make_scoped_ptr(
+      new ShaderCacheStore(temp_dir.path(), kStoreSizeBytes, "1.0"))));
+  SetExpectationsForGetDriverStrings("3.0 Test 1.0");
+  SetExpectationsForSaveLinkedProgram(kProgramId, &emulator);
+  cache_->SaveLinkedProgram(kProgramId, vertex_shader_, NULL,
+                            fragment_shader_, NULL, NULL,
+                            ShaderCacheCallback());
+
+  VariableMap vertex_attrib_map = vertex_shader_->attrib_map();
+  VariableMap fragment_uniform_map = fragment_shader_->uniform_map();
+  vertex_shader_->set_attrib_map(VariableMap());
+  fragment_shader_->set_uniform_map(VariableMap());
+
+  cache_.reset(new MemoryProgramCache(make_scoped_ptr(
+      new ShaderCacheStore(temp_dir.path(), kStoreSizeBytes, "1.0"))));
+  SetExpectationsForGetDriverStrings("3.0 Test 1.0");
+  EXPECT_EQ(ProgramCache::LINK_SUCCEEDED, cache_->GetLinkedProgramStatus(
+      *vertex_shader_->signature_source(),
+      NULL,
+      *fragment_shader_->signature_source(),
+      NULL,
+      NULL));
+
+  SetExpectationsForLoadLinkedProgram(kProgramId, &emulator);
+  EXPECT_EQ(ProgramCache::PROGRAM_LOAD_SUCCESS, cache_->LoadLinkedProgram(
+      kProgramId,
+      vertex_shader_,
+      NULL,
+      fragment_shader_,
+      NULL,
+      NULL,
+      ShaderCacheCallback()));
+
+#if !defined(OS_ANDROID)
+  EXPECT_EQ(vertex_attrib_map, vertex_shader_->attrib_map());
+  EXPECT_EQ(fragment_uniform_map, fragment_shader_->uniform_map());
+#endif
+}
+
+// Programs saved by another GL driver are not loaded from the cache store,
+// and linking them again stores the new binary.
+TEST_F(MemoryProgramCacheTest, CacheStoreMissAfterDriverUpdate) {
+  const GLenum kFormat = 1;
+  const int kProgramId = 10;
+  const int kBinaryLength = 20;
+  const size_t kStoreSizeBytes = 64 * 1024;
+  char test_binary[kBinaryLength];
+  for (int i = 0; i < kBinaryLength; ++i) {
+    test_binary[i] = i;
+  }
+  ProgramBinaryEmulator emulator(kBinaryLength, kFormat, test_binary);
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  cache_.reset(new MemoryProgramCache(make_scoped_ptr(
+      new ShaderCacheStore(temp_dir.path(), kStoreSizeBytes, "1.0"))));
+  SetExpectationsForGetDriverStrings("3.0 Test 1.0");
+  SetExpectationsForSaveLinkedProgram(kProgramId, &emulator);
+  cache_->SaveLinkedProgram(kProgramId, vertex_shader_, NULL,
+                            fragment_shader_, NULL, NULL,
+                            ShaderCacheCallback());
+
+  cache_.reset(new MemoryProgramCache(make_scoped_ptr(
+      new ShaderCacheStore(temp_dir.path(), kStoreSizeBytes, "1.0"))));
+  SetExpectationsForGetDriverStrings("3.0 Test 2.0");
+  EXPECT_EQ(ProgramCache::LINK_UNKNOWN, cache_->GetLinkedProgramStatus(
+      *vertex_shader_->signature_source(),
+      NULL,
+      *fragment_shader_->signature_source(),
+      NULL,
+      NULL));
+  EXPECT_EQ(ProgramCache::PROGRAM_LOAD_FAILURE, cache_->LoadLinkedProgram(
+      kProgramId,
+      vertex_shader_,
+      NULL,
+      fragment_shader_,
+      NULL,
+      NULL,
+      ShaderCacheCallback()));
+
+  SetExpectationsForSaveLinkedProgram(kProgramId, &emulator);
+  cache_->SaveLinkedProgram(kProgramId, vertex_shader_, NULL,
+                            fragment_shader_, NULL, NULL,
+                            ShaderCacheCallback());
+  cache_.reset(new MemoryProgramCache(make_scoped_ptr(
+      new ShaderCacheStore(temp_dir.path(), kStoreSizeBytes, "1.0"))));
+  SetExpectationsForGetDriverStrings("3.0 Test 2.0");
+  EXPECT_EQ(ProgramCache::LINK_SUCCEEDED, cache_->GetLinkedProgramStatus(
+      *vertex_shader_->signature_source(),
+      NULL,
+      *fragment_shader_->signature_source(),
+      NULL,
+      NULL));
+}
+
 TEST_F(MemoryProgramCacheTest, LoadProgramMatchesSave) {
   const GLenum kFormat = 1;
   const int kProgramId = 10;
@@ -39,7 +39,8 @@ ProgramCache::LinkedProgramStatus ProgramCache::GetLinkedProgramStatus(
 
   LinkStatusMap::const_iterator found = link_status_.find(sha_string);
   if (found == link_status_.end()) {
-    return ProgramCache::LINK_UNKNOWN;
+    return IsProgramStored(sha_string) ? ProgramCache::LINK_SUCCEEDED :
+                                         ProgramCache::LINK_UNKNOWN;
   } else {
     return found->second;
   }
@@ -84,6 +85,10 @@ void ProgramCache::Evict(const std::string& program_hash) {
   link_status_.erase(program_hash);
 }
 
+bool ProgramCache::IsProgramStored(const std::string& program_hash) const {
+  return false;
+}
+
 namespace {
 size_t CalculateMapSize(const std::map<std::string, GLint>* map) {
   if (!map) {
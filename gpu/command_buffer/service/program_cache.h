@@ -101,6 +101,10 @@ class GPU_EXPORT ProgramCache {
   void Evict(const std::string& program_hash);
 
  private:
+  // Returns true if the backend has |program_hash| somewhere it can load it
+  // from, even though it isn't known to have been linked in this process.
+  virtual bool IsProgramStored(const std::string& program_hash) const;
+
   typedef base::hash_map<std::string,
                          LinkedProgramStatus> LinkStatusMap;
 
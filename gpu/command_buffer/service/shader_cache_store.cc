@@ -0,0 +1,208 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/shader_cache_store.h"
+
+#include <string.h>
+
+#include "base/file_util.h"
+#include "base/hash.h"
+#include "base/logging.h"
+#include "base/metrics/histogram.h"
+#include "base/sha1.h"
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+const base::FilePath::CharType kIndexFileName[] = FILE_PATH_LITERAL("index");
+const base::FilePath::CharType kDataFileName[] = FILE_PATH_LITERAL("data");
+
+// The index file starts with a magic number and a format version, followed
+// by IndexRecords.  The data file holds nothing but the values.
+const uint32 kIndexMagic = 0x43534447;  // "GDSC"
+const uint32 kIndexVersion = 1;
+const int64 kIndexHeaderSize = 2 * sizeof(uint32);
+
+// Keys are SHA1 hashes.
+const size_t kKeyLength = base::kSHA1Length;
+
+struct IndexRecord {
+  char key[kKeyLength];
+  uint32 offset;
+  uint32 size;
+  // base::Hash() of the value.
+  uint32 checksum;
+};
+COMPILE_ASSERT(sizeof(IndexRecord) == kKeyLength + 3 * sizeof(uint32),
+               index_record_must_not_have_padding);
+
+}  // namespace
+
+ShaderCacheStore::ShaderCacheStore(const base::FilePath& directory,
+                                   size_t max_size_bytes,
+                                   const std::string& build_version)
+    : directory_(directory),
+      max_size_bytes_(max_size_bytes),
+      build_version_(build_version),
+      loaded_(false),
+      usable_(false),
+      index_size_(0),
+      data_size_(0) {
+}
+
+ShaderCacheStore::~ShaderCacheStore() {
+}
+
+bool ShaderCacheStore::Contains(const std::string& key) {
+  if (!EnsureLoaded())
+    return false;
+  return entries_.find(key) != entries_.end();
+}
+
+bool ShaderCacheStore::Get(const std::string& key, std::string* value) {
+  if (!EnsureLoaded())
+    return false;
+  EntryMap::iterator it = entries_.find(key);
+  if (it == entries_.end())
+    return false;
+
+  const Entry& entry = it->second;
+  value->resize(entry.size);
+  if (entry.size &&
+      (data_file_.Read(entry.offset, &(*value)[0], entry.size) !=
+           static_cast<int>(entry.size) ||
+       base::Hash(*value) != entry.checksum)) {
+    // Leave the bytes in the files; they go away the next time the store is
+    // emptied.
+    entries_.erase(it);
+    value->clear();
+    return false;
+  }
+  return true;
+}
+
+void ShaderCacheStore::Put(const std::string& key, const std::string& value) {
+  DCHECK_EQ(kKeyLength, key.size());
+  if (!EnsureLoaded())
+    return;
+  // A replaced value stays in the data file until the store is emptied; the
+  // last index record for a key is the one Load() uses.
+  EntryMap::const_iterator it = entries_.find(key);
+  if (it != entries_.end() && it->second.size == value.size() &&
+      it->second.checksum == base::Hash(value)) {
+    return;
+  }
+  if (value.size() > max_size_bytes_)
+    return;
+  if (data_size_ + value.size() > max_size_bytes_ && !Reset()) {
+    usable_ = false;
+    return;
+  }
+
+  IndexRecord record;
+  memcpy(record.key, key.data(), kKeyLength);
+  record.offset = static_cast<uint32>(data_size_);
+  record.size = static_cast<uint32>(value.size());
+  record.checksum = base::Hash(value);
+
+  // The value goes in first, so that a crash never leaves an index record
+  // pointing past the end of the data.
+  if (data_file_.Write(data_size_, value.data(), value.size()) !=
+          static_cast<int>(value.size())) {
+    return;
+  }
+  data_size_ += value.size();
+  if (index_file_.Write(index_size_,
+                        reinterpret_cast<const char*>(&record),
+                        sizeof(record)) != static_cast<int>(sizeof(record))) {
+    index_file_.SetLength(index_size_);
+    return;
+  }
+  index_size_ += sizeof(record);
+
+  Entry entry = { record.offset, record.size, record.checksum };
+  entries_[key] = entry;
+}
+
+size_t ShaderCacheStore::size() {
+  if (!EnsureLoaded())
+    return 0;
+  return entries_.size();
+}
+
+bool ShaderCacheStore::EnsureLoaded() {
+  if (!loaded_) {
+    loaded_ = true;
+    usable_ = Load();
+    UMA_HISTOGRAM_BOOLEAN("GPU.ShaderCacheStore.LoadSuccess", usable_);
+  }
+  return usable_;
+}
+
+bool ShaderCacheStore::Load() {
+  if (!base::CreateDirectory(directory_))
+    return false;
+  const uint32 flags = base::File::FLAG_OPEN_ALWAYS |
+                       base::File::FLAG_READ |
+                       base::File::FLAG_WRITE;
+  index_file_.Initialize(directory_.Append(kIndexFileName), flags);
+  data_file_.Initialize(directory_.Append(kDataFileName), flags);
+  if (!index_file_.IsValid() || !data_file_.IsValid())
+    return false;
+
+  const int64 index_length = index_file_.GetLength();
+  data_size_ = data_file_.GetLength();
+  if (index_length < kIndexHeaderSize || data_size_ < 0)
+    return Reset();
+
+  std::string index(index_length, '\0');
+  if (index_file_.Read(0, &index[0], index_length) != index_length)
+    return Reset();
+  uint32 magic = 0;
+  uint32 version = 0;
+  memcpy(&magic, index.data(), sizeof(magic));
+  memcpy(&version, index.data() + sizeof(magic), sizeof(version));
+  if (magic != kIndexMagic || version != kIndexVersion)
+    return Reset();
+
+  // A record torn by a crash, or one pointing past the data that made it to
+  // disk, ends the index.
+  int64 offset = kIndexHeaderSize;
+  while (index_length - offset >= static_cast<int64>(sizeof(IndexRecord))) {
+    IndexRecord record;
+    memcpy(&record, index.data() + offset, sizeof(record));
+    if (static_cast<int64>(record.offset) + record.size > data_size_)
+      break;
+    Entry entry = { record.offset, record.size, record.checksum };
+    entries_[std::string(record.key, kKeyLength)] = entry;
+    offset += sizeof(record);
+  }
+  index_size_ = offset;
+  if (index_size_ < index_length)
+    index_file_.SetLength(index_size_);
+  return true;
+}
+
+bool ShaderCacheStore::Reset() {
+  entries_.clear();
+  index_size_ = 0;
+  data_size_ = 0;
+  if (!index_file_.SetLength(0) || !data_file_.SetLength(0))
+    return false;
+
+  char header[kIndexHeaderSize];
+  memcpy(header, &kIndexMagic, sizeof(kIndexMagic));
+  memcpy(header + sizeof(kIndexMagic), &kIndexVersion, sizeof(kIndexVersion));
+  if (index_file_.Write(0, header, sizeof(header)) !=
+          static_cast<int>(sizeof(header))) {
+    return false;
+  }
+  index_size_ = kIndexHeaderSize;
+  return true;
+}
+
+}  // namespace gles2
+}  // namespace gpu
@@ -0,0 +1,85 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GPU_COMMAND_BUFFER_SERVICE_SHADER_CACHE_STORE_H_
+#define GPU_COMMAND_BUFFER_SERVICE_SHADER_CACHE_STORE_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "gpu/gpu_export.h"
+
+namespace gpu {
+namespace gles2 {
+
+// Keeps cached shader translations or program binaries on disk, so that they
+// survive restarts of the GPU process.  Values are appended to a data file and
+// located through an index file of fixed size records, which is read the first
+// time the store is used.  Values are only read when they are looked up.
+//
+// This class is not thread safe.
+class GPU_EXPORT ShaderCacheStore {
+ public:
+  // |directory| is created if it doesn't exist.  Once the values in the store
+  // take up more than |max_size_bytes|, it is emptied.  Users of the store
+  // include |build_version| in their keys, so that values written by another
+  // build aren't used.
+  ShaderCacheStore(const base::FilePath& directory,
+                   size_t max_size_bytes,
+                   const std::string& build_version);
+  ~ShaderCacheStore();
+
+  // Returns true if there is a value for |key|, without reading it.
+  bool Contains(const std::string& key);
+
+  // Reads the value for |key| into |value|.  Returns false if there is none,
+  // or if it couldn't be read back intact.
+  bool Get(const std::string& key, std::string* value);
+
+  // Stores |value| for |key|, replacing any value stored for it before.
+  void Put(const std::string& key, const std::string& value);
+
+  // The number of values in the store.
+  size_t size();
+
+  const std::string& build_version() const { return build_version_; }
+
+ private:
+  struct Entry {
+    uint32 offset;
+    uint32 size;
+    uint32 checksum;
+  };
+
+  typedef base::hash_map<std::string, Entry> EntryMap;
+
+  // Opens the files and reads the index, if that hasn't been done yet.
+  // Returns false if the store can't be used.
+  bool EnsureLoaded();
+  bool Load();
+
+  // Removes everything from the store, and starts new files.
+  bool Reset();
+
+  const base::FilePath directory_;
+  const size_t max_size_bytes_;
+  const std::string build_version_;
+  bool loaded_;
+  bool usable_;
+  base::File index_file_;
+  base::File data_file_;
+  int64 index_size_;
+  int64 data_size_;
+  EntryMap entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShaderCacheStore);
+};
+
+}  // namespace gles2
+}  // namespace gpu
+
+#endif  // GPU_COMMAND_BUFFER_SERVICE_SHADER_CACHE_STORE_H_
@@ -0,0 +1,179 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/shader_cache_store.h"
+
+#include "base/file_util.h"
+#include "base/files/file.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/sha1.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+const size_t kMaxSizeBytes = 1024;
+
+}  // namespace
+
+class ShaderCacheStoreTest : public testing::Test {
+ public:
+  ShaderCacheStoreTest() {}
+
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    directory_ = temp_dir_.path().AppendASCII("store");
+  }
+
+  scoped_ptr<ShaderCacheStore> CreateStore() {
+    return make_scoped_ptr(new ShaderCacheStore(directory_, kMaxSizeBytes, "1.0"));
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath directory_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ShaderCacheStoreTest);
+};
+
+TEST_F(ShaderCacheStoreTest, PutGet) {
+  scoped_ptr<ShaderCacheStore> store = CreateStore();
+  const std::string key_a = base::SHA1HashString("a");
+  const std::string key_b = base::SHA1HashString("b");
+  std::string value;
+  EXPECT_FALSE(store->Contains(key_a));
+  EXPECT_FALSE(store->Get(key_a, &value));
+
+  store->Put(key_a, "value a");
+  store->Put(key_b, std::string());
+  EXPECT_TRUE(store->Contains(key_a));
+  EXPECT_TRUE(store->Get(key_a, &value));
+  EXPECT_EQ("value a", value);
+  EXPECT_TRUE(store->Get(key_b, &value));
+  EXPECT_EQ(std::string(), value);
+
+  // A later value stored for a key replaces the first, also once the store
+  // is reopened.
+  store->Put(key_a, "another value");
+  EXPECT_TRUE(store->Get(key_a, &value));
+  EXPECT_EQ("another value", value);
+  EXPECT_EQ(2U, store->size());
+  store = CreateStore();
+  EXPECT_TRUE(store->Get(key_a, &value));
+  EXPECT_EQ("another value", value);
+  EXPECT_EQ(2U, store->size());
+}
+
+TEST_F(ShaderCacheStoreTest, Reopen) {
+  const std::string key = base::SHA1HashString("a");
+  CreateStore()->Put(key, "value a");
+
+  scoped_ptr<ShaderCacheStore> store = CreateStore();
+  std::string value;
+  EXPECT_TRUE(store->Get(key, &value));
+  EXPECT_EQ("value a", value);
+
+  // Values stored after reopening are kept too.
+  const std::string other_key = base::SHA1HashString("b");
+  store->Put(other_key, "value b");
+  store = CreateStore();
+  EXPECT_TRUE(store->Get(other_key, &value));
+  EXPECT_EQ("value b", value);
+  EXPECT_EQ(2U, store->size());
+}
+
+TEST_F(ShaderCacheStoreTest, Full) {
+  scoped_ptr<ShaderCacheStore> store = CreateStore();
+  const std::string value(kMaxSizeBytes / 2, 'x');
+  const std::string key_a = base::SHA1HashString("a");
+  const std::string key_b = base::SHA1HashString("b");
+  const std::string key_c = base::SHA1HashString("c");
+  store->Put(key_a, value);
+  store->Put(key_b, value);
+  EXPECT_EQ(2U, store->size());
+
+  // There is no room for a third value, so the store starts over.
+  store->Put(key_c, value);
+  EXPECT_FALSE(store->Contains(key_a));
+  EXPECT_FALSE(store->Contains(key_b));
+  EXPECT_TRUE(store->Contains(key_c));
+
+  // Values too big for the store are dropped.
+  store->Put(key_a, std::string(kMaxSizeBytes + 1, 'x'));
+  EXPECT_FALSE(store->Contains(key_a));
+  EXPECT_TRUE(store->Contains(key_c));
+}
+
+// A value whose bytes were damaged on disk is a miss, and the rest of the
+// store is still used.
+TEST_F(ShaderCacheStoreTest, CorruptValue) {
+  const std::string key_a = base::SHA1HashString("a");
+  const std::string key_b = base::SHA1HashString("b");
+  {
+    scoped_ptr<ShaderCacheStore> store = CreateStore();
+    store->Put(key_a, "value a");
+    store->Put(key_b, "value b");
+  }
+  {
+    base::File file(directory_.AppendASCII("data"),
+                    base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+    ASSERT_EQ(1, file.Write(0, "V", 1));
+  }
+
+  scoped_ptr<ShaderCacheStore> store = CreateStore();
+  std::string value;
+  EXPECT_FALSE(store->Get(key_a, &value));
+  EXPECT_FALSE(store->Contains(key_a));
+  EXPECT_TRUE(store->Get(key_b, &value));
+  EXPECT_EQ("value b", value);
+}
+
+// Index records for values that never made it to disk are dropped.
+TEST_F(ShaderCacheStoreTest, TruncatedData) {
+  const std::string key_a = base::SHA1HashString("a");
+  const std::string key_b = base::SHA1HashString("b");
+  {
+    scoped_ptr<ShaderCacheStore> store = CreateStore();
+    store->Put(key_a, "value a");
+    store->Put(key_b, "value b");
+  }
+  {
+    base::File file(directory_.AppendASCII("data"),
+                    base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+    ASSERT_TRUE(file.SetLength(file.GetLength() - 1));
+  }
+
+  scoped_ptr<ShaderCacheStore> store = CreateStore();
+  EXPECT_TRUE(store->Contains(key_a));
+  EXPECT_FALSE(store->Contains(key_b));
+  store->Put(key_b, "value b");
+
+  store = CreateStore();
+  std::string value;
+  EXPECT_TRUE(store->Get(key_b, &value));
+  EXPECT_EQ("value b", value);
+}
+
+TEST_F(ShaderCacheStoreTest, BadIndex) {
+  const std::string key = base::SHA1HashString("a");
+  CreateStore()->Put(key, "value a");
+  const char kGarbage[] = "not an index";
+  ASSERT_EQ(static_cast<int>(sizeof(kGarbage)),
+            base::WriteFile(directory_.AppendASCII("index"), kGarbage,
+                            sizeof(kGarbage)));
+
+  scoped_ptr<ShaderCacheStore> store = CreateStore();
+  EXPECT_EQ(0U, store->size());
+  store->Put(key, "value b");
+  std::string value;
+  EXPECT_TRUE(CreateStore()->Get(key, &value));
+  EXPECT_EQ("value b", value);
+}
+
+}  // namespace gles2
+}  // namespace gpu
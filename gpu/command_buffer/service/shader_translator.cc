@@ -12,7 +12,11 @@
 #include "base/debug/trace_event.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/metrics/histogram.h"
+#include "base/sha1.h"
 #include "base/strings/string_number_conversions.h"
+#include "gpu/command_buffer/service/disk_cache_proto.pb.h"
+#include "gpu/command_buffer/service/shader_cache_store.h"
 
 namespace {
 
@@ -110,6 +114,41 @@ void GetNameHashingInfo(
   }
 }
 
+typedef google::protobuf::RepeatedPtrField<ShaderInfoProto> ShaderInfoProtos;
+
+void StoreVariableMap(const ShaderTranslator::VariableMap& map,
+                      ShaderInfoProtos* protos) {
+  for (ShaderTranslator::VariableMap::const_iterator it = map.begin();
+       it != map.end(); ++it) {
+    ShaderInfoProto* info = protos->Add();
+    info->set_key(it->first);
+    info->set_type(it->second.type);
+    info->set_size(it->second.size);
+    info->set_precision(it->second.precision);
+    info->set_static_use(it->second.static_use);
+    info->set_name(it->second.name);
+  }
+}
+
+void RetrieveVariableMap(const ShaderInfoProtos& protos,
+                         ShaderTranslator::VariableMap* map) {
+  for (int i = 0; i < protos.size(); ++i) {
+    const ShaderInfoProto& info = protos.Get(i);
+    (*map)[info.key()] = ShaderTranslator::VariableInfo(
+        info.type(), info.size(), info.precision(), info.static_use(),
+        info.name());
+  }
+}
+
+// Returns a NUL terminated copy of |str|, or NULL if it is empty.
+char* CopyToCString(const std::string& str) {
+  if (str.empty())
+    return NULL;
+  char* result = new char[str.size() + 1];
+  memcpy(result, str.c_str(), str.size() + 1);
+  return result;
+}
+
 }  // namespace
 
 namespace gpu {
@@ -124,7 +163,10 @@ ShaderTranslator::DestructionObserver::~DestructionObserver() {
 ShaderTranslator::ShaderTranslator()
     : compiler_(NULL),
       implementation_is_glsl_es_(false),
-      driver_bug_workarounds_(static_cast<ShCompileOptions>(0)) {
+      driver_bug_workarounds_(static_cast<ShCompileOptions>(0)),
+      shader_type_(0),
+      shader_spec_(0),
+      cache_store_(NULL) {
 }
 
 bool ShaderTranslator::Init(
@@ -160,6 +202,8 @@ bool ShaderTranslator::Init(
   compiler_options_ = *resources;
   implementation_is_glsl_es_ = (glsl_implementation_type == kGlslES);
   driver_bug_workarounds_ = driver_bug_workarounds;
+  shader_type_ = shader_type;
+  shader_spec_ = shader_spec;
   return compiler_ != NULL;
 }
 
@@ -180,6 +224,15 @@ bool ShaderTranslator::Translate(const char* shader) {
   DCHECK(shader != NULL);
   ClearResults();
 
+  std::string cache_key;
+  if (cache_store_) {
+    cache_key = GetCacheKey(shader);
+    bool hit = LoadFromCacheStore(cache_key);
+    UMA_HISTOGRAM_BOOLEAN("GPU.ShaderTranslator.CacheStoreHit", hit);
+    if (hit)
+      return true;
+  }
+
   bool success = false;
   {
     TRACE_EVENT0("gpu", "ShCompile");
@@ -211,6 +264,8 @@ bool ShaderTranslator::Translate(const char* shader) {
     info_log_.reset();
   }
 
+  if (success && cache_store_)
+    SaveToCacheStore(cache_key);
   return success;
 }
 
@@ -354,6 +409,63 @@ ShaderTranslator::~ShaderTranslator() {
     ShDestruct(compiler_);
 }
 
+std::string ShaderTranslator::GetCacheKey(const char* shader) {
+  if (cache_key_prefix_.empty()) {
+    // The translator's output depends on the version of ANGLE as well as on
+    // its options.  ANGLE_SH_VERSION isn't bumped for every change to the
+    // translator, so the build version is part of the key too.
+    cache_key_prefix_ =
+        ":Build:" + cache_store_->build_version() +
+        ":ShaderType:" + base::IntToString(shader_type_) +
+        ":ShaderSpec:" + base::IntToString(shader_spec_) +
+        ":GlslES:" + base::IntToString(implementation_is_glsl_es_) +
+#if defined(ANGLE_SH_VERSION)
+        ":ANGLE:" + base::IntToString(ANGLE_SH_VERSION) +
+#endif
+        GetStringForOptionsThatWouldAffectCompilation() + ":Source:";
+  }
+  return base::SHA1HashString(cache_key_prefix_ + shader);
+}
+
+bool ShaderTranslator::LoadFromCacheStore(const std::string& key) {
+  std::string value;
+  TranslatedShaderProto proto;
+  if (!cache_store_->Get(key, &value) || !proto.ParseFromString(value))
+    return false;
+
+  translated_shader_.reset(CopyToCString(proto.translated_source()));
+  info_log_.reset(CopyToCString(proto.info_log()));
+  RetrieveVariableMap(proto.attribs(), &attrib_map_);
+  RetrieveVariableMap(proto.uniforms(), &uniform_map_);
+  RetrieveVariableMap(proto.varyings(), &varying_map_);
+  for (int i = 0; i < proto.name_map_size(); ++i) {
+    const NameMapEntryProto& entry = proto.name_map(i);
+    name_map_[entry.hashed_name()] = entry.original_name();
+  }
+  return true;
+}
+
+void ShaderTranslator::SaveToCacheStore(const std::string& key) {
+  TranslatedShaderProto proto;
+  if (translated_shader_)
+    proto.set_translated_source(translated_shader_.get());
+  if (info_log_)
+    proto.set_info_log(info_log_.get());
+  StoreVariableMap(attrib_map_, proto.mutable_attribs());
+  StoreVariableMap(uniform_map_, proto.mutable_uniforms());
+  StoreVariableMap(varying_map_, proto.mutable_varyings());
+  for (NameMap::const_iterator it = name_map_.begin();
+       it != name_map_.end(); ++it) {
+    NameMapEntryProto* entry = proto.add_name_map();
+    entry->set_hashed_name(it->first);
+    entry->set_original_name(it->second);
+  }
+
+  std::string value;
+  if (proto.SerializeToString(&value))
+    cache_store_->Put(key, value);
+}
+
 void ShaderTranslator::ClearResults() {
   translated_shader_.reset();
   info_log_.reset();
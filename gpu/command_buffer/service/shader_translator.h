@@ -18,6 +18,8 @@
 namespace gpu {
 namespace gles2 {
 
+class ShaderCacheStore;
+
 // Translates a GLSL ES 2.0 shader to desktop GLSL shader, or just
 // validates GLSL ES 2.0 shaders on a true GLSL ES implementation.
 class ShaderTranslatorInterface {
@@ -149,6 +151,13 @@ class GPU_EXPORT ShaderTranslator
   void AddDestructionObserver(DestructionObserver* observer);
   void RemoveDestructionObserver(DestructionObserver* observer);
 
+  // Successful translations are looked up in and added to |cache_store|,
+  // which must outlive this translator.
+  void set_cache_store(ShaderCacheStore* cache_store) {
+    cache_store_ = cache_store;
+    cache_key_prefix_.clear();
+  }
+
  private:
   friend class base::RefCounted<ShaderTranslator>;
 
@@ -156,6 +165,11 @@ class GPU_EXPORT ShaderTranslator
   void ClearResults();
   int GetCompileOptions() const;
 
+  // Returns the key |shader| is stored under in |cache_store_|.
+  std::string GetCacheKey(const char* shader);
+  bool LoadFromCacheStore(const std::string& key);
+  void SaveToCacheStore(const std::string& key);
+
   ShHandle compiler_;
   ShBuiltInResources compiler_options_;
   scoped_ptr<char[]> translated_shader_;
@@ -168,6 +182,14 @@ class GPU_EXPORT ShaderTranslator
   ShCompileOptions driver_bug_workarounds_;
   ObserverList<DestructionObserver> destruction_observers_;
 
+  // The parameters to Init that aren't part of
+  // GetStringForOptionsThatWouldAffectCompilation().
+  int shader_type_;
+  int shader_spec_;
+  ShaderCacheStore* cache_store_;
+  // Built the first time a translation is looked up in |cache_store_|.
+  std::string cache_key_prefix_;
+
   DISALLOW_COPY_AND_ASSIGN(ShaderTranslator);
 };
 
@@ -12,6 +12,11 @@ namespace gles2 {
 ShaderTranslatorCache::ShaderTranslatorCache() {
 }
 
+ShaderTranslatorCache::ShaderTranslatorCache(
+    scoped_ptr<ShaderCacheStore> cache_store)
+    : cache_store_(cache_store.Pass()) {
+}
+
 ShaderTranslatorCache::~ShaderTranslatorCache() {
   DCHECK(cache_.empty());
 }
@@ -54,6 +59,7 @@ scoped_refptr<ShaderTranslator> ShaderTranslatorCache::GetTranslator(
                        driver_bug_workarounds)) {
     cache_[params] = translator;
     translator->AddDestructionObserver(this);
+    translator->set_cache_store(cache_store_.get());
     return translator;
   } else {
     return NULL;
@@ -10,6 +10,8 @@
 #include <map>
 
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "gpu/command_buffer/service/shader_cache_store.h"
 #include "gpu/command_buffer/service/shader_translator.h"
 #include "third_party/angle/include/GLSLANG/ShaderLang.h"
 
@@ -27,6 +29,9 @@ class GPU_EXPORT ShaderTranslatorCache
       public NON_EXPORTED_BASE(ShaderTranslator::DestructionObserver) {
  public:
   ShaderTranslatorCache();
+  // The translators keep their translations in |cache_store|, which may be
+  // NULL.
+  explicit ShaderTranslatorCache(scoped_ptr<ShaderCacheStore> cache_store);
 
   // ShaderTranslator::DestructionObserver implementation
   virtual void OnDestruct(ShaderTranslator* translator) OVERRIDE;
@@ -94,6 +99,8 @@ class GPU_EXPORT ShaderTranslatorCache
   typedef std::map<ShaderTranslatorInitParams, ShaderTranslator* > Cache;
   Cache cache_;
 
+  scoped_ptr<ShaderCacheStore> cache_store_;
+
   DISALLOW_COPY_AND_ASSIGN(ShaderTranslatorCache);
 };
 
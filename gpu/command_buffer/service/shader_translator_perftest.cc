@@ -0,0 +1,211 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how long translating a set of shaders at startup takes without a
+// ShaderCacheStore, and with one that is empty (cold) or was filled by an
+// earlier run (warm).  The translator runs without a GPU.
+
+#include <GLES2/gl2.h>
+
+#include <string>
+#include <vector>
+
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "gpu/command_buffer/service/shader_cache_store.h"
+#include "gpu/command_buffer/service/shader_translator.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+// The ANGLE shader translator now uses native GLenums
+#if (ANGLE_SH_VERSION >= 126)
+#define SH_VERTEX_SHADER GL_VERTEX_SHADER
+#define SH_FRAGMENT_SHADER GL_FRAGMENT_SHADER
+#endif
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+const size_t kStoreSizeBytes = 8 * 1024 * 1024;
+
+// Each shader is translated with a number of different constants, the way a
+// compositor generates variants of the same few programs.
+const int kVariantsPerShader = 32;
+
+const char kVertexShaderTemplate[] =
+    "precision mediump float;\n"
+    "attribute vec4 a_position;\n"
+    "attribute vec2 a_texCoord;\n"
+    "uniform mat4 matrix;\n"
+    "uniform vec4 texTransform;\n"
+    "uniform float opacity[VARIANT];\n"
+    "varying vec2 v_texCoord;\n"
+    "varying float v_alpha;\n"
+    "void main() {\n"
+    "  gl_Position = matrix * a_position;\n"
+    "  v_texCoord = a_texCoord * texTransform.zw + texTransform.xy;\n"
+    "  v_alpha = opacity[VARIANT - 1];\n"
+    "}\n";
+
+const char kAAVertexShaderTemplate[] =
+    "precision mediump float;\n"
+    "attribute vec4 a_position;\n"
+    "attribute float a_index;\n"
+    "uniform mat4 matrix;\n"
+    "uniform vec4 viewport;\n"
+    "uniform vec3 edge[8];\n"
+    "uniform vec4 vertexTexTransform;\n"
+    "varying vec2 v_texCoord;\n"
+    "varying vec4 edge_dist[2];\n"
+    "void main() {\n"
+    "  vec4 pos = matrix * a_position;\n"
+    "  vec3 screen = vec3(viewport.xy + viewport.zw *\n"
+    "      (pos.xy / pos.w * 0.5 + 0.5), 1.0);\n"
+    "  edge_dist[0] = vec4(dot(edge[0], screen), dot(edge[1], screen),\n"
+    "                      dot(edge[2], screen), dot(edge[3], screen));\n"
+    "  edge_dist[1] = vec4(dot(edge[4], screen), dot(edge[5], screen),\n"
+    "                      dot(edge[6], screen), dot(edge[7], screen)) *\n"
+    "      float(VARIANT);\n"
+    "  v_texCoord = a_position.xy * vertexTexTransform.zw +\n"
+    "      vertexTexTransform.xy;\n"
+    "  gl_Position = pos;\n"
+    "}\n";
+
+const char kFragmentShaderTemplate[] =
+    "precision mediump float;\n"
+    "varying vec2 v_texCoord;\n"
+    "varying float v_alpha;\n"
+    "uniform sampler2D s_texture;\n"
+    "uniform mat4 colorMatrix;\n"
+    "uniform vec4 colorOffset;\n"
+    "void main() {\n"
+    "  vec4 texColor = texture2D(s_texture, v_texCoord);\n"
+    "  float nonZeroAlpha = max(texColor.a, 0.00001);\n"
+    "  texColor = vec4(texColor.rgb / nonZeroAlpha, nonZeroAlpha);\n"
+    "  texColor = colorMatrix * texColor + colorOffset;\n"
+    "  texColor.rgb *= texColor.a;\n"
+    "  texColor = clamp(texColor, 0.0, 1.0);\n"
+    "  gl_FragColor = texColor * v_alpha / float(VARIANT);\n"
+    "}\n";
+
+const char kAAFragmentShaderTemplate[] =
+    "precision mediump float;\n"
+    "uniform sampler2D s_texture;\n"
+    "uniform float alpha;\n"
+    "uniform vec4 fragmentTexTransform;\n"
+    "varying vec2 v_texCoord;\n"
+    "varying vec4 edge_dist[2];\n"
+    "void main() {\n"
+    "  vec2 texCoord = clamp(v_texCoord, 0.0, 1.0) *\n"
+    "      fragmentTexTransform.zw + fragmentTexTransform.xy;\n"
+    "  vec4 texColor = texture2D(s_texture, texCoord);\n"
+    "  vec4 d4 = min(edge_dist[0], edge_dist[1]);\n"
+    "  vec2 d2 = min(d4.xz, d4.yw);\n"
+    "  float aa = clamp(gl_FragCoord.w * min(d2.x, d2.y), 0.0, 1.0);\n"
+    "  for (int i = 0; i < VARIANT; ++i)\n"
+    "    aa *= 0.999;\n"
+    "  gl_FragColor = texColor * alpha * aa;\n"
+    "}\n";
+
+// Returns |shader_template| with VARIANT replaced by |variant|.
+std::string MakeVariant(const char* shader_template, int variant) {
+  const std::string kPlaceholder("VARIANT");
+  std::string shader(shader_template);
+  const std::string value = base::IntToString(variant);
+  for (size_t pos = shader.find(kPlaceholder); pos != std::string::npos;
+       pos = shader.find(kPlaceholder, pos + value.size())) {
+    shader.replace(pos, kPlaceholder.size(), value);
+  }
+  return shader;
+}
+
+}  // namespace
+
+class ShaderTranslatorPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    // Initialize the translator library up front, so that the first
+    // measurement doesn't pay for it.
+    ASSERT_TRUE(CreateTranslator(SH_VERTEX_SHADER, NULL).get());
+    for (int i = 1; i <= kVariantsPerShader; ++i) {
+      vertex_shaders_.push_back(MakeVariant(kVertexShaderTemplate, i));
+      vertex_shaders_.push_back(MakeVariant(kAAVertexShaderTemplate, i));
+      fragment_shaders_.push_back(MakeVariant(kFragmentShaderTemplate, i));
+      fragment_shaders_.push_back(MakeVariant(kAAFragmentShaderTemplate, i));
+    }
+  }
+
+  scoped_refptr<ShaderTranslator> CreateTranslator(
+#if (ANGLE_SH_VERSION >= 126)
+      GLenum shader_type,
+#else
+      ShShaderType shader_type,
+#endif
+      ShaderCacheStore* store) {
+    ShBuiltInResources resources;
+    ShInitBuiltInResources(&resources);
+    resources.MaxExpressionComplexity = 256;
+    resources.MaxCallStackDepth = 256;
+    scoped_refptr<ShaderTranslator> translator = new ShaderTranslator;
+    if (!translator->Init(shader_type, SH_GLES2_SPEC, &resources,
+                          ShaderTranslatorInterface::kGlsl,
+                          static_cast<ShCompileOptions>(0))) {
+      return NULL;
+    }
+    translator->set_cache_store(store);
+    return translator;
+  }
+
+  // Translates all the shaders with new translators, as a newly started GPU
+  // process would, and reports how long it took.
+  void TranslateAll(const std::string& trace, ShaderCacheStore* store) {
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+
+    scoped_refptr<ShaderTranslator> vertex_translator =
+        CreateTranslator(SH_VERTEX_SHADER, store);
+    scoped_refptr<ShaderTranslator> fragment_translator =
+        CreateTranslator(SH_FRAGMENT_SHADER, store);
+    ASSERT_TRUE(vertex_translator.get() && fragment_translator.get());
+
+    for (size_t i = 0; i < vertex_shaders_.size(); ++i)
+      EXPECT_TRUE(vertex_translator->Translate(vertex_shaders_[i].c_str()));
+    for (size_t i = 0; i < fragment_shaders_.size(); ++i) {
+      EXPECT_TRUE(
+          fragment_translator->Translate(fragment_shaders_[i].c_str()));
+    }
+
+    base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+    perf_test::PrintResult("shader_translator",
+                           "",
+                           trace,
+                           elapsed.InMillisecondsF(),
+                           "ms",
+                           true);
+  }
+
+  base::ScopedTempDir temp_dir_;
+  std::vector<std::string> vertex_shaders_;
+  std::vector<std::string> fragment_shaders_;
+};
+
+TEST_F(ShaderTranslatorPerfTest, Startup) {
+  TranslateAll("no_store", NULL);
+
+  {
+    ShaderCacheStore store(temp_dir_.path(), kStoreSizeBytes, "1.0");
+    TranslateAll("cold_store", &store);
+    EXPECT_EQ(vertex_shaders_.size() + fragment_shaders_.size(),
+              store.size());
+  }
+
+  ShaderCacheStore store(temp_dir_.path(), kStoreSizeBytes, "1.0");
+  TranslateAll("warm_store", &store);
+}
+
+}  // namespace gles2
+}  // namespace gpu
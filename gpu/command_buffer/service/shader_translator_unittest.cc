@@ -4,6 +4,8 @@
 
 #include <GLES2/gl2.h>
 
+#include "base/files/scoped_temp_dir.h"
+#include "gpu/command_buffer/service/shader_cache_store.h"
 #include "gpu/command_buffer/service/shader_translator.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -270,6 +272,69 @@ TEST_F(ShaderTranslatorTest, OptionsString) {
   EXPECT_NE(options_3, options_4);
 }
 
+// Translations are stored in the cache store, and read back from it by a
+// translator with the same options after a restart.
+TEST_F(ShaderTranslatorTest, CacheStore) {
+  const char* shader =
+      "attribute vec4 vPosition;\n"
+      "uniform mat4 mvp;\n"
+      "void main() {\n"
+      "  gl_Position = mvp * vPosition;\n"
+      "}";
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const size_t kMaxSizeBytes = 64 * 1024;
+
+  ShaderCacheStore store(temp_dir.path(), kMaxSizeBytes, "1.0");
+  vertex_translator_->set_cache_store(&store);
+  EXPECT_TRUE(vertex_translator_->Translate(shader));
+  EXPECT_EQ(1U, store.size());
+  ASSERT_TRUE(vertex_translator_->translated_shader() != NULL);
+  const std::string translated_shader(vertex_translator_->translated_shader());
+  const ShaderTranslator::VariableMap attrib_map(
+      vertex_translator_->attrib_map());
+  const ShaderTranslator::VariableMap uniform_map(
+      vertex_translator_->uniform_map());
+  vertex_translator_->set_cache_store(NULL);
+
+  // Shaders that fail to translate aren't stored.
+  ShaderCacheStore reopened_store(temp_dir.path(), kMaxSizeBytes, "1.0");
+  fragment_translator_->set_cache_store(&reopened_store);
+  EXPECT_FALSE(fragment_translator_->Translate("bad shader"));
+  EXPECT_EQ(1U, reopened_store.size());
+  fragment_translator_->set_cache_store(NULL);
+
+  ShBuiltInResources resources;
+  ShInitBuiltInResources(&resources);
+  resources.MaxExpressionComplexity = 32;
+  resources.MaxCallStackDepth = 32;
+  scoped_refptr<ShaderTranslator> translator = new ShaderTranslator();
+  ASSERT_TRUE(translator->Init(
+      SH_VERTEX_SHADER, SH_GLES2_SPEC, &resources,
+      ShaderTranslatorInterface::kGlsl,
+      SH_EMULATE_BUILT_IN_FUNCTIONS));
+  translator->set_cache_store(&reopened_store);
+  EXPECT_TRUE(translator->Translate(shader));
+  EXPECT_EQ(1U, reopened_store.size());
+  ASSERT_TRUE(translator->translated_shader() != NULL);
+  EXPECT_EQ(translated_shader, translator->translated_shader());
+  EXPECT_TRUE(translator->info_log() == NULL);
+  // apparently the hash_map implementation on android doesn't have the
+  // equality operator
+#if !defined(OS_ANDROID)
+  EXPECT_EQ(attrib_map, translator->attrib_map());
+  EXPECT_EQ(uniform_map, translator->uniform_map());
+#endif
+  translator->set_cache_store(NULL);
+
+  // Translations stored by another build aren't used.
+  ShaderCacheStore upgraded_store(temp_dir.path(), kMaxSizeBytes, "2.0");
+  translator->set_cache_store(&upgraded_store);
+  EXPECT_TRUE(translator->Translate(shader));
+  EXPECT_EQ(2U, upgraded_store.size());
+  translator->set_cache_store(NULL);
+}
+
 }  // namespace gles2
 }  // namespace gpu
 
@@ -266,6 +266,7 @@
         'command_buffer/service/query_manager_unittest.cc',
         'command_buffer/service/renderbuffer_manager_unittest.cc',
         'command_buffer/service/program_cache_unittest.cc',
+        'command_buffer/service/shader_cache_store_unittest.cc',
         'command_buffer/service/shader_manager_unittest.cc',
         'command_buffer/service/shader_translator_unittest.cc',
         'command_buffer/service/test_helper.cc',
@@ -304,6 +305,43 @@
       # TODO(jschuh): crbug.com/167187 fix size_t to int truncations.
       'msvs_disabled_warnings': [ 4267, ],
     },
+    {
+      # GN version: //gpu:gpu_perftests
+      'target_name': 'gpu_perftests',
+      'type': '<(gtest_target_type)',
+      'dependencies': [
+        '../base/base.gyp:base',
+        '../base/base.gyp:test_support_base',
+        '../base/base.gyp:test_support_perf',
+        '../testing/gmock.gyp:gmock',
+        '../testing/gtest.gyp:gtest',
+        '../testing/perf/perf_test.gyp:perf_test',
+        '../ui/gl/gl.gyp:gl',
+        '../ui/gfx/gfx.gyp:gfx',
+        'command_buffer_client',
+        'command_buffer_common',
+        'command_buffer_service',
+        'gpu',
+      ],
+      'sources': [
+        'command_buffer/client/fenced_allocator_perftest.cc',
+        'command_buffer/client/transfer_buffer_perftest.cc',
+        'command_buffer/service/cmd_parser_perftest.cc',
+        'command_buffer/service/gpu_service_test.cc',
+        'command_buffer/service/gpu_service_test.h',
+        'command_buffer/service/mailbox_manager_perftest.cc',
+        'command_buffer/service/mocks.cc',
+        'command_buffer/service/mocks.h',
+        'command_buffer/service/shader_translator_perftest.cc',
+      ],
+      'conditions': [
+        ['OS == "android"', {
+          'dependencies': [
+            '../testing/android/native_test.gyp:native_test_native_code',
+          ],
+        }],
+      ],
+    },
     {
       # GN version: //gpu:gl_tests
       'target_name': 'gl_tests',
@@ -98,6 +98,8 @@
         '..'
       ],
       'sources': [
+        'ipc_message_dispatch_perftest.cc',
+        'ipc_message_dispatch_perftest_messages.h',
         'ipc_perftests.cc',
         'ipc_test_base.cc',
         'ipc_test_base.h',
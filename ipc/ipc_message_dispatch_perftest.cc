@@ -0,0 +1,326 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how long it takes to get a message to its handler once it has
+// arrived: the message map switch of a listener with many handlers, and the
+// routing of messages through many filters.
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "ipc/ipc_listener.h"
+#include "ipc/ipc_message.h"
+#include "ipc/message_filter.h"
+#include "ipc/message_filter_router.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#define IPC_MESSAGE_IMPL
+#include "ipc/ipc_message_dispatch_perftest_messages.h"
+
+// Generate constructors.
+#include "ipc/struct_constructor_macros.h"
+#include "ipc/ipc_message_dispatch_perftest_messages.h"
+
+// Generate destructors.
+#include "ipc/struct_destructor_macros.h"
+#include "ipc/ipc_message_dispatch_perftest_messages.h"
+
+// Generate param traits write methods.
+#include "ipc/param_traits_write_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_dispatch_perftest_messages.h"
+}  // namespace IPC
+
+// Generate param traits read methods.
+#include "ipc/param_traits_read_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_dispatch_perftest_messages.h"
+}  // namespace IPC
+
+// Generate param traits log methods.
+#include "ipc/param_traits_log_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_dispatch_perftest_messages.h"
+}  // namespace IPC
+
+namespace {
+
+const int kDispatchCount = 1000000;
+
+// Handles all 128 messages, the way a listener with a big message map does.
+class DispatchListener : public IPC::Listener {
+ public:
+  DispatchListener() : sum_(0) {}
+  virtual ~DispatchListener() {}
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    bool handled = true;
+    IPC_BEGIN_MESSAGE_MAP(DispatchListener, message)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_000, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_001, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_002, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_003, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_004, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_005, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_006, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_007, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_008, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_009, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_010, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_011, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_012, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_013, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_014, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_015, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_016, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_017, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_018, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_019, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_020, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_021, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_022, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_023, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_024, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_025, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_026, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_027, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_028, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_029, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_030, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_031, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_032, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_033, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_034, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_035, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_036, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_037, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_038, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_039, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_040, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_041, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_042, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_043, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_044, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_045, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_046, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_047, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_048, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_049, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_050, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_051, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_052, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_053, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_054, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_055, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_056, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_057, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_058, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_059, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_060, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_061, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_062, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_063, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_064, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_065, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_066, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_067, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_068, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_069, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_070, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_071, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_072, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_073, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_074, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_075, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_076, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_077, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_078, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_079, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_080, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_081, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_082, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_083, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_084, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_085, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_086, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_087, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_088, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_089, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_090, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_091, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_092, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_093, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_094, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_095, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_096, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_097, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_098, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_099, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_100, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_101, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_102, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_103, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_104, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_105, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_106, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_107, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_108, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_109, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_110, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_111, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_112, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_113, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_114, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_115, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_116, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_117, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_118, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_119, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_120, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_121, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_122, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_123, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_124, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_125, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_126, OnMessage)
+    IPC_MESSAGE_HANDLER(DispatchPerfMsg_127, OnMessage)
+    IPC_MESSAGE_UNHANDLED(handled = false)
+    IPC_END_MESSAGE_MAP()
+    return handled;
+  }
+
+  int64 sum() const { return sum_; }
+
+ private:
+  void OnMessage(int value) { sum_ += value; }
+
+  int64 sum_;
+
+  DISALLOW_COPY_AND_ASSIGN(DispatchListener);
+};
+
+// A filter that handles the messages of one class and only counts what it's
+// offered. A filter that doesn't declare a class is offered every message,
+// and handles none of them.
+class CountingFilter : public IPC::MessageFilter {
+ public:
+  explicit CountingFilter(int message_class)
+      : message_class_(message_class),
+        offered_(0) {
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    offered_++;
+    return message_class_ >= 0 &&
+        IPC_MESSAGE_CLASS(message) == static_cast<uint32>(message_class_);
+  }
+
+  virtual bool GetSupportedMessageClasses(
+      std::vector<uint32>* supported_message_classes) const OVERRIDE {
+    if (message_class_ < 0)
+      return false;
+    supported_message_classes->push_back(message_class_);
+    return true;
+  }
+
+  int offered() const { return offered_; }
+
+ private:
+  virtual ~CountingFilter() {}
+
+  int message_class_;
+  int offered_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingFilter);
+};
+
+void DispatchRepeatedly(const char* name,
+                        DispatchListener* listener,
+                        const IPC::Message& message,
+                        bool expect_handled) {
+  base::PerfTimeLogger logger(
+      base::StringPrintf("IPC_Dispatch_%s_%dx", name, kDispatchCount)
+          .c_str());
+  for (int i = 0; i < kDispatchCount; i++)
+    EXPECT_EQ(expect_handled, listener->OnMessageReceived(message));
+}
+
+void RouteRepeatedly(const char* name,
+                     IPC::MessageFilterRouter* router,
+                     const IPC::Message& message) {
+  base::PerfTimeLogger logger(
+      base::StringPrintf("IPC_FilterRouting_%s_%dx", name, kDispatchCount)
+          .c_str());
+  for (int i = 0; i < kDispatchCount; i++)
+    EXPECT_TRUE(router->TryFilters(message));
+}
+
+}  // namespace
+
+// The message map is a switch over the message ids, so the position of the
+// handler in the map shouldn't matter.
+TEST(IPCMessageDispatchPerfTest, MessageMap) {
+  DispatchListener listener;
+
+  DispatchPerfMsg_000 first(1);
+  DispatchRepeatedly("First", &listener, first, true);
+
+  DispatchPerfMsg_064 middle(1);
+  DispatchRepeatedly("Middle", &listener, middle, true);
+
+  DispatchPerfMsg_127 last(1);
+  DispatchRepeatedly("Last", &listener, last, true);
+
+  // Same class as the handled messages, but an id none of them has.
+  IPC::Message unhandled(MSG_ROUTING_CONTROL, (TestMsgStart << 16) + 0xffff,
+                         IPC::Message::PRIORITY_NORMAL);
+  DispatchRepeatedly("Unhandled", &listener, unhandled, false);
+
+  EXPECT_EQ(3 * kDispatchCount, listener.sum());
+}
+
+// Filters that declare the message classes they handle are only offered
+// messages of those classes, no matter how many other filters there are.
+TEST(IPCMessageDispatchPerfTest, FilterRouting) {
+  const int kFilterCount = 32;
+
+  // Every filter sees every message until one handles it.
+  {
+    IPC::MessageFilterRouter router;
+    std::vector<scoped_refptr<CountingFilter> > filters;
+    for (int i = 0; i < kFilterCount - 1; i++) {
+      filters.push_back(new CountingFilter(-1));
+      router.AddFilter(filters.back().get());
+    }
+    filters.push_back(new CountingFilter(TestMsgStart));
+    router.AddFilter(filters.back().get());
+
+    DispatchPerfMsg_000 message(1);
+    RouteRepeatedly("GlobalFilters", &router, message);
+    EXPECT_EQ(kDispatchCount, filters[0]->offered());
+    router.Clear();
+  }
+
+  // Each filter only sees its own class.
+  {
+    IPC::MessageFilterRouter router;
+    std::vector<scoped_refptr<CountingFilter> > filters;
+    for (int i = 0; i < kFilterCount && i < LastIPCMsgStart; i++) {
+      filters.push_back(new CountingFilter(i));
+      router.AddFilter(filters.back().get());
+    }
+
+    DispatchPerfMsg_000 message(1);
+    RouteRepeatedly("ClassFilters", &router, message);
+    for (size_t i = 0; i < filters.size(); i++) {
+      EXPECT_EQ(i == static_cast<size_t>(TestMsgStart) ? kDispatchCount : 0,
+                filters[i]->offered());
+    }
+    router.Clear();
+  }
+}
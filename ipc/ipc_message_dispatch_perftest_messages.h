@@ -0,0 +1,139 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Messages for ipc_message_dispatch_perftest.cc. There are enough of them to
+// match the listeners with the biggest message maps, such as RenderViewImpl.
+// Multiply-included message file, hence no include guard.
+
+#include "ipc/ipc_message_macros.h"
+
+#define IPC_MESSAGE_START TestMsgStart
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_000, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_001, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_002, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_003, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_004, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_005, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_006, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_007, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_008, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_009, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_010, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_011, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_012, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_013, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_014, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_015, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_016, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_017, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_018, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_019, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_020, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_021, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_022, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_023, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_024, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_025, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_026, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_027, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_028, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_029, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_030, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_031, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_032, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_033, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_034, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_035, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_036, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_037, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_038, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_039, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_040, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_041, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_042, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_043, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_044, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_045, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_046, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_047, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_048, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_049, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_050, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_051, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_052, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_053, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_054, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_055, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_056, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_057, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_058, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_059, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_060, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_061, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_062, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_063, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_064, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_065, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_066, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_067, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_068, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_069, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_070, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_071, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_072, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_073, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_074, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_075, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_076, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_077, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_078, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_079, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_080, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_081, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_082, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_083, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_084, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_085, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_086, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_087, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_088, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_089, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_090, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_091, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_092, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_093, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_094, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_095, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_096, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_097, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_098, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_099, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_100, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_101, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_102, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_103, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_104, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_105, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_106, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_107, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_108, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_109, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_110, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_111, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_112, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_113, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_114, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_115, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_116, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_117, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_118, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_119, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_120, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_121, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_122, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_123, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_124, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_125, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_126, int)
+IPC_MESSAGE_CONTROL1(DispatchPerfMsg_127, int)
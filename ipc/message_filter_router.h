@@ -7,6 +7,7 @@
 
 #include <vector>
 
+#include "ipc/ipc_export.h"
 #include "ipc/ipc_message_start.h"
 
 namespace IPC {
@@ -14,7 +15,7 @@ namespace IPC {
 class Message;
 class MessageFilter;
 
-class MessageFilterRouter {
+class IPC_EXPORT MessageFilterRouter {
  public:
   typedef std::vector<MessageFilter*> MessageFilters;
 
@@ -500,6 +500,13 @@ void SandboxBPF::SetSandboxPolicy(SandboxBPFPolicy* policy) {
   policy_.reset(policy);
 }
 
+void SandboxBPF::SetSyscallProfile(const SyscallProfile& profile) {
+  if (sandbox_has_started_ || !conds_) {
+    SANDBOX_DIE("Cannot change system call profile after sandbox has started");
+  }
+  syscall_profile_ = profile;
+}
+
 void SandboxBPF::InstallFilter(SandboxThreadState thread_state) {
   // We want to be very careful in not imposing any requirements on the
   // policies that are set with SetSandboxPolicy(). This means, as soon as
@@ -769,6 +776,28 @@ void SandboxBPF::FindRanges(Ranges* ranges) {
       old_err = err;
     }
   }
+
+  // Weight the ranges by how often their system calls are made. The profiled
+  // frequencies are scaled by the number of ranges, so that they outweigh the
+  // base weight of all ranges together; the base weight only matters for
+  // laying out the ranges that aren't in the profile.
+  const uint64_t scale = ranges->size();
+  for (Ranges::iterator range = ranges->begin(); range != ranges->end();
+       ++range) {
+    range->weight = 1;
+  }
+  for (SyscallProfile::const_iterator iter = syscall_profile_.begin();
+       iter != syscall_profile_.end();
+       ++iter) {
+    const uint32_t sysnum = static_cast<uint32_t>(iter->first);
+    for (Ranges::iterator range = ranges->begin(); range != ranges->end();
+         ++range) {
+      if (sysnum >= range->from && sysnum <= range->to) {
+        range->weight += iter->second * scale;
+        break;
+      }
+    }
+  }
 }
 
 Instruction* SandboxBPF::AssembleJumpTable(CodeGen* gen,
@@ -786,11 +815,31 @@ Instruction* SandboxBPF::AssembleJumpTable(CodeGen* gen,
     return RetExpression(gen, start->err);
   }
 
-  // Pick the range object that is located at the mid point of our list.
+  // Pick the range object that splits our list into two halves of about
+  // equal weight. Unless a system call profile was set, all ranges weigh
+  // the same, and this is the range at the mid point of our list. Otherwise,
+  // frequently made system calls end up closer to the top of the jump table.
   // We compare our system call number against the lowest valid system call
   // number in this range object. If our number is lower, it is outside of
   // this range object. If it is greater or equal, it might be inside.
-  Ranges::const_iterator mid = start + (stop - start) / 2;
+  uint64_t total_weight = 0;
+  for (Ranges::const_iterator iter = start; iter != stop; ++iter) {
+    total_weight += iter->weight;
+  }
+  Ranges::const_iterator mid = start + 1;
+  uint64_t best_imbalance = std::numeric_limits<uint64_t>::max();
+  uint64_t weight_below = 0;
+  for (Ranges::const_iterator iter = start + 1; iter != stop; ++iter) {
+    weight_below += (iter - 1)->weight;
+    const uint64_t weight_above = total_weight - weight_below;
+    const uint64_t imbalance = weight_below > weight_above
+                                   ? weight_below - weight_above
+                                   : weight_above - weight_below;
+    if (imbalance < best_imbalance) {
+      best_imbalance = imbalance;
+      mid = iter;
+    }
+  }
 
   // Sub-divide the list of ranges and continue recursively.
   Instruction* jf = AssembleJumpTable(gen, start, mid);
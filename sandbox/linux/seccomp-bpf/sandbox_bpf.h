@@ -70,6 +70,11 @@ class SANDBOX_EXPORT SandboxBPF {
   // program in the kernel.
   typedef std::vector<struct sock_filter> Program;
 
+  // Maps system call numbers to how often they are made, e.g. as counted by
+  // "strace -c" for a typical run of the sandboxed process. Only the relative
+  // values matter.
+  typedef std::map<int, uint64_t> SyscallProfile;
+
   // Constructors and destructors.
   // NOTE: Setting a policy and starting the sandbox is a one-way operation.
   //       The kernel does not provide any option for unloading a loaded
@@ -106,6 +111,15 @@ class SANDBOX_EXPORT SandboxBPF {
   // to the sandbox object.
   void SetSandboxPolicy(SandboxBPFPolicy* policy);
 
+  // By default, the system call jump table is a balanced binary search over
+  // all distinct ranges of system call numbers. If a profile is provided, the
+  // table is instead laid out so that frequently made system calls are found
+  // after fewer comparisons, at the expense of rare ones. System calls that
+  // are missing from |profile| are assumed to be rare. This only changes the
+  // shape of the jump table, never the result of the filter.
+  // Must be called before StartSandbox() or AssembleFilter().
+  void SetSyscallProfile(const SyscallProfile& profile);
+
   // We can use ErrorCode to request calling of a trap handler. This method
   // performs the required wrapping of the callback function into an
   // ErrorCode object.
@@ -193,9 +207,10 @@ class SANDBOX_EXPORT SandboxBPF {
 
   struct Range {
     Range(uint32_t f, uint32_t t, const ErrorCode& e)
-        : from(f), to(t), err(e) {}
+        : from(f), to(t), err(e), weight(0) {}
     uint32_t from, to;
     ErrorCode err;
+    uint64_t weight;  // Relative frequency, used to lay out the jump table.
   };
   typedef std::vector<Range> Ranges;
   typedef std::map<uint32_t, ErrorCode> ErrMap;
@@ -231,11 +246,14 @@ class SANDBOX_EXPORT SandboxBPF {
   // Finds all the ranges of system calls that need to be handled. Ranges are
   // sorted in ascending order of system call numbers. There are no gaps in the
   // ranges. System calls with identical ErrorCodes are coalesced into a single
-  // range.
+  // range. Every range has a weight of one, plus the profiled frequencies of
+  // the system calls it contains, if a profile was set.
   void FindRanges(Ranges* ranges);
 
   // Returns a BPF program snippet that implements a jump table for the
   // given range of system call numbers. This function runs recursively.
+  // The ranges are split where the weights on both sides are closest to
+  // equal. Without a profile, that is the middle range.
   Instruction* AssembleJumpTable(CodeGen* gen,
                                  Ranges::const_iterator start,
                                  Ranges::const_iterator stop);
@@ -259,6 +277,7 @@ class SANDBOX_EXPORT SandboxBPF {
   int proc_fd_;
   scoped_ptr<const SandboxBPFPolicy> policy_;
   Conds* conds_;
+  SyscallProfile syscall_profile_;
   bool sandbox_has_started_;
 
   DISALLOW_COPY_AND_ASSIGN(SandboxBPF);
@@ -194,6 +194,57 @@ BPF_TEST_C(SandboxBPF, ApplyBasicWhitelistPolicy, WhitelistGetpidPolicy) {
   BPF_ASSERT(errno == ENOMEM);
 }
 
+// A policy with a distinct range for every system call, so that the jump
+// table gets as deep as it can be.
+class AlternatingPolicy : public SandboxBPFPolicy {
+ public:
+  AlternatingPolicy() {}
+  virtual ErrorCode EvaluateSyscall(SandboxBPF*, int sysno) const OVERRIDE {
+    DCHECK(SandboxBPF::IsValidSyscallNumber(sysno));
+    if (sysno % 2) {
+      return ErrorCode(EPERM);
+    }
+    return ErrorCode(ErrorCode::ERR_ALLOWED);
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(AlternatingPolicy);
+};
+
+// Returns the number of BPF instructions |program| runs for |sysno|.
+size_t CountInstructions(const SandboxBPF::Program& program, int sysno) {
+  struct arch_seccomp_data data = {sysno, SECCOMP_ARCH};
+  size_t instructions_executed = 0;
+  const char* err = NULL;
+  Verifier::EvaluateBPF(program, data, &instructions_executed, &err);
+  BPF_ASSERT(!err);
+  return instructions_executed;
+}
+
+// The assembled filter programs are verified against the policy, so only the
+// layout of the jump table needs to be checked here.
+SANDBOX_TEST(SandboxBPF, SyscallProfile) {
+  SandboxBPF balanced_sandbox;
+  balanced_sandbox.SetSandboxPolicy(new AlternatingPolicy);
+  scoped_ptr<SandboxBPF::Program> balanced(
+      balanced_sandbox.AssembleFilter(true /* force_verification */));
+
+  SandboxBPF::SyscallProfile profile;
+  profile[__NR_getpid] = 1000;
+  profile[__NR_close] = 1000;
+  SandboxBPF profiled_sandbox;
+  profiled_sandbox.SetSandboxPolicy(new AlternatingPolicy);
+  profiled_sandbox.SetSyscallProfile(profile);
+  scoped_ptr<SandboxBPF::Program> profiled(
+      profiled_sandbox.AssembleFilter(true /* force_verification */));
+
+  // The profiled system calls take fewer comparisons to get to.
+  BPF_ASSERT_LT(CountInstructions(*profiled, __NR_getpid),
+                CountInstructions(*balanced, __NR_getpid));
+  BPF_ASSERT_LT(CountInstructions(*profiled, __NR_close),
+                CountInstructions(*balanced, __NR_close));
+}
+
 // A simple blacklist policy, with a SIGSYS handler
 intptr_t EnomemHandler(const struct arch_seccomp_data& args, void* aux) {
   // We also check that the auxiliary data is correct
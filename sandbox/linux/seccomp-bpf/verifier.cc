@@ -400,7 +400,17 @@ bool Verifier::VerifyBPF(SandboxBPF* sandbox,
 uint32_t Verifier::EvaluateBPF(const std::vector<struct sock_filter>& program,
                                const struct arch_seccomp_data& data,
                                const char** err) {
+  return EvaluateBPF(program, data, NULL, err);
+}
+
+uint32_t Verifier::EvaluateBPF(const std::vector<struct sock_filter>& program,
+                               const struct arch_seccomp_data& data,
+                               size_t* instructions_executed,
+                               const char** err) {
   *err = NULL;
+  if (instructions_executed) {
+    *instructions_executed = 0;
+  }
   if (program.size() < 1 || program.size() >= SECCOMP_MAX_PROGRAM_SIZE) {
     *err = "Invalid program length";
     return 0;
@@ -411,6 +421,9 @@ uint32_t Verifier::EvaluateBPF(const std::vector<struct sock_filter>& program,
       break;
     }
     const struct sock_filter& insn = program[state.ip];
+    if (instructions_executed) {
+      ++*instructions_executed;
+    }
     switch (BPF_CLASS(insn.code)) {
       case BPF_LD:
         Ld(&state, insn, err);
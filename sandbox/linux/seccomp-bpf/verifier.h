@@ -6,6 +6,7 @@
 #define SANDBOX_LINUX_SECCOMP_BPF_VERIFIER_H__
 
 #include <linux/filter.h>
+#include <stddef.h>
 
 #include <utility>
 #include <vector>
@@ -40,6 +41,14 @@ class Verifier {
                               const struct arch_seccomp_data& data,
                               const char** err);
 
+  // Same as above, but also returns the number of BPF instructions that were
+  // executed to compute the result in "instructions_executed". This is the
+  // cost the kernel pays for running the filter on this system call.
+  static uint32_t EvaluateBPF(const std::vector<struct sock_filter>& program,
+                              const struct arch_seccomp_data& data,
+                              size_t* instructions_executed,
+                              const char** err);
+
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(Verifier);
 };
@@ -117,6 +117,15 @@ CIncludeIterator::CIncludeIterator(const InputFile* input)
       lines_since_last_include_(0) {
 }
 
+CIncludeIterator::CIncludeIterator(const InputFile* input,
+                                   const base::StringPiece& contents)
+    : input_file_(input),
+      file_(contents),
+      offset_(0),
+      line_number_(0),
+      lines_since_last_include_(0) {
+}
+
 CIncludeIterator::~CIncludeIterator() {
 }
 
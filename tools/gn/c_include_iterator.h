@@ -19,6 +19,12 @@ class CIncludeIterator {
  public:
   // The InputFile pointed to must outlive this class.
   CIncludeIterator(const InputFile* input);
+
+  // Iterates over the given contents instead of the contents of the input
+  // file, which is then only used for the locations. This allows scanning a
+  // file that was mapped into memory rather than read. The contents must
+  // outlive this class.
+  CIncludeIterator(const InputFile* input, const base::StringPiece& contents);
   ~CIncludeIterator();
 
   // Fills in the string with the contents of the next include, and the
@@ -37,7 +43,8 @@ class CIncludeIterator {
 
   const InputFile* input_file_;
 
-  // This just points into input_file_.contents() for convenience.
+  // The contents being scanned. This usually points into
+  // input_file_.contents().
   base::StringPiece file_;
 
   // 0-based offset into the file.
@@ -128,3 +128,23 @@ TEST(CIncludeIterator, TolerateNonIncludes) {
   }
   EXPECT_FALSE(iter.GetNextIncludeString(&contents, &range));
 }
+
+// Tests scanning contents that aren't owned by the input file.
+TEST(CIncludeIterator, ExternalContents) {
+  std::string buffer;
+  buffer.append("// Some comment\n");
+  buffer.append("#include \"foo/bar.h\"\n");
+
+  InputFile file(SourceFile("//foo.cc"));
+  CIncludeIterator iter(&file, buffer);
+
+  base::StringPiece contents;
+  LocationRange range;
+  EXPECT_TRUE(iter.GetNextIncludeString(&contents, &range));
+  EXPECT_EQ("foo/bar.h", contents);
+  EXPECT_EQ(buffer.data() + buffer.find("foo/bar.h"), contents.data());
+  EXPECT_TRUE(RangeIs(range, 2, 11, 20)) << range.begin().Describe(true);
+  EXPECT_EQ(&file, range.begin().file());
+
+  EXPECT_FALSE(iter.GetNextIncludeString(&contents, &range));
+}
@@ -18,6 +18,10 @@ const char kCheck_Help[] =
     "  except that this command does not write out any build files. It's\n"
     "  intended to be an easy way to manually trigger include file checking.\n"
     "\n"
+    "  The includes found in each file are cached in the build directory and\n"
+    "  reused as long as the file's size and modification time don't change.\n"
+    "  Pass \"--time\" to see how long each phase of the check took.\n"
+    "\n"
     "  See \"gn help\" for the common command-line switches.\n";
 
 int RunCheck(const std::vector<std::string>& args) {
@@ -4,17 +4,24 @@
 
 #include "base/atomicops.h"
 #include "base/bind.h"
+#include "base/base_paths.h"
 #include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/path_service.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/timer/elapsed_timer.h"
 #include "tools/gn/build_settings.h"
 #include "tools/gn/commands.h"
+#include "tools/gn/filesystem_utils.h"
+#include "tools/gn/gen_manifest.h"
+#include "tools/gn/input_file_manager.h"
 #include "tools/gn/ninja_target_writer.h"
 #include "tools/gn/ninja_writer.h"
 #include "tools/gn/scheduler.h"
 #include "tools/gn/setup.h"
 #include "tools/gn/standard_out.h"
 #include "tools/gn/target.h"
+#include "tools/gn/trace.h"
 
 namespace commands {
 
@@ -25,6 +32,9 @@ const char kSwitchQuiet[] = "q";
 
 const char kSwitchCheck[] = "check";
 
+// Regenerate even if nothing changed since the last generation.
+const char kSwitchForce[] = "force";
+
 void BackgroundDoWrite(const Target* target,
                        const std::vector<const Item*>& deps_for_visibility) {
   // Validate visibility.
@@ -64,6 +74,71 @@ void ItemResolvedCallback(base::subtle::Atomic32* write_counter,
   }
 }
 
+base::FilePath GetManifestPath(const BuildSettings& build_settings) {
+  return build_settings.GetFullPath(SourceFile(
+      build_settings.build_dir().value() + GenManifest::kFileName));
+}
+
+base::FilePath GetBuildNinjaPath(const BuildSettings& build_settings) {
+  return build_settings.GetFullPath(SourceFile(
+      build_settings.build_dir().value() + "build.ninja"));
+}
+
+// Returns true if the manifest in the build directory says that the last
+// generation had the same command line and that none of the files it read
+// have changed since.
+bool IsUpToDate(const BuildSettings& build_settings,
+                const std::string& command_line,
+                size_t* files_checked) {
+  // Deleting build.ninja forces a regeneration.
+  if (!base::PathExists(GetBuildNinjaPath(build_settings)))
+    return false;
+
+  GenManifest manifest;
+  if (!manifest.Load(GetManifestPath(build_settings)) ||
+      manifest.command_line() != command_line)
+    return false;
+  *files_checked = manifest.file_count();
+  return manifest.FilesAreUnchanged();
+}
+
+// Records the files read by this generation, which started at |start_time|,
+// so the next one can be skipped if none of them change. Failing to write the
+// manifest only means the next generation won't be skipped.
+void WriteManifest(const BuildSettings& build_settings,
+                   const std::string& command_line,
+                   base::Time start_time) {
+  // The manifest of the last generation no longer describes the ninja files.
+  const base::FilePath manifest_path = GetManifestPath(build_settings);
+  base::DeleteFile(manifest_path, false);
+
+  GenManifest manifest;
+  manifest.set_command_line(command_line);
+
+  // A different gn could generate different files.
+  base::FilePath exe_path;
+  if (!PathService::Get(base::FILE_EXE, &exe_path) ||
+      !manifest.AddFile(exe_path))
+    return;
+
+  // The build files, and everything else ninja would rerun gn for.
+  std::vector<base::FilePath> files;
+  g_scheduler->input_file_manager()->GetAllPhysicalInputFileNames(&files);
+  std::vector<base::FilePath> other_files = g_scheduler->GetGenDependencies();
+  files.insert(files.end(), other_files.begin(), other_files.end());
+
+  for (size_t i = 0; i < files.size(); i++) {
+    if (!manifest.AddFile(files[i]))
+      return;
+  }
+
+  // The sizes and times are only read now, so a file saved during the
+  // generation would be recorded in its new state.
+  if (manifest.HasFileModifiedSince(start_time))
+    return;
+  manifest.Save(manifest_path);
+}
+
 }  // namespace
 
 const char kGen[] = "gen";
@@ -82,10 +157,22 @@ const char kGen_Help[] =
     "  Or it can be a directory relative to the current directory such as:\n"
     "      out/foo\n"
     "\n"
+    "  If none of the files read by the last \"gn gen\" into the same\n"
+    "  directory have changed, and the command line is the same, nothing is\n"
+    "  regenerated. Otherwise only the ninja files whose contents changed are\n"
+    "  written. Runs with \"--check\" are never skipped since they also read\n"
+    "  the source files.\n"
+    "\n"
+    "Option:\n"
+    "  --force\n"
+    "      Regenerate even if nothing changed, for example after a generated\n"
+    "      ninja file was edited or deleted by hand.\n"
+    "\n"
     "  See \"gn help\" for the common command-line switches.\n";
 
 int RunGen(const std::vector<std::string>& args) {
   base::ElapsedTimer timer;
+  const base::Time start_time = base::Time::Now();
 
   if (args.size() != 1) {
     Err(Location(), "Need exactly one build directory to generate.",
@@ -99,8 +186,26 @@ int RunGen(const std::vector<std::string>& args) {
   if (!setup->DoSetup(args[0]))
     return 1;
 
-  if (CommandLine::ForCurrentProcess()->HasSwitch(kSwitchCheck))
+  const CommandLine* cmdline = CommandLine::ForCurrentProcess();
+  std::string command_line = FilePathToUTF8(cmdline->GetArgumentsString());
+  if (cmdline->HasSwitch(kSwitchCheck)) {
     setup->set_check_public_headers(true);
+  } else if (!cmdline->HasSwitch(kSwitchForce)) {
+    size_t files_checked = 0;
+    if (IsUpToDate(setup->build_settings(), command_line, &files_checked)) {
+      if (!cmdline->HasSwitch(kSwitchQuiet)) {
+        OutputString("Done. ", DECORATION_GREEN);
+        OutputString("Up to date, checked " +
+            base::IntToString(static_cast<int>(files_checked)) +
+            " files in " +
+            base::IntToString(timer.Elapsed().InMilliseconds()) + "ms\n");
+      }
+      return 0;
+    }
+  }
+
+  // The timing summary should include writing the root ninja files below.
+  setup->set_write_traces(false);
 
   // Cause the load to also generate the ninja files for each target. We wrap
   // the writing to maintain a counter.
@@ -114,13 +219,19 @@ int RunGen(const std::vector<std::string>& args) {
     return 1;
 
   // Write the root ninja files.
+  ScopedTrace phase_trace(TraceItem::TRACE_PHASE, "Write root ninja files");
   if (!NinjaWriter::RunAndWriteFiles(&setup->build_settings(),
                                      setup->builder()))
     return 1;
+  phase_trace.Done();
+
+  WriteManifest(setup->build_settings(), command_line, start_time);
+
+  setup->WriteTraces();
 
   base::TimeDelta elapsed_time = timer.Elapsed();
 
-  if (!CommandLine::ForCurrentProcess()->HasSwitch(kSwitchQuiet)) {
+  if (!cmdline->HasSwitch(kSwitchQuiet)) {
     OutputString("Done. ", DECORATION_GREEN);
 
     std::string stats = "Wrote " +
@@ -650,6 +650,24 @@ std::string GetOutputSubdirName(const Label& toolchain_label, bool is_default) {
   return toolchain_label.name() + "/";
 }
 
+bool WriteFileIfChanged(const base::FilePath& file_path,
+                        const std::string& data) {
+  // Comparing the size first avoids reading most files that did change.
+  int64 existing_size;
+  if (base::GetFileSize(file_path, &existing_size) &&
+      existing_size == static_cast<int64>(data.size())) {
+    std::string existing_data;
+    if (base::ReadFileToString(file_path, &existing_data) &&
+        existing_data == data)
+      return true;
+  }
+
+  if (!base::CreateDirectory(file_path.DirName()))
+    return false;
+  int size = static_cast<int>(data.size());
+  return base::WriteFile(file_path, data.c_str(), size) == size;
+}
+
 SourceDir GetToolchainOutputDir(const Settings* settings) {
   return settings->toolchain_output_subdir().AsSourceDir(
       settings->build_settings());
@@ -157,6 +157,20 @@ SourceDir SourceDirForCurrentDirectory(const base::FilePath& source_root);
 // go in the root build directory. Otherwise, the result will end in a slash.
 std::string GetOutputSubdirName(const Label& toolchain_label, bool is_default);
 
+// Writes the given data to the file, creating its directory if necessary,
+// unless the file already has exactly that data. Leaving unchanged files alone
+// keeps their timestamps, so ninja doesn't consider anything that depends on
+// them to be dirty. Returns true on success.
+bool WriteFileIfChanged(const base::FilePath& file_path,
+                        const std::string& data);
+
+// Writes the given data to the file, creating its directory if necessary,
+// unless the file already has exactly that data. Leaving unchanged files alone
+// keeps their timestamps, so ninja doesn't consider anything that depends on
+// them to be dirty. Returns true on success.
+bool WriteFileIfChanged(const base::FilePath& file_path,
+                        const std::string& data);
+
 // -----------------------------------------------------------------------------
 
 // These functions return the various flavors of output and gen directories.
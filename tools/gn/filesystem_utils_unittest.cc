@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "build/build_config.h"
@@ -507,3 +509,30 @@ TEST(FilesystemUtils, GetDirForEmptyBuildDir) {
             GetGenDirForSourceDirAsOutputFile(
                 &settings, SourceDir("//")).value());
 }
+
+TEST(FilesystemUtils, WriteFileIfChanged) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  // The directory is created if needed.
+  base::FilePath file_path =
+      temp_dir.path().AppendASCII("foo").AppendASCII("foo.ninja");
+  EXPECT_TRUE(WriteFileIfChanged(file_path, "build foo: phony\n"));
+
+  std::string contents;
+  EXPECT_TRUE(base::ReadFileToString(file_path, &contents));
+  EXPECT_EQ("build foo: phony\n", contents);
+
+  // Writing the same contents leaves the file alone.
+  base::Time old_time = base::Time::Now() - base::TimeDelta::FromHours(1);
+  ASSERT_TRUE(base::TouchFile(file_path, old_time, old_time));
+  EXPECT_TRUE(WriteFileIfChanged(file_path, "build foo: phony\n"));
+  base::File::Info info;
+  ASSERT_TRUE(base::GetFileInfo(file_path, &info));
+  EXPECT_EQ(old_time.ToTimeT(), info.last_modified.ToTimeT());
+
+  // Different contents of the same size are still written.
+  EXPECT_TRUE(WriteFileIfChanged(file_path, "build bar: phony\n"));
+  EXPECT_TRUE(base::ReadFileToString(file_path, &contents));
+  EXPECT_EQ("build bar: phony\n", contents);
+}
@@ -0,0 +1,145 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/gen_manifest.h"
+
+#include "base/file_util.h"
+#include "base/files/file.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "tools/gn/filesystem_utils.h"
+
+// The manifest file is a header line and the command line, followed by one
+// line per file:
+//
+//   <size> <last modified> <path>
+//
+// The path runs to the end of the line, so it can contain spaces.
+
+namespace {
+
+const char kHeader[] = "gn manifest 1";
+
+bool GetFileRecordInfo(const base::FilePath& path,
+                       int64* size,
+                       int64* last_modified) {
+  base::File::Info info;
+  if (!base::GetFileInfo(path, &info) || info.is_directory)
+    return false;
+  *size = info.size;
+  *last_modified = info.last_modified.ToInternalValue();
+  return true;
+}
+
+// Returns false at the end of the input.
+bool GetNextLine(const base::StringPiece& input,
+                 size_t* offset,
+                 base::StringPiece* line) {
+  if (*offset >= input.size())
+    return false;
+  size_t end = input.find('\n', *offset);
+  if (end == base::StringPiece::npos)
+    end = input.size();
+  *line = input.substr(*offset, end - *offset);
+  *offset = end + 1;
+  return true;
+}
+
+}  // namespace
+
+const char GenManifest::kFileName[] = "gn_manifest";
+
+GenManifest::GenManifest() {
+}
+
+GenManifest::~GenManifest() {
+}
+
+bool GenManifest::AddFile(const base::FilePath& path) {
+  FileRecord record;
+  record.path = path;
+  if (!GetFileRecordInfo(path, &record.size, &record.last_modified))
+    return false;
+  files_.push_back(record);
+  return true;
+}
+
+bool GenManifest::Load(const base::FilePath& path) {
+  command_line_.clear();
+  files_.clear();
+
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return false;
+
+  size_t offset = 0;
+  base::StringPiece line;
+  if (!GetNextLine(contents, &offset, &line) || line != kHeader)
+    return false;
+  if (!GetNextLine(contents, &offset, &line))
+    return false;
+  std::string command_line = line.as_string();
+
+  std::vector<FileRecord> files;
+  while (GetNextLine(contents, &offset, &line)) {
+    size_t first_space = line.find(' ');
+    size_t second_space = first_space == base::StringPiece::npos ?
+        base::StringPiece::npos : line.find(' ', first_space + 1);
+    if (second_space == base::StringPiece::npos)
+      return false;
+
+    FileRecord record;
+    if (!base::StringToInt64(line.substr(0, first_space), &record.size) ||
+        !base::StringToInt64(
+            line.substr(first_space + 1, second_space - first_space - 1),
+            &record.last_modified))
+      return false;
+    record.path = UTF8ToFilePath(line.substr(second_space + 1));
+    files.push_back(record);
+  }
+
+  command_line_.swap(command_line);
+  files_.swap(files);
+  return true;
+}
+
+bool GenManifest::Save(const base::FilePath& path) const {
+  std::string contents(kHeader);
+  contents.push_back('\n');
+  contents.append(command_line_);
+  contents.push_back('\n');
+  for (size_t i = 0; i < files_.size(); i++) {
+    contents.append(base::Int64ToString(files_[i].size));
+    contents.push_back(' ');
+    contents.append(base::Int64ToString(files_[i].last_modified));
+    contents.push_back(' ');
+    contents.append(FilePathToUTF8(files_[i].path));
+    contents.push_back('\n');
+  }
+  return WriteFileIfChanged(path, contents);
+}
+
+bool GenManifest::FilesAreUnchanged() const {
+  if (files_.empty())
+    return false;
+
+  for (size_t i = 0; i < files_.size(); i++) {
+    int64 size;
+    int64 last_modified;
+    if (!GetFileRecordInfo(files_[i].path, &size, &last_modified) ||
+        size != files_[i].size ||
+        last_modified != files_[i].last_modified)
+      return false;
+  }
+  return true;
+}
+
+bool GenManifest::HasFileModifiedSince(base::Time time) const {
+  const int64 internal_time = time.ToInternalValue();
+  for (size_t i = 0; i < files_.size(); i++) {
+    if (files_[i].last_modified >= internal_time)
+      return true;
+  }
+  return false;
+}
@@ -0,0 +1,72 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_GEN_MANIFEST_H_
+#define TOOLS_GN_GEN_MANIFEST_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/time/time.h"
+
+// Records the files a "gn gen" read, along with their sizes and modification
+// times, so that running it again into the same directory can tell that none
+// of them changed and skip regenerating.
+//
+// This is the same information ninja uses to decide when to rerun gn (the
+// build.ninja.d file), plus gn itself and the command line it was run with.
+class GenManifest {
+ public:
+  // Name of the manifest file in the build directory.
+  static const char kFileName[];
+
+  GenManifest();
+  ~GenManifest();
+
+  // The command line the build was generated with. A regeneration can only be
+  // skipped if it has the same command line.
+  const std::string& command_line() const { return command_line_; }
+  void set_command_line(const std::string& c) { command_line_ = c; }
+
+  // Records the current size and modification time of the given file.
+  // Returns false if the file doesn't exist.
+  bool AddFile(const base::FilePath& path);
+
+  // Replaces the contents of the manifest with the given file. Returns false
+  // and leaves the manifest empty if the file doesn't exist or isn't in the
+  // current format.
+  bool Load(const base::FilePath& path);
+
+  // Returns true on success.
+  bool Save(const base::FilePath& path) const;
+
+  // Returns true if every recorded file still has the size and modification
+  // time it was recorded with. An empty manifest is never up to date.
+  bool FilesAreUnchanged() const;
+
+  // Returns true if any file was recorded with a modification time at or
+  // after |time|. A file saved while gen was reading it may have been read
+  // in its old state, so a manifest recording it must not be trusted.
+  bool HasFileModifiedSince(base::Time time) const;
+
+  size_t file_count() const { return files_.size(); }
+
+ private:
+  struct FileRecord {
+    FileRecord() : size(0), last_modified(0) {}
+
+    base::FilePath path;
+    int64 size;
+    int64 last_modified;  // Internal value of the base::Time.
+  };
+
+  std::string command_line_;
+  std::vector<FileRecord> files_;
+
+  DISALLOW_COPY_AND_ASSIGN(GenManifest);
+};
+
+#endif  // TOOLS_GN_GEN_MANIFEST_H_
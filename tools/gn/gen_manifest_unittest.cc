@@ -0,0 +1,101 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "tools/gn/gen_manifest.h"
+
+namespace {
+
+bool WriteTestFile(const base::FilePath& path, const std::string& contents) {
+  int size = static_cast<int>(contents.size());
+  return base::WriteFile(path, contents.c_str(), size) == size;
+}
+
+}  // namespace
+
+TEST(GenManifest, SaveLoad) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath manifest_path =
+      temp_dir.path().AppendASCII(GenManifest::kFileName);
+  base::FilePath build_file = temp_dir.path().AppendASCII("BUILD.gn");
+  base::FilePath other_file = temp_dir.path().AppendASCII("some file.gni");
+  ASSERT_TRUE(WriteTestFile(build_file, "group(\"foo\") {}\n"));
+  ASSERT_TRUE(WriteTestFile(other_file, "a = 1\n"));
+
+  {
+    GenManifest manifest;
+    EXPECT_FALSE(manifest.Load(manifest_path));
+
+    // Empty manifests are never up to date.
+    EXPECT_FALSE(manifest.FilesAreUnchanged());
+
+    manifest.set_command_line("gen out/Debug");
+    EXPECT_TRUE(manifest.AddFile(build_file));
+    EXPECT_TRUE(manifest.AddFile(other_file));
+    EXPECT_FALSE(manifest.AddFile(temp_dir.path().AppendASCII("missing")));
+    EXPECT_TRUE(manifest.FilesAreUnchanged());
+    EXPECT_TRUE(manifest.Save(manifest_path));
+  }
+
+  GenManifest manifest;
+  EXPECT_TRUE(manifest.Load(manifest_path));
+  EXPECT_EQ("gen out/Debug", manifest.command_line());
+  EXPECT_EQ(2u, manifest.file_count());
+  EXPECT_TRUE(manifest.FilesAreUnchanged());
+
+  // Changing the contents of a file is noticed through the size...
+  ASSERT_TRUE(WriteTestFile(other_file, "a = 10\n"));
+  EXPECT_FALSE(manifest.FilesAreUnchanged());
+  ASSERT_TRUE(WriteTestFile(other_file, "a = 1\n"));
+
+  // ...or the modification time.
+  base::Time later = base::Time::Now() + base::TimeDelta::FromHours(1);
+  ASSERT_TRUE(base::TouchFile(other_file, later, later));
+  EXPECT_FALSE(manifest.FilesAreUnchanged());
+
+  // So is deleting one.
+  ASSERT_TRUE(base::DeleteFile(build_file, false));
+  EXPECT_FALSE(manifest.FilesAreUnchanged());
+}
+
+TEST(GenManifest, HasFileModifiedSince) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath build_file = temp_dir.path().AppendASCII("BUILD.gn");
+  ASSERT_TRUE(WriteTestFile(build_file, "group(\"foo\") {}\n"));
+  base::Time modified = base::Time::Now() - base::TimeDelta::FromHours(1);
+  ASSERT_TRUE(base::TouchFile(build_file, modified, modified));
+
+  GenManifest manifest;
+  EXPECT_FALSE(manifest.HasFileModifiedSince(modified));
+  EXPECT_TRUE(manifest.AddFile(build_file));
+  EXPECT_FALSE(manifest.HasFileModifiedSince(
+      modified + base::TimeDelta::FromMinutes(1)));
+
+  // A file modified at the start of the generation or later may have been
+  // read before the change.
+  EXPECT_TRUE(manifest.HasFileModifiedSince(
+      modified - base::TimeDelta::FromMinutes(1)));
+}
+
+TEST(GenManifest, LoadBadFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath manifest_path =
+      temp_dir.path().AppendASCII(GenManifest::kFileName);
+
+  ASSERT_TRUE(WriteTestFile(manifest_path,
+                            "gn manifest 1\n"
+                            "gen out/Debug\n"
+                            "12 BUILD.gn\n"));
+
+  GenManifest manifest;
+  EXPECT_FALSE(manifest.Load(manifest_path));
+  EXPECT_TRUE(manifest.command_line().empty());
+  EXPECT_EQ(0u, manifest.file_count());
+}
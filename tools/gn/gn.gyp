@@ -66,12 +66,16 @@
         'function_template.cc',
         'function_toolchain.cc',
         'function_write_file.cc',
+        'gen_manifest.cc',
+        'gen_manifest.h',
         'group_target_generator.cc',
         'group_target_generator.h',
         'header_checker.cc',
         'header_checker.h',
         'import_manager.cc',
         'import_manager.h',
+        'include_cache.cc',
+        'include_cache.h',
         'input_conversion.cc',
         'input_conversion.h',
         'input_file.cc',
@@ -203,7 +207,9 @@
         'function_write_file_unittest.cc',
         'functions_target_unittest.cc',
         'functions_unittest.cc',
+        'gen_manifest_unittest.cc',
         'header_checker_unittest.cc',
+        'include_cache_unittest.cc',
         'input_conversion_unittest.cc',
         'label_unittest.cc',
         'loader_unittest.cc',
@@ -8,6 +8,7 @@
 
 #include "base/bind.h"
 #include "base/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/message_loop/message_loop.h"
 #include "base/threading/sequenced_worker_pool.h"
 #include "tools/gn/build_settings.h"
@@ -16,6 +17,7 @@
 #include "tools/gn/config.h"
 #include "tools/gn/err.h"
 #include "tools/gn/filesystem_utils.h"
+#include "tools/gn/input_file.h"
 #include "tools/gn/scheduler.h"
 #include "tools/gn/source_file_type.h"
 #include "tools/gn/target.h"
@@ -23,23 +25,29 @@
 
 namespace {
 
-// This class makes InputFiles on the stack as it reads files to check. When
-// we throw an error, the Err indicates a locatin which has a pointer to
-// an InputFile that must persist as long as the Err does.
+// Includes are usually found without keeping the file contents around (the
+// file is either mapped while it's scanned or not read at all when the include
+// cache has it). When we throw an error, the Err indicates a location which has
+// a pointer to an InputFile that must persist as long as the Err does.
 //
-// To make this work, this function creates a clone of the InputFile managed
+// To make this work, this function reads the file into an InputFile managed
 // by the InputFileManager so the error can refer to something that
 // persists. This means that the current file contents will live as long as
 // the program, but this is OK since we're erroring out anyway.
-LocationRange CreatePersistentRange(const InputFile& input_file,
+LocationRange CreatePersistentRange(const BuildSettings* build_settings,
+                                    const SourceFile& source_file,
                                     const LocationRange& range) {
   InputFile* clone_input_file;
   std::vector<Token>* tokens;  // Don't care about this.
   scoped_ptr<ParseNode>* parse_root;  // Don't care about this.
 
+  // If the read fails, the error is still reported, just without the line.
+  std::string contents;
+  base::ReadFileToString(build_settings->GetFullPath(source_file), &contents);
+
   g_scheduler->input_file_manager()->AddDynamicInput(
-      input_file.name(), &clone_input_file, &tokens, &parse_root);
-  clone_input_file->SetContents(input_file.contents());
+      source_file, &clone_input_file, &tokens, &parse_root);
+  clone_input_file->SetContents(contents);
 
   return LocationRange(
       Location(clone_input_file, range.begin().line_number(),
@@ -135,41 +143,67 @@ bool HeaderChecker::Run(std::vector<Err>* errors) {
   if (file_map_.empty())
     return true;
 
+  // Includes found in earlier runs are kept in the build directory.
+  base::FilePath cache_path = build_settings_->GetFullPath(SourceFile(
+      build_settings_->build_dir().value() + IncludeCache::kFileName));
+  include_cache_.Load(cache_path);
+
+  // Each file is scanned once no matter how many targets list it, and then
+  // checked for each of those targets.
   scoped_refptr<base::SequencedWorkerPool> pool(
       new base::SequencedWorkerPool(16, "HeaderChecker"));
   for (FileMap::const_iterator file_i = file_map_.begin();
        file_i != file_map_.end(); ++file_i) {
-    const TargetVector& vect = file_i->second;
-
     // Only check C-like source files (RC files also have includes).
     SourceFileType type = GetSourceFileType(file_i->first);
     if (type != SOURCE_CC && type != SOURCE_H && type != SOURCE_C &&
         type != SOURCE_M && type != SOURCE_MM && type != SOURCE_RC)
       continue;
 
-    for (size_t vect_i = 0; vect_i < vect.size(); ++vect_i) {
-      pool->PostWorkerTaskWithShutdownBehavior(
-          FROM_HERE,
-          base::Bind(&HeaderChecker::DoWork, this,
-                     vect[vect_i].target, file_i->first),
-          base::SequencedWorkerPool::BLOCK_SHUTDOWN);
-    }
+    pool->PostWorkerTaskWithShutdownBehavior(
+        FROM_HERE,
+        base::Bind(&HeaderChecker::DoWork, this, file_i->first),
+        base::SequencedWorkerPool::BLOCK_SHUTDOWN);
   }
 
   // After this call we're single-threaded again.
   pool->Shutdown();
 
+  // Failing to save only costs time on the next run.
+  include_cache_.Save(cache_path);
+
   if (errors_.empty())
     return true;
   *errors = errors_;
   return false;
 }
 
-void HeaderChecker::DoWork(const Target* target, const SourceFile& file) {
+void HeaderChecker::DoWork(const SourceFile& file) {
+  ScopedTrace trace(TraceItem::TRACE_CHECK_HEADER, file.value());
+
+  // Sometimes you have generated source files included as sources in another
+  // target. These won't exist at checking time. Since we require all generated
+  // files to be somewhere in the output tree, we can just check the name to
+  // see if they should be skipped.
+  if (IsFileInOuputDir(file))
+    return;
+
+  const TargetVector& targets = file_map_.find(file)->second;
+  DCHECK(!targets.empty());
+
   Err err;
-  if (!CheckFile(target, file, &err)) {
+  IncludeCache::IncludeVector includes;
+  if (!GetIncludes(targets[0].target, file, &includes, &err)) {
     base::AutoLock lock(lock_);
     errors_.push_back(err);
+    return;
+  }
+
+  for (size_t i = 0; i < targets.size(); i++) {
+    if (!CheckFile(targets[i].target, file, includes, &err)) {
+      base::AutoLock lock(lock_);
+      errors_.push_back(err);
+    }
   }
 }
 
@@ -215,39 +249,65 @@ SourceFile HeaderChecker::SourceFileForInclude(
   return SourceFile(str);
 }
 
-bool HeaderChecker::CheckFile(const Target* from_target,
-                              const SourceFile& file,
-                              Err* err) const {
-  ScopedTrace trace(TraceItem::TRACE_CHECK_HEADER, file.value());
-
-  // Sometimes you have generated source files included as sources in another
-  // target. These won't exist at checking time. Since we require all generated
-  // files to be somewhere in the output tree, we can just check the name to
-  // see if they should be skipped.
-  if (IsFileInOuputDir(file))
-    return true;
-
+bool HeaderChecker::GetIncludes(const Target* from_target,
+                                const SourceFile& file,
+                                IncludeCache::IncludeVector* includes,
+                                Err* err) {
   base::FilePath path = build_settings_->GetFullPath(file);
-  std::string contents;
-  if (!base::ReadFileToString(path, &contents)) {
+  base::File::Info info;
+  if (!base::GetFileInfo(path, &info) || info.is_directory) {
     *err = Err(from_target->defined_from(), "Source file not found.",
         "This target includes as a source:\n  " + file.value() +
         "\nwhich was not found.");
     return false;
   }
 
-  InputFile input_file(file);
-  input_file.SetContents(contents);
+  if (include_cache_.Get(file, info, includes))
+    return true;
+
+  // Map the file rather than reading it. The scan usually stops near the top
+  // of the file, so most of it is never touched. Empty files can't be mapped.
+  base::MemoryMappedFile mapped_file;
+  base::StringPiece contents;
+  if (info.size > 0) {
+    if (!mapped_file.Initialize(path)) {
+      *err = Err(from_target->defined_from(), "Source file not found.",
+          "This target includes as a source:\n  " + file.value() +
+          "\nwhich could not be read.");
+      return false;
+    }
+    contents = base::StringPiece(
+        reinterpret_cast<const char*>(mapped_file.data()),
+        mapped_file.length());
+  }
 
-  CIncludeIterator iter(&input_file);
+  InputFile input_file(file);
+  CIncludeIterator iter(&input_file, contents);
   base::StringPiece current_include;
   LocationRange range;
   while (iter.GetNextIncludeString(&current_include, &range)) {
-    SourceFile include = SourceFileForInclude(current_include);
-    if (!CheckInclude(from_target, input_file, include, range, err))
-      return false;
+    includes->push_back(IncludeCache::Include(current_include,
+                                              range.begin().line_number(),
+                                              range.begin().char_offset()));
   }
 
+  include_cache_.Set(file, info, *includes);
+  return true;
+}
+
+bool HeaderChecker::CheckFile(const Target* from_target,
+                              const SourceFile& file,
+                              const IncludeCache::IncludeVector& includes,
+                              Err* err) const {
+  for (size_t i = 0; i < includes.size(); i++) {
+    const IncludeCache::Include& include = includes[i];
+    int end_char = include.begin_char + static_cast<int>(include.path.size());
+    LocationRange range(Location(NULL, include.line, include.begin_char),
+                        Location(NULL, include.line, end_char));
+    if (!CheckInclude(from_target, file, SourceFileForInclude(include.path),
+                      range, err))
+      return false;
+  }
   return true;
 }
 
@@ -261,7 +321,7 @@ bool HeaderChecker::CheckFile(const Target* from_target,
 //    include file needs needs compiler settings to compile it, that those
 //    settings are applied to the file including it.
 bool HeaderChecker::CheckInclude(const Target* from_target,
-                                 const InputFile& source_file,
+                                 const SourceFile& source_file,
                                  const SourceFile& include_file,
                                  const LocationRange& range,
                                  Err* err) const {
@@ -310,7 +370,7 @@ bool HeaderChecker::CheckInclude(const Target* from_target,
             "\n(see \"gn help visibility\").";
 
         // Danger: must call CreatePersistentRange to put in Err.
-        *err = Err(CreatePersistentRange(source_file, range),
+        *err = Err(CreatePersistentRange(build_settings_, source_file, range),
             "Including a header from non-visible target.", msg);
         return false;
       }
@@ -318,7 +378,7 @@ bool HeaderChecker::CheckInclude(const Target* from_target,
       // The file must be public in the target.
       if (!targets[i].is_public) {
         // Danger: must call CreatePersistentRange to put in Err.
-        *err = Err(CreatePersistentRange(source_file, range),
+        *err = Err(CreatePersistentRange(build_settings_, source_file, range),
                    "Including a private header.",
                    "This file is private to the target " +
                        targets[i].target->label().GetUserVisibleName(false));
@@ -330,7 +390,7 @@ bool HeaderChecker::CheckInclude(const Target* from_target,
       if (has_direct_dependent_compiler_settings &&
           !direct_dependent_configs_apply) {
         size_t problematic_index = GetDependentConfigChainProblemIndex(chain);
-        *err = Err(CreatePersistentRange(source_file, range),
+        *err = Err(CreatePersistentRange(build_settings_, source_file, range),
                    "Can't include this header from here.",
                    GetDependentConfigChainError(chain, problematic_index));
         return false;
@@ -352,7 +412,7 @@ bool HeaderChecker::CheckInclude(const Target* from_target,
         from_target->label().GetUserVisibleName(false);
 
     // Danger: must call CreatePersistentRange to put in Err.
-    *err = Err(CreatePersistentRange(source_file, range),
+    *err = Err(CreatePersistentRange(build_settings_, source_file, range),
                "Include not allowed.", msg);
     return false;
   }
@@ -16,9 +16,9 @@
 #include "base/strings/string_piece.h"
 #include "base/synchronization/lock.h"
 #include "tools/gn/err.h"
+#include "tools/gn/include_cache.h"
 
 class BuildSettings;
-class InputFile;
 class Label;
 class LocationRange;
 class SourceFile;
@@ -44,6 +44,7 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
   FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest,
                            IsDependencyOf_ForwardsDirectDependentConfigs);
   FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest, CheckInclude);
+  FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest, GetIncludes);
   FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest,
                            GetDependentConfigChainProblemIndex);
   ~HeaderChecker();
@@ -58,7 +59,9 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
 
   typedef std::vector<TargetInfo> TargetVector;
 
-  void DoWork(const Target* target, const SourceFile& file);
+  // Scans the given file once and checks its includes for every target the
+  // file is listed in.
+  void DoWork(const SourceFile& file);
 
   // Adds the sources and public files from the given target to the file_map_.
   // Not threadsafe! Called only during init.
@@ -70,18 +73,28 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
   // Resolves the contents of an include to a SourceFile.
   SourceFile SourceFileForInclude(const base::StringPiece& input) const;
 
-  // from_target is the target the file was defined from. It will be used in
-  // error messages.
+  // Gets the user includes of the given file, from the include cache if the
+  // file hasn't changed since it was last scanned, or else by mapping the
+  // file into memory and scanning it. from_target is a target the file is
+  // listed in. It will be used in error messages.
+  bool GetIncludes(const Target* from_target,
+                   const SourceFile& file,
+                   IncludeCache::IncludeVector* includes,
+                   Err* err);
+
+  // Checks the includes found in the given file against from_target, which is
+  // a target the file is listed in.
   bool CheckFile(const Target* from_target,
                  const SourceFile& file,
+                 const IncludeCache::IncludeVector& includes,
                  Err* err) const;
 
   // Checks that the given file in the given target can include the given
   // include file. If disallowed, returns false and sets the error. The
   // range indicates the location of the include in the file for error
-  // reporting.
+  // reporting; only its line and character offsets are used.
   bool CheckInclude(const Target* from_target,
-                    const InputFile& source_file,
+                    const SourceFile& source_file,
                     const SourceFile& include_file,
                     const LocationRange& range,
                     Err* err) const;
@@ -144,6 +157,9 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
 
   std::vector<Err> errors_;
 
+  // Threadsafe on its own.
+  IncludeCache include_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(HeaderChecker);
 };
 
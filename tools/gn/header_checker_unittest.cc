@@ -4,6 +4,8 @@
 
 #include <vector>
 
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "tools/gn/config.h"
 #include "tools/gn/header_checker.h"
@@ -142,8 +144,7 @@ TEST_F(HeaderCheckerTest, IsDependencyOf_ForwardsDirectDependentConfigs) {
 }
 
 TEST_F(HeaderCheckerTest, CheckInclude) {
-  InputFile input_file(SourceFile("//some_file.cc"));
-  input_file.SetContents(std::string());
+  SourceFile file("//some_file.cc");
   LocationRange range;  // Dummy value.
 
   // Add a disconnected target d with a header to check that you have to have
@@ -170,24 +171,24 @@ TEST_F(HeaderCheckerTest, CheckInclude) {
   // A file in target A can't include a header from D because A has no
   // dependency on D.
   Err err;
-  EXPECT_FALSE(checker->CheckInclude(&a_, input_file, d_header, range, &err));
+  EXPECT_FALSE(checker->CheckInclude(&a_, file, d_header, range, &err));
   EXPECT_TRUE(err.has_error());
 
   // A can include the public header in B.
   err = Err();
-  EXPECT_TRUE(checker->CheckInclude(&a_, input_file, b_public, range, &err));
+  EXPECT_TRUE(checker->CheckInclude(&a_, file, b_public, range, &err));
   EXPECT_FALSE(err.has_error());
 
   // Check A depending on the public and private headers in C.
   err = Err();
-  EXPECT_TRUE(checker->CheckInclude(&a_, input_file, c_public, range, &err));
+  EXPECT_TRUE(checker->CheckInclude(&a_, file, c_public, range, &err));
   EXPECT_FALSE(err.has_error());
-  EXPECT_FALSE(checker->CheckInclude(&a_, input_file, c_private, range, &err));
+  EXPECT_FALSE(checker->CheckInclude(&a_, file, c_private, range, &err));
   EXPECT_TRUE(err.has_error());
 
   // A can depend on a random file unknown to the build.
   err = Err();
-  EXPECT_TRUE(checker->CheckInclude(&a_, input_file, SourceFile("//random.h"),
+  EXPECT_TRUE(checker->CheckInclude(&a_, file, SourceFile("//random.h"),
                                     range, &err));
   EXPECT_FALSE(err.has_error());
 
@@ -195,7 +196,7 @@ TEST_F(HeaderCheckerTest, CheckInclude) {
   // is a dependency path.
   c_.visibility().SetPrivate(c_.label().dir());
   err = Err();
-  EXPECT_FALSE(checker->CheckInclude(&a_, input_file, c_public, range, &err));
+  EXPECT_FALSE(checker->CheckInclude(&a_, file, c_public, range, &err));
   EXPECT_TRUE(err.has_error());
   c_.visibility().SetPublic();
 
@@ -207,18 +208,18 @@ TEST_F(HeaderCheckerTest, CheckInclude) {
 
     c_.direct_dependent_configs().push_back(LabelConfigPair(&direct));
     err = Err();
-    EXPECT_FALSE(checker->CheckInclude(&a_, input_file, c_public, range, &err));
+    EXPECT_FALSE(checker->CheckInclude(&a_, file, c_public, range, &err));
     EXPECT_TRUE(err.has_error());
 
     b_.forward_dependent_configs().push_back(LabelTargetPair(&c_));
     err = Err();
-    EXPECT_TRUE(checker->CheckInclude(&a_, input_file, c_public, range, &err));
+    EXPECT_TRUE(checker->CheckInclude(&a_, file, c_public, range, &err));
     EXPECT_FALSE(err.has_error());
 
     b_.forward_dependent_configs().clear();
     b_.set_output_type(Target::GROUP);
     err = Err();
-    EXPECT_TRUE(checker->CheckInclude(&a_, input_file, c_public, range, &err));
+    EXPECT_TRUE(checker->CheckInclude(&a_, file, c_public, range, &err));
     EXPECT_FALSE(err.has_error());
 
     b_.set_output_type(Target::UNKNOWN);
@@ -257,3 +258,55 @@ TEST_F(HeaderCheckerTest, GetDependentConfigChainProblemIndex) {
   target_b.forward_dependent_configs().clear();
   EXPECT_EQ(2u, HeaderChecker::GetDependentConfigChainProblemIndex(chain));
 }
+
+TEST_F(HeaderCheckerTest, GetIncludes) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  setup_.build_settings()->SetRootPath(temp_dir.path());
+
+  const char kContents[] =
+      "// Comment\n"
+      "#include \"b/b.h\"\n"
+      "#include <vector>\n"
+      "#include \"c/c.h\"\n";
+  ASSERT_TRUE(base::CreateDirectory(temp_dir.path().AppendASCII("a")));
+  ASSERT_TRUE(base::WriteFile(temp_dir.path().AppendASCII("a/a.cc"),
+                              kContents, arraysize(kContents) - 1) > 0);
+  ASSERT_TRUE(base::WriteFile(temp_dir.path().AppendASCII("a/empty.cc"),
+                              "", 0) == 0);
+
+  scoped_refptr<HeaderChecker> checker(
+      new HeaderChecker(setup_.build_settings(), targets_));
+
+  // The first scan reads the file.
+  Err err;
+  IncludeCache::IncludeVector includes;
+  EXPECT_TRUE(checker->GetIncludes(&a_, SourceFile("//a/a.cc"), &includes,
+                                   &err));
+  EXPECT_FALSE(err.has_error());
+  ASSERT_EQ(2u, includes.size());
+  EXPECT_EQ("b/b.h", includes[0].path);
+  EXPECT_EQ(2, includes[0].line);
+  EXPECT_EQ(11, includes[0].begin_char);
+  EXPECT_EQ("c/c.h", includes[1].path);
+  EXPECT_EQ(4, includes[1].line);
+  EXPECT_EQ(0, checker->include_cache_.hit_count());
+
+  // The second one comes from the cache.
+  includes.clear();
+  EXPECT_TRUE(checker->GetIncludes(&a_, SourceFile("//a/a.cc"), &includes,
+                                   &err));
+  EXPECT_EQ(2u, includes.size());
+  EXPECT_EQ(1, checker->include_cache_.hit_count());
+
+  // Empty files can't be mapped but have no includes either.
+  includes.clear();
+  EXPECT_TRUE(checker->GetIncludes(&a_, SourceFile("//a/empty.cc"), &includes,
+                                   &err));
+  EXPECT_TRUE(includes.empty());
+
+  // Missing files are an error.
+  EXPECT_FALSE(checker->GetIncludes(&a_, SourceFile("//a/missing.cc"),
+                                    &includes, &err));
+  EXPECT_TRUE(err.has_error());
+}
@@ -0,0 +1,190 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/include_cache.h"
+
+#include "base/file_util.h"
+#include "base/files/file_path.h"
+#include "base/strings/string_number_conversions.h"
+#include "tools/gn/source_file.h"
+
+// The cache file is a header line followed by one record per source file:
+//
+//   <size> <last modified> <number of includes> <source file>
+//
+// followed by one line per include:
+//
+//   <line> <begin char> <include contents>
+//
+// The last field of each line runs to the end of the line, so it can contain
+// spaces.
+
+namespace {
+
+const char kHeader[] = "gn include cache 1";
+
+// Splits the given line at the first |count| spaces into |fields|, with the
+// rest of the line in |rest|. Returns false if there aren't enough fields.
+bool SplitCacheLine(const base::StringPiece& line,
+                    size_t count,
+                    base::StringPiece* fields,
+                    base::StringPiece* rest) {
+  size_t begin = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t space = line.find(' ', begin);
+    if (space == base::StringPiece::npos)
+      return false;
+    fields[i] = line.substr(begin, space - begin);
+    begin = space + 1;
+  }
+  *rest = line.substr(begin);
+  return true;
+}
+
+// Returns false at the end of the input.
+bool GetNextLine(const base::StringPiece& input,
+                 size_t* offset,
+                 base::StringPiece* line) {
+  if (*offset >= input.size())
+    return false;
+  size_t end = input.find('\n', *offset);
+  if (end == base::StringPiece::npos)
+    end = input.size();
+  *line = input.substr(*offset, end - *offset);
+  *offset = end + 1;
+  return true;
+}
+
+}  // namespace
+
+const char IncludeCache::kFileName[] = "gn_include_cache";
+
+IncludeCache::IncludeCache()
+    : hit_count_(0),
+      miss_count_(0),
+      dirty_(false) {
+}
+
+IncludeCache::~IncludeCache() {
+}
+
+bool IncludeCache::Load(const base::FilePath& path) {
+  base::AutoLock lock(lock_);
+  entries_.clear();
+  dirty_ = false;
+
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return false;
+
+  size_t offset = 0;
+  base::StringPiece line;
+  if (!GetNextLine(contents, &offset, &line) || line != kHeader)
+    return false;
+
+  EntryMap entries;
+  while (GetNextLine(contents, &offset, &line)) {
+    base::StringPiece fields[3];
+    base::StringPiece name;
+    Entry entry;
+    int count;
+    if (!SplitCacheLine(line, 3, fields, &name) ||
+        !base::StringToInt64(fields[0], &entry.size) ||
+        !base::StringToInt64(fields[1], &entry.last_modified) ||
+        !base::StringToInt(fields[2], &count) ||
+        count < 0)
+      return false;
+
+    entry.includes.resize(count);
+    for (int i = 0; i < count; i++) {
+      Include& include = entry.includes[i];
+      base::StringPiece include_path;
+      if (!GetNextLine(contents, &offset, &line) ||
+          !SplitCacheLine(line, 2, fields, &include_path) ||
+          !base::StringToInt(fields[0], &include.line) ||
+          !base::StringToInt(fields[1], &include.begin_char))
+        return false;
+      include.path = include_path.as_string();
+    }
+    entries[name.as_string()] = entry;
+  }
+
+  entries_.swap(entries);
+  return true;
+}
+
+bool IncludeCache::Save(const base::FilePath& path) {
+  base::AutoLock lock(lock_);
+
+  std::string contents(kHeader);
+  contents.push_back('\n');
+  for (EntryMap::const_iterator i = entries_.begin(); i != entries_.end();
+       ++i) {
+    const Entry& entry = i->second;
+    if (!entry.used) {
+      dirty_ = true;
+      continue;
+    }
+
+    contents.append(base::Int64ToString(entry.size));
+    contents.push_back(' ');
+    contents.append(base::Int64ToString(entry.last_modified));
+    contents.push_back(' ');
+    contents.append(base::IntToString(static_cast<int>(entry.includes.size())));
+    contents.push_back(' ');
+    contents.append(i->first);
+    contents.push_back('\n');
+
+    for (size_t inc = 0; inc < entry.includes.size(); inc++) {
+      const Include& include = entry.includes[inc];
+      contents.append(base::IntToString(include.line));
+      contents.push_back(' ');
+      contents.append(base::IntToString(include.begin_char));
+      contents.push_back(' ');
+      contents.append(include.path);
+      contents.push_back('\n');
+    }
+  }
+
+  if (!dirty_)
+    return true;
+
+  if (!base::CreateDirectory(path.DirName()))
+    return false;
+  int size = static_cast<int>(contents.size());
+  if (base::WriteFile(path, contents.data(), size) != size)
+    return false;
+  dirty_ = false;
+  return true;
+}
+
+bool IncludeCache::Get(const SourceFile& file,
+                       const base::File::Info& info,
+                       IncludeVector* includes) {
+  base::AutoLock lock(lock_);
+  EntryMap::iterator found = entries_.find(file.value());
+  if (found == entries_.end() ||
+      found->second.size != info.size ||
+      found->second.last_modified != info.last_modified.ToInternalValue()) {
+    miss_count_++;
+    return false;
+  }
+
+  hit_count_++;
+  found->second.used = true;
+  *includes = found->second.includes;
+  return true;
+}
+
+void IncludeCache::Set(const SourceFile& file,
+                       const base::File::Info& info,
+                       const IncludeVector& includes) {
+  base::AutoLock lock(lock_);
+  Entry& entry = entries_[file.value()];
+  entry.size = info.size;
+  entry.last_modified = info.last_modified.ToInternalValue();
+  entry.used = true;
+  entry.includes = includes;
+  dirty_ = true;
+}
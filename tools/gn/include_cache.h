@@ -0,0 +1,99 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_INCLUDE_CACHE_H_
+#define TOOLS_GN_INCLUDE_CACHE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+
+class SourceFile;
+
+namespace base {
+class FilePath;
+}
+
+// Remembers the #includes found in each source file between runs of the
+// header checker, so that files that haven't changed since the last check
+// don't need to be read again. An entry is only used while the size and
+// modification time of the file match the ones it was recorded with.
+//
+// Get() and Set() are threadsafe.
+class IncludeCache {
+ public:
+  struct Include {
+    Include() : line(0), begin_char(0) {}
+    Include(const base::StringPiece& p, int l, int b)
+        : path(p.as_string()),
+          line(l),
+          begin_char(b) {
+    }
+
+    std::string path;  // The contents of the include, without the quotes.
+    int line;  // One-based.
+    int begin_char;  // One-based.
+  };
+  typedef std::vector<Include> IncludeVector;
+
+  // Name of the cache file in the build directory.
+  static const char kFileName[];
+
+  IncludeCache();
+  ~IncludeCache();
+
+  // Replaces the contents of the cache with the given file. Returns false and
+  // leaves the cache empty if the file doesn't exist or isn't in the current
+  // format.
+  bool Load(const base::FilePath& path);
+
+  // Writes the entries that were looked up or set since the cache was loaded,
+  // so entries for files that are no longer checked get dropped. Does nothing
+  // if nothing changed. Returns false on failure.
+  bool Save(const base::FilePath& path);
+
+  // Fills in the includes recorded for the given file and returns true, or
+  // returns false if there is no entry that matches the given file info.
+  bool Get(const SourceFile& file,
+           const base::File::Info& info,
+           IncludeVector* includes);
+
+  // Records the includes for the given file.
+  void Set(const SourceFile& file,
+           const base::File::Info& info,
+           const IncludeVector& includes);
+
+  int hit_count() const { return hit_count_; }
+  int miss_count() const { return miss_count_; }
+
+ private:
+  struct Entry {
+    Entry() : size(0), last_modified(0), used(false) {}
+
+    int64 size;
+    int64 last_modified;  // Internal value of the base::Time.
+    bool used;
+    IncludeVector includes;
+  };
+  typedef std::map<std::string, Entry> EntryMap;
+
+  base::Lock lock_;
+
+  EntryMap entries_;
+
+  int hit_count_;
+  int miss_count_;
+
+  // Set when an entry was added, replaced, or dropped since the last load.
+  bool dirty_;
+
+  DISALLOW_COPY_AND_ASSIGN(IncludeCache);
+};
+
+#endif  // TOOLS_GN_INCLUDE_CACHE_H_
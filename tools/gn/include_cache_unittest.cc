@@ -0,0 +1,110 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "tools/gn/include_cache.h"
+#include "tools/gn/source_file.h"
+
+namespace {
+
+base::File::Info MakeInfo(int64 size, int64 last_modified) {
+  base::File::Info info;
+  info.size = size;
+  info.last_modified = base::Time::FromInternalValue(last_modified);
+  return info;
+}
+
+}  // namespace
+
+TEST(IncludeCache, GetSet) {
+  IncludeCache cache;
+  SourceFile file("//foo.cc");
+  base::File::Info info = MakeInfo(100, 12345);
+
+  IncludeCache::IncludeVector includes;
+  EXPECT_FALSE(cache.Get(file, info, &includes));
+
+  IncludeCache::IncludeVector set_includes;
+  set_includes.push_back(IncludeCache::Include("foo/bar.h", 3, 11));
+  cache.Set(file, info, set_includes);
+
+  EXPECT_TRUE(cache.Get(file, info, &includes));
+  ASSERT_EQ(1u, includes.size());
+  EXPECT_EQ("foo/bar.h", includes[0].path);
+  EXPECT_EQ(3, includes[0].line);
+  EXPECT_EQ(11, includes[0].begin_char);
+
+  // Changing the size or the modification time invalidates the entry.
+  EXPECT_FALSE(cache.Get(file, MakeInfo(101, 12345), &includes));
+  EXPECT_FALSE(cache.Get(file, MakeInfo(100, 12346), &includes));
+
+  EXPECT_EQ(1, cache.hit_count());
+  EXPECT_EQ(3, cache.miss_count());
+}
+
+TEST(IncludeCache, SaveLoad) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.path().AppendASCII(IncludeCache::kFileName);
+
+  SourceFile foo("//foo.cc");
+  SourceFile bar("//bar bar.h");  // Spaces are allowed.
+  base::File::Info info = MakeInfo(100, 12345);
+
+  IncludeCache::IncludeVector foo_includes;
+  foo_includes.push_back(IncludeCache::Include("foo/bar.h", 3, 11));
+  foo_includes.push_back(IncludeCache::Include("some dir/baz.h", 4, 12));
+  {
+    IncludeCache cache;
+    EXPECT_FALSE(cache.Load(path));
+    cache.Set(foo, info, foo_includes);
+    cache.Set(bar, info, IncludeCache::IncludeVector());
+    EXPECT_TRUE(cache.Save(path));
+  }
+
+  IncludeCache::IncludeVector includes;
+  {
+    IncludeCache cache;
+    EXPECT_TRUE(cache.Load(path));
+    EXPECT_TRUE(cache.Get(foo, info, &includes));
+    ASSERT_EQ(2u, includes.size());
+    EXPECT_EQ("foo/bar.h", includes[0].path);
+    EXPECT_EQ(3, includes[0].line);
+    EXPECT_EQ(11, includes[0].begin_char);
+    EXPECT_EQ("some dir/baz.h", includes[1].path);
+    EXPECT_EQ(4, includes[1].line);
+    EXPECT_EQ(12, includes[1].begin_char);
+
+    // Only foo was looked up, so bar is dropped when saving.
+    EXPECT_TRUE(cache.Save(path));
+  }
+
+  {
+    IncludeCache cache;
+    EXPECT_TRUE(cache.Load(path));
+    EXPECT_TRUE(cache.Get(foo, info, &includes));
+    EXPECT_FALSE(cache.Get(bar, info, &includes));
+  }
+}
+
+TEST(IncludeCache, LoadBadFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.path().AppendASCII(IncludeCache::kFileName);
+
+  const char kContents[] =
+      "gn include cache 1\n"
+      "100 12345 2 //foo.cc\n"
+      "3 11 a.h\n";
+  ASSERT_TRUE(base::WriteFile(path, kContents, arraysize(kContents) - 1) > 0);
+
+  // The second include is missing, so nothing is loaded.
+  IncludeCache cache;
+  EXPECT_FALSE(cache.Load(path));
+  IncludeCache::IncludeVector includes;
+  EXPECT_FALSE(cache.Get(SourceFile("//foo.cc"), MakeInfo(100, 12345),
+                         &includes));
+}
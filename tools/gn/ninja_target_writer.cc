@@ -7,7 +7,6 @@
 #include <fstream>
 #include <sstream>
 
-#include "base/file_util.h"
 #include "base/strings/string_util.h"
 #include "tools/gn/err.h"
 #include "tools/gn/filesystem_utils.h"
@@ -47,8 +46,6 @@ void NinjaTargetWriter::RunAndWriteFile(const Target* target) {
   if (g_scheduler->verbose_logging())
     g_scheduler->Log("Writing", FilePathToUTF8(ninja_file));
 
-  base::CreateDirectory(ninja_file.DirName());
-
   // It's rediculously faster to write to a string and then write that to
   // disk in one operation than to use an fstream here.
   std::stringstream file;
@@ -74,9 +71,9 @@ void NinjaTargetWriter::RunAndWriteFile(const Target* target) {
     CHECK(0);
   }
 
-  std::string contents = file.str();
-  base::WriteFile(ninja_file, contents.c_str(),
-                  static_cast<int>(contents.size()));
+  // Regenerating usually leaves most targets the same, so only the ninja
+  // files that changed get written.
+  WriteFileIfChanged(ninja_file, file.str());
 }
 
 void NinjaTargetWriter::WriteSharedVars(const SubstitutionBits& bits) {
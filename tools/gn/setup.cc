@@ -143,7 +143,8 @@ CommonSetup::CommonSetup()
       root_build_file_("//BUILD.gn"),
       check_for_bad_items_(true),
       check_for_unused_overrides_(true),
-      check_public_headers_(false) {
+      check_public_headers_(false),
+      write_traces_(true) {
   loader_->set_complete_callback(base::Bind(&DecrementWorkCount));
 }
 
@@ -154,7 +155,8 @@ CommonSetup::CommonSetup(const CommonSetup& other)
       root_build_file_(other.root_build_file_),
       check_for_bad_items_(other.check_for_bad_items_),
       check_for_unused_overrides_(other.check_for_unused_overrides_),
-      check_public_headers_(other.check_public_headers_) {
+      check_public_headers_(other.check_public_headers_),
+      write_traces_(other.write_traces_) {
   loader_->set_complete_callback(base::Bind(&DecrementWorkCount));
 }
 
@@ -188,6 +190,7 @@ bool CommonSetup::RunPostMessageLoop() {
   }
 
   if (check_public_headers_) {
+    ScopedTrace phase_trace(TraceItem::TRACE_PHASE, "Check headers");
     std::vector<const Target*> targets = builder_->GetAllResolvedTargets();
     scoped_refptr<HeaderChecker> header_checker(
         new HeaderChecker(&build_settings_, targets));
@@ -203,14 +206,18 @@ bool CommonSetup::RunPostMessageLoop() {
       return false;
   }
 
-  // Write out tracing and timing if requested.
+  if (write_traces_)
+    WriteTraces();
+
+  return true;
+}
+
+void CommonSetup::WriteTraces() const {
   const CommandLine* cmdline = CommandLine::ForCurrentProcess();
   if (cmdline->HasSwitch(kTimeSwitch))
     PrintLongHelp(SummarizeTraces());
   if (cmdline->HasSwitch(kTracelogSwitch))
     SaveTraces(cmdline->GetSwitchValuePath(kTracelogSwitch));
-
-  return true;
 }
 
 // Setup -----------------------------------------------------------------------
@@ -240,6 +247,7 @@ bool Setup::DoSetup(const std::string& build_dir) {
       cmdline->HasSwitch(kTracelogSwitch))
     EnableTracing();
 
+  ScopedTrace phase_trace(TraceItem::TRACE_PHASE, "Setup");
   ScopedTrace setup_trace(TraceItem::TRACE_SETUP, "DoSetup");
 
   if (!FillSourceDir(*cmdline))
@@ -260,9 +268,11 @@ bool Setup::DoSetup(const std::string& build_dir) {
 }
 
 bool Setup::Run() {
+  ScopedTrace phase_trace(TraceItem::TRACE_PHASE, "Load build files");
   RunPreMessageLoop();
   if (!scheduler_.Run())
     return false;
+  phase_trace.Done();
   return RunPostMessageLoop();
 }
 
@@ -497,6 +507,7 @@ bool Setup::RunConfigFile() {
         .PrintToStdout();
     return false;
   }
+  scheduler_.AddGenDependency(dotfile_name_);
 
   Err err;
   dotfile_tokens_ = Tokenizer::Tokenize(dotfile_input_file_.get(), &err);
@@ -54,6 +54,15 @@ class CommonSetup {
     check_public_headers_ = s;
   }
 
+  // When true (the default), RunPostMessageLoop will print the timing summary
+  // and save the trace log if they were requested on the command line.
+  // Commands that do more work after the run can turn this off and call
+  // WriteTraces() themselves once they're done.
+  void set_write_traces(bool s) { write_traces_ = s; }
+
+  // Prints the timing summary and saves the trace log if requested.
+  void WriteTraces() const;
+
   BuildSettings& build_settings() { return build_settings_; }
   Builder* builder() { return builder_.get(); }
   LoaderImpl* loader() { return loader_.get(); }
@@ -80,6 +89,7 @@ class CommonSetup {
   bool check_for_bad_items_;
   bool check_for_unused_overrides_;
   bool check_public_headers_;
+  bool write_traces_;
 
  private:
   CommonSetup& operator=(const CommonSetup& other);  // Disallow.
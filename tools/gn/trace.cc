@@ -56,10 +56,28 @@ bool DurationGreater(const TraceItem* a, const TraceItem* b) {
   return a->delta() > b->delta();
 }
 
+bool BeginLess(const TraceItem* a, const TraceItem* b) {
+  return a->begin() < b->begin();
+}
+
 bool CoalescedDurationGreater(const Coalesced& a, const Coalesced& b) {
   return a.total_duration > b.total_duration;
 }
 
+void SummarizePhases(std::vector<const TraceItem*>& phases,
+                     std::ostream& out) {
+  out << "Phase times: (time in ms, name)\n";
+
+  // Phases run one after the other, so list them in the order they ran.
+  std::sort(phases.begin(), phases.end(), &BeginLess);
+
+  for (size_t i = 0; i < phases.size(); i++) {
+    out << base::StringPrintf(" %8.2f  ",
+                              phases[i]->delta().InMillisecondsF());
+    out << phases[i]->name() << std::endl;
+  }
+}
+
 void SummarizeParses(std::vector<const TraceItem*>& loads,
                      std::ostream& out) {
   out << "File parse times: (time in ms, name)\n";
@@ -186,6 +204,7 @@ std::string SummarizeTraces() {
   std::vector<const TraceItem*> file_execs;
   std::vector<const TraceItem*> script_execs;
   std::vector<const TraceItem*> check_headers;
+  std::vector<const TraceItem*> phases;
   int headers_checked = 0;
   for (size_t i = 0; i < events.size(); i++) {
     switch (events[i]->type()) {
@@ -204,6 +223,9 @@ std::string SummarizeTraces() {
       case TraceItem::TRACE_CHECK_HEADER:
         headers_checked++;
         break;
+      case TraceItem::TRACE_PHASE:
+        phases.push_back(events[i]);
+        break;
       case TraceItem::TRACE_SETUP:
       case TraceItem::TRACE_FILE_LOAD:
       case TraceItem::TRACE_FILE_WRITE:
@@ -213,6 +235,10 @@ std::string SummarizeTraces() {
   }
 
   std::ostringstream out;
+  if (!phases.empty()) {
+    SummarizePhases(phases, out);
+    out << std::endl;
+  }
   SummarizeParses(parses, out);
   out << std::endl;
   SummarizeFileExecs(file_execs, out);
@@ -293,6 +319,9 @@ void SaveTraces(const base::FilePath& file_name) {
       case TraceItem::TRACE_CHECK_HEADERS:
         out << "\"header_check\"";
         break;
+      case TraceItem::TRACE_PHASE:
+        out << "\"phase\"";
+        break;
     }
 
     if (!item.toolchain().empty() || !item.cmdline().empty()) {
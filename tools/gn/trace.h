@@ -28,6 +28,7 @@ class TraceItem {
     TRACE_DEFINE_TARGET,
     TRACE_CHECK_HEADER,  // One file.
     TRACE_CHECK_HEADERS,  // All files.
+    TRACE_PHASE,  // One step of a command, such as loading or writing.
   };
 
   TraceItem(Type type,
@@ -8,6 +8,12 @@
 #include "base/strings/string_util.h"
 #include "tools/gn/scope.h"
 
+Value::ListStorage::ListStorage() {
+}
+
+Value::ListStorage::~ListStorage() {
+}
+
 Value::Value()
     : type_(NONE),
       boolean_value_(false),
@@ -20,6 +26,8 @@ Value::Value(const ParseNode* origin, Type t)
       boolean_value_(false),
       int_value_(0),
       origin_(origin) {
+  if (type_ == LIST)
+    list_value_ = new ListStorage;
 }
 
 Value::Value(const ParseNode* origin, bool bool_val)
@@ -88,6 +96,16 @@ Value& Value::operator=(const Value& other) {
   return *this;
 }
 
+std::vector<Value>& Value::list_value() {
+  DCHECK(type_ == LIST);
+  if (!list_value_->HasOneRef()) {
+    scoped_refptr<ListStorage> copy(new ListStorage);
+    copy->values = list_value_->values;
+    list_value_.swap(copy);
+  }
+  return list_value_->values;
+}
+
 // static
 const char* Value::DescribeType(Type t) {
   switch (t) {
@@ -137,10 +155,10 @@ std::string Value::ToString(bool quote_string) const {
       return string_value_;
     case LIST: {
       std::string result = "[";
-      for (size_t i = 0; i < list_value_.size(); i++) {
+      for (size_t i = 0; i < list_value().size(); i++) {
         if (i > 0)
           result += ", ";
-        result += list_value_[i].ToString(true);
+        result += list_value()[i].ToString(true);
       }
       result.push_back(']');
       return result;
@@ -188,6 +206,8 @@ bool Value::operator==(const Value& other) const {
     case Value::STRING:
       return string_value() == other.string_value();
     case Value::LIST:
+      if (list_value_ == other.list_value_)
+        return true;  // Copies of the same list.
       if (list_value().size() != other.list_value().size())
         return false;
       for (size_t i = 0; i < list_value().size(); i++) {
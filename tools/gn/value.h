@@ -9,6 +9,7 @@
 
 #include "base/basictypes.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string_piece.h"
 #include "tools/gn/err.h"
@@ -82,13 +83,15 @@ class Value {
     return string_value_;
   }
 
-  std::vector<Value>& list_value() {
-    DCHECK(type_ == LIST);
-    return list_value_;
-  }
+  // Lists are copy-on-write: copying a Value shares its list, and the list is
+  // only copied when the non-const accessor is called while it's shared.
+  // Templates, imports and closures copy lists around far more often than
+  // they modify them. Don't hold on to the mutable reference across a copy of
+  // this Value, since the copy would see later changes.
+  std::vector<Value>& list_value();
   const std::vector<Value>& list_value() const {
     DCHECK(type_ == LIST);
-    return list_value_;
+    return list_value_->values;
   }
 
   Scope* scope_value() {
@@ -115,6 +118,19 @@ class Value {
   bool operator!=(const Value& other) const;
 
  private:
+  // The storage for a list, shared between copies of the Value. Values are
+  // copied between threads (e.g. out of the scopes of imported files), so
+  // this must be threadsafe reference counted.
+  struct ListStorage : public base::RefCountedThreadSafe<ListStorage> {
+    ListStorage();
+
+    std::vector<Value> values;
+
+   private:
+    friend class base::RefCountedThreadSafe<ListStorage>;
+    ~ListStorage();
+  };
+
   // This are a lot of objects associated with every Value that need
   // initialization and tear down every time. It might be more efficient to
   // create a union of ManualConstructor objects (see SmallMap) and only
@@ -123,7 +139,7 @@ class Value {
   std::string string_value_;
   bool boolean_value_;
   int64 int_value_;
-  std::vector<Value> list_value_;
+  scoped_refptr<ListStorage> list_value_;  // Non-null for lists.
   scoped_ptr<Scope> scope_value_;
 
   const ParseNode* origin_;
@@ -36,3 +36,36 @@ TEST(Value, ToString) {
   EXPECT_EQ("{\n  a = 42\n  b = \"hello, world\"\n}", scopeval.ToString(false));
 }
 
+
+// Tests that copies of a list share storage until one of them is modified.
+TEST(Value, ListCopyOnWrite) {
+  Value original(NULL, Value::LIST);
+  original.list_value().push_back(Value(NULL, "a"));
+
+  Value copy(original);
+  const Value& const_original = original;
+  const Value& const_copy = copy;
+  EXPECT_EQ(&const_original.list_value(), &const_copy.list_value());
+  EXPECT_TRUE(original == copy);
+
+  // Modifying the copy leaves the original alone.
+  copy.list_value().push_back(Value(NULL, "b"));
+  EXPECT_NE(&const_original.list_value(), &const_copy.list_value());
+  ASSERT_EQ(1u, const_original.list_value().size());
+  ASSERT_EQ(2u, const_copy.list_value().size());
+  EXPECT_EQ("a", const_copy.list_value()[0].string_value());
+  EXPECT_EQ("b", const_copy.list_value()[1].string_value());
+  EXPECT_FALSE(original == copy);
+
+  // Unshared lists are modified in place.
+  const std::vector<Value>* storage = &const_copy.list_value();
+  copy.list_value().push_back(Value(NULL, "c"));
+  EXPECT_EQ(storage, &const_copy.list_value());
+
+  // Assignment shares too.
+  Value assigned;
+  assigned = copy;
+  EXPECT_EQ(storage, &static_cast<const Value&>(assigned).list_value());
+  assigned.list_value().clear();
+  EXPECT_EQ(3u, const_copy.list_value().size());
+}
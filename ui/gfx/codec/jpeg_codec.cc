@@ -6,6 +6,9 @@
 
 #include <setjmp.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "third_party/skia/include/core/SkBitmap.h"
@@ -451,6 +454,24 @@ class DecompressDestroyer {
 bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
                        ColorFormat format, std::vector<unsigned char>* output,
                        int* w, int* h) {
+  return DecodeScaled(input, input_size, format, 1,
+                      0, std::numeric_limits<int>::max(), output, w, h);
+}
+
+// static
+bool JPEGCodec::DecodeScaled(const unsigned char* input, size_t input_size,
+                             ColorFormat format, int scale_denominator,
+                             int first_row, int num_rows,
+                             std::vector<unsigned char>* output,
+                             int* w, int* h) {
+  if (scale_denominator != 1 && scale_denominator != 2 &&
+      scale_denominator != 4 && scale_denominator != 8) {
+    NOTREACHED() << "Invalid scale denominator";
+    return false;
+  }
+  if (first_row < 0 || num_rows <= 0)
+    return false;
+
   jpeg_decompress_struct cinfo;
   DecompressDestroyer destroyer;
   destroyer.SetManagedObject(&cinfo);
@@ -533,9 +554,20 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
   cinfo.output_components = 3;
 #endif
 
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = scale_denominator;
   jpeg_calc_output_dimensions(&cinfo);
   *w = cinfo.output_width;
   *h = cinfo.output_height;
+  // A libjpeg built without IDCT_SCALING_SUPPORTED ignores scale_denom.
+  const int image_width = cinfo.image_width;
+  const int image_height = cinfo.image_height;
+  if (*w != (image_width + scale_denominator - 1) / scale_denominator ||
+      *h != (image_height + scale_denominator - 1) / scale_denominator)
+    return false;
+  if (first_row >= *h)
+    return false;
+  int row_count = std::min(num_rows, *h - first_row);
 
   jpeg_start_decompress(&cinfo);
 
@@ -543,13 +575,23 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
   // how to align row lengths as we do for the compressor.
   int row_read_stride = cinfo.output_width * cinfo.output_components;
 
+  // The rows above the range have to be decoded, but aren't kept.
+  if (first_row > 0) {
+    scoped_ptr<unsigned char[]> skipped_row(new unsigned char[row_read_stride]);
+    unsigned char* rowptr = skipped_row.get();
+    for (int row = 0; row < first_row; row++) {
+      if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
+        return false;
+    }
+  }
+
 #ifdef JCS_EXTENSIONS
   // Create memory for a decoded image and write decoded lines to the memory
   // without conversions same as JPEGCodec::Encode().
   int row_write_stride = row_read_stride;
-  output->resize(row_write_stride * cinfo.output_height);
+  output->resize(row_write_stride * row_count);
 
-  for (int row = 0; row < static_cast<int>(cinfo.output_height); row++) {
+  for (int row = 0; row < row_count; row++) {
     unsigned char* rowptr = &(*output)[row * row_write_stride];
     if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
       return false;
@@ -558,9 +600,9 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
   if (format == FORMAT_RGB) {
     // easy case, row needs no conversion
     int row_write_stride = row_read_stride;
-    output->resize(row_write_stride * cinfo.output_height);
+    output->resize(row_write_stride * row_count);
 
-    for (int row = 0; row < static_cast<int>(cinfo.output_height); row++) {
+    for (int row = 0; row < row_count; row++) {
       unsigned char* rowptr = &(*output)[row * row_write_stride];
       if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
         return false;
@@ -585,11 +627,11 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
       return false;
     }
 
-    output->resize(row_write_stride * cinfo.output_height);
+    output->resize(row_write_stride * row_count);
 
     scoped_ptr<unsigned char[]> row_data(new unsigned char[row_read_stride]);
     unsigned char* rowptr = row_data.get();
-    for (int row = 0; row < static_cast<int>(cinfo.output_height); row++) {
+    for (int row = 0; row < row_count; row++) {
       if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
         return false;
       converter(rowptr, *w, &(*output)[row * row_write_stride]);
@@ -597,16 +639,27 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
   }
 #endif
 
-  jpeg_finish_decompress(&cinfo);
+  // When the rows below the range aren't wanted, skip decoding them and
+  // destroy the decompressor mid-image instead of finishing.
+  if (first_row + row_count == *h)
+    jpeg_finish_decompress(&cinfo);
   jpeg_destroy_decompress(&cinfo);
   return true;
 }
 
 // static
 SkBitmap* JPEGCodec::Decode(const unsigned char* input, size_t input_size) {
+  return DecodeScaled(input, input_size, 1);
+}
+
+// static
+SkBitmap* JPEGCodec::DecodeScaled(const unsigned char* input,
+                                  size_t input_size,
+                                  int scale_denominator) {
   int w, h;
   std::vector<unsigned char> data_vector;
-  if (!Decode(input, input_size, FORMAT_SkBitmap, &data_vector, &w, &h))
+  if (!DecodeScaled(input, input_size, FORMAT_SkBitmap, scale_denominator,
+                    0, std::numeric_limits<int>::max(), &data_vector, &w, &h))
     return NULL;
 
   // Skia only handles 32 bit images.
@@ -68,10 +68,34 @@ class GFX_EXPORT JPEGCodec {
                      ColorFormat format, std::vector<unsigned char>* output,
                      int* w, int* h);
 
+  // Like Decode() above, but decodes the image at 1/scale_denominator of its
+  // size, where scale_denominator is 1, 2, 4 or 8. libjpeg does the scaling
+  // as part of the inverse DCT, which is much cheaper than decoding at full
+  // size and downscaling. The scaled dimensions, rounded up, are placed in *w
+  // and *h. Returns false for a scale_denominator other than 1 if libjpeg
+  // can't scale, as is the case for third_party/libjpeg (use_libjpeg_turbo=0);
+  // callers then have to decode at full size.
+  //
+  // Only rows [first_row, first_row + num_rows) of the scaled image are
+  // written to *output, so that large images can be decoded a band at a time
+  // without holding all of them in memory. Rows past the bottom of the image
+  // are ignored, but first_row must be inside it. The rows above first_row
+  // still have to be decoded, the rows below the range don't.
+  static bool DecodeScaled(const unsigned char* input, size_t input_size,
+                           ColorFormat format, int scale_denominator,
+                           int first_row, int num_rows,
+                           std::vector<unsigned char>* output,
+                           int* w, int* h);
+
   // Decodes the JPEG data contained in input of length input_size. If
   // successful, a SkBitmap is created and returned. It is up to the caller
   // to delete the returned bitmap.
   static SkBitmap* Decode(const unsigned char* input, size_t input_size);
+
+  // Like Decode() above, but the bitmap is 1/scale_denominator of the size of
+  // the image. See DecodeScaled() above.
+  static SkBitmap* DecodeScaled(const unsigned char* input, size_t input_size,
+                                int scale_denominator);
 };
 
 }  // namespace gfx
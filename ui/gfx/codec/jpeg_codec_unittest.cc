@@ -4,6 +4,8 @@
 
 #include <math.h>
 
+#include <algorithm>
+
 #include "base/basictypes.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/gfx/codec/jpeg_codec.h"
@@ -164,6 +166,106 @@ TEST(JPEGCodec, EncodeDecodeRGBA) {
   ASSERT_GE(jpeg_equality_threshold, AveragePixelDelta(original, decoded));
 }
 
+TEST(JPEGCodec, DecodeScaled) {
+  int w = 32, h = 32;
+
+  std::vector<unsigned char> original;
+  MakeRGBImage(w, h, &original);
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(JPEGCodec::Encode(&original[0], JPEGCodec::FORMAT_RGB, w, h,
+                                w * 3, jpeg_quality, &encoded));
+
+  for (int scale = 1; scale <= 8; scale *= 2) {
+    std::vector<unsigned char> decoded;
+    int outw, outh;
+    if (!JPEGCodec::DecodeScaled(&encoded[0], encoded.size(),
+                                 JPEGCodec::FORMAT_RGB, scale,
+                                 0, h, &decoded, &outw, &outh)) {
+      // Only a libjpeg built without IDCT scaling may fail, and only when
+      // asked to scale.
+#if defined(USE_LIBJPEG_TURBO)
+      ADD_FAILURE() << "DecodeScaled failed for scale " << scale;
+#endif
+      EXPECT_NE(1, scale);
+      continue;
+    }
+    ASSERT_EQ(w / scale, outw);
+    ASSERT_EQ(h / scale, outh);
+
+    // The scaled image should look like the original averaged over each
+    // scale x scale block. Scaling the DCT is a little less exact than
+    // decoding at full size.
+    std::vector<unsigned char> expected(outw * outh * 3);
+    for (int y = 0; y < outh; y++) {
+      for (int x = 0; x < outw; x++) {
+        for (int c = 0; c < 3; c++) {
+          int sum = 0;
+          for (int dy = 0; dy < scale; dy++) {
+            for (int dx = 0; dx < scale; dx++) {
+              sum += original[((y * scale + dy) * w + x * scale + dx) * 3 + c];
+            }
+          }
+          expected[(y * outw + x) * 3 + c] =
+              (sum + scale * scale / 2) / (scale * scale);
+        }
+      }
+    }
+    ASSERT_GE(2 * jpeg_equality_threshold,
+              AveragePixelDelta(expected, decoded));
+  }
+}
+
+TEST(JPEGCodec, DecodeScaledRows) {
+  int w = 64, h = 64;
+
+  std::vector<unsigned char> original;
+  MakeRGBImage(w, h, &original);
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(JPEGCodec::Encode(&original[0], JPEGCodec::FORMAT_RGB, w, h,
+                                w * 3, jpeg_quality, &encoded));
+
+  std::vector<unsigned char> whole;
+  int outw, outh;
+  if (!JPEGCodec::DecodeScaled(&encoded[0], encoded.size(),
+                               JPEGCodec::FORMAT_RGBA, 2, 0, h,
+                               &whole, &outw, &outh)) {
+    // A libjpeg built without IDCT scaling can't decode at half size.
+#if defined(USE_LIBJPEG_TURBO)
+    ADD_FAILURE() << "DecodeScaled failed";
+#endif
+    return;
+  }
+  ASSERT_EQ(32, outw);
+  ASSERT_EQ(32, outh);
+  ASSERT_EQ(static_cast<size_t>(outw * outh * 4), whole.size());
+
+  // Decoding in bands gives the same rows as decoding all at once, including
+  // a last band that runs past the bottom of the image.
+  const int kBandHeight = 10;
+  for (int first_row = 0; first_row < outh; first_row += kBandHeight) {
+    std::vector<unsigned char> band;
+    int bandw, bandh;
+    ASSERT_TRUE(JPEGCodec::DecodeScaled(&encoded[0], encoded.size(),
+                                        JPEGCodec::FORMAT_RGBA, 2,
+                                        first_row, kBandHeight,
+                                        &band, &bandw, &bandh));
+    EXPECT_EQ(outw, bandw);
+    EXPECT_EQ(outh, bandh);
+
+    int rows = std::min(kBandHeight, outh - first_row);
+    ASSERT_EQ(static_cast<size_t>(outw * rows * 4), band.size());
+    EXPECT_TRUE(std::equal(band.begin(), band.end(),
+                           whole.begin() + first_row * outw * 4));
+  }
+
+  // The first row has to be inside the image.
+  std::vector<unsigned char> band;
+  EXPECT_FALSE(JPEGCodec::DecodeScaled(&encoded[0], encoded.size(),
+                                       JPEGCodec::FORMAT_RGBA, 2,
+                                       outh, kBandHeight,
+                                       &band, &outw, &outh));
+}
+
 // Test that corrupted data decompression causes failures.
 TEST(JPEGCodec, DecodeCorrupted) {
   int w = 20, h = 20;
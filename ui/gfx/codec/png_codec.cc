@@ -6,6 +6,7 @@
 
 #include "base/logging.h"
 #include "base/strings/string_util.h"
+#include "build/build_config.h"
 #include "third_party/libpng/png.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
@@ -18,16 +19,33 @@ namespace gfx {
 
 namespace {
 
+// Loads and stores a pixel as one word. The rows come from the caller and may
+// not be aligned, so this goes through memcpy, which compilers turn into a
+// plain load or store where that is allowed.
+inline uint32_t LoadPixel(const unsigned char* p) {
+  uint32_t pixel;
+  memcpy(&pixel, p, sizeof(pixel));
+  return pixel;
+}
+
+inline void StorePixel(uint32_t pixel, unsigned char* p) {
+  memcpy(p, &pixel, sizeof(pixel));
+}
+
 // Converts BGRA->RGBA and RGBA->BGRA.
 void ConvertBetweenBGRAandRGBA(const unsigned char* input, int pixel_width,
                                unsigned char* output, bool* is_opaque) {
   for (int x = 0; x < pixel_width; x++) {
-    const unsigned char* pixel_in = &input[x * 4];
-    unsigned char* pixel_out = &output[x * 4];
-    pixel_out[0] = pixel_in[2];
-    pixel_out[1] = pixel_in[1];
-    pixel_out[2] = pixel_in[0];
-    pixel_out[3] = pixel_in[3];
+    const uint32_t pixel_in = LoadPixel(&input[x * 4]);
+    // Swapping the first and third bytes is the same either way.
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+    const uint32_t pixel_out = (pixel_in & 0xff00ff00) |
+        ((pixel_in >> 16) & 0xff) | ((pixel_in & 0xff) << 16);
+#else
+    const uint32_t pixel_out = (pixel_in & 0x00ff00ff) |
+        ((pixel_in >> 16) & 0xff00) | ((pixel_in & 0xff00) << 16);
+#endif
+    StorePixel(pixel_out, &output[x * 4]);
   }
 }
 
@@ -39,8 +57,23 @@ void ConvertRGBAtoRGB(const unsigned char* rgba, int pixel_width,
 
 void ConvertSkiaToRGB(const unsigned char* skia, int pixel_width,
                       unsigned char* rgb, bool* is_opaque) {
+  // Rows that are entirely opaque don't need to be unpremultiplied.
+  uint32_t all = 0xffffffff;
+  for (int x = 0; x < pixel_width; x++)
+    all &= LoadPixel(&skia[x * 4]);
+  if (SkGetPackedA32(all) == 255) {
+    for (int x = 0; x < pixel_width; x++) {
+      const uint32_t pixel_in = LoadPixel(&skia[x * 4]);
+      unsigned char* pixel_out = &rgb[x * 3];
+      pixel_out[0] = SkGetPackedR32(pixel_in);
+      pixel_out[1] = SkGetPackedG32(pixel_in);
+      pixel_out[2] = SkGetPackedB32(pixel_in);
+    }
+    return;
+  }
+
   for (int x = 0; x < pixel_width; x++) {
-    const uint32_t pixel_in = *reinterpret_cast<const uint32_t*>(&skia[x * 4]);
+    const uint32_t pixel_in = LoadPixel(&skia[x * 4]);
     unsigned char* pixel_out = &rgb[x * 3];
 
     int alpha = SkGetPackedA32(pixel_in);
@@ -1117,6 +1117,44 @@ TEST(PNGCodec, EncodeBGRASkBitmapDiscardTransparency) {
   }
 }
 
+// Opaque rows are converted without unpremultiplying, so make sure a bitmap
+// mixing opaque and translucent rows survives with either compression setting.
+TEST(PNGCodec, EncodeBGRASkBitmapOpaqueAndTranslucentRows) {
+  const int w = 20, h = 20;
+
+  SkBitmap original_bitmap;
+  original_bitmap.allocN32Pixels(w, h);
+  for (int y = 0; y < h; y++) {
+    uint32_t* row = original_bitmap.getAddr32(0, y);
+    for (int x = 0; x < w; x++) {
+      int alpha = y % 2 ? (x * 10) % 256 : 255;
+      row[x] = SkPreMultiplyARGB(alpha, x * 12, y * 12, (x + y) * 6);
+    }
+  }
+
+  for (int fast = 0; fast < 2; fast++) {
+    std::vector<unsigned char> encoded;
+    if (fast) {
+      EXPECT_TRUE(
+          PNGCodec::FastEncodeBGRASkBitmap(original_bitmap, false, &encoded));
+    } else {
+      EXPECT_TRUE(
+          PNGCodec::EncodeBGRASkBitmap(original_bitmap, false, &encoded));
+    }
+
+    SkBitmap decoded_bitmap;
+    EXPECT_TRUE(PNGCodec::Decode(&encoded.front(), encoded.size(),
+                                 &decoded_bitmap));
+    for (int x = 0; x < w; x++) {
+      for (int y = 0; y < h; y++) {
+        uint32_t original_pixel = original_bitmap.getAddr32(0, y)[x];
+        uint32_t decoded_pixel = decoded_bitmap.getAddr32(0, y)[x];
+        EXPECT_TRUE(ColorsClose(original_pixel, decoded_pixel));
+      }
+    }
+  }
+}
+
 TEST(PNGCodec, EncodeWithComment) {
   const int w = 10, h = 10;
 
@@ -4,6 +4,8 @@
 
 #include "ui/gfx/skia_util.h"
 
+#include <string.h>
+
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColorFilter.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
@@ -166,12 +168,41 @@ bool BitmapsAreEqual(const SkBitmap& bitmap1, const SkBitmap& bitmap2) {
   return (size1 == size2) && (0 == memcmp(addr1, addr2, bitmap1.getSize()));
 }
 
+namespace {
+
+// |skia| may not be aligned, so pixels are loaded through memcpy, which
+// compilers turn into a plain load where that is allowed.
+inline uint32_t LoadPixel(const unsigned char* p) {
+  uint32_t pixel;
+  memcpy(&pixel, p, sizeof(pixel));
+  return pixel;
+}
+
+}  // namespace
+
 void ConvertSkiaToRGBA(const unsigned char* skia,
                        int pixel_width,
                        unsigned char* rgba) {
   int total_length = pixel_width * 4;
+
+  // Rows that are entirely opaque, the common case, don't need to be
+  // unpremultiplied.
+  uint32_t all = 0xffffffff;
+  for (int i = 0; i < total_length; i += 4)
+    all &= LoadPixel(&skia[i]);
+  if (SkGetPackedA32(all) == 255) {
+    for (int i = 0; i < total_length; i += 4) {
+      const uint32_t pixel_in = LoadPixel(&skia[i]);
+      rgba[i + 0] = SkGetPackedR32(pixel_in);
+      rgba[i + 1] = SkGetPackedG32(pixel_in);
+      rgba[i + 2] = SkGetPackedB32(pixel_in);
+      rgba[i + 3] = 255;
+    }
+    return;
+  }
+
   for (int i = 0; i < total_length; i += 4) {
-    const uint32_t pixel_in = *reinterpret_cast<const uint32_t*>(&skia[i]);
+    const uint32_t pixel_in = LoadPixel(&skia[i]);
 
     // Pack the components here.
     int alpha = SkGetPackedA32(pixel_in);